@@ -56,6 +56,10 @@ public:
     void Hide(boost::shared_ptr<Window> window);
     // check if the window is visible
     bool IsVisible(boost::shared_ptr<Window> window) const;
+    // check if the window is shown and not minimized (something on screen needs its frames)
+    bool IsOnScreen(boost::shared_ptr<Window> window) const;
+    // check if no tracked window is on screen (all hidden or minimized)
+    bool AreAllWindowsHidden() const;
 
     // --- 多窗口管理 ---
 
@@ -130,6 +134,10 @@ void ExecuteBackgroundTask(boost::shared_ptr<T> contextObject, TaskAction&& task
     boost::signals2::signal<void(boost::shared_ptr<Window>, int, int)> OnWindowResized;
     boost::signals2::signal<void(boost::shared_ptr<Window>, bool)> OnWindowFocusChanged;
     boost::signals2::signal<void(boost::shared_ptr<Window>, float xScale, float yScale)> OnScreenScaleFactorChanged;
+    // 窗口显示/隐藏或最小化/恢复时触发（onScreen 为 IsOnScreen 的新值）
+    boost::signals2::signal<void(boost::shared_ptr<Window>, bool onScreen)> OnWindowVisibilityChanged;
+    // 最后一个在屏幕上的窗口被隐藏或最小化时触发（适合释放 GPU 缓存等资源）
+    boost::signals2::signal<void()> OnAllWindowsHidden;
     
 private:
     // 构造与析构私有化
@@ -142,6 +150,9 @@ private:
     WindowManager(WindowManager&&) = delete;
     WindowManager& operator=(WindowManager&&) = delete;
 
+    // 窗口可见性变化后发出信号
+    void NotifyVisibilityChanged(boost::shared_ptr<Window> window, bool wasAllHidden);
+
     // --- 内部成员 ---
 
     // 多窗口追踪容器
@@ -60,6 +60,13 @@ public:
     float GetContentScaleY() const { return contentScaleY_; }
     float GetContentScale() const { return contentScaleX_; } // 返回 X 缩放因子作为主要缩放值
 
+    // 窗口是否处于最小化状态
+    bool IsIconified() const { return iconified_; }
+
+    // 帧缓冲区尺寸（像素，由 GLFW 回调维护，不需要每帧查询）
+    int GetFramebufferWidth() const { return framebufferWidth_; }
+    int GetFramebufferHeight() const { return framebufferHeight_; }
+
     // DPI 变化信号（当窗口所在的屏幕 DPI 改变时触发）
     boost::signals2::signal<void(float xScale, float yScale)> OnContentScaleChanged;
     
@@ -68,6 +75,12 @@ public:
     
     // 窗口需要重绘信号（当窗口内容需要重新渲染时触发，如 DPI 变化）
     boost::signals2::signal<void()> OnInvalidate;
+    
+    // 最小化状态变化信号（窗口被最小化或从最小化恢复时触发）
+    boost::signals2::signal<void(bool iconified)> OnIconifyChanged;
+    
+    // 帧缓冲区尺寸变化信号（拖动调整大小时每个中间尺寸都会触发，渲染侧应在帧内合并处理）
+    boost::signals2::signal<void(int width, int height)> OnFramebufferResized;
 
 private:
     GLFWwindow* handle_;
@@ -77,6 +90,13 @@ private:
     float contentScaleX_ = 1.0f;
     float contentScaleY_ = 1.0f;
     
+    // 最小化状态（由 GLFW 回调维护）
+    bool iconified_ = false;
+    
+    // 帧缓冲区尺寸（由 GLFW 回调维护）
+    int framebufferWidth_ = 0;
+    int framebufferHeight_ = 0;
+    
     // 更新 DPI 缩放因子（由 GLFW 回调调用）
     void UpdateContentScale(float xScale, float yScale);
     
@@ -88,6 +108,12 @@ private:
     
     // GLFW 焦点回调的静态包装函数
     static void FocusCallback(GLFWwindow* window, int focused);
+    
+    // GLFW 最小化回调的静态包装函数
+    static void IconifyCallback(GLFWwindow* window, int iconified);
+    
+    // GLFW 帧缓冲区尺寸回调的静态包装函数
+    static void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
 };
 
 } // namespace foundation
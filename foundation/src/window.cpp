@@ -21,6 +21,9 @@ Window::Window(GLFWwindow* handle, bool isFrameless)
     contentScaleX_ = SnapToNearestStep(systemXScale);
     contentScaleY_ = SnapToNearestStep(systemYScale);
     
+    iconified_ = glfwGetWindowAttrib(handle_, GLFW_ICONIFIED) != 0;
+    glfwGetFramebufferSize(handle_, &framebufferWidth_, &framebufferHeight_);
+    
     // 设置窗口用户指针，用于回调中获取 Window 实例
     glfwSetWindowUserPointer(handle_, this);
     // 设置 GLFW 回调
@@ -64,6 +67,12 @@ void Window::SetupCallbacks() {
     
     // 设置焦点回调
     glfwSetWindowFocusCallback(handle_, FocusCallback);
+    
+    // 设置最小化回调
+    glfwSetWindowIconifyCallback(handle_, IconifyCallback);
+    
+    // 设置帧缓冲区尺寸回调
+    glfwSetFramebufferSizeCallback(handle_, FramebufferSizeCallback);
 }
 
 void Window::ContentScaleCallback(GLFWwindow* window, float xScale, float yScale) {
@@ -103,6 +112,23 @@ void Window::FocusCallback(GLFWwindow* window, int focused) {
     }
 }
 
+void Window::IconifyCallback(GLFWwindow* window, int iconified) {
+    Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    if (win && win->iconified_ != (iconified != 0)) {
+        win->iconified_ = iconified != 0;
+        win->OnIconifyChanged(win->iconified_);
+    }
+}
+
+void Window::FramebufferSizeCallback(GLFWwindow* window, int width, int height) {
+    Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    if (win && (win->framebufferWidth_ != width || win->framebufferHeight_ != height)) {
+        win->framebufferWidth_ = width;
+        win->framebufferHeight_ = height;
+        win->OnFramebufferResized(width, height);
+    }
+}
+
 } // namespace foundation
 } // namespace KiUI
 
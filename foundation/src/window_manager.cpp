@@ -72,17 +72,46 @@ namespace KiUI{
         }
 
         void WindowManager::Show(boost::shared_ptr<Window> window){
+            if (!window) return;
+            bool wasAllHidden = AreAllWindowsHidden();
             glfwShowWindow(window->GetHandle());
+            NotifyVisibilityChanged(window, wasAllHidden);
         }
 
         void WindowManager::Hide(boost::shared_ptr<Window> window){
+            if (!window) return;
+            bool wasAllHidden = AreAllWindowsHidden();
             glfwHideWindow(window->GetHandle());
+            NotifyVisibilityChanged(window, wasAllHidden);
         }
 
         bool WindowManager::IsVisible(boost::shared_ptr<Window> window) const{
             return glfwGetWindowAttrib(window->GetHandle(), GLFW_VISIBLE) != 0;
         }
 
+        bool WindowManager::IsOnScreen(boost::shared_ptr<Window> window) const{
+            return window && IsVisible(window) && !window->IsIconified();
+        }
+
+        bool WindowManager::AreAllWindowsHidden() const{
+            for (const auto& window : trackedWindows_) {
+                if (IsOnScreen(window)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void WindowManager::NotifyVisibilityChanged(boost::shared_ptr<Window> window, bool wasAllHidden){
+            OnWindowVisibilityChanged(window, IsOnScreen(window));
+            if (!wasAllHidden && AreAllWindowsHidden()) {
+                #ifndef NDEBUG
+                Logger::Debug("WindowManager::OnAllWindowsHidden: {0} tracked windows", trackedWindows_.size());
+                #endif
+                OnAllWindowsHidden();
+            }
+        }
+
         boost::shared_ptr<Window> WindowManager::CreateNativeWindow(
             const std::string& windowTitle,
             int width,
@@ -115,6 +144,22 @@ namespace KiUI{
             window->OnInvalidate.connect([this, weakWin]() {
             });
             
+            // 最小化/恢复同样会改变窗口是否在屏幕上
+            window->OnIconifyChanged.connect([this, weakWin](bool iconified) {
+                if (auto pinnedWin = weakWin.lock()) {
+                    // 回调触发时状态已经更新：最小化前它在屏幕上当且仅当它是可见的
+                    bool othersOnScreen = false;
+                    for (const auto& other : trackedWindows_) {
+                        if (other != pinnedWin && IsOnScreen(other)) {
+                            othersOnScreen = true;
+                        }
+                    }
+                    bool wasOnScreen = iconified && IsVisible(pinnedWin);
+                    bool wasAllHidden = !othersOnScreen && !wasOnScreen;
+                    this->NotifyVisibilityChanged(pinnedWin, wasAllHidden);
+                }
+            });
+            
             // 当窗口获得或失去焦点时，更新 WindowManager 的焦点窗口状态
             window->OnFocusChanged.connect([this, weakWin](bool focused) {
                 if (auto pinnedWin = weakWin.lock()) {
@@ -146,8 +191,13 @@ namespace KiUI{
             // 从追踪列表中移除
             auto it = std::find(trackedWindows_.begin(), trackedWindows_.end(), window);
             if (it != trackedWindows_.end()) {
+                bool wasAllHidden = AreAllWindowsHidden();
                 OnWindowClosed(window);
                 trackedWindows_.erase(it);
+                // 关掉最后一个在屏幕上的窗口后，剩下的窗口都不可见
+                if (!wasAllHidden && !trackedWindows_.empty() && AreAllWindowsHidden()) {
+                    OnAllWindowsHidden();
+                }
             }
         }
 
@@ -0,0 +1,169 @@
+#ifndef DRAW_COMMAND_BUFFER_HPP
+#define DRAW_COMMAND_BUFFER_HPP
+#pragma once
+
+#include <include/core/SkCanvas.h>
+#include <include/core/SkPaint.h>
+#include <include/core/SkColor.h>
+#include <include/core/SkMatrix.h>
+#include <include/core/SkRect.h>
+#include <include/core/SkRRect.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace KiUI {
+namespace graphics {
+
+/**
+ * @brief 绘制命令缓冲区
+ * 收集一帧内的图元命令（参数与 Shapes 一致），在 Flush 时统一提交给 SkCanvas：
+ * - 在不破坏画家算法顺序的前提下，把绘制状态相同的命令排到一起（只与不重叠的命令交换次序）
+ * - 对齐到设备像素的纯色填充矩形合并成一次 drawVertices 调用
+ * - 复用同一个 SkPaint，只在矩阵真正变化时调用 setMatrix，不再逐个图元 save/concat/restore
+ */
+class DrawCommandBuffer {
+public:
+    /**
+     * @brief 最近一次 Flush 的统计信息
+     */
+    struct Stats {
+        size_t commands = 0;     ///< 提交的图元命令数
+        size_t batches = 0;      ///< 重排后的批次数
+        size_t drawCalls = 0;    ///< 实际发出的 SkCanvas 绘制调用数
+        size_t mergedRects = 0;  ///< 通过 drawVertices 合并绘制的矩形数
+    };
+
+    /**
+     * @brief 向前查找可合并批次时最多跨越的批次数
+     */
+    static constexpr size_t kReorderWindow = 16;
+
+    DrawCommandBuffer();
+    ~DrawCommandBuffer();
+
+    /**
+     * @brief 设置后续命令使用的局部到设备矩阵
+     * @param matrix 完整的设备矩阵（不是相对于上一个矩阵的增量）
+     */
+    void SetMatrix(const SkMatrix& matrix);
+
+    /**
+     * @brief 获取当前矩阵
+     * @return 当前的局部到设备矩阵
+     */
+    const SkMatrix& GetMatrix() const { return matrix_; }
+
+    /**
+     * @brief 记录矩形，参数含义同 Shapes::DrawRectangle
+     */
+    void AddRectangle(float x, float y, float width, float height,
+                      SkColor fillColor = SK_ColorTRANSPARENT,
+                      SkColor strokeColor = SK_ColorTRANSPARENT,
+                      float strokeWidth = 0.0f,
+                      float opacity = 1.0f);
+
+    /**
+     * @brief 记录圆角矩形（四角半径可不同），参数含义同 Shapes::DrawRoundedRectangle
+     */
+    void AddRoundedRectangle(float x, float y, float width, float height,
+                             float topLeft, float topRight,
+                             float bottomRight, float bottomLeft,
+                             SkColor fillColor = SK_ColorTRANSPARENT,
+                             SkColor strokeColor = SK_ColorTRANSPARENT,
+                             float strokeWidth = 0.0f,
+                             float opacity = 1.0f);
+
+    /**
+     * @brief 记录圆形，参数含义同 Shapes::DrawCircle
+     */
+    void AddCircle(float centerX, float centerY, float radius,
+                   SkColor fillColor = SK_ColorTRANSPARENT,
+                   SkColor strokeColor = SK_ColorTRANSPARENT,
+                   float strokeWidth = 0.0f,
+                   float opacity = 1.0f);
+
+    /**
+     * @brief 把已记录的命令提交到画布并清空缓冲区
+     * 画布的矩阵和裁剪状态在返回后保持不变
+     * @param canvas Skia 画布
+     */
+    void Flush(SkCanvas* canvas);
+
+    /**
+     * @brief 丢弃已记录的命令（矩阵保持不变）
+     */
+    void Clear();
+
+    /**
+     * @brief 是否没有待提交的命令
+     */
+    bool IsEmpty() const { return commands_.empty(); }
+
+    /**
+     * @brief 待提交的命令数
+     */
+    size_t GetCommandCount() const { return commands_.size(); }
+
+    /**
+     * @brief 获取最近一次 Flush 的统计信息
+     */
+    const Stats& GetLastFlushStats() const { return lastStats_; }
+
+private:
+    enum class CommandType : uint8_t {
+        SolidRect,  // 对齐到设备像素的纯色填充矩形，坐标为设备空间，可合并
+        Rect,
+        RRect,
+        Circle,
+    };
+
+    static constexpr uint32_t kNoIndex = 0xFFFFFFFFu;
+
+    struct Command {
+        CommandType type;
+        SkColor color;
+        float strokeWidth;     // 0 表示填充
+        uint32_t matrixIndex;  // SolidRect 不使用
+        uint32_t rrectIndex;   // 仅 RRect 使用
+        uint32_t next;         // 同一批次中的下一条命令
+        SkRect rect;           // 局部坐标（SolidRect 为设备坐标；Circle 为外接矩形）
+    };
+
+    // 批次只按绘制状态（图元类型、颜色、描边）区分，矩阵在批次内逐条切换
+    struct Batch {
+        CommandType type;
+        SkColor color;
+        float strokeWidth;
+        uint32_t first;
+        uint32_t last;
+        uint32_t count;
+        SkRect bounds;         // 设备空间包围盒
+    };
+
+    void AddCommand(CommandType type, const SkRect& rect, const SkRRect* rrect,
+                    SkColor color, float strokeWidth);
+    bool MapToPixelAlignedRect(const SkRect& rect, SkRect* deviceRect) const;
+    uint32_t CurrentMatrixIndex();
+    void FlushSolidRects(SkCanvas* canvas, const Batch& batch);
+
+    SkMatrix matrix_;
+    std::vector<SkMatrix> matrices_;
+    bool matrixRecorded_ = false;
+
+    std::vector<Command> commands_;
+    std::vector<SkRRect> rrects_;
+    std::vector<Batch> batches_;
+
+    // 跨帧复用的临时存储
+    std::vector<SkPoint> positions_;
+    std::vector<uint16_t> indices_;
+    SkPaint paint_;
+
+    Stats lastStats_;
+};
+
+} // namespace graphics
+} // namespace KiUI
+
+#endif // DRAW_COMMAND_BUFFER_HPP
@@ -0,0 +1,190 @@
+#ifndef GLYPH_ATLAS_HPP
+#define GLYPH_ATLAS_HPP
+#pragma once
+
+#include "TextEngine.hpp"
+#include <include/core/SkBitmap.h>
+#include <include/core/SkCanvas.h>
+#include <include/core/SkColor.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkRect.h>
+#include <include/core/SkRefCnt.h>
+#include <include/core/SkSurface.h>
+#include <boost/noncopyable.hpp>
+#include <boost/signals2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+class GrDirectContext;
+
+namespace KiUI {
+namespace graphics {
+
+/**
+ * @brief 字形图集：把光栅化后的字形打包进一张共享纹理，一段文字用一次 drawAtlas 绘制
+ * 字形按（字体、字形、设备像素字号）缓存，只在第一次出现时光栅化；
+ * 图集用行（shelf）方式分配空间，放满后整体清空重建。
+ * CPU 端像素在所有线程之间共享，GPU 纹理按 GrDirectContext 分别维护（共享上下文各自持有一份），
+ * 新增字形时只上传变化的区域；光栅画布同样使用一块只写入变化区域的光栅表面。
+ * 录制（SkPictureRecorder）的画布按光栅画布处理，录制结果持有图集快照，之后新增字形时
+ * 写时复制会复制整张光栅图集（默认 4MB）
+ */
+class GlyphAtlas : boost::noncopyable {
+public:
+    /**
+     * @brief 默认图集边长（像素）
+     */
+    static constexpr int kDefaultSize = 1024;
+
+    /**
+     * @brief 图集统计
+     */
+    struct Stats {
+        size_t glyphCount = 0;      ///< 当前图集中的字形数
+        uint64_t rasterized = 0;    ///< 累计光栅化的字形数
+        uint64_t resets = 0;        ///< 图集放满后清空的次数
+        uint64_t uploads = 0;       ///< 纹理上传次数
+    };
+
+    /**
+     * @brief 遍历字形的回调：字体 id、字形索引、设备像素字号 × 4、位图（空白字形的宽高为 0）
+     */
+    using GlyphVisitor = std::function<void(int fontId, uint32_t glyphId, uint32_t sizeKey, const GlyphBitmap& bitmap)>;
+
+    static GlyphAtlas& GetSharedInstance();
+
+    /**
+     * @brief 构造图集
+     * @param width 图集宽度
+     * @param height 图集高度
+     */
+    explicit GlyphAtlas(int width = kDefaultSize, int height = kDefaultSize);
+    ~GlyphAtlas();
+
+    /**
+     * @brief 绘制一段排版结果
+     * 缺少的字形先光栅化进图集，然后整段文字用一次 drawAtlas 绘制。
+     * 字形按画布当前的缩放光栅化，缩放后的文字依然清晰
+     * @param canvas 画布
+     * @param run 排版结果
+     * @param x 起点 x（基线）
+     * @param y 基线 y
+     * @param color 文字颜色
+     * @param opacity 额外的不透明度
+     */
+    void DrawRun(SkCanvas* canvas, const ShapedRun& run, float x, float y, SkColor color, float opacity = 1.0f);
+
+    /**
+     * @brief 放入已经光栅化的字形（例如从磁盘缓存读取），字形已存在时忽略
+     * @param fontId 字体 id
+     * @param glyphId 字形索引
+     * @param sizeKey 设备像素字号 × 4（四舍五入），与 DrawRun 使用的键一致
+     * @param bitmap 字形位图
+     * @return 是否已在图集中；图集放满时返回 false
+     */
+    bool AddGlyph(int fontId, uint32_t glyphId, uint32_t sizeKey, const GlyphBitmap& bitmap);
+
+    /**
+     * @brief 遍历图集中的所有字形（覆盖率从图集像素中取回），遍历期间持有图集的锁
+     */
+    void ForEachGlyph(const GlyphVisitor& visitor) const;
+
+    /**
+     * @brief 清空图集（字形下次绘制时重新光栅化）
+     */
+    void Clear();
+
+    /**
+     * @brief 释放指定上下文的纹理，CPU 端像素保留；上下文关闭时自动调用
+     * 纹理属于该上下文，必须在使用它的线程上调用（图集本身可以被多个线程共享）
+     * @param context GPU 上下文
+     */
+    void ReleaseTextures(GrDirectContext* context);
+
+    /**
+     * @brief 获取统计信息
+     */
+    Stats GetStats() const;
+
+private:
+    struct GlyphKey {
+        int fontId;
+        uint32_t glyphId;
+        uint32_t sizeKey;   // 设备像素字号 × 4（四分之一像素精度）
+
+        bool operator==(const GlyphKey& other) const {
+            return fontId == other.fontId && glyphId == other.glyphId && sizeKey == other.sizeKey;
+        }
+    };
+
+    struct GlyphKeyHash {
+        size_t operator()(const GlyphKey& key) const;
+    };
+
+    struct GlyphEntry {
+        SkRect texRect;     // 在图集中的位置，空白字形为空矩形
+        float left = 0.0f;  // 位图相对于字形原点的偏移（设备像素）
+        float top = 0.0f;
+    };
+
+    /**
+     * @brief 查找字形，不存在时光栅化并放入图集（调用方持有锁）
+     * @return 字形条目；图集已满返回 nullptr
+     */
+    const GlyphEntry* FindOrAddLocked(int fontId, uint32_t glyphId, uint32_t sizeKey);
+
+    /**
+     * @brief 把位图复制进图集并记录条目（调用方持有锁）
+     * @return 字形条目；图集已满返回 nullptr
+     */
+    const GlyphEntry* InsertLocked(const GlyphKey& key, const GlyphBitmap& bitmap);
+
+    /**
+     * @brief 在图集中分配一块区域（调用方持有锁）
+     */
+    bool AllocateLocked(int width, int height, int* x, int* y);
+
+    /**
+     * @brief 清空图集内容（调用方持有锁）
+     */
+    void ResetLocked();
+
+    /**
+     * @brief 记录需要重新上传的区域（调用方持有锁）
+     */
+    void MarkDirtyLocked(const SkIRect& rect);
+
+    /**
+     * @brief 获取可以在 canvas 上绘制的图集图片，有变化的区域先上传（调用方持有锁）
+     */
+    sk_sp<SkImage> GetImageLocked(SkCanvas* canvas);
+
+    struct Upload {
+        sk_sp<SkSurface> surface;   // 图集纹理（光栅画布为光栅表面）
+        sk_sp<SkImage> image;       // surface 的快照，只在图集清空后写入时由 Skia 写时复制
+        SkIRect dirty = SkIRect::MakeEmpty();
+        bool overwritten = false;   // 上次写入后图集被清空过，已有字形的位置会被覆盖
+    };
+
+    mutable std::mutex mutex_;
+    int width_;
+    int height_;
+    SkBitmap pixels_;           // 预乘 RGBA，颜色为白色、alpha 为覆盖率，绘制时用 kModulate 着色
+    std::unordered_map<GlyphKey, GlyphEntry, GlyphKeyHash> glyphs_;
+    int shelfX_ = 0;            // 当前行已用宽度
+    int shelfY_ = 0;            // 当前行顶部
+    int shelfHeight_ = 0;       // 当前行高度
+    std::unordered_map<GrDirectContext*, Upload> textures_;    // 键为 nullptr 的是光栅画布使用的表面
+    uint64_t rasterized_ = 0;
+    uint64_t resets_ = 0;
+    uint64_t uploads_ = 0;
+    boost::signals2::scoped_connection shutdownConnection_;
+};
+
+} // namespace graphics
+} // namespace KiUI
+
+#endif // GLYPH_ATLAS_HPP
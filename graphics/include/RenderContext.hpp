@@ -6,15 +6,28 @@
 #include <boost/optional.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <include/core/SkRefCnt.h>
+#include "TextDiskCache.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
 
 class GrDirectContext;
+class SkCanvas;
+class SkImage;
+class SkPixmap;
 namespace KiUI {
 namespace foundation {
     class Window;
+    class WindowManager;
 }
 
 namespace graphics {
 
+class ShaderCache;
+
 /**
  * @brief RenderContext: 渲染上下文管理类
  * 负责管理图形渲染相关的资源，包括渲染上下文创建、销毁和状态管理
@@ -26,14 +39,97 @@ public:
     
     /**
      * @brief 初始化渲染上下文
+     * 如果之前调用过 SetShaderCacheDirectory，会以该目录创建持久化着色器缓存并交给 Skia；
+     * 如果之前调用过 SetTextCacheFile，会用该文件预先填充字形图集和排版缓存
      * @return 是否成功初始化
      */
     bool Initialize();
+
+    /**
+     * @brief 设置持久化着色器缓存目录（需在 Initialize 之前调用）
+     * 编译过的 GL 程序二进制保存在该目录下，按 GL 渲染器/ANGLE 版本/Skia 版本分子目录，
+     * 下次启动直接加载，避免首帧和首次出现新效果时的编译卡顿
+     * @param directory 缓存目录，空字符串表示不使用缓存
+     */
+    void SetShaderCacheDirectory(const std::string& directory);
+
+    /**
+     * @brief 设置文字磁盘缓存文件（需在 Initialize 之前调用）
+     * Initialize 时读取文件，把上次运行的字形位图和排版结果放回共享的图集和排版缓存
+     * （只恢复已经加载的字体，字体应在 Initialize 之前加载）；Shutdown 时把当前内容写回文件。
+     * 见 TextDiskCache
+     * @param path 缓存文件路径，空字符串表示不使用缓存
+     */
+    void SetTextCacheFile(const std::string& path);
+
+    /**
+     * @brief 获取持久化着色器缓存
+     * @return 缓存对象，未启用时返回 nullptr
+     */
+    ShaderCache* GetShaderCache() const;
+
+    /**
+     * @brief 获取 Initialize 时从文字磁盘缓存恢复的统计
+     * @return 加载统计，未设置缓存文件或文件无效时各项为 0
+     */
+    TextDiskCache::Stats GetTextCacheStats() const;
+
+    /**
+     * @brief 着色器预热
+     * 在离屏表面上绘制一组有代表性的图元（矩形、圆角矩形、圆、描边、变换、合并矩形、
+     * 透明度图层等），让 Skia 提前编译（或从持久化缓存加载）这些程序并同步等待完成
+     * @param extraDraws 额外的预热绘制（例如用示例组件树渲染一帧），可以为空
+     * @return 是否执行了预热
+     */
+    bool WarmUpShaders(const std::function<void(SkCanvas*)>& extraDraws = nullptr);
+
+    /**
+     * @brief 获取最近一次 WarmUpShaders 的耗时（包括等待 GPU 完成）
+     * @return 耗时，没有执行过预热时为 0
+     */
+    std::chrono::milliseconds GetWarmUpDuration() const;
     /**
      * @brief 资源释放
      */
     void Shutdown();
 
+    /**
+     * @brief 创建与 parent 处于同一共享组的渲染上下文
+     * 新上下文复用 parent 的 EGLDisplay/EGLConfig，拥有自己的 EGLContext 和 GrDirectContext，
+     * 可以在另一个线程上为自己的窗口录制和提交，与其他线程并行渲染；纹理等 GL 对象在共享组内共享。
+     * 创建后不绑定到任何线程，由使用它的线程在 BeginFrame（或 MakeCurrent）时绑定。
+     * 同一时刻一个上下文只能被一个线程使用，资源回收（TrimMemory 等）也需在该线程调用
+     * @param parent 已初始化的主渲染上下文（共享上下文持有它的引用）
+     * @return 共享上下文，失败返回空指针
+     */
+    static boost::shared_ptr<RenderContext> CreateShared(boost::shared_ptr<RenderContext> parent);
+
+    /**
+     * @brief 是否为通过 CreateShared 创建的共享上下文
+     */
+    bool IsShared() const;
+
+    /**
+     * @brief 在当前线程以无表面方式绑定上下文（用于离屏工作，例如上传纹理）
+     * @return 是否成功
+     */
+    bool MakeCurrent();
+
+    /**
+     * @brief 解除当前线程对本上下文的绑定，之后其他线程才能绑定它
+     */
+    void ReleaseCurrent();
+
+    /**
+     * @brief 创建可在共享组内所有上下文中使用的纹理图片
+     * 普通的 GPU 图片只属于创建它的 GrDirectContext；用这个方法上传的图片可以在其他线程的
+     * 共享上下文中直接绘制（图片、图标等只上传一次）
+     * @param pixmap 像素数据
+     * @param buildMips 是否生成 mipmap
+     * @return 跨上下文图片，失败返回空
+     */
+    sk_sp<SkImage> MakeCrossContextImage(const SkPixmap& pixmap, bool buildMips = false);
+
     /**
      * @brief 获取 Skia 的 GPU 上下文。
      * 所有的渲染表面（RenderSurface）都需要通过这个上下文来创建画布。
@@ -60,6 +156,90 @@ public:
      */
     NativeHandles GetNativeHandles() const;
 
+    /**
+     * @brief GPU 资源缓存的占用情况
+     */
+    struct ResourceUsage {
+        int resourceCount = 0;      ///< 缓存中的资源数量
+        size_t resourceBytes = 0;   ///< 缓存中的资源总字节数
+        size_t purgeableBytes = 0;  ///< 当前未被使用、可以立即释放的字节数
+        size_t limitBytes = 0;      ///< 缓存上限
+    };
+
+    /**
+     * @brief 最近一次 TrimMemory 的结果
+     */
+    struct TrimStats {
+        uint64_t trimCount = 0;     ///< 累计执行 TrimMemory 的次数
+        size_t bytesBefore = 0;     ///< 最近一次回收前的缓存字节数
+        size_t bytesAfter = 0;      ///< 最近一次回收后的缓存字节数
+    };
+
+    /**
+     * @brief 设置 Skia GPU 资源缓存上限（纹理、字形图集、离屏表面等）
+     * 可以在 Initialize 之前调用，初始化时生效；超出上限后 Skia 会优先回收最久未使用的资源
+     * @param maxBytes 缓存上限（字节）
+     */
+    void SetResourceCacheLimit(size_t maxBytes);
+
+    /**
+     * @brief 获取 GPU 资源缓存上限
+     * @return 缓存上限（字节），未初始化且未设置时返回 0
+     */
+    size_t GetResourceCacheLimit() const;
+
+    /**
+     * @brief 查询 GPU 资源缓存的当前占用
+     * @return 占用情况，未初始化时各项为 0
+     */
+    ResourceUsage GetResourceUsage() const;
+
+    /**
+     * @brief 释放当前没有被使用的 GPU 资源
+     * @param scratchOnly 为 true 时只释放可复用的临时资源（离屏目标等），保留带内容的纹理
+     */
+    void PurgeUnlockedResources(bool scratchOnly = false);
+
+    /**
+     * @brief 释放超过指定时长未被使用的 GPU 资源（适合每隔若干帧调用一次）
+     * @param age 未使用时长
+     */
+    void PurgeResourcesNotUsedFor(std::chrono::milliseconds age);
+
+    /**
+     * @brief 内存压力下的完整回收
+     * 先发出 OnTrimMemory 让上层释放自己持有的 GPU 对象，再提交挂起的工作并释放所有可释放的 GPU 资源
+     */
+    void TrimMemory();
+
+    /**
+     * @brief 获取最近一次 TrimMemory 的回收量
+     * @return 回收统计，从未回收时各项为 0
+     */
+    TrimStats GetTrimStats() const;
+
+    /**
+     * @brief 所有窗口都隐藏或最小化时自动执行 TrimMemory
+     * @param windowManager 窗口管理器
+     */
+    void EnableAutomaticTrim(foundation::WindowManager& windowManager);
+
+    /**
+     * @brief 停止自动回收
+     */
+    void DisableAutomaticTrim();
+
+    /**
+     * @brief TrimMemory 开始时触发，上层在此释放持有的图片、图层等 GPU 对象
+     */
+    boost::signals2::signal<void()> OnTrimMemory;
+
+    /**
+     * @brief 任意上下文 Shutdown 时触发（进程级），参数为即将释放的 GrDirectContext
+     * 触发时该上下文已绑定到当前线程（或已放弃 GPU 资源），进程级缓存在此释放属于它的纹理
+     */
+    static boost::signals2::signal<void(GrDirectContext*)>& OnContextShutdown();
+
 private:
     struct Impl;
     boost::scoped_ptr<Impl> impl_;
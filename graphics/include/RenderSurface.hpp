@@ -35,6 +35,12 @@ public:
      */
     boost::optional<boost::reference_wrapper<SkCanvas>> BeginFrame();
     
+    /**
+     * @brief 把本帧到目前为止的绘制命令提交给 GPU，不交换缓冲区
+     * 用于分别统计提交和交换的耗时；EndFrame 仍会提交之后的命令
+     */
+    void Flush();
+
     /**
      * @brief 结束绘制一帧并显示
      * 执行双缓冲交换（eglSwapBuffers），将后台缓冲区的内容推送到屏幕
@@ -42,6 +48,22 @@ public:
      */
     void EndFrame();
 
+    /**
+     * @brief 解除当前线程对上下文和表面的绑定
+     * 之后可以在另一个线程上 BeginFrame（同一时刻只能有一个线程绘制这个表面）
+     */
+    void ReleaseCurrent();
+
+    /**
+     * @brief 获取当前表面宽度（像素）
+     */
+    int GetWidth() const;
+
+    /**
+     * @brief 获取当前表面高度（像素）
+     */
+    int GetHeight() const;
+
 private:
     struct Impl;
     boost::scoped_ptr<Impl> impl_;
@@ -0,0 +1,89 @@
+#ifndef SHADER_CACHE_HPP
+#define SHADER_CACHE_HPP
+#pragma once
+
+#include <include/core/SkData.h>
+#include <include/core/SkRefCnt.h>
+#include <include/core/SkString.h>
+#include <gpu/ganesh/GrContextOptions.h>
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+namespace KiUI {
+namespace graphics {
+
+/**
+ * @brief 磁盘持久化的 Skia 着色器/程序缓存
+ * 作为 GrContextOptions::fPersistentCache 交给 GrDirectContext，Skia 编译出 GL 程序后调用 store
+ * 保存程序二进制，下次启动时通过 load 直接取回，省去着色器编译。
+ * 每个条目存为目录下的一个文件；目录按驱动标识（GL 渲染器/ANGLE 版本/Skia 版本）分开，
+ * 驱动升级后自动使用新的子目录，不会加载不兼容的二进制。
+ */
+class ShaderCache : public GrContextOptions::PersistentCache {
+public:
+    /**
+     * @brief 缓存统计
+     */
+    struct Stats {
+        size_t hits = 0;    ///< load 命中次数
+        size_t misses = 0;  ///< load 未命中次数
+        size_t stores = 0;  ///< 写入的条目数
+    };
+
+    /**
+     * @brief 构造缓存
+     * @param directory 缓存根目录（不存在时自动创建）
+     * @param driverIdentity 驱动标识字符串，不同的标识使用不同的子目录
+     */
+    ShaderCache(const std::string& directory, const std::string& driverIdentity);
+    ~ShaderCache() override;
+
+    /**
+     * @brief 按键读取缓存的程序数据（由 Skia 调用）
+     * @return 缓存的数据，未命中返回 nullptr
+     */
+    sk_sp<SkData> load(const SkData& key) override;
+
+    /**
+     * @brief 写入程序数据（由 Skia 调用）
+     */
+    void store(const SkData& key, const SkData& data, const SkString& description) override;
+
+    /**
+     * @brief 删除当前驱动标识下的所有条目
+     */
+    void Clear();
+
+    /**
+     * @brief 缓存是否可用（目录创建成功）
+     */
+    bool IsValid() const { return valid_; }
+
+    /**
+     * @brief 当前驱动标识对应的条目目录
+     */
+    const std::filesystem::path& GetDirectory() const { return directory_; }
+
+    /**
+     * @brief 获取统计信息
+     */
+    Stats GetStats() const;
+
+private:
+    std::filesystem::path EntryPath(const SkData& key) const;
+
+    std::filesystem::path directory_;
+    bool valid_ = false;
+
+    // Skia 可能在任意线程调用（例如 DDL 录制），计数器使用原子变量
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+    std::atomic<size_t> stores_{0};
+};
+
+} // namespace graphics
+} // namespace KiUI
+
+#endif // SHADER_CACHE_HPP
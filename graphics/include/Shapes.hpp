@@ -81,6 +81,22 @@ public:
                                     float strokeWidth = 0.0f,
                                     float opacity = 1.0f);
     
+    /**
+     * @brief 构造圆角矩形（半径会被限制在短边的一半以内）
+     * @param x 左上角 x 坐标
+     * @param y 左上角 y 坐标
+     * @param width 宽度
+     * @param height 高度
+     * @param topLeft 左上角半径
+     * @param topRight 右上角半径
+     * @param bottomRight 右下角半径
+     * @param bottomLeft 左下角半径
+     * @return 圆角矩形
+     */
+    static SkRRect MakeRoundedRect(float x, float y, float width, float height,
+                                   float topLeft, float topRight,
+                                   float bottomRight, float bottomLeft);
+    
     /**
      * @brief 绘制圆形
      * @param canvas Skia 画布
@@ -0,0 +1,62 @@
+#ifndef TEXT_DISK_CACHE_HPP
+#define TEXT_DISK_CACHE_HPP
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace KiUI {
+namespace graphics {
+
+/**
+ * @brief 文字磁盘缓存：保存字形图集中的字形位图和常用文字的排版结果，下次启动时直接放回
+ * 冷启动时第一帧大多是文字，这些字形和排版结果不再需要 FreeType 光栅化和 HarfBuzz 排版。
+ * 文件用内存映射读取；数据按字体分段，每段记录字体路径和字体文件哈希，
+ * 字体文件变化后对应的数据自动失效。只恢复已经加载的字体，因此应在加载字体之后调用 Load
+ * （RenderContext::Initialize 会自动加载 SetTextCacheFile 指定的文件）
+ */
+class TextDiskCache {
+public:
+    /**
+     * @brief 文件格式版本，格式变化时递增，旧文件整体失效
+     */
+    static constexpr uint32_t kFormatVersion = 1;
+
+    /**
+     * @brief 默认最多保存的排版结果数
+     */
+    static constexpr size_t kDefaultMaxRuns = 2048;
+
+    /**
+     * @brief 加载统计
+     */
+    struct Stats {
+        size_t fontsMatched = 0;    ///< 路径和哈希都匹配的字体数
+        size_t fontsSkipped = 0;    ///< 没有加载、文件已变化或数据损坏的字体数
+        size_t glyphsLoaded = 0;    ///< 放入图集的字形数
+        size_t runsLoaded = 0;      ///< 放入排版缓存的条目数
+    };
+
+    /**
+     * @brief 读取缓存文件，把字形放入共享的 GlyphAtlas，把排版结果放入 TextEngine 的缓存
+     * @param path 缓存文件路径
+     * @param stats 输出加载统计，可以为空
+     * @return 文件存在且格式有效时返回 true
+     */
+    static bool Load(const std::string& path, Stats* stats = nullptr);
+
+    /**
+     * @brief 把当前图集中的字形和排版缓存中最近使用的条目写入缓存文件
+     * 先写临时文件再替换，写入中途退出不会留下损坏的缓存
+     * @param path 缓存文件路径
+     * @param maxRuns 最多保存的排版结果数
+     * @return 是否写入成功
+     */
+    static bool Save(const std::string& path, size_t maxRuns = kDefaultMaxRuns);
+};
+
+} // namespace graphics
+} // namespace KiUI
+
+#endif // TEXT_DISK_CACHE_HPP
@@ -0,0 +1,219 @@
+#ifndef TEXT_ENGINE_HPP
+#define TEXT_ENGINE_HPP
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KiUI {
+namespace graphics {
+
+/**
+ * @brief 字体度量（像素）
+ */
+struct FontMetrics {
+    float ascent = 0.0f;    ///< 基线到字形顶部的距离（正数）
+    float descent = 0.0f;   ///< 基线到字形底部的距离（正数）
+    float lineGap = 0.0f;   ///< 行间距
+
+    /**
+     * @brief 行高
+     */
+    float GetLineHeight() const { return ascent + descent + lineGap; }
+};
+
+/**
+ * @brief 排版后的一个字形
+ */
+struct ShapedGlyph {
+    uint32_t glyphId = 0;   ///< 字体内的字形索引
+    uint32_t cluster = 0;   ///< 字形对应的文字在 UTF-8 字符串中的字节偏移
+    float x = 0.0f;         ///< 相对于排版起点（基线）的位置
+    float y = 0.0f;
+};
+
+/**
+ * @brief 一段文字的排版结果（单一字体、字号）
+ * 结果创建后不再修改，可以在多个元素和线程之间共享
+ */
+struct ShapedRun {
+    int fontId = -1;
+    float fontSize = 0.0f;
+    std::vector<ShapedGlyph> glyphs;
+    float advance = 0.0f;   ///< 总前进宽度
+    FontMetrics metrics;
+};
+
+/**
+ * @brief 光栅化后的单个字形（8 位覆盖率）
+ */
+struct GlyphBitmap {
+    int width = 0;
+    int height = 0;
+    int left = 0;           ///< 位图左边相对于字形原点的偏移
+    int top = 0;            ///< 位图顶部相对于基线的偏移（向上为正）
+    std::vector<uint8_t> coverage;
+};
+
+/**
+ * @brief 文字引擎：字体加载（FreeType）、排版（HarfBuzz）和排版结果缓存
+ * 排版结果按（文字、字体、字号、OpenType 特性）缓存，相同的标签（表头、单位等）只排版一次；
+ * 缓存按 LRU 淘汰。所有接口都是线程安全的
+ */
+class TextEngine : boost::noncopyable {
+public:
+    /**
+     * @brief 默认的排版缓存容量（条目数）
+     */
+    static constexpr size_t kDefaultShapeCacheCapacity = 4096;
+
+    /**
+     * @brief 排版缓存统计
+     */
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t entryCount = 0;
+    };
+
+    /**
+     * @brief 排版缓存中的一个条目（用于持久化）
+     */
+    struct ShapeCacheEntry {
+        std::string text;
+        std::vector<std::string> features;
+        boost::shared_ptr<const ShapedRun> run;     ///< 包含字体 id 和字号
+    };
+
+    static TextEngine& GetSharedInstance();
+
+    /**
+     * @brief 加载字体文件
+     * 同一路径重复加载返回同一个 id；第一个加载成功的字体成为默认字体
+     * @param path 字体文件路径（TTF/OTF/TTC）
+     * @param faceIndex 字体集合中的索引
+     * @return 字体 id，失败返回 -1
+     */
+    int LoadFont(const std::string& path, int faceIndex = 0);
+
+    /**
+     * @brief 设置默认字体
+     * @param fontId 字体 id
+     */
+    void SetDefaultFont(int fontId);
+
+    /**
+     * @brief 获取默认字体，没有加载任何字体时返回 -1
+     */
+    int GetDefaultFont() const;
+
+    /**
+     * @brief 字体 id 是否有效
+     */
+    bool IsValidFont(int fontId) const;
+
+    /**
+     * @brief 获取字体文件路径
+     */
+    std::string GetFontPath(int fontId) const;
+
+    /**
+     * @brief 获取字体在字体集合中的索引
+     */
+    int GetFontFaceIndex(int fontId) const;
+
+    /**
+     * @brief 获取字体文件内容的哈希（第一次调用时计算），字体无效时返回 0
+     * 用于判断持久化的字形和排版数据是否仍然对应同一个字体文件
+     */
+    uint64_t GetFontHash(int fontId) const;
+
+    /**
+     * @brief 查找已经加载的字体（不会加载新字体）
+     * @return 字体 id，没有加载过返回 -1
+     */
+    int FindFont(const std::string& path, int faceIndex = 0) const;
+
+    /**
+     * @brief 获取字体在指定字号下的度量
+     */
+    FontMetrics GetMetrics(int fontId, float fontSize) const;
+
+    /**
+     * @brief 排版一段文字（命中缓存时直接返回缓存的结果）
+     * @param text UTF-8 文字
+     * @param fontId 字体 id，-1 表示默认字体
+     * @param fontSize 字号（像素）
+     * @param features OpenType 特性，格式同 hb_feature_from_string（例如 "kern=0"、"tnum"）
+     * @return 排版结果，字体无效时返回空指针
+     */
+    boost::shared_ptr<const ShapedRun> Shape(const std::string& text, int fontId, float fontSize,
+                                             const std::vector<std::string>& features = std::vector<std::string>());
+
+    /**
+     * @brief 排版一段文字但不放入缓存
+     * 用于只出现一次的长文字（例如文档中的段落），避免挤掉界面标签的缓存
+     * @return 排版结果，字体无效时返回空指针
+     */
+    boost::shared_ptr<const ShapedRun> ShapeUncached(const std::string& text, int fontId, float fontSize,
+                                                     const std::vector<std::string>& features = std::vector<std::string>());
+
+    /**
+     * @brief 光栅化一个字形
+     * @param fontId 字体 id
+     * @param glyphId 字形索引
+     * @param pixelSize 光栅化的像素字号
+     * @param bitmap 输出位图（空白字形的宽高为 0）
+     * @return 是否成功
+     */
+    bool RasterizeGlyph(int fontId, uint32_t glyphId, float pixelSize, GlyphBitmap* bitmap);
+
+    /**
+     * @brief 设置排版缓存容量，超出的条目立即淘汰
+     * @param entries 最多缓存的条目数
+     */
+    void SetShapeCacheCapacity(size_t entries);
+
+    /**
+     * @brief 清空排版缓存
+     */
+    void ClearShapeCache();
+
+    /**
+     * @brief 获取排版缓存统计
+     */
+    Stats GetShapeCacheStats() const;
+
+    /**
+     * @brief 导出排版缓存中的条目，最近使用的在前
+     * @param maxEntries 最多导出的条目数
+     */
+    std::vector<ShapeCacheEntry> GetShapeCacheEntries(size_t maxEntries) const;
+
+    /**
+     * @brief 放入预先排版好的结果（例如从磁盘缓存读取）
+     * 已有的条目不会被替换；预置的条目放在最久未使用的一端，缓存已满时不会挤掉现有条目
+     * @param text UTF-8 文字
+     * @param features OpenType 特性
+     * @param run 排版结果，字体 id 和字号必须是当前进程中有效的值
+     */
+    void SeedShapeCache(const std::string& text, const std::vector<std::string>& features,
+                        const boost::shared_ptr<const ShapedRun>& run);
+
+private:
+    TextEngine();
+    ~TextEngine();
+
+    struct Impl;
+    boost::scoped_ptr<Impl> impl_;
+};
+
+} // namespace graphics
+} // namespace KiUI
+
+#endif // TEXT_ENGINE_HPP
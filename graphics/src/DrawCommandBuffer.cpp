@@ -0,0 +1,284 @@
+#include "DrawCommandBuffer.hpp"
+#include "Shapes.hpp"
+#include <include/core/SkVertices.h>
+#include <algorithm>
+#include <cmath>
+
+namespace KiUI {
+namespace graphics {
+
+namespace {
+
+// 每个合并矩形占 4 个顶点、6 个索引；顶点索引是 uint16_t，需要分块提交
+constexpr size_t kMaxRectsPerVertices = 65536 / 4 - 1;
+
+// 判定坐标是否落在设备像素边界上的容差
+constexpr float kPixelEpsilon = 1.0f / 1024.0f;
+
+bool IsOnPixelGrid(float value) {
+    return std::fabs(value - std::round(value)) <= kPixelEpsilon;
+}
+
+SkColor ApplyOpacity(SkColor color, float opacity) {
+    return SkColorSetA(color, static_cast<U8CPU>(opacity * 255));
+}
+
+} // namespace
+
+DrawCommandBuffer::DrawCommandBuffer() {
+    matrix_.reset();
+}
+
+DrawCommandBuffer::~DrawCommandBuffer() {
+}
+
+void DrawCommandBuffer::SetMatrix(const SkMatrix& matrix) {
+    if (matrix != matrix_) {
+        matrix_ = matrix;
+        matrixRecorded_ = false;
+    }
+}
+
+uint32_t DrawCommandBuffer::CurrentMatrixIndex() {
+    if (!matrixRecorded_ || matrices_.empty()) {
+        matrices_.push_back(matrix_);
+        matrixRecorded_ = true;
+    }
+    return static_cast<uint32_t>(matrices_.size() - 1);
+}
+
+bool DrawCommandBuffer::MapToPixelAlignedRect(const SkRect& rect, SkRect* deviceRect) const {
+    if (!matrix_.rectStaysRect() || matrix_.hasPerspective()) {
+        return false;
+    }
+    SkRect mapped = matrix_.mapRect(rect);
+    if (!IsOnPixelGrid(mapped.fLeft) || !IsOnPixelGrid(mapped.fTop) ||
+        !IsOnPixelGrid(mapped.fRight) || !IsOnPixelGrid(mapped.fBottom)) {
+        return false;
+    }
+    *deviceRect = SkRect::MakeLTRB(std::round(mapped.fLeft), std::round(mapped.fTop),
+                                   std::round(mapped.fRight), std::round(mapped.fBottom));
+    return !deviceRect->isEmpty();
+}
+
+void DrawCommandBuffer::AddRectangle(float x, float y, float width, float height,
+                                     SkColor fillColor,
+                                     SkColor strokeColor,
+                                     float strokeWidth,
+                                     float opacity) {
+    if (width <= 0.0f || height <= 0.0f) {
+        return;
+    }
+
+    SkRect rect = SkRect::MakeXYWH(x, y, width, height);
+
+    if (fillColor != SK_ColorTRANSPARENT) {
+        // 边缘正好落在像素上时抗锯齿不会产生部分覆盖，可以在设备空间无抗锯齿地合并绘制
+        SkRect deviceRect;
+        if (MapToPixelAlignedRect(rect, &deviceRect)) {
+            AddCommand(CommandType::SolidRect, deviceRect, nullptr, ApplyOpacity(fillColor, opacity), 0.0f);
+        } else {
+            AddCommand(CommandType::Rect, rect, nullptr, ApplyOpacity(fillColor, opacity), 0.0f);
+        }
+    }
+
+    if (strokeColor != SK_ColorTRANSPARENT && strokeWidth > 0.0f) {
+        AddCommand(CommandType::Rect, rect, nullptr, ApplyOpacity(strokeColor, opacity), strokeWidth);
+    }
+}
+
+void DrawCommandBuffer::AddRoundedRectangle(float x, float y, float width, float height,
+                                            float topLeft, float topRight,
+                                            float bottomRight, float bottomLeft,
+                                            SkColor fillColor,
+                                            SkColor strokeColor,
+                                            float strokeWidth,
+                                            float opacity) {
+    if (width <= 0.0f || height <= 0.0f) {
+        return;
+    }
+
+    SkRRect rrect = Shapes::MakeRoundedRect(x, y, width, height, topLeft, topRight, bottomRight, bottomLeft);
+
+    if (fillColor != SK_ColorTRANSPARENT) {
+        AddCommand(CommandType::RRect, rrect.rect(), &rrect, ApplyOpacity(fillColor, opacity), 0.0f);
+    }
+
+    if (strokeColor != SK_ColorTRANSPARENT && strokeWidth > 0.0f) {
+        AddCommand(CommandType::RRect, rrect.rect(), &rrect, ApplyOpacity(strokeColor, opacity), strokeWidth);
+    }
+}
+
+void DrawCommandBuffer::AddCircle(float centerX, float centerY, float radius,
+                                  SkColor fillColor,
+                                  SkColor strokeColor,
+                                  float strokeWidth,
+                                  float opacity) {
+    if (radius <= 0.0f) {
+        return;
+    }
+
+    SkRect oval = SkRect::MakeLTRB(centerX - radius, centerY - radius, centerX + radius, centerY + radius);
+
+    if (fillColor != SK_ColorTRANSPARENT) {
+        AddCommand(CommandType::Circle, oval, nullptr, ApplyOpacity(fillColor, opacity), 0.0f);
+    }
+
+    if (strokeColor != SK_ColorTRANSPARENT && strokeWidth > 0.0f) {
+        AddCommand(CommandType::Circle, oval, nullptr, ApplyOpacity(strokeColor, opacity), strokeWidth);
+    }
+}
+
+void DrawCommandBuffer::AddCommand(CommandType type, const SkRect& rect, const SkRRect* rrect,
+                                   SkColor color, float strokeWidth) {
+    Command command{type, color, strokeWidth, kNoIndex, kNoIndex, kNoIndex, rect};
+
+    SkRect bounds = rect;
+    if (type != CommandType::SolidRect) {
+        command.matrixIndex = CurrentMatrixIndex();
+        if (strokeWidth > 0.0f) {
+            bounds.outset(strokeWidth / 2.0f, strokeWidth / 2.0f);
+        }
+        bounds = matrix_.mapRect(bounds);
+        // 抗锯齿边缘会多覆盖一个像素
+        bounds.outset(1.0f, 1.0f);
+    }
+
+    if (rrect) {
+        command.rrectIndex = static_cast<uint32_t>(rrects_.size());
+        rrects_.push_back(*rrect);
+    }
+
+    const uint32_t index = static_cast<uint32_t>(commands_.size());
+    commands_.push_back(command);
+
+    // 向前寻找绘制状态相同的批次。只要途经的批次都与新命令不重叠，
+    // 把它提前到那个批次末尾就不会改变任何像素的绘制先后顺序。
+    size_t scanned = 0;
+    for (size_t i = batches_.size(); i-- > 0 && scanned < kReorderWindow; ++scanned) {
+        Batch& batch = batches_[i];
+        if (batch.type == type && batch.color == color && batch.strokeWidth == strokeWidth) {
+            commands_[batch.last].next = index;
+            batch.last = index;
+            ++batch.count;
+            batch.bounds.join(bounds);
+            return;
+        }
+        if (SkRect::Intersects(batch.bounds, bounds)) {
+            break;
+        }
+    }
+
+    batches_.push_back(Batch{type, color, strokeWidth, index, index, 1, bounds});
+}
+
+void DrawCommandBuffer::Flush(SkCanvas* canvas) {
+    lastStats_ = Stats();
+    lastStats_.commands = commands_.size();
+    lastStats_.batches = batches_.size();
+
+    if (!canvas || commands_.empty()) {
+        Clear();
+        return;
+    }
+
+    canvas->save();
+
+    const SkMatrix* currentMatrix = nullptr;
+    for (const Batch& batch : batches_) {
+        if (batch.type == CommandType::SolidRect) {
+            // 合并矩形的坐标已经是设备空间
+            if (currentMatrix != &SkMatrix::I()) {
+                canvas->setMatrix(SkMatrix::I());
+                currentMatrix = &SkMatrix::I();
+            }
+            FlushSolidRects(canvas, batch);
+            continue;
+        }
+
+        // 同一批次共享一份画笔状态
+        paint_.setColor(batch.color);
+        paint_.setStyle(batch.strokeWidth > 0.0f ? SkPaint::kStroke_Style : SkPaint::kFill_Style);
+        paint_.setStrokeWidth(batch.strokeWidth);
+        paint_.setAntiAlias(true);
+
+        for (uint32_t i = batch.first; i != kNoIndex; i = commands_[i].next) {
+            const Command& command = commands_[i];
+            const SkMatrix* matrix = &matrices_[command.matrixIndex];
+            if (currentMatrix != matrix) {
+                canvas->setMatrix(*matrix);
+                currentMatrix = matrix;
+            }
+
+            switch (command.type) {
+                case CommandType::Rect:
+                    canvas->drawRect(command.rect, paint_);
+                    break;
+                case CommandType::RRect:
+                    canvas->drawRRect(rrects_[command.rrectIndex], paint_);
+                    break;
+                case CommandType::Circle:
+                    canvas->drawCircle(command.rect.centerX(), command.rect.centerY(),
+                                       command.rect.width() / 2.0f, paint_);
+                    break;
+                case CommandType::SolidRect:
+                    break;
+            }
+            ++lastStats_.drawCalls;
+        }
+    }
+
+    canvas->restore();
+    Clear();
+}
+
+void DrawCommandBuffer::FlushSolidRects(SkCanvas* canvas, const Batch& batch) {
+    paint_.setColor(batch.color);
+    paint_.setStyle(SkPaint::kFill_Style);
+    paint_.setStrokeWidth(0.0f);
+    paint_.setAntiAlias(false);
+
+    if (batch.count == 1) {
+        canvas->drawRect(commands_[batch.first].rect, paint_);
+        ++lastStats_.drawCalls;
+        return;
+    }
+
+    uint32_t i = batch.first;
+    while (i != kNoIndex) {
+        positions_.clear();
+        indices_.clear();
+        size_t rects = 0;
+        for (; i != kNoIndex && rects < kMaxRectsPerVertices; i = commands_[i].next, ++rects) {
+            const SkRect& r = commands_[i].rect;
+            const uint16_t base = static_cast<uint16_t>(positions_.size());
+            positions_.push_back({r.fLeft, r.fTop});
+            positions_.push_back({r.fRight, r.fTop});
+            positions_.push_back({r.fRight, r.fBottom});
+            positions_.push_back({r.fLeft, r.fBottom});
+            const uint16_t quad[6] = {base, static_cast<uint16_t>(base + 1), static_cast<uint16_t>(base + 2),
+                                      base, static_cast<uint16_t>(base + 2), static_cast<uint16_t>(base + 3)};
+            indices_.insert(indices_.end(), quad, quad + 6);
+        }
+
+        // 没有顶点颜色和纹理坐标时，drawVertices 直接使用画笔颜色
+        sk_sp<SkVertices> vertices = SkVertices::MakeCopy(
+            SkVertices::kTriangles_VertexMode,
+            static_cast<int>(positions_.size()), positions_.data(), nullptr, nullptr,
+            static_cast<int>(indices_.size()), indices_.data());
+        canvas->drawVertices(vertices, SkBlendMode::kModulate, paint_);
+        ++lastStats_.drawCalls;
+        lastStats_.mergedRects += rects;
+    }
+}
+
+void DrawCommandBuffer::Clear() {
+    commands_.clear();
+    rrects_.clear();
+    batches_.clear();
+    matrices_.clear();
+    matrixRecorded_ = false;
+}
+
+} // namespace graphics
+} // namespace KiUI
@@ -0,0 +1,305 @@
+#include "GlyphAtlas.hpp"
+#include "RenderContext.hpp"
+#include <include/core/SkImageInfo.h>
+#include <include/core/SkPaint.h>
+#include <include/core/SkPixmap.h>
+#include <include/core/SkRSXform.h>
+#include <include/core/SkSamplingOptions.h>
+#include <include/gpu/ganesh/GrDirectContext.h>
+#include <include/gpu/ganesh/GrRecordingContext.h>
+#include <include/gpu/ganesh/SkSurfaceGanesh.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace KiUI {
+namespace graphics {
+
+size_t GlyphAtlas::GlyphKeyHash::operator()(const GlyphKey& key) const {
+    size_t hash = std::hash<uint32_t>()(key.glyphId);
+    hash ^= std::hash<int>()(key.fontId) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<uint32_t>()(key.sizeKey) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+GlyphAtlas& GlyphAtlas::GetSharedInstance() {
+    static GlyphAtlas instance;
+    return instance;
+}
+
+GlyphAtlas::GlyphAtlas(int width, int height)
+    : width_(std::max(1, width)), height_(std::max(1, height)) {
+    pixels_.allocPixels(SkImageInfo::MakeN32Premul(width_, height_));
+    pixels_.eraseColor(SK_ColorTRANSPARENT);
+    // 上下文关闭时它的纹理必须在 Skia 上下文释放之前放掉
+    shutdownConnection_ = RenderContext::OnContextShutdown().connect(
+        [this](GrDirectContext* context) { ReleaseTextures(context); });
+}
+
+GlyphAtlas::~GlyphAtlas() = default;
+
+void GlyphAtlas::DrawRun(SkCanvas* canvas, const ShapedRun& run, float x, float y, SkColor color, float opacity) {
+    if (!canvas || run.glyphs.empty() || SkColorGetA(color) == 0 || opacity <= 0.0f) {
+        return;
+    }
+
+    // 按设备像素字号光栅化；透视变换下 getMaxScale 返回负值，按 1 处理
+    float scale = canvas->getTotalMatrix().getMaxScale();
+    if (!(scale > 0.0f)) {
+        scale = 1.0f;
+    }
+    const uint32_t sizeKey = static_cast<uint32_t>(std::lround(run.fontSize * scale * 4.0f));
+    if (sizeKey == 0) {
+        return;
+    }
+    const float pixelSize = sizeKey / 4.0f;
+    const float inverse = run.fontSize / pixelSize;    // 设备像素到局部坐标
+    const bool pixelAligned = inverse == 1.0f;
+
+    std::vector<SkRSXform> xforms;
+    std::vector<SkRect> texRects;
+    xforms.reserve(run.glyphs.size());
+    texRects.reserve(run.glyphs.size());
+    sk_sp<SkImage> image;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 图集在中途放满时清空后重来一次，之前取到的字形位置已经失效
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            xforms.clear();
+            texRects.clear();
+            bool complete = true;
+            for (const ShapedGlyph& glyph : run.glyphs) {
+                const GlyphEntry* entry = FindOrAddLocked(run.fontId, glyph.glyphId, sizeKey);
+                if (!entry) {
+                    if (attempt == 0) {
+                        ResetLocked();
+                        ++resets_;
+                        complete = false;
+                        break;
+                    }
+                    continue;
+                }
+                if (entry->texRect.isEmpty()) {
+                    continue;
+                }
+
+                float originX = x + glyph.x;
+                float originY = y + glyph.y;
+                if (pixelAligned) {
+                    // 没有缩放时对齐到整像素，字形位图可以按最近邻采样原样绘制
+                    originX = std::round(originX);
+                    originY = std::round(originY);
+                }
+                xforms.push_back(SkRSXform::Make(inverse, 0.0f,
+                                                 originX + entry->left * inverse,
+                                                 originY - entry->top * inverse));
+                texRects.push_back(entry->texRect);
+            }
+            if (complete) {
+                break;
+            }
+        }
+        if (!xforms.empty()) {
+            image = GetImageLocked(canvas);
+        }
+    }
+
+    if (!image) {
+        return;
+    }
+
+    // 图集是白色的覆盖率，kModulate 把每个字形染成文字颜色
+    std::vector<SkColor> colors(xforms.size(), color);
+    SkPaint paint;
+    paint.setAlphaf(opacity);
+    const SkSamplingOptions sampling = pixelAligned ? SkSamplingOptions(SkFilterMode::kNearest)
+                                                    : SkSamplingOptions(SkFilterMode::kLinear);
+    canvas->drawAtlas(image.get(), xforms.data(), texRects.data(), colors.data(), static_cast<int>(xforms.size()),
+                      SkBlendMode::kModulate, sampling, nullptr, &paint);
+}
+
+const GlyphAtlas::GlyphEntry* GlyphAtlas::FindOrAddLocked(int fontId, uint32_t glyphId, uint32_t sizeKey) {
+    const GlyphKey key{fontId, glyphId, sizeKey};
+    auto it = glyphs_.find(key);
+    if (it != glyphs_.end()) {
+        return &it->second;
+    }
+
+    GlyphBitmap bitmap;
+    if (TextEngine::GetSharedInstance().RasterizeGlyph(fontId, glyphId, sizeKey / 4.0f, &bitmap) &&
+        bitmap.width > 0 && bitmap.height > 0) {
+        ++rasterized_;
+    }
+    return InsertLocked(key, bitmap);
+}
+
+const GlyphAtlas::GlyphEntry* GlyphAtlas::InsertLocked(const GlyphKey& key, const GlyphBitmap& bitmap) {
+    GlyphEntry entry;
+    entry.texRect = SkRect::MakeEmpty();
+    // 比整个图集还大的字形（超大字号）不进入图集，按空白处理
+    if (bitmap.width > 0 && bitmap.height > 0 && bitmap.width < width_ && bitmap.height < height_ &&
+        bitmap.coverage.size() >= static_cast<size_t>(bitmap.width) * bitmap.height) {
+        // 每个字形右侧和下方留 1 像素间隔，线性采样时不会采到相邻字形
+        int atlasX = 0;
+        int atlasY = 0;
+        if (!AllocateLocked(bitmap.width + 1, bitmap.height + 1, &atlasX, &atlasY)) {
+            return nullptr;
+        }
+
+        uint8_t* base = static_cast<uint8_t*>(pixels_.getPixels());
+        const size_t rowBytes = pixels_.rowBytes();
+        for (int row = 0; row < bitmap.height; ++row) {
+            uint32_t* dst = reinterpret_cast<uint32_t*>(base + (atlasY + row) * rowBytes) + atlasX;
+            const uint8_t* src = bitmap.coverage.data() + static_cast<size_t>(row) * bitmap.width;
+            for (int column = 0; column < bitmap.width; ++column) {
+                // 预乘的白色：四个通道都等于覆盖率，与通道顺序无关
+                dst[column] = src[column] * 0x01010101u;
+            }
+        }
+        entry.texRect = SkRect::MakeXYWH(static_cast<float>(atlasX), static_cast<float>(atlasY),
+                                         static_cast<float>(bitmap.width), static_cast<float>(bitmap.height));
+        entry.left = static_cast<float>(bitmap.left);
+        entry.top = static_cast<float>(bitmap.top);
+        MarkDirtyLocked(SkIRect::MakeXYWH(atlasX, atlasY, bitmap.width, bitmap.height));
+    }
+
+    return &(glyphs_[key] = entry);
+}
+
+bool GlyphAtlas::AddGlyph(int fontId, uint32_t glyphId, uint32_t sizeKey, const GlyphBitmap& bitmap) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const GlyphKey key{fontId, glyphId, sizeKey};
+    if (glyphs_.count(key)) {
+        return true;
+    }
+    return InsertLocked(key, bitmap) != nullptr;
+}
+
+void GlyphAtlas::ForEachGlyph(const GlyphVisitor& visitor) const {
+    if (!visitor) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint8_t* base = static_cast<const uint8_t*>(pixels_.getPixels());
+    const size_t rowBytes = pixels_.rowBytes();
+    GlyphBitmap bitmap;
+    for (const auto& item : glyphs_) {
+        const GlyphEntry& entry = item.second;
+        bitmap.width = static_cast<int>(entry.texRect.width());
+        bitmap.height = static_cast<int>(entry.texRect.height());
+        bitmap.left = static_cast<int>(entry.left);
+        bitmap.top = static_cast<int>(entry.top);
+        bitmap.coverage.resize(static_cast<size_t>(bitmap.width) * bitmap.height);
+        // 覆盖率从预乘白色像素中取回（四个通道相同，取最低字节即可）
+        const int atlasX = static_cast<int>(entry.texRect.left());
+        const int atlasY = static_cast<int>(entry.texRect.top());
+        for (int row = 0; row < bitmap.height; ++row) {
+            const uint32_t* src = reinterpret_cast<const uint32_t*>(base + (atlasY + row) * rowBytes) + atlasX;
+            uint8_t* dst = bitmap.coverage.data() + static_cast<size_t>(row) * bitmap.width;
+            for (int column = 0; column < bitmap.width; ++column) {
+                dst[column] = static_cast<uint8_t>(src[column] & 0xff);
+            }
+        }
+        visitor(item.first.fontId, item.first.glyphId, item.first.sizeKey, bitmap);
+    }
+}
+
+bool GlyphAtlas::AllocateLocked(int width, int height, int* x, int* y) {
+    if (shelfX_ + width > width_) {
+        shelfY_ += shelfHeight_;
+        shelfX_ = 0;
+        shelfHeight_ = 0;
+    }
+    if (shelfY_ + height > height_) {
+        return false;
+    }
+    *x = shelfX_;
+    *y = shelfY_;
+    shelfX_ += width;
+    shelfHeight_ = std::max(shelfHeight_, height);
+    return true;
+}
+
+void GlyphAtlas::ResetLocked() {
+    glyphs_.clear();
+    shelfX_ = 0;
+    shelfY_ = 0;
+    shelfHeight_ = 0;
+    pixels_.eraseColor(SK_ColorTRANSPARENT);
+    MarkDirtyLocked(SkIRect::MakeWH(width_, height_));
+    for (auto& item : textures_) {
+        item.second.overwritten = true;
+    }
+}
+
+void GlyphAtlas::MarkDirtyLocked(const SkIRect& rect) {
+    for (auto& item : textures_) {
+        item.second.dirty.join(rect);
+    }
+}
+
+sk_sp<SkImage> GlyphAtlas::GetImageLocked(SkCanvas* canvas) {
+    GrRecordingContext* recordingContext = canvas->recordingContext();
+    GrDirectContext* directContext = recordingContext ? recordingContext->asDirectContext() : nullptr;
+
+    // 光栅画布（包括录制用的画布）使用键为 nullptr 的光栅表面，和纹理一样只写入变化的区域
+    Upload& upload = textures_[directContext];
+    if (!upload.surface || !upload.image || (directContext && !upload.image->isValid(recordingContext))) {
+        // 第一次在这个上下文上绘制（或上下文已经重建）：创建表面并整体写入
+        upload.surface = directContext
+            ? SkSurfaces::RenderTarget(directContext, skgpu::Budgeted::kYes, pixels_.info())
+            : SkSurfaces::Raster(pixels_.info());
+        upload.image.reset();
+        upload.dirty = SkIRect::MakeWH(width_, height_);
+        upload.overwritten = false;
+        if (!upload.surface) {
+            textures_.erase(directContext);
+            return nullptr;
+        }
+    }
+
+    if (!upload.dirty.isEmpty()) {
+        // 新字形只写入图集中未使用过的区域，之前录制的绘制不会读到它们：先放掉快照，
+        // 表面不再被共享，写入时 Skia 不必复制整张图集。图集清空过时旧字形的位置被覆盖，
+        // 保留快照让写时复制保护之前的绘制（或仍持有快照的录制结果）
+        if (!upload.overwritten) {
+            upload.image.reset();
+        }
+        SkPixmap dirtyPixels;
+        if (pixels_.pixmap().extractSubset(&dirtyPixels, upload.dirty)) {
+            upload.surface->writePixels(dirtyPixels, upload.dirty.x(), upload.dirty.y());
+            if (directContext) {
+                ++uploads_;
+            }
+        }
+        upload.dirty.setEmpty();
+        upload.overwritten = false;
+        upload.image = upload.surface->makeImageSnapshot();
+    }
+    return upload.image;
+}
+
+void GlyphAtlas::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ResetLocked();
+}
+
+void GlyphAtlas::ReleaseTextures(GrDirectContext* context) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    textures_.erase(context);
+}
+
+GlyphAtlas::Stats GlyphAtlas::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.glyphCount = glyphs_.size();
+    stats.rasterized = rasterized_;
+    stats.resets = resets_;
+    stats.uploads = uploads_;
+    return stats;
+}
+
+} // namespace graphics
+} // namespace KiUI
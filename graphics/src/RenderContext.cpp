@@ -4,14 +4,27 @@
 #endif
 
 #include "RenderContext.hpp"
+#include "ShaderCache.hpp"
+#include "TextDiskCache.hpp"
+#include "Shapes.hpp"
+#include "DrawCommandBuffer.hpp"
+#include "window.hpp"
 #include "EGL/eglplatform.h"
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 #include <EGL/eglext_angle.h> 
 #include <GLES3/gl3.h>
 #include <core/SkRefCnt.h>  
+#include <core/SkMilestone.h>
+#include <core/SkSurface.h>
+#include <core/SkImage.h>
+#include <core/SkSamplingOptions.h>
+#include <gpu/ganesh/GrContextOptions.h>
+#include <gpu/ganesh/SkSurfaceGanesh.h>
+#include <gpu/ganesh/SkImageGanesh.h>
 #include <gpu/ganesh/GrDirectContext.h>
 #include <gpu/ganesh/gl/GrGLDirectContext.h>  
 #include <gpu/ganesh/gl/GrGLInterface.h>
@@ -23,9 +36,124 @@ namespace graphics {
         EGLDisplay display_ = EGL_NO_DISPLAY; // EGL display
         EGLConfig config_ = nullptr; // EGL config
         EGLContext context_ = EGL_NO_CONTEXT; // EGL context
+        std::string shaderCacheDirectory_;
+        std::string textCacheFile_;
+        boost::scoped_ptr<ShaderCache> shaderCache_; // 必须比 skiaContext_ 活得久
         sk_sp<GrDirectContext> skiaContext_ = nullptr;
+        size_t resourceCacheLimit_ = 0; // 0 表示使用 Skia 默认上限
+        TrimStats trimStats_;
+        TextDiskCache::Stats textCacheStats_; // 启动时从文字磁盘缓存恢复的内容
+        std::chrono::milliseconds warmUpDuration_{0};
+        boost::signals2::scoped_connection trimConnection_;
+        boost::shared_ptr<RenderContext> parent_; // 共享上下文：复用 parent 的 display，不负责终止它
+        
+        bool CreateSkiaContext(ShaderCache* shaderCache) {
+            // connect the context to the skia context
+            auto interface = GrGLMakeAssembledInterface(nullptr, [](void* ctx, const char name[]) {
+                return eglGetProcAddress(name);
+            });
+            
+            if (!interface) {
+                std::cerr << "RenderContext: Failed to create GL interface" << std::endl;
+                return false;
+            }
+            
+            GrContextOptions options;
+            if (shaderCache) {
+                options.fPersistentCache = shaderCache;
+                options.fShaderCacheStrategy = GrContextOptions::ShaderCacheStrategy::kBackendBinary;
+            }
+            
+            skiaContext_ = GrDirectContexts::MakeGL(interface, options);
+            if (!skiaContext_) {
+                std::cerr << "RenderContext: Failed to create Skia GL context" << std::endl;
+                return false;
+            }
+            
+            if (resourceCacheLimit_ > 0) {
+                skiaContext_->setResourceCacheLimit(resourceCacheLimit_);
+            }
+            return true;
+        }
+
+        // 资源回收需要当前线程持有 GL 上下文；没有窗口表面时以无表面方式绑定
+        bool EnsureCurrent() {
+            if (display_ == EGL_NO_DISPLAY || context_ == EGL_NO_CONTEXT) return false;
+            if (eglGetCurrentContext() == context_) return true;
+            return eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context_) == EGL_TRUE;
+        }
+
+        // 程序二进制只对同一驱动、同一 ANGLE 和同一 Skia 版本有效
+        std::string QueryDriverIdentity() const {
+            auto glString = [](GLenum name) {
+                const GLubyte* value = glGetString(name);
+                return value ? std::string(reinterpret_cast<const char*>(value)) : std::string();
+            };
+            auto eglString = [this](EGLint name) {
+                const char* value = eglQueryString(display_, name);
+                return value ? std::string(value) : std::string();
+            };
+            std::ostringstream identity;
+            identity << "skia:" << SK_MILESTONE << '\n'
+                     << "egl:" << eglString(EGL_VENDOR) << ' ' << eglString(EGL_VERSION) << '\n'
+                     << "gl:" << glString(GL_VENDOR) << '|' << glString(GL_RENDERER) << '|' << glString(GL_VERSION);
+            return identity.str();
+        }
     };  
 
+    namespace {
+        // 预热场景：覆盖 Box/Shapes 常用的绘制组合，每种都在像素对齐、亚像素偏移和旋转矩阵下各画一次
+        void DrawWarmUpScene(SkCanvas* canvas) {
+            const SkColor fill = SkColorSetARGB(255, 66, 133, 244);
+            const SkColor stroke = SkColorSetARGB(255, 32, 32, 32);
+
+            SkMatrix transforms[3];
+            transforms[0].setIdentity();
+            transforms[1].setTranslate(0.5f, 0.5f);
+            transforms[2].setRotate(15.0f, 64.0f, 64.0f);
+
+            for (const SkMatrix& matrix : transforms) {
+                canvas->save();
+                canvas->concat(matrix);
+                Shapes::DrawRectangle(canvas, 4, 4, 40, 24, fill);
+                Shapes::DrawRectangle(canvas, 4, 32, 40, 24, fill, stroke, 2.0f, 0.5f);
+                Shapes::DrawRoundedRectangle(canvas, 48, 4, 40, 24, 6.0f, fill, stroke, 1.0f);
+                Shapes::DrawRoundedRectangle(canvas, 48, 32, 40, 24, 8.0f, 2.0f, 8.0f, 2.0f, fill, stroke, 2.0f);
+                Shapes::DrawCircle(canvas, 104, 16, 12, fill, stroke, 1.5f);
+                Shapes::DrawEllipse(canvas, 92, 32, 24, 16, fill, stroke, 1.0f);
+                Shapes::DrawLine(canvas, 4, 60, 120, 60, stroke, 1.0f);
+                canvas->restore();
+            }
+
+            // 命令缓冲区的合并矩形走 drawVertices
+            DrawCommandBuffer buffer;
+            buffer.SetMatrix(SkMatrix::I());
+            buffer.AddRectangle(0, 64, 16, 16, fill);
+            buffer.AddRectangle(20, 64, 16, 16, fill);
+            buffer.AddRectangle(40, 64, 16, 16, fill);
+            buffer.Flush(canvas);
+
+            // 裁剪与透明度图层
+            canvas->save();
+            canvas->clipRect(SkRect::MakeXYWH(64, 64, 56, 56));
+            canvas->saveLayerAlphaf(nullptr, 0.5f);
+            Shapes::DrawRoundedRectangle(canvas, 60, 60, 48, 48, 8.0f, fill, stroke, 1.0f);
+            canvas->restore();
+            canvas->restore();
+
+            // 缓存图层合成：离屏表面快照再画回来
+            sk_sp<SkSurface> layer = canvas->makeSurface(SkImageInfo::MakeN32Premul(32, 32));
+            if (layer) {
+                Shapes::DrawCircle(layer->getCanvas(), 16, 16, 14, fill);
+                SkPaint paint;
+                paint.setAlphaf(0.5f);
+                sk_sp<SkImage> image = layer->makeImageSnapshot();
+                canvas->drawImage(image, 0, 88, SkSamplingOptions(), &paint);
+                canvas->drawImage(image, 36.5f, 88.5f, SkSamplingOptions(SkFilterMode::kLinear), &paint);
+            }
+        }
+    }
+
     RenderContext::RenderContext() : impl_(new Impl()) {}
     RenderContext::~RenderContext() {
         Shutdown();
@@ -126,32 +254,76 @@ namespace graphics {
             return false;
         }
 
-        // connect the context to the skia context
-        auto interface = GrGLMakeAssembledInterface(nullptr, [](void* ctx, const char name[]) {
-            return eglGetProcAddress(name);
-        });
+        if (!impl_->shaderCacheDirectory_.empty()) {
+            impl_->shaderCache_.reset(new ShaderCache(impl_->shaderCacheDirectory_, impl_->QueryDriverIdentity()));
+            if (!impl_->shaderCache_->IsValid()) {
+                impl_->shaderCache_.reset();
+            }
+        }
         
-        if (!interface) {
-            std::cerr << "RenderContext: Failed to create GL interface" << std::endl;
+        if (!impl_->CreateSkiaContext(impl_->shaderCache_.get())) {
             return false;
         }
         
-        impl_->skiaContext_ = GrDirectContexts::MakeGL(interface);
-        if (!impl_->skiaContext_) {
-            std::cerr << "RenderContext: Failed to create Skia GL context" << std::endl;
-            return false;
+        if (!impl_->textCacheFile_.empty()) {
+            TextDiskCache::Stats stats;
+            if (TextDiskCache::Load(impl_->textCacheFile_, &stats)) {
+                impl_->textCacheStats_ = stats;
+            }
         }
         
         return true;
     }
 
+    boost::signals2::signal<void(GrDirectContext*)>& RenderContext::OnContextShutdown() {
+        static boost::signals2::signal<void(GrDirectContext*)> signal;
+        return signal;
+    }
+
     void RenderContext::Shutdown() {
         if (!impl_) return;
         
-        // Release Skia context first
+        impl_->trimConnection_.disconnect();
+        
+        // 只有初始化成功的主上下文写回文字缓存，Shutdown 重复调用时不会重复写
+        if (impl_->skiaContext_ && !impl_->parent_ && !impl_->textCacheFile_.empty()) {
+            TextDiskCache::Save(impl_->textCacheFile_);
+        }
+        
+        // 释放 Skia 上下文时会删除它的 GL 对象；FBO、VAO 不在共享组内共享，必须在本上下文上删除，
+        // 所以先把本上下文绑定到当前线程（共享上下文完成后恢复调用线程原来的绑定）
+        EGLContext previousContext = eglGetCurrentContext();
+        EGLSurface previousDraw = eglGetCurrentSurface(EGL_DRAW);
+        EGLSurface previousRead = eglGetCurrentSurface(EGL_READ);
         if (impl_->skiaContext_) {
+            if (!impl_->EnsureCurrent()) {
+                // 无法绑定（例如仍被其他线程持有）：放弃 GL 对象，不在错误的上下文上发出删除
+                std::cerr << "RenderContext: Failed to make context current for shutdown, abandoning GPU resources" << std::endl;
+                impl_->skiaContext_->abandonContext();
+            }
+            OnContextShutdown()(impl_->skiaContext_.get());
             impl_->skiaContext_.reset();
         }
+        impl_->shaderCache_.reset();
+        
+        if (impl_->parent_) {
+            // 共享上下文：只解除本上下文在当前线程的绑定，display 属于 parent
+            if (eglGetCurrentContext() == impl_->context_) {
+                if (previousContext != impl_->context_ && previousContext != EGL_NO_CONTEXT) {
+                    eglMakeCurrent(impl_->display_, previousDraw, previousRead, previousContext);
+                } else {
+                    eglMakeCurrent(impl_->display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                }
+            }
+            if (impl_->context_ != EGL_NO_CONTEXT) {
+                eglDestroyContext(impl_->display_, impl_->context_);
+                impl_->context_ = EGL_NO_CONTEXT;
+            }
+            impl_->display_ = EGL_NO_DISPLAY;
+            impl_->config_ = nullptr;
+            impl_->parent_.reset();
+            return;
+        }
         
         // Make context not current
         if (impl_->display_ != EGL_NO_DISPLAY) {
@@ -173,6 +345,75 @@ namespace graphics {
         impl_->config_ = nullptr;
     }
 
+    boost::shared_ptr<RenderContext> RenderContext::CreateShared(boost::shared_ptr<RenderContext> parent) {
+        if (!parent || !parent->IsInitialized()) {
+            std::cerr << "RenderContext: Parent context is not initialized" << std::endl;
+            return boost::shared_ptr<RenderContext>();
+        }
+        
+        boost::shared_ptr<RenderContext> shared(new RenderContext());
+        Impl& impl = *shared->impl_;
+        impl.parent_ = parent;
+        impl.display_ = parent->impl_->display_;
+        impl.config_ = parent->impl_->config_;
+        impl.resourceCacheLimit_ = parent->impl_->resourceCacheLimit_;
+        
+        // 以 parent 的上下文为共享对象，纹理、缓冲区等 GL 对象在整个共享组内可见
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_CLIENT_VERSION, 3, // 使用 OpenGL ES 3.0
+            EGL_NONE
+        };
+        impl.context_ = eglCreateContext(impl.display_, impl.config_, parent->impl_->context_, contextAttributes);
+        if (impl.context_ == EGL_NO_CONTEXT) {
+            EGLint error = eglGetError();
+            std::cerr << "RenderContext: Failed to create shared EGL context, error: 0x" 
+                      << std::hex << error << std::dec << std::endl;
+            return boost::shared_ptr<RenderContext>();
+        }
+        
+        // 创建 GrDirectContext 需要上下文是当前的；完成后恢复调用线程原来的绑定
+        EGLContext previousContext = eglGetCurrentContext();
+        EGLSurface previousDraw = eglGetCurrentSurface(EGL_DRAW);
+        EGLSurface previousRead = eglGetCurrentSurface(EGL_READ);
+        
+        bool created = false;
+        if (eglMakeCurrent(impl.display_, EGL_NO_SURFACE, EGL_NO_SURFACE, impl.context_)) {
+            created = impl.CreateSkiaContext(parent->GetShaderCache());
+        } else {
+            EGLint error = eglGetError();
+            std::cerr << "RenderContext: Failed to make shared EGL context current, error: 0x" 
+                      << std::hex << error << std::dec << std::endl;
+        }
+        
+        eglMakeCurrent(impl.display_, previousDraw, previousRead, previousContext);
+        
+        if (!created) {
+            return boost::shared_ptr<RenderContext>();
+        }
+        return shared;
+    }
+
+    bool RenderContext::IsShared() const {
+        return impl_ && impl_->parent_;
+    }
+
+    bool RenderContext::MakeCurrent() {
+        if (!impl_) return false;
+        return impl_->EnsureCurrent();
+    }
+
+    void RenderContext::ReleaseCurrent() {
+        if (!impl_ || impl_->display_ == EGL_NO_DISPLAY) return;
+        if (eglGetCurrentContext() == impl_->context_) {
+            eglMakeCurrent(impl_->display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        }
+    }
+
+    sk_sp<SkImage> RenderContext::MakeCrossContextImage(const SkPixmap& pixmap, bool buildMips) {
+        if (!impl_ || !impl_->skiaContext_ || !impl_->EnsureCurrent()) return nullptr;
+        return SkImages::CrossContextTextureFromPixmap(impl_->skiaContext_.get(), pixmap, buildMips, true);
+    }
+
     GrDirectContext* RenderContext::GetSkiaContext() const {
         if (!impl_) return nullptr;
         return impl_->skiaContext_.get();
@@ -199,5 +440,145 @@ namespace graphics {
         return handles;
     }
 
+    void RenderContext::SetShaderCacheDirectory(const std::string& directory) {
+        if (!impl_) return;
+        if (impl_->skiaContext_) {
+            std::cerr << "RenderContext: Shader cache directory must be set before Initialize" << std::endl;
+            return;
+        }
+        impl_->shaderCacheDirectory_ = directory;
+    }
+
+    void RenderContext::SetTextCacheFile(const std::string& path) {
+        if (!impl_) return;
+        if (impl_->skiaContext_) {
+            std::cerr << "RenderContext: Text cache file must be set before Initialize" << std::endl;
+            return;
+        }
+        impl_->textCacheFile_ = path;
+    }
+
+    ShaderCache* RenderContext::GetShaderCache() const {
+        if (!impl_) return nullptr;
+        // 共享上下文使用主上下文的持久化缓存
+        if (!impl_->shaderCache_ && impl_->parent_) {
+            return impl_->parent_->GetShaderCache();
+        }
+        return impl_->shaderCache_.get();
+    }
+
+    bool RenderContext::WarmUpShaders(const std::function<void(SkCanvas*)>& extraDraws) {
+        if (!impl_ || !impl_->skiaContext_ || !impl_->EnsureCurrent()) return false;
+        
+        auto start = std::chrono::steady_clock::now();
+        
+        // 与窗口表面相同的格式和原点，编译出的程序才能在窗口上复用
+        SkImageInfo info = SkImageInfo::Make(256, 256, kRGBA_8888_SkColorType, kPremul_SkAlphaType);
+        sk_sp<SkSurface> surface = SkSurfaces::RenderTarget(
+            impl_->skiaContext_.get(), skgpu::Budgeted::kNo, info, 0, kBottomLeft_GrSurfaceOrigin, nullptr);
+        if (!surface) {
+            std::cerr << "RenderContext: Failed to create warm-up surface" << std::endl;
+            return false;
+        }
+        
+        SkCanvas* canvas = surface->getCanvas();
+        canvas->clear(SK_ColorWHITE);
+        DrawWarmUpScene(canvas);
+        if (extraDraws) {
+            canvas->save();
+            extraDraws(canvas);
+            canvas->restore();
+        }
+        
+        // 同步等待，确保程序在第一帧之前全部编译完成
+        impl_->skiaContext_->flushAndSubmit(surface.get(), GrSyncCpu::kYes);
+        
+        // 耗时只记录下来，不在每次启动时输出；缓存命中情况见 GetShaderCache()->GetStats()
+        impl_->warmUpDuration_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        return true;
+    }
+
+    std::chrono::milliseconds RenderContext::GetWarmUpDuration() const {
+        return impl_ ? impl_->warmUpDuration_ : std::chrono::milliseconds(0);
+    }
+
+    void RenderContext::SetResourceCacheLimit(size_t maxBytes) {
+        if (!impl_) return;
+        impl_->resourceCacheLimit_ = maxBytes;
+        if (impl_->skiaContext_) {
+            impl_->skiaContext_->setResourceCacheLimit(maxBytes);
+        }
+    }
+
+    size_t RenderContext::GetResourceCacheLimit() const {
+        if (!impl_) return 0;
+        if (impl_->skiaContext_) {
+            return impl_->skiaContext_->getResourceCacheLimit();
+        }
+        return impl_->resourceCacheLimit_;
+    }
+
+    RenderContext::ResourceUsage RenderContext::GetResourceUsage() const {
+        ResourceUsage usage;
+        if (!impl_ || !impl_->skiaContext_) return usage;
+        impl_->skiaContext_->getResourceCacheUsage(&usage.resourceCount, &usage.resourceBytes);
+        usage.purgeableBytes = impl_->skiaContext_->getResourceCachePurgeableBytes();
+        usage.limitBytes = impl_->skiaContext_->getResourceCacheLimit();
+        return usage;
+    }
+
+    void RenderContext::PurgeUnlockedResources(bool scratchOnly) {
+        if (!impl_ || !impl_->skiaContext_ || !impl_->EnsureCurrent()) return;
+        impl_->skiaContext_->purgeUnlockedResources(scratchOnly ? GrPurgeResourceOptions::kScratchResourcesOnly
+                                                                : GrPurgeResourceOptions::kAllResources);
+    }
+
+    void RenderContext::PurgeResourcesNotUsedFor(std::chrono::milliseconds age) {
+        if (!impl_ || !impl_->skiaContext_ || !impl_->EnsureCurrent()) return;
+        impl_->skiaContext_->performDeferredCleanup(age);
+    }
+
+    void RenderContext::TrimMemory() {
+        if (!impl_ || !impl_->skiaContext_) return;
+        
+        // 先让上层放掉引用，这些资源才会变成可释放状态
+        OnTrimMemory();
+        
+        if (!impl_->EnsureCurrent()) {
+            std::cerr << "RenderContext: Failed to make context current for trimming" << std::endl;
+            return;
+        }
+        
+        // 内存压力事件可能很频繁，回收量只记录下来，由需要的调用者查询
+        int count = 0;
+        TrimStats& stats = impl_->trimStats_;
+        impl_->skiaContext_->getResourceCacheUsage(&count, &stats.bytesBefore);
+        impl_->skiaContext_->flushAndSubmit(GrSyncCpu::kYes);
+        impl_->skiaContext_->freeGpuResources();
+        impl_->skiaContext_->getResourceCacheUsage(&count, &stats.bytesAfter);
+        ++stats.trimCount;
+    }
+
+    TextDiskCache::Stats RenderContext::GetTextCacheStats() const {
+        return impl_ ? impl_->textCacheStats_ : TextDiskCache::Stats();
+    }
+
+    RenderContext::TrimStats RenderContext::GetTrimStats() const {
+        return impl_ ? impl_->trimStats_ : TrimStats();
+    }
+
+    void RenderContext::EnableAutomaticTrim(foundation::WindowManager& windowManager) {
+        if (!impl_) return;
+        // 放在最后执行：其他监听者（如 SceneRenderer）先释放它们的缓存
+        impl_->trimConnection_ = windowManager.OnAllWindowsHidden.connect(
+            [this]() { TrimMemory(); }, boost::signals2::at_back);
+    }
+
+    void RenderContext::DisableAutomaticTrim() {
+        if (!impl_) return;
+        impl_->trimConnection_.disconnect();
+    }
+
 } // namespace graphics
 } // namespace KiUI
@@ -23,6 +23,7 @@
 #include <core/SkColorSpace.h>  // SkColorSpace (needed by SkSurface)
 #include <gpu/ganesh/GrBackendSurface.h>
 #include <gpu/ganesh/GrTypes.h>
+#include <atomic>
 #include <iostream>
 
 namespace KiUI {
@@ -36,8 +37,44 @@ struct RenderSurface::Impl {
     int height_ = 0;
     bool initialized_ = false;
     SkCanvas* currentCanvas_ = nullptr;
+    GrGLenum framebufferFormat_ = GL_RGBA8; // 由 EGL 配置决定，Initialize 时查询一次
+    std::atomic<bool> resizePending_{false}; // 窗口尺寸回调置位，BeginFrame 中合并处理（可能在另一个线程上）
+    boost::signals2::scoped_connection resizeConnection_;
+    
+    bool CreateSkiaSurface();
 };
 
+bool RenderSurface::Impl::CreateSkiaSurface() {
+    GrDirectContext* skiaContext = context_->GetSkiaContext();
+    if (!skiaContext) {
+        return false;
+    }
+    
+    // 获取默认的 framebuffer
+    GrGLFramebufferInfo framebufferInfo;
+    framebufferInfo.fFBOID = 0;
+    framebufferInfo.fFormat = framebufferFormat_;
+    
+    // 创建 GrBackendRenderTarget
+    GrBackendRenderTarget backendRenderTarget = GrBackendRenderTargets::MakeGL(
+        width_,
+        height_,
+        0,  // sample count
+        0,  // stencil bits
+        framebufferInfo
+    );
+    
+    skSurface_ = SkSurfaces::WrapBackendRenderTarget(
+        reinterpret_cast<GrRecordingContext*>(skiaContext),
+        backendRenderTarget,
+        kBottomLeft_GrSurfaceOrigin,
+        kRGBA_8888_SkColorType,
+        nullptr,  // 颜色空间
+        nullptr   // SurfaceProps
+    );
+    return skSurface_ != nullptr;
+}
+
 RenderSurface::RenderSurface(boost::shared_ptr<RenderContext> context, 
                              boost::shared_ptr<foundation::Window> window)
     : impl_(new Impl())
@@ -108,8 +145,8 @@ bool RenderSurface::Initialize() {
     }
     
     // 获取窗口大小（考虑 DPI 缩放）
-    int width, height;
-    glfwGetFramebufferSize(glfwWindow, &width, &height);
+    int width = window->GetFramebufferWidth();
+    int height = window->GetFramebufferHeight();
     impl_->width_ = width;
     impl_->height_ = height;
     
@@ -153,43 +190,12 @@ bool RenderSurface::Initialize() {
         return false;
     }
     
-    // 获取默认的 framebuffer
-    GrGLFramebufferInfo framebufferInfo;
-    framebufferInfo.fFBOID = 0;
-    
-    // 获取颜色格式
-    EGLint redSize, greenSize, blueSize, alphaSize;
-    eglGetConfigAttrib(display, config, EGL_RED_SIZE, &redSize);
-    eglGetConfigAttrib(display, config, EGL_GREEN_SIZE, &greenSize);
-    eglGetConfigAttrib(display, config, EGL_BLUE_SIZE, &blueSize);
+    // 颜色格式只取决于 EGL 配置，查询一次后调整大小时直接复用
+    EGLint alphaSize = 0;
     eglGetConfigAttrib(display, config, EGL_ALPHA_SIZE, &alphaSize);
+    impl_->framebufferFormat_ = (alphaSize == 0) ? GL_RGB8 : GL_RGBA8;
     
-    // 确定 Skia 颜色类型
-    GrGLenum format = GL_RGBA8;
-    if (alphaSize == 0) {
-        format = GL_RGB8;
-    }
-    
-    framebufferInfo.fFormat = format;
-    
-    // 创建 GrBackendRenderTarget
-    GrBackendRenderTarget backendRenderTarget = GrBackendRenderTargets::MakeGL(
-        impl_->width_, 
-        impl_->height_,
-        0,
-        0,
-        framebufferInfo
-    );
-    
-    GrRecordingContext* recordingContext = reinterpret_cast<GrRecordingContext*>(skiaContext);
-    impl_->skSurface_ = SkSurfaces::WrapBackendRenderTarget(
-        recordingContext,
-        backendRenderTarget,
-        kBottomLeft_GrSurfaceOrigin,
-        kRGBA_8888_SkColorType,
-        nullptr,
-        nullptr
-    );
+    impl_->CreateSkiaSurface();
     
     if (!impl_->skSurface_) {
         std::cerr << "RenderSurface: Failed to create Skia surface" << std::endl;
@@ -198,6 +204,13 @@ bool RenderSurface::Initialize() {
         return false;
     }
     
+    // 调整大小由回调驱动：这里只记录"有变化"，真正的重建在下一次 BeginFrame 中合并执行
+    RenderSurface::Impl* impl = impl_.get();
+    impl_->resizeConnection_ = window->OnFramebufferResized.connect([impl](int, int) {
+        impl->resizePending_ = true;
+    });
+    impl_->resizePending_ = false;
+    
     impl_->initialized_ = true;
     std::cout << "RenderSurface: Initialized successfully, size: " 
               << impl_->width_ << "x" << impl_->height_ << std::endl;
@@ -235,6 +248,8 @@ bool RenderSurface::Destroy() {
         impl_->eglSurface_ = EGL_NO_SURFACE;
     }
     
+    impl_->resizeConnection_.disconnect();
+    impl_->resizePending_ = false;
     impl_->initialized_ = false;
     impl_->width_ = 0;
     impl_->height_ = 0;
@@ -255,68 +270,6 @@ boost::optional<boost::reference_wrapper<SkCanvas>> RenderSurface::BeginFrame()
         return boost::none;
     }
     
-    // 获取当前窗口大小（可能已经改变）
-    GLFWwindow* glfwWindow = window->GetHandle();
-    if (!glfwWindow) {
-        return boost::none;
-    }
-    
-    int newWidth, newHeight;
-    glfwGetFramebufferSize(glfwWindow, &newWidth, &newHeight);
-    
-    // 如果窗口大小改变了，需要重新创建 Skia 表面
-    if (newWidth != impl_->width_ || newHeight != impl_->height_) {
-        if (newWidth > 0 && newHeight > 0) {
-            impl_->width_ = newWidth;
-            impl_->height_ = newHeight;
-            
-            // 重新创建 Skia 表面（EGL 表面会自动适应窗口大小）
-            auto nativeHandles = impl_->context_->GetNativeHandles();
-            EGLDisplay display = static_cast<EGLDisplay>(nativeHandles.display);
-            EGLConfig config = static_cast<EGLConfig>(nativeHandles.config);
-            EGLContext context = static_cast<EGLContext>(nativeHandles.context);
-            
-            // 确保上下文是当前的
-            if (!eglMakeCurrent(display, impl_->eglSurface_, impl_->eglSurface_, context)) {
-                std::cerr << "RenderSurface: Failed to make context current in BeginFrame" << std::endl;
-                return boost::none;
-            }
-            
-            // 重新创建 Skia 表面
-            GrDirectContext* skiaContext = impl_->context_->GetSkiaContext();
-            if (skiaContext) {
-                GrGLFramebufferInfo framebufferInfo;
-                framebufferInfo.fFBOID = 0;
-                
-                EGLint alphaSize;
-                eglGetConfigAttrib(display, config, EGL_ALPHA_SIZE, &alphaSize);
-                framebufferInfo.fFormat = (alphaSize > 0) ? GL_RGBA8 : GL_RGB8;
-                
-                GrBackendRenderTarget backendRenderTarget = GrBackendRenderTargets::MakeGL(
-                    impl_->width_,
-                    impl_->height_,
-                    0,  // sample count
-                    0,  // stencil bits
-                    framebufferInfo
-                );
-                
-                impl_->skSurface_ = SkSurfaces::WrapBackendRenderTarget(
-                    reinterpret_cast<GrRecordingContext*>(skiaContext),  // 隐式转换为 GrRecordingContext*
-                    backendRenderTarget,
-                    kBottomLeft_GrSurfaceOrigin,
-                    kRGBA_8888_SkColorType,
-                    nullptr,  // 颜色空间
-                    nullptr   // SurfaceProps
-                );
-                
-                if (!impl_->skSurface_) {
-                    std::cerr << "RenderSurface: Failed to recreate Skia surface after resize" << std::endl;
-                    return boost::none;
-                }
-            }
-        }
-    }
-    
     // 确保 EGL 上下文是当前的（上下文切换）
     // 注意：如果有多个窗口，每一帧都需要切换上下文
     auto nativeHandles = impl_->context_->GetNativeHandles();
@@ -330,6 +283,25 @@ boost::optional<boost::reference_wrapper<SkCanvas>> RenderSurface::BeginFrame()
         return boost::none;
     }
     
+    // 拖动调整大小时两帧之间可能收到多次尺寸回调，这里只按最新尺寸重建一次表面
+    // （EGL 表面会自动适应窗口大小，只需要重新包装 Skia 表面）
+    if (impl_->resizePending_) {
+        int newWidth = window->GetFramebufferWidth();
+        int newHeight = window->GetFramebufferHeight();
+        // 最小化时尺寸为 0：保留原表面，恢复后再处理
+        if (newWidth > 0 && newHeight > 0) {
+            impl_->resizePending_ = false;
+            if (newWidth != impl_->width_ || newHeight != impl_->height_) {
+                impl_->width_ = newWidth;
+                impl_->height_ = newHeight;
+                if (!impl_->CreateSkiaSurface()) {
+                    std::cerr << "RenderSurface: Failed to recreate Skia surface after resize" << std::endl;
+                    return boost::none;
+                }
+            }
+        }
+    }
+    
     // 获取 Skia 画布
     SkCanvas* canvas = impl_->skSurface_->getCanvas();
     if (!canvas) {
@@ -346,6 +318,16 @@ boost::optional<boost::reference_wrapper<SkCanvas>> RenderSurface::BeginFrame()
     return boost::make_optional(boost::ref(*canvas));
 }
 
+void RenderSurface::Flush() {
+    if (!impl_->initialized_ || !impl_->currentCanvas_) {
+        return;
+    }
+    GrDirectContext* skiaContext = impl_->context_->GetSkiaContext();
+    if (skiaContext && impl_->skSurface_) {
+        skiaContext->flush(impl_->skSurface_.get());
+    }
+}
+
 void RenderSurface::EndFrame() {
     if (!impl_->initialized_ || !impl_->currentCanvas_) {
         return; // 没有活动的帧
@@ -381,6 +363,30 @@ void RenderSurface::EndFrame() {
     impl_->currentCanvas_ = nullptr;
 }
 
+void RenderSurface::ReleaseCurrent() {
+    if (!impl_->initialized_) {
+        return;
+    }
+    auto nativeHandles = impl_->context_->GetNativeHandles();
+    EGLDisplay display = static_cast<EGLDisplay>(nativeHandles.display);
+    if (display == EGL_NO_DISPLAY || eglGetCurrentSurface(EGL_DRAW) != impl_->eglSurface_) {
+        return;
+    }
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT)) {
+        EGLint error = eglGetError();
+        std::cerr << "RenderSurface: Failed to release context, error: 0x"
+                  << std::hex << error << std::dec << std::endl;
+    }
+}
+
+int RenderSurface::GetWidth() const {
+    return impl_->width_;
+}
+
+int RenderSurface::GetHeight() const {
+    return impl_->height_;
+}
+
 } // namespace graphics
 } // namespace KiUI
 
@@ -0,0 +1,163 @@
+#include "ShaderCache.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace KiUI {
+namespace graphics {
+
+namespace {
+
+// 条目文件格式：[magic][keySize][key][data]，读取时校验完整的键，避免哈希碰撞取错程序
+constexpr uint32_t kEntryMagic = 0x3143534B; // "KSC1"
+
+uint64_t HashBytes(const void* bytes, size_t size) {
+    // FNV-1a 64
+    const uint8_t* p = static_cast<const uint8_t*>(bytes);
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string ToHex(uint64_t value) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        text[i] = kDigits[value & 0xF];
+        value >>= 4;
+    }
+    return text;
+}
+
+} // namespace
+
+ShaderCache::ShaderCache(const std::string& directory, const std::string& driverIdentity) {
+    directory_ = std::filesystem::path(directory) / ToHex(HashBytes(driverIdentity.data(), driverIdentity.size()));
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    valid_ = !ec && std::filesystem::is_directory(directory_, ec);
+    if (!valid_) {
+        std::cerr << "ShaderCache: Failed to create cache directory " << directory_.string()
+                  << ": " << ec.message() << std::endl;
+        return;
+    }
+
+    // 记录驱动标识，便于排查
+    std::ofstream identity(directory_ / "driver.txt", std::ios::trunc);
+    identity << driverIdentity << std::endl;
+}
+
+ShaderCache::~ShaderCache() {
+}
+
+std::filesystem::path ShaderCache::EntryPath(const SkData& key) const {
+    return directory_ / (ToHex(HashBytes(key.data(), key.size())) + ".bin");
+}
+
+sk_sp<SkData> ShaderCache::load(const SkData& key) {
+    if (!valid_) {
+        return nullptr;
+    }
+
+    std::ifstream file(EntryPath(key), std::ios::binary);
+    if (!file) {
+        ++misses_;
+        return nullptr;
+    }
+
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const size_t headerSize = sizeof(uint32_t) * 2;
+    if (contents.size() < headerSize) {
+        ++misses_;
+        return nullptr;
+    }
+
+    uint32_t magic = 0;
+    uint32_t keySize = 0;
+    std::memcpy(&magic, contents.data(), sizeof(uint32_t));
+    std::memcpy(&keySize, contents.data() + sizeof(uint32_t), sizeof(uint32_t));
+    if (magic != kEntryMagic || keySize != key.size() ||
+        contents.size() < headerSize + keySize ||
+        std::memcmp(contents.data() + headerSize, key.data(), keySize) != 0) {
+        ++misses_;
+        return nullptr;
+    }
+
+    ++hits_;
+    const size_t offset = headerSize + keySize;
+    return SkData::MakeWithCopy(contents.data() + offset, contents.size() - offset);
+}
+
+void ShaderCache::store(const SkData& key, const SkData& data, const SkString& description) {
+    if (!valid_) {
+        return;
+    }
+
+    const std::filesystem::path path = EntryPath(key);
+    // 共享上下文可能在多个线程同时写同一个条目，临时文件按线程区分
+    std::filesystem::path temp = path;
+    temp += "." + ToHex(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+    // 先写临时文件再重命名，进程中途退出也不会留下半个条目
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return;
+        }
+        const uint32_t magic = kEntryMagic;
+        const uint32_t keySize = static_cast<uint32_t>(key.size());
+        file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&keySize), sizeof(keySize));
+        file.write(static_cast<const char*>(key.data()), static_cast<std::streamsize>(key.size()));
+        file.write(static_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return;
+    }
+    ++stores_;
+    // description 是着色器源码摘要，仅用于调试，不写入磁盘
+    (void)description;
+}
+
+void ShaderCache::Clear() {
+    if (!valid_) {
+        return;
+    }
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+        if (entry.path().extension() == ".bin") {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+}
+
+ShaderCache::Stats ShaderCache::GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load();
+    stats.misses = misses_.load();
+    stats.stores = stores_.load();
+    return stats;
+}
+
+} // namespace graphics
+} // namespace KiUI
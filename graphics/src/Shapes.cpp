@@ -61,6 +61,31 @@ void Shapes::DrawRoundedRectangle(SkCanvas* canvas,
         return;
     }
     
+    SkRRect rrect = MakeRoundedRect(x, y, width, height, topLeft, topRight, bottomRight, bottomLeft);
+    
+    // Draw fill
+    if (fillColor != SK_ColorTRANSPARENT) {
+        SkPaint fillPaint;
+        fillPaint.setColor(SkColorSetA(fillColor, static_cast<U8CPU>(opacity * 255)));
+        fillPaint.setStyle(SkPaint::kFill_Style);
+        fillPaint.setAntiAlias(true);
+        canvas->drawRRect(rrect, fillPaint);
+    }
+    
+    // Draw stroke
+    if (strokeColor != SK_ColorTRANSPARENT && strokeWidth > 0.0f) {
+        SkPaint strokePaint;
+        strokePaint.setColor(SkColorSetA(strokeColor, static_cast<U8CPU>(opacity * 255)));
+        strokePaint.setStyle(SkPaint::kStroke_Style);
+        strokePaint.setStrokeWidth(strokeWidth);
+        strokePaint.setAntiAlias(true);
+        canvas->drawRRect(rrect, strokePaint);
+    }
+}
+
+SkRRect Shapes::MakeRoundedRect(float x, float y, float width, float height,
+                                float topLeft, float topRight,
+                                float bottomRight, float bottomLeft) {
     SkRect rect = SkRect::MakeXYWH(x, y, width, height);
     
     // Clamp radii to half the size of the rect
@@ -83,25 +108,7 @@ void Shapes::DrawRoundedRectangle(SkCanvas* canvas,
         };
         rrect.setRectRadii(rect, radii);
     }
-    
-    // Draw fill
-    if (fillColor != SK_ColorTRANSPARENT) {
-        SkPaint fillPaint;
-        fillPaint.setColor(SkColorSetA(fillColor, static_cast<U8CPU>(opacity * 255)));
-        fillPaint.setStyle(SkPaint::kFill_Style);
-        fillPaint.setAntiAlias(true);
-        canvas->drawRRect(rrect, fillPaint);
-    }
-    
-    // Draw stroke
-    if (strokeColor != SK_ColorTRANSPARENT && strokeWidth > 0.0f) {
-        SkPaint strokePaint;
-        strokePaint.setColor(SkColorSetA(strokeColor, static_cast<U8CPU>(opacity * 255)));
-        strokePaint.setStyle(SkPaint::kStroke_Style);
-        strokePaint.setStrokeWidth(strokeWidth);
-        strokePaint.setAntiAlias(true);
-        canvas->drawRRect(rrect, strokePaint);
-    }
+    return rrect;
 }
 
 void Shapes::DrawCircle(SkCanvas* canvas,
@@ -0,0 +1,337 @@
+#include "TextDiskCache.hpp"
+#include "GlyphAtlas.hpp"
+#include "TextEngine.hpp"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/make_shared.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <system_error>
+#include <vector>
+
+namespace KiUI {
+namespace graphics {
+
+namespace {
+
+constexpr char kMagic[4] = {'K', 'T', 'X', 'C'};
+
+/*
+ * 文件布局（本机字节序，文件只在同一台机器上使用）：
+ *   magic[4] version:u32 fontCount:u32
+ *   每个字体：pathLength:u32 path faceIndex:i32 fontHash:u64 sectionSize:u64，后面是 sectionSize 字节：
+ *     glyphCount:u32 { glyphId:u32 sizeKey:u32 width:i32 height:i32 left:i32 top:i32 coverage[width*height] }
+ *     runCount:u32 { fontSize:f32 textLength:u32 text featureCount:u32 { length:u32 feature }
+ *                    advance:f32 glyphCount:u32 { glyphId:u32 cluster:u32 x:f32 y:f32 } }
+ * 字体不匹配时按 sectionSize 整段跳过
+ */
+
+class Writer {
+public:
+    template <typename T>
+    void Put(const T& value) {
+        data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void PutString(const std::string& value) {
+        Put(static_cast<uint32_t>(value.size()));
+        data_.append(value);
+    }
+
+    void PutBytes(const void* bytes, size_t size) {
+        data_.append(static_cast<const char*>(bytes), size);
+    }
+
+    std::string& Data() { return data_; }
+
+private:
+    std::string data_;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool Get(T* value) {
+        if (size_ - offset_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool GetString(std::string* value) {
+        uint32_t length = 0;
+        const uint8_t* bytes = nullptr;
+        if (!Get(&length) || !GetBytes(length, &bytes)) {
+            return false;
+        }
+        value->assign(reinterpret_cast<const char*>(bytes), length);
+        return true;
+    }
+
+    bool GetBytes(size_t size, const uint8_t** bytes) {
+        if (size_ - offset_ < size) {
+            return false;
+        }
+        *bytes = data_ + offset_;
+        offset_ += size;
+        return true;
+    }
+
+    size_t Remaining() const { return size_ - offset_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+struct GlyphRecord {
+    uint32_t glyphId = 0;
+    uint32_t sizeKey = 0;
+    GlyphBitmap bitmap;
+};
+
+struct FontSection {
+    std::vector<GlyphRecord> glyphs;
+    std::vector<TextEngine::ShapeCacheEntry> runs;
+};
+
+bool LoadSection(Reader& reader, int fontId, TextDiskCache::Stats* stats) {
+    TextEngine& engine = TextEngine::GetSharedInstance();
+    GlyphAtlas& atlas = GlyphAtlas::GetSharedInstance();
+
+    uint32_t glyphCount = 0;
+    if (!reader.Get(&glyphCount)) {
+        return false;
+    }
+    bool atlasFull = false;
+    GlyphBitmap bitmap;
+    for (uint32_t i = 0; i < glyphCount; ++i) {
+        uint32_t glyphId = 0;
+        uint32_t sizeKey = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t left = 0;
+        int32_t top = 0;
+        const uint8_t* coverage = nullptr;
+        if (!reader.Get(&glyphId) || !reader.Get(&sizeKey) || !reader.Get(&width) || !reader.Get(&height) ||
+            !reader.Get(&left) || !reader.Get(&top) || width < 0 || height < 0 ||
+            !reader.GetBytes(static_cast<size_t>(width) * static_cast<size_t>(height), &coverage)) {
+            return false;
+        }
+        if (atlasFull) {
+            continue;
+        }
+        bitmap.width = width;
+        bitmap.height = height;
+        bitmap.left = left;
+        bitmap.top = top;
+        bitmap.coverage.assign(coverage, coverage + static_cast<size_t>(width) * height);
+        // 图集放满后不再放入，剩下的字形第一次绘制时照常光栅化
+        if (atlas.AddGlyph(fontId, glyphId, sizeKey, bitmap)) {
+            ++stats->glyphsLoaded;
+        } else {
+            atlasFull = true;
+        }
+    }
+
+    uint32_t runCount = 0;
+    if (!reader.Get(&runCount)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < runCount; ++i) {
+        auto run = boost::make_shared<ShapedRun>();
+        run->fontId = fontId;
+        std::string text;
+        std::vector<std::string> features;
+        uint32_t featureCount = 0;
+        if (!reader.Get(&run->fontSize) || !reader.GetString(&text) || !reader.Get(&featureCount)) {
+            return false;
+        }
+        // 每个特性至少有 4 字节的长度前缀，先校验数量，避免损坏的计数导致超大分配
+        if (featureCount > reader.Remaining() / sizeof(uint32_t)) {
+            return false;
+        }
+        features.resize(featureCount);
+        for (auto& feature : features) {
+            if (!reader.GetString(&feature)) {
+                return false;
+            }
+        }
+        uint32_t count = 0;
+        if (!reader.Get(&run->advance) || !reader.Get(&count) || count > reader.Remaining() / 16) {
+            return false;
+        }
+        run->glyphs.resize(count);
+        for (auto& glyph : run->glyphs) {
+            if (!reader.Get(&glyph.glyphId) || !reader.Get(&glyph.cluster) || !reader.Get(&glyph.x) ||
+                !reader.Get(&glyph.y)) {
+                return false;
+            }
+        }
+        // 度量不保存，从字体重新读取（不需要排版）
+        run->metrics = engine.GetMetrics(fontId, run->fontSize);
+        engine.SeedShapeCache(text, features, run);
+        ++stats->runsLoaded;
+    }
+    return true;
+}
+
+} // namespace
+
+bool TextDiskCache::Load(const std::string& path, Stats* stats) {
+    Stats localStats;
+    if (!stats) {
+        stats = &localStats;
+    }
+    *stats = Stats();
+
+    std::error_code error;
+    if (!std::filesystem::exists(path, error) || std::filesystem::file_size(path, error) == 0) {
+        return false;
+    }
+
+    namespace bip = boost::interprocess;
+    try {
+        bip::file_mapping file(path.c_str(), bip::read_only);
+        bip::mapped_region region(file, bip::read_only);
+        Reader reader(static_cast<const uint8_t*>(region.get_address()), region.get_size());
+
+        const uint8_t* magic = nullptr;
+        uint32_t version = 0;
+        uint32_t fontCount = 0;
+        if (!reader.GetBytes(sizeof(kMagic), &magic) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+            !reader.Get(&version) || version != kFormatVersion || !reader.Get(&fontCount)) {
+            std::cerr << "TextDiskCache: Ignoring incompatible cache file " << path << std::endl;
+            return false;
+        }
+
+        TextEngine& engine = TextEngine::GetSharedInstance();
+        for (uint32_t i = 0; i < fontCount; ++i) {
+            std::string fontPath;
+            int32_t faceIndex = 0;
+            uint64_t fontHash = 0;
+            uint64_t sectionSize = 0;
+            const uint8_t* section = nullptr;
+            if (!reader.GetString(&fontPath) || !reader.Get(&faceIndex) || !reader.Get(&fontHash) ||
+                !reader.Get(&sectionSize) || !reader.GetBytes(static_cast<size_t>(sectionSize), &section)) {
+                std::cerr << "TextDiskCache: Cache file is truncated " << path << std::endl;
+                return false;
+            }
+
+            const int fontId = engine.FindFont(fontPath, faceIndex);
+            if (fontId < 0 || engine.GetFontHash(fontId) != fontHash) {
+                ++stats->fontsSkipped;
+                continue;
+            }
+            ++stats->fontsMatched;
+            Reader sectionReader(section, static_cast<size_t>(sectionSize));
+            if (!LoadSection(sectionReader, fontId, stats)) {
+                // 已经放入的字形和排版结果本身有效，保留；这一段按跳过计数
+                std::cerr << "TextDiskCache: Corrupted data for font " << fontPath << std::endl;
+                --stats->fontsMatched;
+                ++stats->fontsSkipped;
+            }
+        }
+        return true;
+    } catch (const bip::interprocess_exception& e) {
+        std::cerr << "TextDiskCache: Failed to map " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool TextDiskCache::Save(const std::string& path, size_t maxRuns) {
+    TextEngine& engine = TextEngine::GetSharedInstance();
+
+    // 按字体分组；字体 id 只在当前进程有效，文件中用路径和哈希标识字体
+    std::map<int, FontSection> sections;
+    GlyphAtlas::GetSharedInstance().ForEachGlyph(
+        [&](int fontId, uint32_t glyphId, uint32_t sizeKey, const GlyphBitmap& bitmap) {
+            GlyphRecord record;
+            record.glyphId = glyphId;
+            record.sizeKey = sizeKey;
+            record.bitmap = bitmap;
+            sections[fontId].glyphs.push_back(std::move(record));
+        });
+    for (auto& entry : engine.GetShapeCacheEntries(maxRuns)) {
+        const int fontId = entry.run->fontId;
+        sections[fontId].runs.push_back(std::move(entry));
+    }
+
+    Writer writer;
+    writer.PutBytes(kMagic, sizeof(kMagic));
+    writer.Put(kFormatVersion);
+    const size_t fontCountOffset = writer.Data().size();
+    writer.Put(static_cast<uint32_t>(0));
+
+    uint32_t fontCount = 0;
+    for (const auto& item : sections) {
+        const std::string fontPath = engine.GetFontPath(item.first);
+        if (fontPath.empty()) {
+            continue;
+        }
+        Writer section;
+        section.Put(static_cast<uint32_t>(item.second.glyphs.size()));
+        for (const auto& glyph : item.second.glyphs) {
+            section.Put(glyph.glyphId);
+            section.Put(glyph.sizeKey);
+            section.Put(static_cast<int32_t>(glyph.bitmap.width));
+            section.Put(static_cast<int32_t>(glyph.bitmap.height));
+            section.Put(static_cast<int32_t>(glyph.bitmap.left));
+            section.Put(static_cast<int32_t>(glyph.bitmap.top));
+            section.PutBytes(glyph.bitmap.coverage.data(), glyph.bitmap.coverage.size());
+        }
+        section.Put(static_cast<uint32_t>(item.second.runs.size()));
+        for (const auto& entry : item.second.runs) {
+            section.Put(entry.run->fontSize);
+            section.PutString(entry.text);
+            section.Put(static_cast<uint32_t>(entry.features.size()));
+            for (const auto& feature : entry.features) {
+                section.PutString(feature);
+            }
+            section.Put(entry.run->advance);
+            section.Put(static_cast<uint32_t>(entry.run->glyphs.size()));
+            for (const auto& glyph : entry.run->glyphs) {
+                section.Put(glyph.glyphId);
+                section.Put(glyph.cluster);
+                section.Put(glyph.x);
+                section.Put(glyph.y);
+            }
+        }
+
+        writer.PutString(fontPath);
+        writer.Put(static_cast<int32_t>(engine.GetFontFaceIndex(item.first)));
+        writer.Put(engine.GetFontHash(item.first));
+        writer.Put(static_cast<uint64_t>(section.Data().size()));
+        writer.Data().append(section.Data());
+        ++fontCount;
+    }
+    std::memcpy(&writer.Data()[fontCountOffset], &fontCount, sizeof(fontCount));
+
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(writer.Data().data(), static_cast<std::streamsize>(writer.Data().size()))) {
+            std::cerr << "TextDiskCache: Failed to write " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::cerr << "TextDiskCache: Failed to replace " << path << ": " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace graphics
+} // namespace KiUI
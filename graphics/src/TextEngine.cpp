@@ -0,0 +1,544 @@
+#include "TextEngine.hpp"
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#if defined(GRAPHICS_USE_FREETYPE) && defined(GRAPHICS_USE_HARFBUZZ)
+#define KIUI_HAS_TEXT_ENGINE 1
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <hb.h>
+#endif
+
+namespace KiUI {
+namespace graphics {
+
+namespace {
+
+// 排版缓存键：各字段之间用不会出现在普通文字中的分隔符隔开
+std::string MakeShapeKey(const std::string& text, int fontId, float fontSize, const std::vector<std::string>& features) {
+    uint32_t sizeBits = 0;
+    std::memcpy(&sizeBits, &fontSize, sizeof(sizeBits));
+    std::string key;
+    key.reserve(text.size() + 32);
+    key.append(std::to_string(fontId)).push_back('\x1f');
+    key.append(std::to_string(sizeBits)).push_back('\x1f');
+    for (const auto& feature : features) {
+        key.append(feature).push_back(',');
+    }
+    key.push_back('\x1f');
+    key.append(text);
+    return key;
+}
+
+// 拆开 MakeShapeKey 生成的键；文字在最后，可以包含任意字符
+bool ParseShapeKey(const std::string& key, std::string* text, std::vector<std::string>* features) {
+    const size_t fontEnd = key.find('\x1f');
+    const size_t sizeEnd = fontEnd == std::string::npos ? std::string::npos : key.find('\x1f', fontEnd + 1);
+    const size_t featuresEnd = sizeEnd == std::string::npos ? std::string::npos : key.find('\x1f', sizeEnd + 1);
+    if (featuresEnd == std::string::npos) {
+        return false;
+    }
+    features->clear();
+    size_t start = sizeEnd + 1;
+    for (size_t comma = key.find(',', start); comma < featuresEnd; comma = key.find(',', start)) {
+        features->push_back(key.substr(start, comma - start));
+        start = comma + 1;
+    }
+    text->assign(key, featuresEnd + 1, std::string::npos);
+    return true;
+}
+
+} // namespace
+
+#ifdef KIUI_HAS_TEXT_ENGINE
+struct FontFace {
+    std::string path;
+    int faceIndex = 0;
+    std::vector<uint8_t> data;      // FreeType 和 HarfBuzz 共用同一份字体数据
+    FT_Face ftFace = nullptr;
+    hb_face_t* hbFace = nullptr;
+    std::mutex ftMutex;             // FT_Face 不是线程安全的，光栅化时加锁
+    uint64_t hash = 0;              // 字体文件哈希，第一次使用时计算（受引擎的锁保护）
+
+    ~FontFace() {
+        if (hbFace) {
+            hb_face_destroy(hbFace);
+        }
+        if (ftFace) {
+            FT_Done_Face(ftFace);
+        }
+    }
+};
+
+namespace {
+
+// 按 8 字节一组计算的 64 位哈希，大字体文件（CJK 字体常有数十 MB）也只需要几毫秒
+uint64_t HashFontData(const std::vector<uint8_t>& data) {
+    constexpr uint64_t kPrime = 0x100000001b3ull;
+    uint64_t hash = 0xcbf29ce484222325ull ^ data.size();
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= data.size(); i += sizeof(uint64_t)) {
+        uint64_t word = 0;
+        std::memcpy(&word, data.data() + i, sizeof(word));
+        hash = (hash ^ word) * kPrime;
+        hash ^= hash >> 29;
+    }
+    for (; i < data.size(); ++i) {
+        hash = (hash ^ data[i]) * kPrime;
+    }
+    return hash;
+}
+
+// 用 HarfBuzz 排版到 run 中；hb_face 是不可变的，每次排版创建自己的 hb_font，不需要加锁
+void ShapeWithFace(FontFace* face, const std::string& text, float fontSize,
+                   const std::vector<std::string>& features, ShapedRun* run) {
+    if (text.empty()) {
+        return;
+    }
+    std::vector<hb_feature_t> hbFeatures;
+    hbFeatures.reserve(features.size());
+    for (const auto& feature : features) {
+        hb_feature_t parsed;
+        if (hb_feature_from_string(feature.c_str(), static_cast<int>(feature.size()), &parsed)) {
+            hbFeatures.push_back(parsed);
+        }
+    }
+
+    // 坐标以 26.6 定点数返回
+    hb_font_t* font = hb_font_create(face->hbFace);
+    const int scale = static_cast<int>(std::lround(fontSize * 64.0f));
+    hb_font_set_scale(font, scale, scale);
+
+    hb_buffer_t* buffer = hb_buffer_create();
+    hb_buffer_add_utf8(buffer, text.data(), static_cast<int>(text.size()), 0, static_cast<int>(text.size()));
+    hb_buffer_guess_segment_properties(buffer);
+    hb_shape(font, buffer, hbFeatures.empty() ? nullptr : hbFeatures.data(),
+             static_cast<unsigned int>(hbFeatures.size()));
+
+    unsigned int count = 0;
+    const hb_glyph_info_t* infos = hb_buffer_get_glyph_infos(buffer, &count);
+    const hb_glyph_position_t* positions = hb_buffer_get_glyph_positions(buffer, &count);
+    run->glyphs.reserve(count);
+    float penX = 0.0f;
+    float penY = 0.0f;
+    for (unsigned int i = 0; i < count; ++i) {
+        ShapedGlyph glyph;
+        glyph.glyphId = infos[i].codepoint;
+        glyph.cluster = infos[i].cluster;
+        glyph.x = penX + positions[i].x_offset / 64.0f;
+        glyph.y = penY - positions[i].y_offset / 64.0f;
+        run->glyphs.push_back(glyph);
+        penX += positions[i].x_advance / 64.0f;
+        penY -= positions[i].y_advance / 64.0f;
+    }
+    run->advance = penX;
+
+    hb_buffer_destroy(buffer);
+    hb_font_destroy(font);
+}
+
+} // namespace
+#endif
+
+struct TextEngine::Impl {
+    using ShapeList = std::list<std::pair<std::string, boost::shared_ptr<const ShapedRun>>>;
+
+    mutable std::mutex mutex_;
+#ifdef KIUI_HAS_TEXT_ENGINE
+    FT_Library library_ = nullptr;
+    std::vector<std::unique_ptr<FontFace>> fonts_;  // 字体加载后不会移除，FontFace 地址保持稳定
+#endif
+    int defaultFont_ = -1;
+
+    ShapeList shapeLru_;    // 头部是最近使用的条目
+    std::unordered_map<std::string, ShapeList::iterator> shapeIndex_;
+    size_t shapeCapacity_ = kDefaultShapeCacheCapacity;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+
+    ~Impl() {
+#ifdef KIUI_HAS_TEXT_ENGINE
+        fonts_.clear();
+        if (library_) {
+            FT_Done_FreeType(library_);
+        }
+#endif
+    }
+
+    void EvictLocked() {
+        while (shapeLru_.size() > shapeCapacity_) {
+            shapeIndex_.erase(shapeLru_.back().first);
+            shapeLru_.pop_back();
+        }
+    }
+
+#ifdef KIUI_HAS_TEXT_ENGINE
+    FontFace* GetFontLocked(int fontId) const {
+        if (fontId < 0) {
+            fontId = defaultFont_;
+        }
+        if (fontId < 0 || fontId >= static_cast<int>(fonts_.size())) {
+            return nullptr;
+        }
+        return fonts_[fontId].get();
+    }
+#endif
+};
+
+TextEngine& TextEngine::GetSharedInstance() {
+    static TextEngine instance;
+    return instance;
+}
+
+TextEngine::TextEngine() : impl_(new Impl()) {}
+
+TextEngine::~TextEngine() = default;
+
+int TextEngine::LoadFont(const std::string& path, int faceIndex) {
+#ifdef KIUI_HAS_TEXT_ENGINE
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    for (size_t i = 0; i < impl_->fonts_.size(); ++i) {
+        if (impl_->fonts_[i]->path == path && impl_->fonts_[i]->faceIndex == faceIndex) {
+            return static_cast<int>(i);
+        }
+    }
+
+    if (!impl_->library_ && FT_Init_FreeType(&impl_->library_) != 0) {
+        impl_->library_ = nullptr;
+        std::cerr << "TextEngine: Failed to initialize FreeType" << std::endl;
+        return -1;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "TextEngine: Cannot open font " << path << std::endl;
+        return -1;
+    }
+
+    auto face = std::make_unique<FontFace>();
+    face->path = path;
+    face->faceIndex = faceIndex;
+    face->data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (face->data.empty() ||
+        FT_New_Memory_Face(impl_->library_, face->data.data(), static_cast<FT_Long>(face->data.size()),
+                           faceIndex, &face->ftFace) != 0) {
+        face->ftFace = nullptr;
+        std::cerr << "TextEngine: Failed to load font " << path << std::endl;
+        return -1;
+    }
+
+    hb_blob_t* blob = hb_blob_create(reinterpret_cast<const char*>(face->data.data()),
+                                     static_cast<unsigned int>(face->data.size()),
+                                     HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+    face->hbFace = hb_face_create(blob, static_cast<unsigned int>(faceIndex));
+    hb_blob_destroy(blob);
+
+    impl_->fonts_.push_back(std::move(face));
+    const int fontId = static_cast<int>(impl_->fonts_.size()) - 1;
+    if (impl_->defaultFont_ < 0) {
+        impl_->defaultFont_ = fontId;
+    }
+    return fontId;
+#else
+    (void)faceIndex;
+    std::cerr << "TextEngine: Text rendering is not available (built without FreeType/HarfBuzz), cannot load "
+              << path << std::endl;
+    return -1;
+#endif
+}
+
+void TextEngine::SetDefaultFont(int fontId) {
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+#ifdef KIUI_HAS_TEXT_ENGINE
+    if (fontId >= 0 && fontId < static_cast<int>(impl_->fonts_.size())) {
+        impl_->defaultFont_ = fontId;
+    }
+#else
+    (void)fontId;
+#endif
+}
+
+int TextEngine::GetDefaultFont() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    return impl_->defaultFont_;
+}
+
+bool TextEngine::IsValidFont(int fontId) const {
+#ifdef KIUI_HAS_TEXT_ENGINE
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    return impl_->GetFontLocked(fontId) != nullptr;
+#else
+    (void)fontId;
+    return false;
+#endif
+}
+
+std::string TextEngine::GetFontPath(int fontId) const {
+#ifdef KIUI_HAS_TEXT_ENGINE
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    FontFace* face = impl_->GetFontLocked(fontId);
+    return face ? face->path : std::string();
+#else
+    (void)fontId;
+    return std::string();
+#endif
+}
+
+int TextEngine::GetFontFaceIndex(int fontId) const {
+#ifdef KIUI_HAS_TEXT_ENGINE
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    FontFace* face = impl_->GetFontLocked(fontId);
+    return face ? face->faceIndex : 0;
+#else
+    (void)fontId;
+    return 0;
+#endif
+}
+
+uint64_t TextEngine::GetFontHash(int fontId) const {
+#ifdef KIUI_HAS_TEXT_ENGINE
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    FontFace* face = impl_->GetFontLocked(fontId);
+    if (!face) {
+        return 0;
+    }
+    if (face->hash == 0) {
+        face->hash = HashFontData(face->data);
+    }
+    return face->hash;
+#else
+    (void)fontId;
+    return 0;
+#endif
+}
+
+int TextEngine::FindFont(const std::string& path, int faceIndex) const {
+#ifdef KIUI_HAS_TEXT_ENGINE
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    for (size_t i = 0; i < impl_->fonts_.size(); ++i) {
+        if (impl_->fonts_[i]->path == path && impl_->fonts_[i]->faceIndex == faceIndex) {
+            return static_cast<int>(i);
+        }
+    }
+#else
+    (void)path;
+    (void)faceIndex;
+#endif
+    return -1;
+}
+
+FontMetrics TextEngine::GetMetrics(int fontId, float fontSize) const {
+    FontMetrics metrics;
+#ifdef KIUI_HAS_TEXT_ENGINE
+    FontFace* face = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        face = impl_->GetFontLocked(fontId);
+    }
+    if (!face || face->ftFace->units_per_EM == 0) {
+        return metrics;
+    }
+
+    // 只读取字体单位下的度量，不依赖 FT_Face 当前设置的字号
+    const float scale = fontSize / static_cast<float>(face->ftFace->units_per_EM);
+    metrics.ascent = face->ftFace->ascender * scale;
+    metrics.descent = -face->ftFace->descender * scale;
+    metrics.lineGap = std::max(0.0f, face->ftFace->height * scale - metrics.ascent - metrics.descent);
+#else
+    (void)fontId;
+    (void)fontSize;
+#endif
+    return metrics;
+}
+
+boost::shared_ptr<const ShapedRun> TextEngine::Shape(const std::string& text, int fontId, float fontSize,
+                                                     const std::vector<std::string>& features) {
+#ifdef KIUI_HAS_TEXT_ENGINE
+    FontFace* face = nullptr;
+    std::string key;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        if (fontId < 0) {
+            fontId = impl_->defaultFont_;
+        }
+        face = impl_->GetFontLocked(fontId);
+        if (!face || fontSize <= 0.0f) {
+            return boost::shared_ptr<const ShapedRun>();
+        }
+
+        key = MakeShapeKey(text, fontId, fontSize, features);
+        auto it = impl_->shapeIndex_.find(key);
+        if (it != impl_->shapeIndex_.end()) {
+            ++impl_->hits_;
+            impl_->shapeLru_.splice(impl_->shapeLru_.begin(), impl_->shapeLru_, it->second);
+            return it->second->second;
+        }
+        ++impl_->misses_;
+    }
+
+    // 排版不持有引擎的锁
+    auto run = boost::make_shared<ShapedRun>();
+    run->fontId = fontId;
+    run->fontSize = fontSize;
+    run->metrics = GetMetrics(fontId, fontSize);
+    ShapeWithFace(face, text, fontSize, features, run.get());
+
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    auto it = impl_->shapeIndex_.find(key);
+    if (it != impl_->shapeIndex_.end()) {
+        // 其他线程同时排版了同样的文字，使用先放入缓存的结果
+        return it->second->second;
+    }
+    impl_->shapeLru_.emplace_front(key, run);
+    impl_->shapeIndex_[key] = impl_->shapeLru_.begin();
+    impl_->EvictLocked();
+    return run;
+#else
+    (void)text;
+    (void)fontId;
+    (void)fontSize;
+    (void)features;
+    return boost::shared_ptr<const ShapedRun>();
+#endif
+}
+
+boost::shared_ptr<const ShapedRun> TextEngine::ShapeUncached(const std::string& text, int fontId, float fontSize,
+                                                             const std::vector<std::string>& features) {
+#ifdef KIUI_HAS_TEXT_ENGINE
+    FontFace* face = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        if (fontId < 0) {
+            fontId = impl_->defaultFont_;
+        }
+        face = impl_->GetFontLocked(fontId);
+    }
+    if (!face || fontSize <= 0.0f) {
+        return boost::shared_ptr<const ShapedRun>();
+    }
+
+    auto run = boost::make_shared<ShapedRun>();
+    run->fontId = fontId;
+    run->fontSize = fontSize;
+    run->metrics = GetMetrics(fontId, fontSize);
+    ShapeWithFace(face, text, fontSize, features, run.get());
+    return run;
+#else
+    (void)text;
+    (void)fontId;
+    (void)fontSize;
+    (void)features;
+    return boost::shared_ptr<const ShapedRun>();
+#endif
+}
+
+bool TextEngine::RasterizeGlyph(int fontId, uint32_t glyphId, float pixelSize, GlyphBitmap* bitmap) {
+    if (!bitmap) {
+        return false;
+    }
+    *bitmap = GlyphBitmap();
+#ifdef KIUI_HAS_TEXT_ENGINE
+    FontFace* face = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        face = impl_->GetFontLocked(fontId);
+    }
+    if (!face || pixelSize <= 0.0f) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> faceLock(face->ftMutex);
+    FT_Face ftFace = face->ftFace;
+    if (FT_Set_Char_Size(ftFace, 0, static_cast<FT_F26Dot6>(std::lround(pixelSize * 64.0f)), 72, 72) != 0 ||
+        FT_Load_Glyph(ftFace, glyphId, FT_LOAD_DEFAULT) != 0 ||
+        FT_Render_Glyph(ftFace->glyph, FT_RENDER_MODE_NORMAL) != 0) {
+        return false;
+    }
+
+    const FT_Bitmap& source = ftFace->glyph->bitmap;
+    bitmap->width = static_cast<int>(source.width);
+    bitmap->height = static_cast<int>(source.rows);
+    bitmap->left = ftFace->glyph->bitmap_left;
+    bitmap->top = ftFace->glyph->bitmap_top;
+    bitmap->coverage.resize(static_cast<size_t>(bitmap->width) * bitmap->height);
+    const int pitch = std::abs(source.pitch);
+    for (int y = 0; y < bitmap->height; ++y) {
+        // pitch 为负时位图自下而上存放
+        const int sourceRow = source.pitch >= 0 ? y : bitmap->height - 1 - y;
+        std::memcpy(bitmap->coverage.data() + static_cast<size_t>(y) * bitmap->width,
+                    source.buffer + static_cast<size_t>(sourceRow) * pitch, bitmap->width);
+    }
+    return true;
+#else
+    (void)fontId;
+    (void)glyphId;
+    (void)pixelSize;
+    return false;
+#endif
+}
+
+void TextEngine::SetShapeCacheCapacity(size_t entries) {
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    impl_->shapeCapacity_ = entries;
+    impl_->EvictLocked();
+}
+
+void TextEngine::ClearShapeCache() {
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    impl_->shapeLru_.clear();
+    impl_->shapeIndex_.clear();
+}
+
+TextEngine::Stats TextEngine::GetShapeCacheStats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    Stats stats;
+    stats.hits = impl_->hits_;
+    stats.misses = impl_->misses_;
+    stats.entryCount = impl_->shapeLru_.size();
+    return stats;
+}
+
+std::vector<TextEngine::ShapeCacheEntry> TextEngine::GetShapeCacheEntries(size_t maxEntries) const {
+    std::vector<ShapeCacheEntry> entries;
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    entries.reserve(std::min(maxEntries, impl_->shapeLru_.size()));
+    for (const auto& item : impl_->shapeLru_) {
+        if (entries.size() >= maxEntries) {
+            break;
+        }
+        ShapeCacheEntry entry;
+        if (item.second && ParseShapeKey(item.first, &entry.text, &entry.features)) {
+            entry.run = item.second;
+            entries.push_back(std::move(entry));
+        }
+    }
+    return entries;
+}
+
+void TextEngine::SeedShapeCache(const std::string& text, const std::vector<std::string>& features,
+                                const boost::shared_ptr<const ShapedRun>& run) {
+    if (!run) {
+        return;
+    }
+    const std::string key = MakeShapeKey(text, run->fontId, run->fontSize, features);
+    std::lock_guard<std::mutex> lock(impl_->mutex_);
+    if (impl_->shapeIndex_.count(key) || impl_->shapeLru_.size() >= impl_->shapeCapacity_) {
+        return;
+    }
+    impl_->shapeLru_.emplace_back(key, run);
+    impl_->shapeIndex_[key] = std::prev(impl_->shapeLru_.end());
+}
+
+} // namespace graphics
+} // namespace KiUI
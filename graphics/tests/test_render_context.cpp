@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <RenderContext.hpp>
+#include <include/core/SkBitmap.h>
+#include <include/core/SkCanvas.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <include/core/SkSurface.h>
+#include <gpu/ganesh/GrDirectContext.h>
+#include <gpu/ganesh/SkSurfaceGanesh.h>
+#include <EGL/egl.h>
+#include <boost/make_shared.hpp>
+#include <thread>
+
+namespace KiUI {
+namespace graphics {
+
+namespace {
+
+constexpr int kImageSize = 4;
+
+// 在 context 上创建 GPU 表面，画上 image 后读回左上角像素
+SkColor DrawAndReadBack(RenderContext& context, const sk_sp<SkImage>& image) {
+    SkImageInfo info = SkImageInfo::MakeN32Premul(kImageSize, kImageSize);
+    sk_sp<SkSurface> surface = SkSurfaces::RenderTarget(context.GetSkiaContext(), skgpu::Budgeted::kNo, info);
+    if (!surface) {
+        return SK_ColorTRANSPARENT;
+    }
+    surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+    surface->getCanvas()->drawImage(image, 0, 0);
+    context.GetSkiaContext()->flushAndSubmit(surface.get(), GrSyncCpu::kYes);
+
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    if (!surface->readPixels(bitmap, 0, 0)) {
+        return SK_ColorTRANSPARENT;
+    }
+    return bitmap.getColor(0, 0);
+}
+
+} // namespace
+
+// 共享上下文：创建时不改变调用线程的绑定；可以在另一个线程上绑定并上传跨上下文图片，
+// 图片在主上下文中直接绘制；Shutdown 后主上下文的绑定和资源不受影响
+TEST(RenderContextTest, SharedContextCreateUseShutdown) {
+    auto parent = boost::make_shared<RenderContext>();
+    if (!parent->Initialize()) {
+        GTEST_SKIP() << "no GPU context available";
+    }
+    const EGLContext parentContext = static_cast<EGLContext>(parent->GetNativeHandles().context);
+    ASSERT_TRUE(parent->MakeCurrent());
+
+    auto shared = RenderContext::CreateShared(parent);
+    ASSERT_TRUE(shared);
+    EXPECT_TRUE(shared->IsShared());
+    EXPECT_FALSE(parent->IsShared());
+    EXPECT_TRUE(shared->IsInitialized());
+    EXPECT_NE(shared->GetSkiaContext(), parent->GetSkiaContext());
+    EXPECT_EQ(eglGetCurrentContext(), parentContext);
+
+    // 共享上下文在工作线程上绑定、上传，用完后解除绑定
+    SkBitmap pixels;
+    pixels.allocPixels(SkImageInfo::MakeN32Premul(kImageSize, kImageSize));
+    pixels.eraseColor(SK_ColorRED);
+    sk_sp<SkImage> image;
+    bool boundOnWorker = false;
+    std::thread worker([&]() {
+        boundOnWorker = shared->MakeCurrent();
+        if (boundOnWorker) {
+            image = shared->MakeCrossContextImage(pixels.pixmap());
+            shared->ReleaseCurrent();
+        }
+    });
+    worker.join();
+    ASSERT_TRUE(boundOnWorker);
+    ASSERT_TRUE(image);
+
+    ASSERT_TRUE(parent->MakeCurrent());
+    EXPECT_EQ(DrawAndReadBack(*parent, image), SK_ColorRED);
+
+    // 在主上下文绑定的线程上关闭共享上下文：Skia 资源在共享上下文上释放，之后恢复原来的绑定
+    shared->Shutdown();
+    EXPECT_FALSE(shared->IsInitialized());
+    EXPECT_EQ(shared->GetSkiaContext(), nullptr);
+    EXPECT_EQ(eglGetCurrentContext(), parentContext);
+    EXPECT_EQ(DrawAndReadBack(*parent, image), SK_ColorRED);
+
+    image.reset();
+    parent->Shutdown();
+    EXPECT_FALSE(parent->IsInitialized());
+}
+
+// 未初始化的主上下文不能创建共享上下文；未初始化的上下文无法绑定
+TEST(RenderContextTest, SharedContextRequiresInitializedParent) {
+    auto parent = boost::make_shared<RenderContext>();
+    EXPECT_FALSE(RenderContext::CreateShared(parent));
+    EXPECT_FALSE(RenderContext::CreateShared(boost::shared_ptr<RenderContext>()));
+    EXPECT_FALSE(parent->MakeCurrent());
+    parent->ReleaseCurrent();
+    parent->Shutdown();
+}
+
+} // namespace graphics
+} // namespace KiUI
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <ShaderCache.hpp>
+#include <filesystem>
+#include <string>
+
+namespace KiUI {
+namespace graphics {
+
+namespace {
+
+std::filesystem::path MakeTempCacheDirectory(const std::string& name) {
+    auto directory = std::filesystem::temp_directory_path() / ("kiui_shader_cache_" + name);
+    std::filesystem::remove_all(directory);
+    return directory;
+}
+
+sk_sp<SkData> MakeData(const std::string& text) {
+    return SkData::MakeWithCopy(text.data(), text.size());
+}
+
+std::string ToString(const sk_sp<SkData>& data) {
+    return std::string(static_cast<const char*>(data->data()), data->size());
+}
+
+} // namespace
+
+// 写入的程序在新的缓存实例（模拟下次启动）中可以读回
+TEST(ShaderCacheTest, StoredEntriesSurviveRestart) {
+    auto directory = MakeTempCacheDirectory("restart");
+    auto key = MakeData("program-key");
+    auto binary = MakeData("program-binary");
+
+    {
+        ShaderCache cache(directory.string(), "driver-a");
+        ASSERT_TRUE(cache.IsValid());
+        EXPECT_EQ(cache.load(*key), nullptr);
+        cache.store(*key, *binary, SkString("test"));
+        EXPECT_EQ(cache.GetStats().stores, 1u);
+    }
+
+    ShaderCache cache(directory.string(), "driver-a");
+    auto loaded = cache.load(*key);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(ToString(loaded), "program-binary");
+    EXPECT_EQ(cache.GetStats().hits, 1u);
+
+    std::filesystem::remove_all(directory);
+}
+
+// 驱动标识变化后不会加载旧驱动编译的二进制
+TEST(ShaderCacheTest, DriverChangeUsesSeparateEntries) {
+    auto directory = MakeTempCacheDirectory("driver");
+    auto key = MakeData("program-key");
+
+    ShaderCache oldDriver(directory.string(), "driver-a");
+    oldDriver.store(*key, *MakeData("old-binary"), SkString("test"));
+
+    ShaderCache newDriver(directory.string(), "driver-b");
+    EXPECT_NE(oldDriver.GetDirectory(), newDriver.GetDirectory());
+    EXPECT_EQ(newDriver.load(*key), nullptr);
+    EXPECT_EQ(newDriver.GetStats().misses, 1u);
+
+    std::filesystem::remove_all(directory);
+}
+
+// 只有键完全一致才返回数据，Clear 之后全部失效
+TEST(ShaderCacheTest, KeysMustMatchExactly) {
+    auto directory = MakeTempCacheDirectory("keys");
+    ShaderCache cache(directory.string(), "driver-a");
+
+    cache.store(*MakeData("key-1"), *MakeData("binary-1"), SkString("test"));
+    cache.store(*MakeData("key-2"), *MakeData("binary-2"), SkString("test"));
+    EXPECT_EQ(ToString(cache.load(*MakeData("key-1"))), "binary-1");
+    EXPECT_EQ(ToString(cache.load(*MakeData("key-2"))), "binary-2");
+    EXPECT_EQ(cache.load(*MakeData("key-3")), nullptr);
+
+    cache.Clear();
+    EXPECT_EQ(cache.load(*MakeData("key-1")), nullptr);
+
+    std::filesystem::remove_all(directory);
+}
+
+} // namespace graphics
+} // namespace KiUI
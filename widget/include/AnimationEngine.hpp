@@ -0,0 +1,269 @@
+#ifndef ANIMATION_ENGINE_HPP
+#define ANIMATION_ENGINE_HPP
+#pragma once
+
+#include "VisualElement.hpp"
+#include "clock.hpp"
+#include <include/core/SkColor.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 可以动画的属性
+ * Width、Height 会触发布局；其余只影响绘制（透明度、变换分量、颜色）
+ */
+enum class AnimatedProperty {
+    Opacity,
+    TranslateX,
+    TranslateY,
+    ScaleX,
+    ScaleY,
+    Rotation,
+    BackgroundColor,
+    BorderColor,
+    ForegroundColor,
+    Width,
+    Height
+};
+
+/**
+ * @brief 缓动曲线：与 CSS cubic-bezier 相同的三次贝塞尔曲线，端点固定为 (0,0) 和 (1,1)
+ */
+struct Easing {
+    float x1 = 0.0f;
+    float y1 = 0.0f;
+    float x2 = 1.0f;
+    float y2 = 1.0f;
+
+    static Easing Linear() { return {0.0f, 0.0f, 1.0f, 1.0f}; }
+    static Easing Ease() { return {0.25f, 0.1f, 0.25f, 1.0f}; }
+    static Easing EaseIn() { return {0.42f, 0.0f, 1.0f, 1.0f}; }
+    static Easing EaseOut() { return {0.0f, 0.0f, 0.58f, 1.0f}; }
+    static Easing EaseInOut() { return {0.42f, 0.0f, 0.58f, 1.0f}; }
+    static Easing CubicBezier(float x1, float y1, float x2, float y2) { return {x1, y1, x2, y2}; }
+
+    /**
+     * @brief 计算进度 t（0~1）处的缓动值，端点精确返回 0 和 1
+     */
+    float Evaluate(float t) const;
+};
+
+/**
+ * @brief 动画参数
+ */
+struct AnimationOptions {
+    float duration = 250.0f;            ///< 单次时长（毫秒）
+    float delay = 0.0f;                 ///< 开始前的延迟（毫秒）
+    Easing easing = Easing::EaseInOut();///< 缓动曲线
+    unsigned int repeatCount = 1;       ///< 播放次数，0 表示无限循环
+    bool autoReverse = false;           ///< 偶数次播放时反向
+};
+
+/**
+ * @brief 动画标识，0 表示无效
+ */
+using AnimationId = uint64_t;
+
+/**
+ * @brief 属性动画引擎
+ * 活动的动画按列存放在扁平数组中（时间、时长、缓动参数、起止值各占一列），
+ * 每次 Tick 依次对整列计算进度、缓动和插值，这几步是没有分支的逐元素循环，编译器可以自动向量化；
+ * 最后一步才逐个把结果写回组件。动画没有单独的回调，结束的动画在 Tick 后通过 GetFinished() 一次性取得。
+ * 同一组件的同一属性同时只有一个动画，新的动画从当前值开始并替换旧的动画。
+ * 只影响绘制的属性通过普通的 setter 写回，只让绘制缓存失效，不会触发布局。
+ * 不是线程安全的，应在驱动组件树的线程上使用（通常是 SceneRenderer 持有的实例）
+ */
+class AnimationEngine {
+public:
+    /**
+     * @brief 统计信息（最近一次 Tick）
+     */
+    struct Stats {
+        size_t activeAnimations = 0;    ///< Tick 之后仍在运行的动画数
+        size_t evaluated = 0;           ///< 计算的动画数
+        size_t propertyWrites = 0;      ///< 实际写回组件的属性数（值没有变化时跳过）
+        size_t layoutWrites = 0;        ///< 其中会触发布局的属性数
+    };
+
+    AnimationEngine();
+    ~AnimationEngine();
+
+    AnimationEngine(const AnimationEngine&) = delete;
+    AnimationEngine& operator=(const AnimationEngine&) = delete;
+
+    /**
+     * @brief 从当前值开始动画一个数值属性
+     * @param target 目标组件（动画只持有弱引用）
+     * @param property 属性（不能是颜色属性）
+     * @param to 目标值
+     * @param options 动画参数
+     * @return 动画标识，参数无效时返回 0
+     */
+    AnimationId Animate(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property, float to,
+                        const AnimationOptions& options = AnimationOptions());
+
+    /**
+     * @brief 从指定的起始值开始动画一个数值属性
+     */
+    AnimationId Animate(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property, float from, float to,
+                        const AnimationOptions& options = AnimationOptions());
+
+    /**
+     * @brief 从当前颜色开始动画一个颜色属性（按 ARGB 四个通道分别插值）
+     */
+    AnimationId AnimateColor(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property, SkColor to,
+                             const AnimationOptions& options = AnimationOptions());
+
+    /**
+     * @brief 从指定的起始颜色开始动画一个颜色属性
+     */
+    AnimationId AnimateColor(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property, SkColor from,
+                             SkColor to, const AnimationOptions& options = AnimationOptions());
+
+    /**
+     * @brief 停止动画，属性保持当前值
+     * @return 是否找到并停止了动画
+     */
+    bool Cancel(AnimationId id);
+
+    /**
+     * @brief 停止一个组件上的所有动画
+     */
+    void CancelAll(const VisualElement* target);
+
+    /**
+     * @brief 动画是否还在运行
+     */
+    bool IsActive(AnimationId id) const;
+
+    /**
+     * @brief 获取正在运行的动画数
+     */
+    size_t GetActiveCount() const { return ids_.size(); }
+
+    /**
+     * @brief 推进所有动画并写回组件
+     * @param deltaMs 距上一次 Tick 的时间（毫秒）
+     */
+    void Tick(float deltaMs);
+
+    /**
+     * @brief 按时钟的帧间隔推进所有动画
+     */
+    void Tick(const CompositionClock& clock);
+
+    /**
+     * @brief 获取最近一次 Tick 中结束（播放完成或目标已销毁）的动画
+     */
+    const std::vector<AnimationId>& GetFinished() const { return finished_; }
+
+    /**
+     * @brief 获取最近一次 Tick 的统计信息
+     */
+    const Stats& GetStats() const { return stats_; }
+
+    /**
+     * @brief 属性是否会触发布局
+     */
+    static bool AffectsLayout(AnimatedProperty property);
+
+    /**
+     * @brief 是否为颜色属性
+     */
+    static bool IsColorProperty(AnimatedProperty property);
+
+private:
+    // 每个动画的起止值占 4 个通道（颜色按 ARGB，数值只用第一个通道）
+    static constexpr size_t kChannels = 4;
+
+    struct SlotKey {
+        const VisualElement* target;
+        AnimatedProperty property;
+
+        bool operator==(const SlotKey& other) const {
+            return target == other.target && property == other.property;
+        }
+    };
+
+    struct SlotKeyHash {
+        size_t operator()(const SlotKey& key) const;
+    };
+
+    /**
+     * @brief 同一组件的多个变换分量动画合并成一次 SetRenderTransform
+     */
+    struct TransformWrite {
+        boost::shared_ptr<VisualElement> target;
+        float components[5];
+        bool changed;
+    };
+
+    /**
+     * @brief 添加一个动画（替换同一组件同一属性上的动画）
+     */
+    AnimationId Add(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property,
+                    const float* from, const float* to, const AnimationOptions& options);
+
+    /**
+     * @brief 读取属性的当前值
+     */
+    static void ReadValue(const VisualElement& target, AnimatedProperty property, float* value);
+
+    /**
+     * @brief 把插值结果写回组件，返回是否写入（值没有变化时跳过）
+     */
+    bool WriteValue(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property, const float* value);
+
+    /**
+     * @brief 把合并的变换分量写回组件
+     */
+    void FlushTransforms();
+
+    /**
+     * @brief 移除第 index 个动画（与最后一个交换）
+     */
+    void RemoveAt(size_t index);
+
+    // 按列存放的动画数据
+    std::vector<AnimationId> ids_;
+    std::vector<boost::weak_ptr<VisualElement>> targets_;
+    std::vector<const VisualElement*> targetKeys_;  // 目标销毁后仍可用于查找 idBySlot_
+    std::vector<AnimatedProperty> properties_;
+    std::vector<float> elapsed_;
+    std::vector<float> delays_;
+    std::vector<float> durations_;
+    std::vector<float> repeats_;        // 播放次数，无限循环为 +inf
+    std::vector<float> reverses_;       // 1 表示往返播放
+    std::vector<float> x1_;
+    std::vector<float> y1_;
+    std::vector<float> x2_;
+    std::vector<float> y2_;
+    std::vector<float> from_;           // kChannels * 动画数
+    std::vector<float> to_;
+
+    // Tick 的中间结果
+    std::vector<float> progress_;
+    std::vector<float> eased_;
+    std::vector<float> values_;
+    std::vector<uint8_t> done_;
+    std::vector<TransformWrite> transformWrites_;
+    std::unordered_map<const VisualElement*, size_t> transformIndex_;
+
+    std::unordered_map<AnimationId, size_t> indexById_;
+    std::unordered_map<SlotKey, AnimationId, SlotKeyHash> idBySlot_;
+    std::vector<AnimationId> finished_;
+    AnimationId nextId_ = 1;
+    Stats stats_;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // ANIMATION_ENGINE_HPP
@@ -23,6 +23,21 @@ public:
      */
     virtual void Render(SkCanvas* canvas) override;
     
+    /**
+     * @brief 把 Box 记录到绘制命令缓冲区
+     * @param buffer 绘制命令缓冲区
+     * @return 总是返回 true
+     */
+    virtual bool Record(::KiUI::graphics::DrawCommandBuffer& buffer) override;
+    
+    /**
+     * @brief 获取背景完全不透明的区域
+     * 背景色 alpha 为 255 且 opacity 为 1 时有效；有圆角时取避开四个圆角的最大矩形带
+     * @param rect 输出局部坐标中的不透明矩形（未应用 transform）
+     * @return 是否存在不透明区域
+     */
+    virtual bool GetOpaqueBounds(SkRect* rect) const override;
+    
     /**
      * @brief 命中测试
      * @param x 父级局部 x 坐标
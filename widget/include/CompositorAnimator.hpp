@@ -0,0 +1,163 @@
+#ifndef COMPOSITOR_ANIMATOR_HPP
+#define COMPOSITOR_ANIMATOR_HPP
+#pragma once
+
+#include "AnimationEngine.hpp"
+#include "VisualElement.hpp"
+#include "clock.hpp"
+#include <include/core/SkMatrix.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 合成层属性：合成时对组件整棵子树的缓存图层再应用的透明度和变换
+ * 变换以组件中心为原点，先缩放、再旋转（度）、最后平移；与组件自身的 RenderTransform 相乘而不是替换
+ */
+struct LayerProperties {
+    float opacity = 1.0f;
+    float translateX = 0.0f;
+    float translateY = 0.0f;
+    float scaleX = 1.0f;
+    float scaleY = 1.0f;
+    float rotation = 0.0f;
+
+    /**
+     * @brief 变换是否为单位矩阵
+     */
+    bool IsIdentityTransform() const;
+
+    /**
+     * @brief 以 (centerX, centerY) 为中心的图层变换矩阵（组件局部空间）
+     */
+    SkMatrix GetMatrix(float centerX, float centerY) const;
+};
+
+/**
+ * @brief 合成器动画
+ * 只支持透明度和变换分量（AnimatedProperty::Opacity 到 Rotation）。动画的值不写回组件，
+ * 而是在合成时应用到组件的缓存图层上（SceneRenderer 为有合成层属性的组件强制使用图层），
+ * 所以组件的内容版本不变，图层也不需要重新光栅化。
+ * 时间由合成的一方通过 Sample() 推进：动画在下一次 Sample 时开始，之后按 steady_clock 的绝对时间计算，
+ * UI 线程忙碌时合成线程仍然可以继续推进。所有方法都是线程安全的：
+ * 通常由 UI 线程添加、取消动画，合成线程采样并读取图层属性。
+ * 动画结束后图层保持终点的值，直到新的动画替换它或调用 RemoveLayer。
+ * 命中测试仍按组件自身的属性进行，不跟随合成层的变换
+ */
+class CompositorAnimator {
+public:
+    using TimePoint = CompositionClock::TimePoint;
+
+    CompositorAnimator();
+    ~CompositorAnimator();
+
+    CompositorAnimator(const CompositorAnimator&) = delete;
+    CompositorAnimator& operator=(const CompositorAnimator&) = delete;
+
+    /**
+     * @brief 从图层的当前值开始动画一个合成层属性
+     * @param target 目标组件（只持有弱引用）
+     * @param property 属性（Opacity、TranslateX、TranslateY、ScaleX、ScaleY、Rotation）
+     * @param to 目标值
+     * @param options 动画参数
+     * @return 动画标识，参数无效时返回 0
+     */
+    AnimationId Animate(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property, float to,
+                        const AnimationOptions& options = AnimationOptions());
+
+    /**
+     * @brief 从指定的起始值开始动画一个合成层属性
+     */
+    AnimationId Animate(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property, float from, float to,
+                        const AnimationOptions& options = AnimationOptions());
+
+    /**
+     * @brief 停止动画，图层属性停在最近一次采样的值
+     * @return 是否找到并停止了动画
+     */
+    bool Cancel(AnimationId id);
+
+    /**
+     * @brief 停止组件上的所有合成器动画并移除它的图层属性，组件恢复普通绘制
+     */
+    void RemoveLayer(const VisualElement* target);
+
+    /**
+     * @brief 动画是否还在运行
+     */
+    bool IsActive(AnimationId id) const;
+
+    /**
+     * @brief 获取正在运行的动画数
+     */
+    size_t GetActiveCount() const;
+
+    /**
+     * @brief 按时间点推进所有动画（合成线程在每次合成前调用）
+     * 目标已经销毁的组件连同它的动画一起移除
+     * @param now 本次合成的时间点
+     * @return 是否还有运行中的动画（需要继续合成下一帧）
+     */
+    bool Sample(TimePoint now);
+
+    /**
+     * @brief 读取组件最近一次采样的图层属性
+     * @return 组件是否有合成层属性
+     */
+    bool GetLayerProperties(const VisualElement* target, LayerProperties* properties) const;
+
+    /**
+     * @brief 获取所有有合成层属性的组件
+     */
+    void GetLayers(std::unordered_set<const VisualElement*>* layers) const;
+
+    /**
+     * @brief 取出自上一次调用以来结束（播放完成或目标已销毁）的动画
+     */
+    std::vector<AnimationId> TakeFinished();
+
+    /**
+     * @brief 属性是否可以在合成器上动画
+     */
+    static bool IsSupported(AnimatedProperty property);
+
+private:
+    struct Animation {
+        AnimationId id;
+        const VisualElement* target;
+        AnimatedProperty property;
+        float from;
+        float to;
+        AnimationOptions options;
+        TimePoint start;
+        bool started;
+    };
+
+    struct Layer {
+        boost::weak_ptr<VisualElement> element;
+        LayerProperties properties;
+    };
+
+    /**
+     * @brief 属性在 LayerProperties 中对应的分量
+     */
+    static float& Component(LayerProperties& properties, AnimatedProperty property);
+
+    mutable std::mutex mutex_;
+    std::vector<Animation> animations_;
+    std::unordered_map<const VisualElement*, Layer> layers_;
+    std::vector<AnimationId> finished_;
+    AnimationId nextId_ = 1;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // COMPOSITOR_ANIMATOR_HPP
@@ -0,0 +1,421 @@
+#ifndef DATA_GRID_HPP
+#define DATA_GRID_HPP
+#pragma once
+
+#include "Box.hpp"
+#include "ItemExtentIndex.hpp"
+#include <include/core/SkCanvas.h>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief DataGrid 的一个分区（冻结角、列标题、行标题、主体），是单元格的滚动容器
+ * 单元格按内容坐标摆放，滚动只改变分区的滚动偏移（SceneRenderer 平移滚动图层），不移动单元格。
+ * 分区记录每次修改单元格后内容版本对应的变化区域，渲染器据此只重新绘制变化的单元格
+ */
+class DataGridPane : public Box {
+public:
+    DataGridPane();
+    virtual ~DataGridPane();
+
+    /**
+     * @brief 设置滚动偏移，只让父级内容失效
+     */
+    void SetScrollOffset(float x, float y);
+
+    /**
+     * @brief 记录一次修改的变化区域
+     * @param versionBefore 修改前分区的子树版本
+     * @param areas 变化区域（内容坐标），包含修改前后单元格的范围
+     * @note 修改前版本与上一次记录后的版本不一致时，说明中间有未记录的变化，之前的记录作废
+     */
+    void RecordDamage(uint64_t versionBefore, std::vector<SkRect> areas);
+
+    bool GetChildScrollOffset(SkPoint* offset) const override;
+    bool GetChildDamage(uint64_t version, std::vector<SkRect>* damage) const override;
+
+protected:
+    /**
+     * @brief 单元格由 DataGrid 摆放，分区尺寸变化时什么也不做
+     */
+    void LayoutChildren(float width, float height) override;
+
+private:
+    struct DamageEntry {
+        uint64_t version = 0;   // 这次修改后的子树版本
+        std::vector<SkRect> areas;
+    };
+    static constexpr size_t kMaxDamageEntries = 64;
+
+    float scrollX_ = 0.0f;
+    float scrollY_ = 0.0f;
+    std::deque<DamageEntry> damageLog_;
+    uint64_t damageFrom_ = 0;   // 记录覆盖的起始版本，从该版本起的所有变化都在记录中
+    uint64_t damageTo_ = 0;     // 最后一次记录后的版本
+};
+
+/**
+ * @brief DataGrid 组件，行和列都虚拟化的二维表格
+ * 只为与视口相交的单元格（再加上 overscan 行列）创建子元素，开销与可见单元格数成正比，
+ * 与行列总数无关；行高和列宽保存在 ItemExtentIndex 中。
+ * 前 FrozenRowCount 行和前 FrozenColumnCount 列冻结（表头），不随滚动移动：
+ * 表格分为冻结角、列标题、行标题和主体四个分区（DataGridPane），各自是一个滚动容器。
+ * 单元格由 DataGrid 直接摆放（VisualElement::Arrange），大小就是列宽 x 行高，不经过 Yoga；
+ * 有子元素的单元格只在绑定后或尺寸变化时布局自己的子元素。
+ * 滚出视口的单元格隐藏后放回对应模板的回收池，之后重新绑定给新的单元格。
+ * 滚动偏移取整到像素；视口范围不变时滚动不修改任何单元格，只平移滚动图层；
+ * 修改单个单元格（InvalidateCell）时渲染器只重新绘制该单元格的区域
+ */
+class DataGrid : public Box {
+public:
+    /**
+     * @brief 默认行高（像素）
+     */
+    static constexpr float kDefaultRowHeight = 24.0f;
+
+    /**
+     * @brief 默认列宽（像素）
+     */
+    static constexpr float kDefaultColumnWidth = 100.0f;
+
+    /**
+     * @brief 默认在视口上下额外创建的行数
+     */
+    static constexpr size_t kDefaultRowOverscan = 4;
+
+    /**
+     * @brief 默认在视口左右额外创建的列数
+     */
+    static constexpr size_t kDefaultColumnOverscan = 1;
+
+    /**
+     * @brief 按模板 id 创建一个单元格元素
+     */
+    using CellFactory = std::function<boost::shared_ptr<VisualElement>(int templateId)>;
+
+    /**
+     * @brief 把单元格数据填入元素（元素可能之前显示过别的单元格）
+     */
+    using CellBinder = std::function<void(size_t row, size_t column, VisualElement& cell)>;
+
+    /**
+     * @brief 返回单元格使用的模板 id，不设置时所有单元格都使用模板 0
+     */
+    using TemplateSelector = std::function<int(size_t row, size_t column)>;
+
+    /**
+     * @brief 虚拟化统计
+     */
+    struct Stats {
+        size_t realizedCells = 0;       ///< 当前显示的单元格数
+        size_t pooledCells = 0;         ///< 回收池中的单元格数
+        uint64_t cellsCreated = 0;      ///< 累计通过 CellFactory 创建的单元格数
+        uint64_t cellsBound = 0;        ///< 累计调用 CellBinder 的次数
+        uint64_t cellsArranged = 0;     ///< 累计摆放单元格的次数
+    };
+
+    DataGrid();
+    virtual ~DataGrid();
+
+    /**
+     * @brief 设置行数（只处理追加或截断，已显示的单元格不会重新绑定）
+     */
+    void SetRowCount(size_t count);
+
+    /**
+     * @brief 获取行数
+     */
+    size_t GetRowCount() const { return rowExtents_.GetCount(); }
+
+    /**
+     * @brief 设置列数（只处理追加或截断，已显示的单元格不会重新绑定）
+     */
+    void SetColumnCount(size_t count);
+
+    /**
+     * @brief 获取列数
+     */
+    size_t GetColumnCount() const { return columnExtents_.GetCount(); }
+
+    /**
+     * @brief 设置单元格元素工厂，已创建的单元格元素全部丢弃
+     */
+    void SetCellFactory(CellFactory factory);
+
+    /**
+     * @brief 设置数据绑定函数，显示中的单元格重新绑定
+     */
+    void SetCellBinder(CellBinder binder);
+
+    /**
+     * @brief 设置模板选择函数，显示中的单元格重新绑定
+     */
+    void SetTemplateSelector(TemplateSelector selector);
+
+    /**
+     * @brief 设置默认行高，单独设置过的行高全部丢弃
+     */
+    void SetDefaultRowHeight(float height);
+
+    /**
+     * @brief 设置默认列宽，单独设置过的列宽全部丢弃
+     */
+    void SetDefaultColumnWidth(float width);
+
+    /**
+     * @brief 设置单行的行高
+     */
+    void SetRowHeight(size_t row, float height);
+
+    /**
+     * @brief 获取行高
+     */
+    float GetRowHeight(size_t row) const { return rowExtents_.GetExtent(row); }
+
+    /**
+     * @brief 设置单列的列宽
+     */
+    void SetColumnWidth(size_t column, float width);
+
+    /**
+     * @brief 获取列宽
+     */
+    float GetColumnWidth(size_t column) const { return columnExtents_.GetExtent(column); }
+
+    /**
+     * @brief 设置冻结（不随纵向滚动移动）的行数，通常是表头
+     */
+    void SetFrozenRowCount(size_t count);
+
+    /**
+     * @brief 获取冻结的行数
+     */
+    size_t GetFrozenRowCount() const { return frozenRows_; }
+
+    /**
+     * @brief 设置冻结（不随横向滚动移动）的列数
+     */
+    void SetFrozenColumnCount(size_t count);
+
+    /**
+     * @brief 获取冻结的列数
+     */
+    size_t GetFrozenColumnCount() const { return frozenColumns_; }
+
+    /**
+     * @brief 设置在视口外额外创建的行数和列数，快速滚动时减少空白
+     */
+    void SetOverscan(size_t rows, size_t columns);
+
+    /**
+     * @brief 设置滚动位置，限制在内容范围内并取整到像素
+     * @param x 非冻结列相对主体视口的横向偏移
+     * @param y 非冻结行相对主体视口的纵向偏移
+     * @note 位置都用 double：十万行以上时内容高度超过 float 能精确表示的像素范围
+     */
+    void SetScrollOffset(double x, double y);
+
+    /**
+     * @brief 获取横向滚动位置
+     */
+    double GetScrollX() const { return scrollX_; }
+
+    /**
+     * @brief 获取纵向滚动位置
+     */
+    double GetScrollY() const { return scrollY_; }
+
+    /**
+     * @brief 最大横向滚动位置（非冻结列超出主体视口的部分）
+     */
+    double GetMaxScrollX() const;
+
+    /**
+     * @brief 最大纵向滚动位置（非冻结行超出主体视口的部分）
+     */
+    double GetMaxScrollY() const;
+
+    /**
+     * @brief 滚动到使单元格完整可见的最近位置（冻结的行列方向上不滚动）
+     */
+    void ScrollIntoView(size_t row, size_t column);
+
+    /**
+     * @brief 单元格数据变化：显示中的单元格重新绑定，渲染时只重新绘制该单元格
+     */
+    void InvalidateCell(size_t row, size_t column);
+
+    /**
+     * @brief 所有单元格数据变化：显示中的单元格全部重新绑定
+     */
+    void InvalidateCells();
+
+    /**
+     * @brief 获取显示中的单元格元素
+     * @return 单元格没有显示时返回空指针
+     */
+    boost::shared_ptr<VisualElement> GetRealizedCell(size_t row, size_t column) const;
+
+    /**
+     * @brief 查找元素（单元格元素或它的后代，例如 HitTest 的结果）所在的单元格
+     * @param element 元素
+     * @param row 输出行索引
+     * @param column 输出列索引
+     * @return 元素属于显示中的单元格时返回 true
+     */
+    bool GetCellIndex(const boost::shared_ptr<VisualElement>& element, size_t* row, size_t* column) const;
+
+    /**
+     * @brief 获取虚拟化统计
+     */
+    Stats GetStats() const;
+
+protected:
+    /**
+     * @brief 按视口和滚动位置摆放分区、创建、回收和摆放单元格
+     */
+    void LayoutChildren(float width, float height) override;
+
+private:
+    /**
+     * @brief 分区索引：第一位表示非冻结列，第二位表示非冻结行
+     */
+    enum PaneIndex {
+        kCornerPane = 0,
+        kColumnHeaderPane = 1,
+        kRowHeaderPane = 2,
+        kBodyPane = 3,
+        kPaneCount = 4
+    };
+
+    /**
+     * @brief 半开区间 [first, last)
+     */
+    struct Range {
+        size_t first = 0;
+        size_t last = 0;
+
+        size_t Size() const { return last > first ? last - first : 0; }
+        bool Contains(size_t index) const { return index >= first && index < last; }
+        bool operator==(const Range& other) const { return first == other.first && last == other.last; }
+    };
+
+    struct RealizedCell {
+        boost::shared_ptr<VisualElement> element;
+        int templateId = 0;
+        bool needsArrange = true;   // 新绑定、行高列宽或坐标原点变化后需要重新摆放
+        bool needsLayout = true;    // 绑定后单元格的子元素需要重新布局
+    };
+
+    struct PaneState {
+        boost::shared_ptr<DataGridPane> pane;
+        Range rows;
+        Range columns;
+        std::vector<RealizedCell> cells;    // rows x columns，按行排列
+        std::unordered_map<int, std::vector<boost::shared_ptr<VisualElement>>> pools;
+    };
+
+    /**
+     * @brief 第一次使用时创建四个分区（构造函数中还不能 AddChild）
+     */
+    void EnsurePanes();
+
+    /**
+     * @brief 更新分区、显示的单元格和滚动偏移
+     */
+    void Realize();
+
+    /**
+     * @brief 更新一个分区显示的行列范围：回收离开范围的单元格，创建或复用进入范围的单元格，再摆放
+     */
+    void RealizePane(PaneState& state, Range rows, Range columns);
+
+    /**
+     * @brief 为单元格取一个元素（优先从回收池取）并绑定数据
+     * @return 单元格工厂没有返回元素时返回 false
+     */
+    bool Acquire(PaneState& state, size_t row, size_t column, RealizedCell* cell);
+
+    /**
+     * @brief 隐藏单元格元素并放回回收池
+     * @param damage 追加单元格原来的区域
+     */
+    void Recycle(PaneState& state, RealizedCell& cell, std::vector<SkRect>* damage);
+
+    /**
+     * @brief 回收所有显示中的单元格
+     */
+    void RecycleAll();
+
+    /**
+     * @brief 把单元格摆放到内容坐标中的位置，大小为列宽 x 行高
+     * @param damage 追加单元格摆放前后的区域
+     */
+    void ArrangeCell(RealizedCell& cell, size_t row, size_t column, std::vector<SkRect>* damage);
+
+    /**
+     * @brief 所有显示中的单元格都需要重新摆放（行高列宽、冻结行列或坐标原点变化）
+     */
+    void MarkCellsForArrange();
+
+    /**
+     * @brief 把滚动位置限制在内容范围内
+     */
+    void ClampScrollOffset();
+
+    /**
+     * @brief 单元格所在的分区
+     */
+    PaneIndex GetPaneIndex(size_t row, size_t column) const;
+
+    /**
+     * @brief 单元格在 cells 中的位置
+     * @return 单元格不在分区当前显示的范围内时返回 npos
+     */
+    static size_t FindCell(const PaneState& state, size_t row, size_t column);
+
+    /**
+     * @brief 追加单元格元素在分区内容坐标中的显示区域（包括超出单元格的子元素），隐藏的元素没有区域
+     */
+    static void AddCellDamage(VisualElement& element, std::vector<SkRect>* damage);
+
+    float GetViewportWidth() const { return width_ - paddingLeft_ - paddingRight_; }
+    float GetViewportHeight() const { return height_ - paddingTop_ - paddingBottom_; }
+    double GetFrozenWidth() const { return columnExtents_.GetOffset(std::min(frozenColumns_, columnExtents_.GetCount())); }
+    double GetFrozenHeight() const { return rowExtents_.GetOffset(std::min(frozenRows_, rowExtents_.GetCount())); }
+
+    // 单元格的内容坐标相对一个按步长取整的原点，滚动很远时坐标仍在 float 能精确表示的范围内
+    static constexpr double kOriginStep = 1048576.0;
+
+    CellFactory factory_;
+    CellBinder binder_;
+    TemplateSelector selector_;
+    ItemExtentIndex rowExtents_;
+    ItemExtentIndex columnExtents_;
+    size_t frozenRows_ = 0;
+    size_t frozenColumns_ = 0;
+    size_t rowOverscan_ = kDefaultRowOverscan;
+    size_t columnOverscan_ = kDefaultColumnOverscan;
+    double scrollX_ = 0.0;
+    double scrollY_ = 0.0;
+    double originX_ = 0.0;
+    double originY_ = 0.0;
+    PaneState panes_[kPaneCount];
+    uint64_t cellsCreated_ = 0;
+    uint64_t cellsBound_ = 0;
+    uint64_t cellsArranged_ = 0;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // DATA_GRID_HPP
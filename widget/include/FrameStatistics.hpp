@@ -0,0 +1,215 @@
+#ifndef FRAME_STATISTICS_HPP
+#define FRAME_STATISTICS_HPP
+#pragma once
+
+#include <boost/signals2.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 一帧中的阶段
+ */
+enum class FramePhase {
+    Events,     ///< 处理窗口事件（glfwPollEvents）
+    Tasks,      ///< 主线程任务（WindowManager::PollMainThreadTasks）
+    Animation,  ///< 推进动画
+    Style,      ///< 把样式变化同步到 Yoga 节点（只处理样式脏的组件）
+    Layout,     ///< 布局
+    Paint,      ///< 遍历组件树绘制（线程合成时为录制）
+    Flush,      ///< 把绘制命令提交给 GPU
+    Swap,       ///< 交换缓冲区（通常在这里等待垂直同步）
+    Count
+};
+
+/**
+ * @brief 一帧的计时（毫秒）
+ */
+struct FrameTiming {
+    uint64_t frameIndex = 0;
+    float total = 0.0f;         ///< 从 BeginFrame 到 EndFrame 的时长
+    float work = 0.0f;          ///< 总时长减去交换缓冲区（等待垂直同步）的时长，用于判断是否超过预算
+    float interval = 0.0f;      ///< 与上一帧开始时间的间隔，第一帧为 0
+    std::array<float, static_cast<size_t>(FramePhase::Count)> phases{};   ///< 各阶段的累计时长
+    uint32_t droppedFrames = 0; ///< 按帧间隔估算的本帧之前错过的帧数
+
+    float GetPhase(FramePhase phase) const { return phases[static_cast<size_t>(phase)]; }
+};
+
+/**
+ * @brief 帧计时统计
+ * 最近 capacity 帧的总时长和各阶段时长保存在固定大小的环形缓冲区中，同时维护按 0.1 毫秒分桶的直方图：
+ * 新帧写入时加入直方图，被覆盖的旧帧从直方图中移除，因此记录一帧是常数时间、不分配内存，
+ * 百分位数只需扫描直方图（超出直方图范围的少量慢帧再回到环形缓冲区中精确查找）。
+ * 除交换缓冲区之外的时长（FrameTiming::work）超过帧预算时触发 OnFrameOverBudget：
+ * 交换缓冲区通常阻塞到下一次垂直同步，按显示节奏运行的帧总时长本来就接近预算，不算超时；启用 Tracy 时每帧把各项数据同步为 Tracy 图表。
+ * 不是线程安全的，应在计时的线程上使用
+ */
+class FrameStatistics {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    static constexpr size_t kPhaseCount = static_cast<size_t>(FramePhase::Count);
+    static constexpr size_t kDefaultCapacity = 240;     ///< 60Hz 下约 4 秒
+    static constexpr float kDefaultBudget = 1000.0f / 60.0f;
+
+    /**
+     * @brief 统计摘要（毫秒），基于环形缓冲区中的帧
+     */
+    struct Summary {
+        size_t frames = 0;          ///< 参与统计的帧数
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+        float average = 0.0f;
+        std::array<float, kPhaseCount> phaseP95{};  ///< 各阶段的 95 百分位
+        uint64_t overBudgetFrames = 0;  ///< 累计超过预算的帧数（自 Reset 起）
+        uint64_t droppedFrames = 0;     ///< 累计错过的帧数（自 Reset 起）
+    };
+
+    /**
+     * @brief 构造函数
+     * @param capacity 环形缓冲区保存的帧数
+     */
+    explicit FrameStatistics(size_t capacity = kDefaultCapacity);
+    ~FrameStatistics();
+
+    FrameStatistics(const FrameStatistics&) = delete;
+    FrameStatistics& operator=(const FrameStatistics&) = delete;
+
+    /**
+     * @brief 设置帧预算（毫秒），同时作为估算错过帧数的刷新间隔
+     */
+    void SetFrameBudget(float milliseconds);
+
+    /**
+     * @brief 获取帧预算（毫秒）
+     */
+    float GetFrameBudget() const { return budget_; }
+
+    /**
+     * @brief 开始一帧
+     */
+    void BeginFrame(TimePoint now = std::chrono::steady_clock::now());
+
+    /**
+     * @brief 标记一段没有帧的空闲期（没有内容需要绘制）
+     * 下一帧与上一帧的间隔不再计入错过的帧
+     */
+    void MarkIdle();
+
+    /**
+     * @brief 累加当前帧中一个阶段的时长（同一阶段可以多次累加）
+     */
+    void RecordPhase(FramePhase phase, float milliseconds);
+
+    /**
+     * @brief 结束当前帧：写入环形缓冲区和直方图，除交换缓冲区之外的时长超过预算时触发 OnFrameOverBudget
+     */
+    void EndFrame(TimePoint now = std::chrono::steady_clock::now());
+
+    /**
+     * @brief 在作用域内为一个阶段计时
+     */
+    class ScopedPhase {
+    public:
+        ScopedPhase(FrameStatistics& statistics, FramePhase phase);
+        ~ScopedPhase();
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        FrameStatistics& statistics_;
+        FramePhase phase_;
+        TimePoint start_;
+    };
+
+    /**
+     * @brief 总时长的百分位数（毫秒，精度为一个桶：返回所在桶的下界）
+     * @param percentile 0~100
+     * @return 没有数据时返回 0
+     */
+    float GetPercentile(float percentile) const;
+
+    /**
+     * @brief 一个阶段时长的百分位数（毫秒）
+     */
+    float GetPhasePercentile(FramePhase phase, float percentile) const;
+
+    /**
+     * @brief 获取统计摘要
+     */
+    Summary GetSummary() const;
+
+    /**
+     * @brief 获取最近结束的一帧
+     */
+    const FrameTiming& GetLastFrame() const { return lastFrame_; }
+
+    /**
+     * @brief 获取环形缓冲区中的帧数
+     */
+    size_t GetFrameCount() const { return count_; }
+
+    /**
+     * @brief 按从旧到新的顺序获取环形缓冲区中的帧
+     */
+    std::vector<FrameTiming> GetFrames() const;
+
+    /**
+     * @brief 清空所有数据和累计计数
+     */
+    void Reset();
+
+    /**
+     * @brief 阶段名称
+     */
+    static const char* GetPhaseName(FramePhase phase);
+
+    /**
+     * @brief 一帧除交换缓冲区之外的时长超过预算时触发（在 EndFrame 中同步调用）
+     */
+    boost::signals2::signal<void(const FrameTiming&)> OnFrameOverBudget;
+
+private:
+    // 每个直方图：总时长 + 各阶段
+    static constexpr size_t kSeriesCount = kPhaseCount + 1;
+    static constexpr float kBucketWidth = 0.1f;         // 毫秒
+    static constexpr size_t kBucketCount = 1000;        // 覆盖 0~100 毫秒，之后是溢出桶
+
+    using Histogram = std::array<uint32_t, kBucketCount + 1>;
+
+    static size_t BucketOf(float milliseconds);
+    static float SeriesValue(const FrameTiming& frame, size_t series);
+    void AddToHistograms(const FrameTiming& frame, int delta);
+    float Percentile(size_t series, float percentile) const;
+
+    std::vector<FrameTiming> ring_;
+    size_t next_ = 0;           // 下一帧写入的位置
+    size_t count_ = 0;
+    std::vector<Histogram> histograms_;
+    mutable std::vector<float> overflow_;   // 百分位落在溢出桶时的临时数组
+
+    float budget_ = kDefaultBudget;
+    bool inFrame_ = false;
+    TimePoint frameStart_;
+    TimePoint lastFrameStart_;
+    bool hasLastFrame_ = false;
+    FrameTiming current_;
+    FrameTiming lastFrame_;
+    uint64_t frameIndex_ = 0;
+    uint64_t overBudgetFrames_ = 0;
+    uint64_t droppedFrames_ = 0;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // FRAME_STATISTICS_HPP
@@ -0,0 +1,186 @@
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+#pragma once
+
+#include "VisualElement.hpp"
+#include "ImageDecoder.hpp"
+#include "ImageCache.hpp"
+#include <include/core/SkCanvas.h>
+#include <include/core/SkImage.h>
+#include <boost/signals2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 图片在元素内的缩放方式
+ */
+enum class ImageStretch {
+    Fill,           // 拉伸填满，不保持宽高比
+    Uniform,        // 保持宽高比完整显示（可能留白）
+    UniformToFill,  // 保持宽高比填满（超出部分被裁掉）
+};
+
+/**
+ * @brief 图片加载状态
+ */
+enum class ImageState {
+    Empty,      // 没有设置图片
+    Loading,    // 后台解码中
+    Decoded,    // 已解码，等待上传纹理
+    Ready,      // 可以直接绘制
+    Failed,     // 加载失败
+};
+
+/**
+ * @brief Image 组件，显示一张位图
+ * 通过 SetSource 设置的文件在 WindowManager 的后台线程池中解码，解码完成后回到 UI 线程；
+ * 文件按元素的设备像素尺寸（布局尺寸 × 画布缩放）缩小解码，并放入 ImageCache 与其他元素共享；
+ * 纹理在渲染线程上传，每帧的上传量受 SetUploadBudget 限制，超出的图片下一帧再上传；
+ * 只有图片被缩小到一半以下绘制时才生成 mipmap。图片就绪之前绘制占位色
+ */
+class Image : public VisualElement {
+public:
+    /**
+     * @brief 默认的每帧纹理上传预算（字节）
+     */
+    static constexpr size_t kDefaultUploadBudget = 8 * 1024 * 1024;
+
+    Image();
+    virtual ~Image();
+
+    /**
+     * @brief 设置图片文件并开始后台解码
+     * 元素需要由 boost::shared_ptr 持有；解码期间元素被销毁时结果会被丢弃。
+     * 尺寸未知（宽或高为 0）时推迟到第一次渲染再解码
+     * @param path 图片文件路径，空字符串表示清除图片
+     */
+    void SetSource(const std::string& path);
+
+    /**
+     * @brief 获取图片文件路径
+     */
+    const std::string& GetSource() const { return source_; }
+
+    /**
+     * @brief 直接设置已经解码的图片（光栅或纹理图片均可）
+     * @param image 图片，为空表示清除
+     */
+    void SetImage(sk_sp<SkImage> image);
+
+    /**
+     * @brief 获取当前图片（未加载完成时为空）
+     */
+    sk_sp<SkImage> GetImage() const { return image_; }
+
+    /**
+     * @brief 获取加载状态
+     */
+    ImageState GetState() const { return state_; }
+
+    /**
+     * @brief 设置缩放方式
+     * @param stretch 缩放方式
+     */
+    void SetStretch(ImageStretch stretch);
+
+    /**
+     * @brief 获取缩放方式
+     */
+    ImageStretch GetStretch() const { return stretch_; }
+
+    /**
+     * @brief 设置图片就绪前显示的占位色
+     * @param color 占位色，透明表示不绘制
+     */
+    void SetPlaceholderColor(SkColor color);
+
+    /**
+     * @brief 获取占位色
+     */
+    SkColor GetPlaceholderColor() const { return placeholderColor_; }
+
+    /**
+     * @brief 渲染图片（未就绪时渲染占位色）
+     * @param canvas 画布
+     */
+    virtual void Render(SkCanvas* canvas) override;
+
+    /**
+     * @brief 设置所有 Image 共享的每帧纹理上传预算
+     * 每帧至少上传一张图片，避免大图永远得不到上传
+     * @param bytesPerFrame 每帧最多上传的字节数
+     */
+    static void SetUploadBudget(size_t bytesPerFrame);
+
+    /**
+     * @brief 获取每帧纹理上传预算
+     */
+    static size_t GetUploadBudget();
+
+    /**
+     * @brief 开始新的一帧，重置本帧剩余的上传预算（由 SceneRenderer::Render 调用）
+     */
+    static void BeginFrame();
+
+    /**
+     * @brief 加载完成信号（在 UI 线程触发）
+     * @param success 是否成功
+     */
+    boost::signals2::signal<void(bool success)> OnLoaded;
+
+private:
+    /**
+     * @brief 按目标尺寸加载 source_：先查 ImageCache，未命中时在后台解码并写入缓存
+     * @param keepCurrent 是否在新图片就绪前继续显示当前图片（放大后重新解码时使用）
+     */
+    void StartLoad(const ImageDecoder::TargetSize& target, bool keepCurrent);
+
+    /**
+     * @brief 后台解码完成后在 UI 线程调用
+     */
+    void OnDecoded(uint64_t generation, const ImageCache::Key& key, const ImageCache::Entry& entry, const std::string& error);
+
+    /**
+     * @brief 按当前布局尺寸和设备缩放计算解码目标尺寸
+     */
+    ImageDecoder::TargetSize ComputeDecodeTarget() const;
+
+    /**
+     * @brief 元素在设备上变大后，当前图片分辨率不足时重新解码
+     */
+    void ReloadIfTooSmall();
+
+    /**
+     * @brief 确保图片可以在 canvas 上直接绘制（GPU 画布上需要先上传纹理）
+     * @return 是否可以绘制
+     */
+    bool EnsureDrawable(SkCanvas* canvas, bool needMipmaps);
+
+    /**
+     * @brief 按缩放方式计算图片的源矩形和目标矩形
+     */
+    void ComputeRects(SkRect* src, SkRect* dst) const;
+
+    std::string source_;
+    sk_sp<SkImage> image_;      // 解码结果（光栅）或调用方给出的图片
+    sk_sp<SkImage> texture_;    // 上传后的纹理图片
+    ImageState state_ = ImageState::Empty;
+    uint64_t loadGeneration_ = 0; // 每次更换图片递增，用来丢弃过期的解码结果
+    ImageCache::Key cacheKey_;  // image_ 在 ImageCache 中的键，source 为空表示不来自缓存
+    int sourceWidth_ = 0;       // 原图尺寸，用来判断重新解码能否得到更清晰的图片
+    int sourceHeight_ = 0;
+    bool loadPending_ = false;  // 尺寸未知，等待渲染时再解码
+    bool reloading_ = false;    // 正在以更大的尺寸重新解码
+    float deviceScale_ = 1.0f;  // 最近一次渲染时画布的缩放
+    ImageStretch stretch_ = ImageStretch::Fill;
+    SkColor placeholderColor_ = SkColorSetARGB(255, 230, 230, 230);
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // IMAGE_HPP
@@ -0,0 +1,195 @@
+#ifndef IMAGE_CACHE_HPP
+#define IMAGE_CACHE_HPP
+#pragma once
+
+#include "ImageDecoder.hpp"
+#include <include/core/SkImage.h>
+#include <include/core/SkRefCnt.h>
+#include <boost/signals2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GrDirectContext;
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 进程内共享的已解码图片缓存
+ * 以“来源 + 目标设备像素尺寸”为键，缓存显示尺寸的光栅图片以及各 GPU 上下文上传后的纹理；
+ * 总字节数（光栅 + 纹理）超过预算时按 LRU 淘汰。可以在任意线程访问。
+ * 纹理属于上传它的 GrDirectContext，只能在使用该上下文的线程上释放：在其他线程（例如后台解码线程）
+ * 被淘汰的纹理先放进该上下文的待释放队列，由渲染线程调用 ReleaseRetiredTextures 释放；
+ * 上下文关闭（RenderContext::Shutdown）时释放它的全部纹理
+ */
+class ImageCache {
+public:
+    /**
+     * @brief 默认缓存预算（字节）
+     */
+    static constexpr size_t kDefaultBudget = 128 * 1024 * 1024;
+
+    /**
+     * @brief 缓存键
+     */
+    struct Key {
+        std::string source;                 ///< 图片来源（文件路径）
+        ImageDecoder::TargetSize target;    ///< 目标设备像素尺寸
+
+        bool operator==(const Key& other) const {
+            return source == other.source && target.width == other.target.width &&
+                   target.height == other.target.height && target.cover == other.target.cover;
+        }
+    };
+
+    /**
+     * @brief 缓存条目
+     */
+    struct Entry {
+        sk_sp<SkImage> image;       ///< 显示尺寸的光栅图片
+        int sourceWidth = 0;        ///< 原图宽度
+        int sourceHeight = 0;       ///< 原图高度
+    };
+
+    /**
+     * @brief 缓存统计
+     */
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entryCount = 0;
+        size_t usedBytes = 0;
+        size_t retiredTextures = 0;     ///< 已淘汰、等待在所属线程上释放的纹理数
+    };
+
+    static ImageCache& GetSharedInstance();
+
+    /**
+     * @brief 设置缓存预算，超出的部分立即淘汰
+     * @param bytes 字节数
+     */
+    void SetBudget(size_t bytes);
+
+    /**
+     * @brief 获取缓存预算
+     */
+    size_t GetBudget() const;
+
+    /**
+     * @brief 查找缓存并把条目移到最近使用
+     * @param key 缓存键
+     * @param entry 输出命中的条目
+     * @return 是否命中
+     */
+    bool Find(const Key& key, Entry* entry);
+
+    /**
+     * @brief 插入或替换条目，然后按预算淘汰
+     * @param key 缓存键
+     * @param entry 条目（image 不能为空）
+     */
+    void Insert(const Key& key, const Entry& entry);
+
+    /**
+     * @brief 查找条目在指定上下文中上传过的纹理（在使用该上下文的线程上调用）
+     * @param key 缓存键
+     * @param context 纹理所属的 GPU 上下文
+     * @return 纹理，没有上传过或条目已被淘汰时为空
+     */
+    sk_sp<SkImage> FindTexture(const Key& key, GrDirectContext* context);
+
+    /**
+     * @brief 为已有条目记录在指定上下文中上传的纹理，条目不存在（已被淘汰）时忽略
+     * 在使用该上下文的线程上调用；该上下文原有的纹理在这里释放
+     * @param key 缓存键
+     * @param context 纹理所属的 GPU 上下文
+     * @param texture 纹理图片
+     */
+    void SetTexture(const Key& key, GrDirectContext* context, sk_sp<SkImage> texture);
+
+    /**
+     * @brief 释放在其他线程被淘汰的、属于指定上下文的纹理（渲染线程每帧调用）
+     * @param context GPU 上下文，需要在当前线程上使用
+     */
+    void ReleaseRetiredTextures(GrDirectContext* context);
+
+    /**
+     * @brief 丢弃指定上下文的所有纹理（GPU 资源被释放或上下文关闭时调用），光栅图片保留
+     * @param context GPU 上下文，需要在当前线程上使用
+     */
+    void ReleaseTextures(GrDirectContext* context);
+
+    /**
+     * @brief 清空缓存
+     * 纹理进入各自上下文的待释放队列，不在调用线程上释放
+     */
+    void Clear();
+
+    /**
+     * @brief 获取统计信息
+     */
+    Stats GetStats() const;
+
+    /**
+     * @brief 计算一张图片占用的字节数
+     */
+    static size_t ComputeBytes(const sk_sp<SkImage>& image);
+
+private:
+    ImageCache();
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Texture {
+        GrDirectContext* context = nullptr;
+        sk_sp<SkImage> image;
+    };
+
+    struct Node {
+        Key key;
+        Entry entry;
+        std::vector<Texture> textures;  // 每个上传过的上下文一份
+        size_t bytes = 0;
+    };
+
+    using NodeList = std::list<Node>;
+
+    /**
+     * @brief 从最久未使用的条目开始淘汰，直到不超过预算（调用方持有锁）
+     */
+    void EvictLocked();
+
+    /**
+     * @brief 把条目的纹理移入各自上下文的待释放队列（调用方持有锁）
+     */
+    void RetireTexturesLocked(Node& node);
+
+    static size_t ComputeNodeBytes(const Node& node);
+
+    mutable std::mutex mutex_;
+    NodeList lru_;      // 头部是最近使用的条目
+    std::unordered_map<Key, NodeList::iterator, KeyHash> index_;
+    size_t budget_ = kDefaultBudget;
+    size_t usedBytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+    std::unordered_map<GrDirectContext*, std::vector<sk_sp<SkImage>>> retiredTextures_;
+    size_t retiredCount_ = 0;
+    boost::signals2::scoped_connection shutdownConnection_;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // IMAGE_CACHE_HPP
@@ -0,0 +1,82 @@
+#ifndef IMAGE_DECODER_HPP
+#define IMAGE_DECODER_HPP
+#pragma once
+
+#include <include/core/SkImage.h>
+#include <include/core/SkRefCnt.h>
+#include <cstddef>
+#include <string>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 图片解码工具（基于 stb_image）
+ * 只做 CPU 端的解码，结果是预乘 alpha 的 RGBA 光栅图片；不访问 GPU，可以在任意线程调用
+ */
+class ImageDecoder {
+public:
+    /**
+     * @brief 解码结果
+     */
+    struct Result {
+        sk_sp<SkImage> image;   ///< 解码后的光栅图片，失败时为空
+        std::string error;      ///< 失败原因
+        int sourceWidth = 0;    ///< 原图宽度
+        int sourceHeight = 0;   ///< 原图高度
+    };
+
+    /**
+     * @brief 解码目标尺寸
+     * 宽高为 0 表示保持原图尺寸；否则按比例缩小到刚好满足目标尺寸（从不放大）
+     */
+    struct TargetSize {
+        int width = 0;
+        int height = 0;
+        bool cover = true;      ///< true：两个方向都不小于目标（Fill/UniformToFill）；false：完整放入目标（Uniform）
+    };
+
+    /**
+     * @brief 读取并按原图尺寸解码图片文件
+     * @param path 文件路径
+     * @return 解码结果
+     */
+    static Result DecodeFile(const std::string& path);
+
+    /**
+     * @brief 读取并解码图片文件
+     * @param path 文件路径
+     * @param target 目标尺寸
+     * @return 解码结果
+     */
+    static Result DecodeFile(const std::string& path, const TargetSize& target);
+
+    /**
+     * @brief 按原图尺寸解码内存中的图片数据
+     * @param data 编码后的数据（PNG、JPEG、BMP、TGA 等）
+     * @param size 数据字节数
+     * @return 解码结果
+     */
+    static Result DecodeMemory(const void* data, size_t size);
+
+    /**
+     * @brief 解码内存中的图片数据
+     * 需要缩小时，原尺寸的像素只在本次调用内存在，返回的图片就是显示尺寸
+     * @param data 编码后的数据（PNG、JPEG、BMP、TGA 等）
+     * @param size 数据字节数
+     * @param target 目标尺寸
+     * @return 解码结果
+     */
+    static Result DecodeMemory(const void* data, size_t size, const TargetSize& target);
+
+    /**
+     * @brief 计算原图按目标尺寸缩小后的像素尺寸
+     * @return 缩小后的尺寸，不需要缩小时等于原图尺寸
+     */
+    static SkISize ComputeScaledSize(int sourceWidth, int sourceHeight, const TargetSize& target);
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // IMAGE_DECODER_HPP
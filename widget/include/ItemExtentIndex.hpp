@@ -0,0 +1,88 @@
+#ifndef ITEM_EXTENT_INDEX_HPP
+#define ITEM_EXTENT_INDEX_HPP
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 按索引保存条目尺寸（行高或列宽），支持快速求位置和按位置查找条目
+ * 所有条目尺寸相同时直接用乘除计算，不占用按条目的内存；
+ * 第一次设置了不同的尺寸后建立树状数组（Fenwick tree），
+ * 修改单个尺寸、求条目位置、按位置查找条目都是 O(log n)，追加条目也是 O(log n)。
+ * 位置用 double 累加，百万行时仍能精确到像素
+ */
+class ItemExtentIndex {
+public:
+    ItemExtentIndex() = default;
+
+    /**
+     * @brief 重置为 count 个尺寸都是 extent 的条目
+     */
+    void Reset(size_t count, float extent);
+
+    /**
+     * @brief 调整条目数，新增的条目使用默认尺寸
+     */
+    void Resize(size_t count);
+
+    /**
+     * @brief 条目数
+     */
+    size_t GetCount() const { return count_; }
+
+    /**
+     * @brief 默认尺寸（Reset 时指定）
+     */
+    float GetDefaultExtent() const { return defaultExtent_; }
+
+    /**
+     * @brief 所有条目是否仍然使用默认尺寸
+     */
+    bool IsUniform() const { return extents_.empty(); }
+
+    /**
+     * @brief 设置单个条目的尺寸
+     */
+    void SetExtent(size_t index, float extent);
+
+    /**
+     * @brief 获取单个条目的尺寸
+     */
+    float GetExtent(size_t index) const;
+
+    /**
+     * @brief 条目的起始位置（前面所有条目的尺寸之和），index 可以等于条目数
+     */
+    double GetOffset(size_t index) const;
+
+    /**
+     * @brief 所有条目的尺寸之和
+     */
+    double GetTotal() const { return GetOffset(count_); }
+
+    /**
+     * @brief 查找包含位置 offset 的条目
+     * @return 条目索引；offset 超出末尾时返回最后一个条目，没有条目时返回 0
+     */
+    size_t FindIndex(double offset) const;
+
+private:
+    /**
+     * @brief 从默认尺寸建立按条目保存的数据
+     */
+    void BuildTree();
+
+    size_t count_ = 0;
+    float defaultExtent_ = 0.0f;
+    std::vector<float> extents_;    // 每个条目的尺寸，统一尺寸时为空
+    std::vector<double> tree_;      // 树状数组，下标从 1 开始
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // ITEM_EXTENT_INDEX_HPP
@@ -0,0 +1,264 @@
+#ifndef LIST_VIEW_HPP
+#define LIST_VIEW_HPP
+#pragma once
+
+#include "Box.hpp"
+#include "ItemExtentIndex.hpp"
+#include <include/core/SkCanvas.h>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief ListView 组件，虚拟化的纵向列表
+ * 只为与视口相交的行（再加上下各 overscan 行）创建子元素，其余的行只记录行高，
+ * 布局、渲染和命中测试的开销与可见行数成正比，与条目总数无关。
+ * 行元素由 RowFactory 按模板 id 创建，由 RowBinder 填入条目数据；
+ * 滚出视口的行隐藏后放回对应模板的回收池，之后重新绑定给新的条目，不再创建和销毁元素。
+ * 行不参与列表的 Yoga 布局：每一行单独做 Yoga 布局，位置由列表按行高累加决定。
+ * 行高有两种模式：Fixed 所有行等高；Measured 以 RowHeight 作为估算值，
+ * 行第一次显示时按内容测量实际高度（视口上方的行高度变化时调整滚动位置，可见内容不跳动）
+ */
+class ListView : public Box {
+public:
+    /**
+     * @brief 行高模式
+     */
+    enum class RowHeightMode {
+        Fixed,      ///< 所有行使用 RowHeight
+        Measured    ///< RowHeight 只是估算值，行显示时按内容测量
+    };
+
+    /**
+     * @brief 默认行高（像素）
+     */
+    static constexpr float kDefaultRowHeight = 24.0f;
+
+    /**
+     * @brief 默认在视口上下额外创建的行数
+     */
+    static constexpr size_t kDefaultOverscan = 4;
+
+    /**
+     * @brief 按模板 id 创建一个行元素
+     */
+    using RowFactory = std::function<boost::shared_ptr<VisualElement>(int templateId)>;
+
+    /**
+     * @brief 把条目数据填入行元素（行元素可能之前显示过别的条目）
+     */
+    using RowBinder = std::function<void(size_t index, VisualElement& row)>;
+
+    /**
+     * @brief 返回条目使用的模板 id，不设置时所有条目都使用模板 0
+     */
+    using TemplateSelector = std::function<int(size_t index)>;
+
+    /**
+     * @brief 虚拟化统计
+     */
+    struct Stats {
+        size_t realizedRows = 0;    ///< 当前显示的行数
+        size_t pooledRows = 0;      ///< 回收池中的行数
+        uint64_t rowsCreated = 0;   ///< 累计通过 RowFactory 创建的行数
+        uint64_t rowsBound = 0;     ///< 累计调用 RowBinder 的次数
+        uint64_t rowsMeasured = 0;  ///< 累计布局（测量）行元素的次数
+    };
+
+    ListView();
+    virtual ~ListView();
+
+    /**
+     * @brief 设置条目数
+     * 只处理在末尾追加或截断，已经显示的条目不会重新绑定；数据整体变化时调用 InvalidateItems
+     */
+    void SetItemCount(size_t count);
+
+    /**
+     * @brief 获取条目数
+     */
+    size_t GetItemCount() const { return extents_.GetCount(); }
+
+    /**
+     * @brief 设置行元素工厂，已创建的行元素全部丢弃
+     */
+    void SetRowFactory(RowFactory factory);
+
+    /**
+     * @brief 设置数据绑定函数，显示中的行重新绑定
+     */
+    void SetRowBinder(RowBinder binder);
+
+    /**
+     * @brief 设置模板选择函数，显示中的行重新绑定
+     */
+    void SetTemplateSelector(TemplateSelector selector);
+
+    /**
+     * @brief 设置行高模式，已测量的行高全部丢弃
+     */
+    void SetRowHeightMode(RowHeightMode mode);
+
+    /**
+     * @brief 获取行高模式
+     */
+    RowHeightMode GetRowHeightMode() const { return rowHeightMode_; }
+
+    /**
+     * @brief 设置行高（Fixed 模式）或估算行高（Measured 模式），已测量的行高全部丢弃
+     */
+    void SetRowHeight(float height);
+
+    /**
+     * @brief 获取行高（Measured 模式下是估算值）
+     */
+    float GetRowHeight() const { return rowHeight_; }
+
+    /**
+     * @brief 设置在视口上下额外创建的行数，快速滚动时减少空白
+     */
+    void SetOverscan(size_t rows);
+
+    /**
+     * @brief 设置纵向滚动位置，只移动和替换行元素，不做列表的布局
+     * @param offset 内容顶部相对视口顶部的偏移，会限制在 [0, 内容高度 - 视口高度]
+     * @note 位置都用 double：百万行时内容高度超过 float 能精确表示的像素范围
+     */
+    void SetScrollOffset(double offset);
+
+    /**
+     * @brief 获取纵向滚动位置
+     */
+    double GetScrollOffset() const { return scrollOffset_; }
+
+    /**
+     * @brief 滚动到使条目完整可见的最近位置
+     */
+    void ScrollIntoView(size_t index);
+
+    /**
+     * @brief 所有行的高度之和（Measured 模式下未测量的行按估算值计算）
+     */
+    double GetContentHeight() const { return extents_.GetTotal(); }
+
+    /**
+     * @brief 条目在内容中的纵向位置
+     */
+    double GetItemOffset(size_t index) const { return extents_.GetOffset(index); }
+
+    /**
+     * @brief 条目数据变化：显示中的条目重新绑定，Measured 模式下重新测量
+     */
+    void InvalidateItem(size_t index);
+
+    /**
+     * @brief 所有条目数据变化：显示中的行重新绑定，已测量的行高全部丢弃
+     */
+    void InvalidateItems();
+
+    /**
+     * @brief 获取显示条目的行元素
+     * @return 条目没有显示时返回空指针
+     */
+    boost::shared_ptr<VisualElement> GetRealizedRow(size_t index) const;
+
+    /**
+     * @brief 查找元素（行元素或它的后代，例如 HitTest 的结果）所在的条目
+     * @param element 元素
+     * @param index 输出条目索引
+     * @return 元素属于显示中的行时返回 true
+     */
+    bool GetItemIndex(const boost::shared_ptr<VisualElement>& element, size_t* index) const;
+
+    /**
+     * @brief 获取虚拟化统计
+     */
+    Stats GetStats() const;
+
+protected:
+    /**
+     * @brief 按滚动位置创建、回收和摆放行元素
+     */
+    void LayoutChildren(float width, float height) override;
+
+private:
+    struct RealizedRow {
+        size_t index = 0;
+        int templateId = 0;
+        boost::shared_ptr<VisualElement> element;
+        bool needsLayout = true;    // 绑定后或视口宽度变化后需要重新布局
+    };
+
+    /**
+     * @brief 更新显示的行并摆放；测量改变了内容高度、滚动位置需要重新限制时再更新一次
+     */
+    void Realize();
+
+    /**
+     * @brief 回收离开范围的行，创建或复用进入范围的行
+     */
+    void RealizeRange();
+
+    /**
+     * @brief 把滚动位置限制在 [0, 内容高度 - 视口高度]
+     * @return 滚动位置是否改变
+     */
+    bool ClampScrollOffset();
+
+    /**
+     * @brief 为条目取一个行元素（优先从回收池取）并绑定数据
+     * @return 行元素工厂没有返回元素时返回 false
+     */
+    bool Acquire(size_t index, RealizedRow* row);
+
+    /**
+     * @brief 隐藏行元素并放回回收池
+     */
+    void Recycle(RealizedRow& row);
+
+    /**
+     * @brief 回收所有显示中的行
+     */
+    void RecycleAll();
+
+    /**
+     * @brief 按视口宽度布局行元素，Measured 模式下记录测量到的行高
+     * @param anchor 滚动锚点条目，它上方的行高度变化时调整滚动位置
+     */
+    void LayoutRow(RealizedRow& row, size_t anchor);
+
+    /**
+     * @brief 查找显示条目在 realized_ 中的位置
+     * @return 条目没有显示时返回 npos
+     */
+    size_t FindRealized(size_t index) const;
+
+    float GetViewportWidth() const { return width_ - paddingLeft_ - paddingRight_; }
+    float GetViewportHeight() const { return height_ - paddingTop_ - paddingBottom_; }
+
+    RowFactory factory_;
+    RowBinder binder_;
+    TemplateSelector selector_;
+    RowHeightMode rowHeightMode_ = RowHeightMode::Fixed;
+    float rowHeight_ = kDefaultRowHeight;
+    size_t overscan_ = kDefaultOverscan;
+    double scrollOffset_ = 0.0;
+    float layoutWidth_ = 0.0f;  // 行元素上次布局使用的宽度
+    ItemExtentIndex extents_;
+    std::vector<RealizedRow> realized_;     // 按条目索引排序
+    std::unordered_map<int, std::vector<boost::shared_ptr<VisualElement>>> pools_;
+    uint64_t rowsCreated_ = 0;
+    uint64_t rowsBound_ = 0;
+    uint64_t rowsMeasured_ = 0;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // LIST_VIEW_HPP
@@ -2,9 +2,26 @@
 #define SCENE_RENDERER_HPP
 #pragma once
 
+#include "AnimationEngine.hpp"
+#include "CompositorAnimator.hpp"
+#include "FrameStatistics.hpp"
 #include "VisualElement.hpp"
+#include "clock.hpp"
+#include <DrawCommandBuffer.hpp>
 #include <include/core/SkCanvas.h>
+#include <include/core/SkDrawable.h>
+#include <include/core/SkMatrix.h>
+#include <include/core/SkRegion.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkSurface.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+
+class GrDirectContext;
 
 namespace KiUI {
 namespace foundation {
@@ -13,12 +30,18 @@ class WindowManager;
 }
 namespace graphics {
 class RenderSurface;
+class RenderContext;
 }
 namespace widget {
 
+class CompositorLayer;
+
 /**
  * @brief SceneRenderer - 场景渲染器
  * 统一管理所有组件的渲染逻辑，让开发者无需关心渲染细节
+ * 每一帧按固定的管线执行：输入 → 动画 → 样式 → 布局 → 绘制 → 合成。
+ * 组件的属性变化只标记它影响的阶段（见 DirtyFlags），每个阶段只处理带有对应标记的组件，
+ * 例如颜色动画只经过绘制阶段，不会触发样式同步、布局或命中测试失效；没有任何标记时整帧跳过
  */
 class SceneRenderer {
 public:
@@ -44,9 +67,16 @@ public:
      */
     boost::shared_ptr<VisualElement> GetRoot() const { return root_; }
     
+    /**
+     * @brief 样式阶段：把样式脏的组件的属性同步到 Yoga 节点
+     * 只访问带有 Style 标记的子树；CalculateLayout 也会先执行这一步
+     */
+    void UpdateStyles();
+    
     /**
      * @brief 计算布局
      * 递归计算所有组件的布局位置和大小
+     * 视口尺寸与上一次相同且组件树没有样式或布局脏标记时直接复用上一次的结果
      * @param viewportWidth 视口宽度（通常是窗口宽度）
      * @param viewportHeight 视口高度（通常是窗口高度）
      */
@@ -55,14 +85,214 @@ public:
     /**
      * @brief 渲染场景
      * 递归渲染所有可见组件（内部包含 Tracy 性能追踪）
+     * 开始绘制前清除组件树的 Paint 标记，绘制过程中新产生的标记（例如图片上传推迟到下一帧）保留到下一帧
      * @param canvas Skia 画布
      */
     void Render(SkCanvas* canvas);
     
+    /**
+     * @brief 在当前帧内绘制一棵子树（例如组件把自己的内容录制成图片）
+     * 与 Render 不同，不开始新的一帧：不清除 Paint 标记、不推进帧序号、不重置图片上传预算和本帧统计，
+     * 也不做遮挡剔除；只有本渲染器的合成器动画中的组件按合成层绘制
+     * @param element 子树的根（按它在父组件中的位置绘制）
+     * @param canvas Skia 画布
+     */
+    void RenderSubtree(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas);
+    
+    /**
+     * @brief 是否需要绘制新的一帧
+     * 组件树有样式、布局或绘制脏标记、视口尺寸变化、动画引擎中有运行的动画或调用过 RequestFrame 时返回 true
+     * （合成器动画由 Run() 单独判断：线程合成时不需要 UI 线程重新录制）
+     * @param viewportWidth 视口宽度
+     * @param viewportHeight 视口高度
+     */
+    bool NeedsFrame(float viewportWidth, float viewportHeight) const;
+    
+    /**
+     * @brief 请求绘制下一帧
+     * 用于渲染器看不到的变化（例如移除合成层的属性）；组件属性的变化会自动标记，不需要调用
+     */
+    void RequestFrame() { frameRequested_ = true; }
+    
+    /**
+     * @brief 获取命中测试版本
+     * 组件树中影响命中测试的变化（位置、尺寸、变换、可见性、子元素、滚动偏移）使版本递增，
+     * 只影响绘制的变化（颜色、未降到 0 的透明度）不会；缓存命中测试结果（例如鼠标下的组件）的调用方
+     * 版本不变时可以直接复用。调用时清除组件树的 HitTest 标记
+     */
+    uint64_t GetHitTestVersion();
+    
+    /**
+     * @brief 启用/禁用绘制命令批处理
+     * 启用时（默认）支持 Record 的组件先记录到命令缓冲区，按绘制状态重排合并后统一提交；
+     * 禁用时每个组件直接调用 Render 立即绘制
+     * @param enabled 是否启用
+     */
+    void SetBatchingEnabled(bool enabled) { batchingEnabled_ = enabled; }
+    
+    /**
+     * @brief 是否启用了绘制命令批处理
+     */
+    bool IsBatchingEnabled() const { return batchingEnabled_; }
+    
+    /**
+     * @brief 获取最近一帧的批处理统计信息
+     * @return 命令数、批次数与实际绘制调用数（一帧内多次提交时累加）
+     */
+    const KiUI::graphics::DrawCommandBuffer::Stats& GetBatchStats() const { return batchStats_; }
+    
+    /**
+     * @brief 获取最近一帧被裁剪剔除的子树数量
+     * 子树的缓存包围盒完全落在当前设备裁剪区域之外时，整棵子树都不会被遍历
+     */
+    size_t GetCulledCount() const { return culledCount_; }
+    
+    /**
+     * @brief 启用/禁用遮挡剔除（默认启用）
+     * 启用时每帧绘制前先按逆绘制顺序遍历一次场景，累积不透明背景覆盖的设备区域，
+     * 被完全覆盖的组件（或整棵子树）不再绘制
+     * @param enabled 是否启用
+     */
+    void SetOcclusionCullingEnabled(bool enabled) { occlusionCullingEnabled_ = enabled; }
+    
+    /**
+     * @brief 是否启用了遮挡剔除
+     */
+    bool IsOcclusionCullingEnabled() const { return occlusionCullingEnabled_; }
+    
+    /**
+     * @brief 获取最近一帧被遮挡而跳过的组件数量（整棵子树被遮挡时计为 1）
+     */
+    size_t GetOccludedCount() const { return occludedCount_; }
+    
+    /**
+     * @brief 获取最近一帧直接复用缓存图层的透明度分组数量
+     */
+    size_t GetGroupLayerHits() const { return groupLayerHits_; }
+    
+    /**
+     * @brief 获取最近一帧重新渲染图层的透明度分组数量
+     */
+    size_t GetGroupLayerRenders() const { return groupLayerRenders_; }
+    
+    /**
+     * @brief 获取最近一帧内容和滚动位置都没有变化、直接复用的滚动图层数量
+     */
+    size_t GetScrollLayerHits() const { return scrollLayerHits_; }
+    
+    /**
+     * @brief 获取最近一帧平移复用、只光栅化新露出区域的滚动图层数量
+     */
+    size_t GetScrollLayerScrolls() const { return scrollLayerScrolls_; }
+    
+    /**
+     * @brief 获取最近一帧整个重新绘制的滚动图层数量
+     */
+    size_t GetScrollLayerRenders() const { return scrollLayerRenders_; }
+
+    /**
+     * @brief 获取最近一帧只重新绘制内容变化区域（VisualElement::GetChildDamage）的滚动图层数量
+     */
+    size_t GetScrollLayerDamageUpdates() const { return scrollLayerDamageUpdates_; }
+    
+    /**
+     * @brief 获取最近一帧滚动图层中重新光栅化的像素数
+     */
+    uint64_t GetScrollLayerRasterizedPixels() const { return scrollLayerPixels_; }
+    
+    /**
+     * @brief 获取驱动本场景动画的动画引擎
+     * Run() 每帧在布局之前按合成时钟推进一次
+     */
+    AnimationEngine& GetAnimationEngine() { return animations_; }
+    
+    /**
+     * @brief 获取合成时钟（Run() 每帧开始时前进一次）
+     */
+    const CompositionClock& GetClock() const { return clock_; }
+    
+    /**
+     * @brief 获取帧计时统计
+     * Run() 每帧记录事件、任务、动画、样式、布局、绘制、提交和交换各阶段的耗时，跳过的空闲帧不计入；
+     * 启用线程合成时记录的是 UI 线程的帧（绘制阶段为录制，提交在合成线程上，不计入；
+     * 交换阶段为等待合成线程取走帧的时间）
+     */
+    FrameStatistics& GetFrameStatistics() { return frameStatistics_; }
+    
+    /**
+     * @brief 获取合成器动画
+     * 有合成层属性的组件总是通过合成层绘制：整棵子树录制一次、光栅化一次，动画的透明度和变换
+     * 在合成时才应用到图层上，不写回组件，组件的内容版本不变。Run() 每次合成前采样一次
+     * （启用线程合成时在合成线程上采样）。嵌套在另一个合成层内的合成层按录制时的值静态绘制
+     */
+    CompositorAnimator& GetCompositorAnimator() { return compositor_; }
+    
+    /**
+     * @brief 获取最近一帧重新录制内容的合成层数量（内容版本变化或第一次绘制）
+     */
+    size_t GetCompositorLayerRecords() const { return compositorLayerRecords_; }
+    
+    /**
+     * @brief 获取累计光栅化合成层的次数（线程合成时由合成线程累加）
+     */
+    uint64_t GetCompositorLayerRasterizations() const { return compositorCounters_->rasterizations.load(); }
+    
+    /**
+     * @brief 获取累计合成合成层的次数
+     */
+    uint64_t GetCompositorLayerComposites() const { return compositorCounters_->composites.load(); }
+    
+    /**
+     * @brief 把场景录制成可以稍后回放（也可以在另一个线程上回放）的一帧
+     * 合成层在帧中保持为活动的 drawable：每次回放时重新读取合成器动画的当前值，
+     * 第一次回放时光栅化、之后复用，所以同一帧可以随动画反复合成而不经过 UI 线程。
+     * 录制画布没有 GPU 上下文，以下内容按光栅画布处理：
+     * - 普通的透明度分组和滚动图层没有离屏表面，按本帧内容直接录制；
+     * - 图片按 CPU 图片录制，回放时由 Skia 在回放线程上同步上传，不受 Image::SetUploadBudget 的每帧预算限制；
+     * - 文字使用字形图集的光栅快照，帧还被持有时图集新增字形会先复制整张光栅图集（写时复制）
+     * @param width 帧宽度
+     * @param height 帧高度
+     * @return 录制的帧，场景为空时返回空指针
+     */
+    sk_sp<SkDrawable> RecordFrame(float width, float height);
+    
+    /**
+     * @brief 启用/禁用线程合成（默认禁用，需要在 Run() 之前设置）
+     * 启用时由单独的合成线程持有渲染表面：按显示节奏采样合成器动画并回放 UI 线程最近录制的一帧（RecordFrame）；
+     * UI 线程只负责事件、动画引擎、布局和录制。UI 线程忙于处理事件或任务时，合成器动画仍然按时推进。
+     * 录制的帧没有 GPU 上下文，图片上传预算和字形图集的增量上传不生效（见 RecordFrame）
+     * @param enabled 是否启用
+     */
+    void SetThreadedCompositingEnabled(bool enabled) { threadedCompositing_ = enabled; }
+    
+    /**
+     * @brief 是否启用了线程合成
+     */
+    bool IsThreadedCompositingEnabled() const { return threadedCompositing_; }
+    
+    /**
+     * @brief 释放渲染器持有的 GPU 缓存（透明度分组、滚动容器和合成层的离屏图层、ImageCache 中的纹理、字形图集纹理）
+     * 下一次渲染时按需重建；通常在内存压力或所有窗口隐藏时调用。纹理只在所属上下文的线程上释放：
+     * 直接渲染时释放最近一次绘制使用的上下文的纹理，线程合成运行时由合成线程释放它自己的上下文的纹理
+     */
+    void ReleaseCachedResources();
+    
+    /**
+     * @brief 用示例组件树预热着色器
+     * 在 RenderContext::WarmUpShaders 的基础图元之外，再用一组 Box（边框、圆角、变换、
+     * 裁剪、透明度分组）分别走一遍立即绘制和批处理路径，启动时调用一次即可
+     * @param context 已初始化的渲染上下文
+     * @return 是否执行了预热
+     */
+    static bool WarmUpShaders(KiUI::graphics::RenderContext& context);
+    
     /**
      * @brief 运行渲染循环
      * 管理整个渲染循环，包括 BeginFrame、Render、EndFrame 和事件处理
      * 开发者无需自己管理 while 循环
+     * 窗口隐藏或最小化时不再绘制，只等待事件；所有窗口都隐藏时释放缓存的图层
+     * 没有需要绘制的内容时（见 NeedsFrame）跳过整帧，最多等待一个帧预算的时间处理事件和主线程任务
+     * 启用线程合成时绘制和交换缓冲区在合成线程上进行（见 SetThreadedCompositingEnabled）
      * @param renderSurface 渲染表面
      * @param window 窗口
      * @param windowManager 窗口管理器
@@ -85,9 +315,198 @@ private:
      * @param offsetX 父组件的 x 偏移
      * @param offsetY 父组件的 y 偏移
      */
-    void RenderElement(boost::shared_ptr<VisualElement> element, SkCanvas* canvas, float offsetX, float offsetY);
+    void RenderElement(boost::shared_ptr<VisualElement> element, SkCanvas* canvas, float offsetX, float offsetY,
+                       bool asLayerContent = false);
+    
+    /**
+     * @brief 递归记录组件到命令缓冲区（矩阵在软件中累积，不修改画布状态）
+     * @param element 要记录的组件
+     * @param canvas Skia 画布（组件不支持 Record 或需要裁剪时使用）
+     * @param parentMatrix 父组件局部空间到设备空间的矩阵
+     * @param deviceClip 当前设备空间裁剪区域（保守的包围盒），用于剔除不可见子树
+     */
+    void RecordElement(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas,
+                       const SkMatrix& parentMatrix, const SkRect& deviceClip, bool asGroupContent = false);
+    
+    /**
+     * @brief 以透明度分组方式绘制组件：整棵子树先以不透明方式绘制到离屏图层，再整体乘以透明度合成
+     * 子树内容版本未变且设备矩阵只差整数平移时直接复用上次的图层
+     * @param element 使用分组透明度的组件
+     * @param canvas Skia 画布
+     * @param parentMatrix 父组件局部空间到设备空间的矩阵
+     * @param matrix 组件局部空间到设备空间的矩阵
+     * @param deviceClip 当前设备空间裁剪区域
+     */
+    void DrawGroupLayer(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas,
+                        const SkMatrix& parentMatrix, const SkMatrix& matrix, const SkRect& deviceClip);
+    
+    /**
+     * @brief 以合成层方式绘制组件
+     * 子树内容版本未变时复用上次录制的合成层，否则在组件局部空间重新录制整棵子树；
+     * 合成层的光栅化和按图层属性合成都推迟到 drawable 回放时
+     * @param element 有合成层属性的组件
+     * @param canvas Skia 画布
+     * @param matrix 组件局部空间到设备空间的矩阵
+     */
+    void DrawCompositorLayer(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas, const SkMatrix& matrix);
+    
+    /**
+     * @brief 组件本帧是否有合成层属性
+     */
+    bool HasCompositorLayer(const VisualElement* element) const {
+        return !compositorLayerSet_.empty() && compositorLayerSet_.count(element) != 0;
+    }
+    
+    /**
+     * @brief 丢弃一个不再使用的 drawable：线程合成运行时交给合成线程释放（可能持有它的 GPU 图片）
+     */
+    void RetireDrawable(sk_sp<SkDrawable> drawable);
+    
+    /**
+     * @brief 线程合成模式的渲染循环（UI 线程部分）
+     */
+    void RunThreaded(boost::shared_ptr<KiUI::graphics::RenderSurface> renderSurface,
+                     boost::shared_ptr<KiUI::foundation::Window> window,
+                     KiUI::foundation::WindowManager& windowManager);
+    
+    /**
+     * @brief 通过滚动图层绘制滚动容器的子元素
+     * 图层覆盖容器的整个视口（设备空间）。容器版本未变且滚动只带来整数像素平移时，
+     * 把上一帧的图层平移后复制到另一块表面，只光栅化新露出的区域；
+     * 容器版本变化但能给出变化范围（GetChildDamage）时同样平移复用，再重新绘制变化的区域；否则整个图层重新绘制
+     * @param element 滚动容器
+     * @param canvas Skia 画布
+     * @param matrix 容器局部空间到设备空间的矩阵
+     * @param scroll 容器的子元素滚动偏移
+     * @param deviceClip 当前设备空间裁剪区域
+     */
+    void DrawScrollLayer(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas,
+                         const SkMatrix& matrix, const SkPoint& scroll, const SkRect& deviceClip);
+    
+    /**
+     * @brief 清空滚动图层中的一块区域并重新绘制容器的子元素
+     * @param element 滚动容器
+     * @param layerCanvas 图层画布
+     * @param contentMatrix 子元素父空间（已包含滚动偏移）到图层空间的矩阵
+     * @param area 图层空间中需要重新绘制的区域
+     */
+    void RasterizeScrollArea(const boost::shared_ptr<VisualElement>& element, SkCanvas* layerCanvas,
+                             const SkMatrix& contentMatrix, const SkIRect& area);
+    
+    /**
+     * @brief 遮挡预处理：按逆绘制顺序遍历，记录被后绘制的不透明区域完全覆盖的组件
+     * @param element 要处理的组件
+     * @param parentMatrix 父组件局部空间到设备空间的矩阵
+     * @param deviceClip 当前设备空间裁剪区域
+     */
+    void CollectOcclusion(const boost::shared_ptr<VisualElement>& element,
+                          const SkMatrix& parentMatrix, const SkRect& deviceClip);
+    
+    /**
+     * @brief 组件整棵子树是否被遮挡
+     */
+    bool IsSubtreeOccluded(const VisualElement* element) const {
+        return !occludedSubtrees_.empty() && occludedSubtrees_.count(element) != 0;
+    }
+    
+    /**
+     * @brief 组件自身的绘制是否被遮挡（子元素可能仍然可见）
+     */
+    bool IsElementOccluded(const VisualElement* element) const {
+        return !occludedElements_.empty() && occludedElements_.count(element) != 0;
+    }
+    
+    /**
+     * @brief 提交命令缓冲区并累加本帧统计
+     * @param canvas Skia 画布
+     */
+    void FlushCommands(SkCanvas* canvas);
     
     boost::shared_ptr<VisualElement> root_;
+    CompositionClock clock_;
+    AnimationEngine animations_;
+    FrameStatistics frameStatistics_;
+    KiUI::graphics::DrawCommandBuffer commandBuffer_;
+    KiUI::graphics::DrawCommandBuffer::Stats batchStats_;
+    size_t culledCount_ = 0;
+    bool batchingEnabled_ = true;
+    
+    // 上一次布局的视口，用于在约束不变时跳过布局
+    bool layoutValid_ = false;
+    float layoutWidth_ = 0.0f;
+    float layoutHeight_ = 0.0f;
+    
+    // 帧管线：组件树之外需要绘制的原因，以及命中测试版本（见 GetHitTestVersion）
+    bool frameRequested_ = true;
+    uint64_t hitTestVersion_ = 0;
+    
+    // 遮挡剔除（每帧重建）
+    SkRegion occluderRegion_;
+    std::unordered_set<const VisualElement*> occludedSubtrees_;
+    std::unordered_set<const VisualElement*> occludedElements_;
+    size_t occludedCount_ = 0;
+    bool occlusionCullingEnabled_ = true;
+    
+    // 透明度分组的离屏图层缓存（设备空间）
+    struct GroupLayer {
+        boost::weak_ptr<VisualElement> element;
+        sk_sp<SkImage> image;
+        SkMatrix matrix;              // 渲染图层时组件的设备矩阵
+        SkIRect bounds;               // 图层在设备空间中的位置
+        uint64_t version = 0;         // 渲染图层时的子树内容版本
+        uint64_t lastUsedFrame = 0;
+    };
+    static constexpr int kMaxGroupLayerSize = 4096;     // 超过该尺寸时退化为每帧 saveLayer
+    static constexpr uint64_t kGroupLayerKeepFrames = 30; // 未使用的图层保留的帧数
+    std::unordered_map<const VisualElement*, GroupLayer> groupLayers_;
+    uint64_t frameIndex_ = 0;
+    GrDirectContext* directContext_ = nullptr; // 最近一次 GPU 绘制使用的上下文，缓存纹理属于它
+    size_t groupLayerHits_ = 0;
+    size_t groupLayerRenders_ = 0;
+    
+    // 滚动容器的图层缓存（设备空间），两块表面交替使用：平移复制时源图像和目标表面不能是同一块
+    struct ScrollLayer {
+        boost::weak_ptr<VisualElement> element;
+        sk_sp<SkSurface> surfaces[2];
+        int front = 0;                // image 来自哪一块表面
+        sk_sp<SkImage> image;
+        SkMatrix contentMatrix;       // 绘制图层时子元素父空间到设备空间的矩阵（包含滚动偏移）
+        SkIRect bounds;               // 图层在设备空间中的位置（容器视口）
+        uint64_t version = 0;         // 绘制图层时容器的子树内容版本
+        uint64_t lastUsedFrame = 0;
+    };
+    static constexpr int kMaxScrollLayerSize = 4096;    // 超过该尺寸时每帧直接绘制
+    std::unordered_map<const VisualElement*, ScrollLayer> scrollLayers_;
+    size_t scrollLayerHits_ = 0;
+    size_t scrollLayerScrolls_ = 0;
+    size_t scrollLayerDamageUpdates_ = 0;
+    size_t scrollLayerRenders_ = 0;
+    uint64_t scrollLayerPixels_ = 0;
+    
+    // 合成层（组件局部空间录制的子树，回放时光栅化并按合成器动画的值合成）
+    struct CompositorLayerEntry {
+        boost::weak_ptr<VisualElement> element;
+        sk_sp<CompositorLayer> layer;
+        uint64_t version = 0;         // 录制时的子树内容版本
+        float paintOpacity = 1.0f;    // 录制时组件自身绘制使用的透明度
+        uint64_t lastUsedFrame = 0;
+    };
+    // 回放可能发生在合成线程上，计数器与 drawable 共享
+    friend class CompositorLayer;
+    struct CompositorCounters {
+        std::atomic<uint64_t> rasterizations{0};
+        std::atomic<uint64_t> composites{0};
+    };
+    CompositorAnimator compositor_;
+    std::unordered_map<const VisualElement*, CompositorLayerEntry> compositorLayers_;
+    std::unordered_set<const VisualElement*> compositorLayerSet_;  // 每帧开始时从 compositor_ 取得
+    boost::shared_ptr<CompositorCounters> compositorCounters_;
+    size_t compositorLayerRecords_ = 0;
+    bool threadedCompositing_ = false;
+    
+    // 线程合成运行期间的共享状态（见 SceneRenderer.cpp）
+    struct CompositorThread;
+    boost::scoped_ptr<CompositorThread> compositorThread_;
 };
 
 } // namespace widget
@@ -0,0 +1,138 @@
+#ifndef SCENE_SERIALIZER_HPP
+#define SCENE_SERIALIZER_HPP
+#pragma once
+
+#include "VisualElement.hpp"
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/make_shared.hpp>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 二进制场景文件头
+ * 文件布局：SceneFileHeader + nodeCount 个 SceneNodeRecord（先序遍历顺序）
+ * 所有字段均为小端序、4 字节对齐，可以直接从内存映射中读取
+ */
+struct SceneFileHeader {
+    char magic[4];          // "KISC"
+    uint32_t version;       // 格式版本，见 SceneSerializer::FormatVersion
+    uint32_t nodeCount;     // 节点记录数量
+    uint32_t recordSize;    // sizeof(SceneNodeRecord)，用于校验
+};
+
+/**
+ * @brief 二进制场景节点记录
+ * 保存一个元素的类型、子元素数量、样式以及静态布局提示（left/top）
+ */
+struct SceneNodeRecord {
+    uint32_t typeId;        // 通过 SceneSerializer::RegisterElementType 注册的类型 ID
+    uint32_t childCount;    // 直接子元素数量，子元素记录紧跟在当前记录之后
+    float width;            // 显式宽度，自动尺寸时为 0
+    float height;           // 显式高度，自动尺寸时为 0
+    float left;
+    float top;
+    float margin[4];        // Top, Bottom, Left, Right
+    float padding[4];       // Top, Bottom, Left, Right
+    float borderWidth[4];   // Top, Bottom, Left, Right
+    float borderRadius[4];  // TopLeft, TopRight, BottomLeft, BottomRight
+    uint32_t backgroundColor;
+    uint32_t foregroundColor;
+    uint32_t borderColor;
+    float opacity;
+    float transform[9];     // SkMatrix 的 9 个元素
+    uint8_t alignment;
+    uint8_t justification;
+    uint8_t visible;
+    uint8_t explicitSize;   // SceneSizeFlags 位掩码，未置位的维度加载后保持自动尺寸
+};
+
+/**
+ * @brief SceneNodeRecord::explicitSize 的位定义
+ */
+enum SceneSizeFlags : uint8_t {
+    SceneExplicitWidth = 1 << 0,
+    SceneExplicitHeight = 1 << 1
+};
+
+static_assert(std::is_trivially_copyable<SceneFileHeader>::value, "SceneFileHeader must be trivially copyable");
+static_assert(std::is_trivially_copyable<SceneNodeRecord>::value, "SceneNodeRecord must be trivially copyable");
+static_assert(sizeof(SceneFileHeader) == 16, "SceneFileHeader layout changed");
+static_assert(sizeof(SceneNodeRecord) % 4 == 0, "SceneNodeRecord must stay 4-byte aligned");
+
+/**
+ * @brief SceneSerializer - 二进制场景序列化器
+ * 将任意 VisualElement 树保存为紧凑的二进制格式，并通过内存映射快速加载。
+ * 加载时所有样式在批量更新（BeginUpdate/EndUpdate）中写入，子元素按父节点一次性挂接，
+ * 避免逐个 setter 触发 UpdateYogaNode。
+ */
+class SceneSerializer {
+public:
+    typedef boost::function<boost::shared_ptr<VisualElement>()> ElementFactory;
+    
+    static constexpr uint32_t FormatVersion = 2;
+    static constexpr uint32_t BoxTypeId = 1;
+    
+    /**
+     * @brief 注册可序列化的元素类型
+     * @tparam T 元素类型（必须派生自 VisualElement 且可默认构造）
+     * @param typeId 写入文件的类型 ID（0 保留）
+     */
+    template<typename T>
+    static void RegisterElementType(uint32_t typeId) {
+        static_assert(std::is_base_of<VisualElement, T>::value, "T must derive from VisualElement");
+        RegisterElementType(typeId, std::type_index(typeid(T)),
+                            []() -> boost::shared_ptr<VisualElement> { return boost::make_shared<T>(); });
+    }
+    
+    /**
+     * @brief 注册可序列化的元素类型（非模板版本）
+     * @param typeId 写入文件的类型 ID（0 保留）
+     * @param type 元素的运行时类型
+     * @param factory 创建元素实例的工厂函数
+     */
+    static void RegisterElementType(uint32_t typeId, std::type_index type, ElementFactory factory);
+    
+    /**
+     * @brief 将元素树序列化到内存缓冲区
+     * @param root 根元素
+     * @param buffer 输出缓冲区（会被覆盖）
+     * @return 成功返回 true；遇到未注册的元素类型时返回 false
+     */
+    static bool SaveToBuffer(const boost::shared_ptr<VisualElement>& root, std::vector<uint8_t>& buffer);
+    
+    /**
+     * @brief 将元素树保存到文件
+     * @param root 根元素
+     * @param path 文件路径
+     * @return 是否保存成功
+     */
+    static bool Save(const boost::shared_ptr<VisualElement>& root, const std::string& path);
+    
+    /**
+     * @brief 从内存中的场景数据构建元素树
+     * @param data 场景数据起始地址（需 4 字节对齐）
+     * @param size 数据字节数
+     * @return 根元素，数据无效时返回 nullptr
+     */
+    static boost::shared_ptr<VisualElement> LoadFromMemory(const void* data, size_t size);
+    
+    /**
+     * @brief 通过内存映射加载场景文件
+     * @param path 文件路径
+     * @return 根元素，失败时返回 nullptr
+     */
+    static boost::shared_ptr<VisualElement> Load(const std::string& path);
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // SCENE_SERIALIZER_HPP
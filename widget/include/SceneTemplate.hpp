@@ -0,0 +1,291 @@
+#ifndef SCENE_TEMPLATE_HPP
+#define SCENE_TEMPLATE_HPP
+#pragma once
+
+#include "Box.hpp"
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+namespace scene {
+
+/**
+ * @brief 编译期样式描述
+ * 可以作为非类型模板参数使用，通过链式 constexpr 方法构造，例如：
+ * Style{}.Size(120.0f, 32.0f).Background(SK_ColorBLUE).Padding(4.0f)
+ */
+struct Style {
+    float width = 0.0f;
+    float height = 0.0f;
+    float margin[4] = { 0.0f, 0.0f, 0.0f, 0.0f };   // Top, Bottom, Left, Right
+    float padding[4] = { 0.0f, 0.0f, 0.0f, 0.0f };  // Top, Bottom, Left, Right
+    float borderWidth = 0.0f;
+    float borderRadius = 0.0f;
+    SkColor backgroundColor = SK_ColorTRANSPARENT;
+    SkColor foregroundColor = SK_ColorBLACK;
+    SkColor borderColor = SK_ColorBLACK;
+    float opacity = 1.0f;
+    Alignment alignment = Alignment::Stretch;
+    Justification justification = Justification::Start;
+    bool visible = true;
+    
+    constexpr Style Size(float w, float h) const { Style s = *this; s.width = w; s.height = h; return s; }
+    constexpr Style Margin(float all) const { return Margin(all, all, all, all); }
+    constexpr Style Margin(float top, float bottom, float left, float right) const {
+        Style s = *this; s.margin[0] = top; s.margin[1] = bottom; s.margin[2] = left; s.margin[3] = right; return s;
+    }
+    constexpr Style Padding(float all) const { return Padding(all, all, all, all); }
+    constexpr Style Padding(float top, float bottom, float left, float right) const {
+        Style s = *this; s.padding[0] = top; s.padding[1] = bottom; s.padding[2] = left; s.padding[3] = right; return s;
+    }
+    constexpr Style Border(float w, SkColor color) const { Style s = *this; s.borderWidth = w; s.borderColor = color; return s; }
+    constexpr Style Radius(float r) const { Style s = *this; s.borderRadius = r; return s; }
+    constexpr Style Background(SkColor color) const { Style s = *this; s.backgroundColor = color; return s; }
+    constexpr Style Foreground(SkColor color) const { Style s = *this; s.foregroundColor = color; return s; }
+    constexpr Style Opacity(float value) const { Style s = *this; s.opacity = value; return s; }
+    constexpr Style Align(Alignment a) const { Style s = *this; s.alignment = a; return s; }
+    constexpr Style Justify(Justification j) const { Style s = *this; s.justification = j; return s; }
+    constexpr Style Visible(bool v) const { Style s = *this; s.visible = v; return s; }
+};
+
+/**
+ * @brief 编译期样式校验
+ */
+constexpr bool IsValidStyle(const Style& s) {
+    for (int i = 0; i < 4; ++i) {
+        if (s.padding[i] < 0.0f) return false;
+    }
+    return s.width >= 0.0f && s.height >= 0.0f &&
+           s.borderWidth >= 0.0f && s.borderRadius >= 0.0f &&
+           s.opacity >= 0.0f && s.opacity <= 1.0f;
+}
+
+/**
+ * @brief 场景模板使用的单块内存池
+ * 所有元素（含 shared_ptr 控制块）都从同一块预分配内存中切分，内存池随最后一个元素一起释放
+ */
+class SceneArenaBase {
+public:
+    virtual ~SceneArenaBase() = default;
+    
+    void* Allocate(size_t bytes) {
+        constexpr size_t alignment = alignof(std::max_align_t);
+        size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+        if (offset + bytes <= capacity_) {
+            used_ = offset + bytes;
+            return buffer_ + offset;
+        }
+        // 预估容量不足时退回到普通分配
+        return ::operator new(bytes);
+    }
+    
+    void Deallocate(void* p) {
+        auto* bytes = static_cast<unsigned char*>(p);
+        if (bytes < buffer_ || bytes >= buffer_ + capacity_) {
+            ::operator delete(p);
+        }
+        // 池内内存随内存池整体释放
+    }
+
+protected:
+    SceneArenaBase(unsigned char* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+private:
+    unsigned char* buffer_;
+    size_t capacity_;
+    size_t used_ = 0;
+};
+
+template<size_t Bytes>
+class SceneArena : public SceneArenaBase {
+public:
+    SceneArena() : SceneArenaBase(storage_, Bytes) {}
+private:
+    alignas(std::max_align_t) unsigned char storage_[Bytes];
+};
+
+/**
+ * @brief 基于 SceneArena 的分配器，供 boost::allocate_shared 使用
+ */
+template<typename T>
+class SceneArenaAllocator {
+public:
+    typedef T value_type;
+    
+    explicit SceneArenaAllocator(boost::shared_ptr<SceneArenaBase> arena) : arena_(std::move(arena)) {}
+    template<typename U>
+    SceneArenaAllocator(const SceneArenaAllocator<U>& other) : arena_(other.arena_) {}
+    
+    T* allocate(size_t n) { return static_cast<T*>(arena_->Allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t) { arena_->Deallocate(p); }
+    
+    template<typename U>
+    bool operator==(const SceneArenaAllocator<U>& other) const { return arena_ == other.arena_; }
+    template<typename U>
+    bool operator!=(const SceneArenaAllocator<U>& other) const { return arena_ != other.arena_; }
+
+private:
+    template<typename U> friend class SceneArenaAllocator;
+    boost::shared_ptr<SceneArenaBase> arena_;
+};
+
+/**
+ * @brief 单个元素在内存池中占用的字节数（含 allocate_shared 控制块的预留）
+ */
+constexpr size_t AlignedSlot(size_t elementBytes) {
+    constexpr size_t ControlBlockReserve = 96;
+    constexpr size_t alignment = alignof(std::max_align_t);
+    return (elementBytes + ControlBlockReserve + alignment - 1) / alignment * alignment;
+}
+
+typedef boost::shared_ptr<VisualElement> (*ElementMaker)(const SceneArenaAllocator<VisualElement>&);
+
+template<typename T>
+boost::shared_ptr<VisualElement> MakeElement(const SceneArenaAllocator<VisualElement>& allocator) {
+    return boost::allocate_shared<T>(SceneArenaAllocator<T>(allocator));
+}
+
+/**
+ * @brief 先序展开后的场景表（编译期生成）
+ */
+template<size_t N>
+struct FlatScene {
+    std::array<Style, N> styles{};
+    std::array<uint32_t, N> childCounts{};
+    std::array<uint32_t, N> subtreeSizes{};
+    std::array<ElementMaker, N> makers{};
+};
+
+template<typename T>
+struct IsSceneNode : std::false_type {};
+
+template<typename Element, Style S, typename... Children>
+struct ElementNode;
+
+template<typename Element, Style S, typename... Children>
+struct IsSceneNode<ElementNode<Element, S, Children...>> : std::true_type {};
+
+/**
+ * @brief 编译期场景节点
+ * @tparam Element 元素类型（必须派生自 VisualElement 且可默认构造）
+ * @tparam S 节点样式
+ * @tparam Children 子节点（ElementNode/Node）
+ */
+template<typename Element, Style S, typename... Children>
+struct ElementNode {
+    static_assert(std::is_base_of<VisualElement, Element>::value, "Element must derive from VisualElement");
+    static_assert(std::is_default_constructible<Element>::value, "Element must be default constructible");
+    static_assert(IsValidStyle(S), "Invalid scene style: sizes, paddings and borders must be >= 0 and opacity in [0, 1]");
+    static_assert((IsSceneNode<Children>::value && ...), "Scene children must be scene::Node/ElementNode types");
+    
+    typedef Element ElementType;
+    static constexpr Style NodeStyle = S;
+    static constexpr size_t ChildCount = sizeof...(Children);
+    static constexpr size_t NodeCount = 1 + (Children::NodeCount + ... + 0);
+    static constexpr size_t Depth = 1 + std::max({ size_t(0), Children::Depth... });
+    // 子树所需的内存池字节数：元素本体 + shared_ptr 控制块，按 max_align_t 对齐
+    static constexpr size_t ArenaBytes = AlignedSlot(sizeof(Element)) + (Children::ArenaBytes + ... + 0);
+    
+    template<size_t N>
+    static constexpr void Write(FlatScene<N>& flat, size_t& index) {
+        flat.styles[index] = S;
+        flat.childCounts[index] = static_cast<uint32_t>(ChildCount);
+        flat.subtreeSizes[index] = static_cast<uint32_t>(NodeCount);
+        flat.makers[index] = &MakeElement<Element>;
+        ++index;
+        (Children::Write(flat, index), ...);
+    }
+    
+    static constexpr FlatScene<NodeCount> MakeFlat() {
+        FlatScene<NodeCount> flat{};
+        size_t index = 0;
+        Write(flat, index);
+        return flat;
+    }
+};
+
+/**
+ * @brief 以 Box 为元素类型的场景节点
+ */
+template<Style S, typename... Children>
+using Node = ElementNode<Box, S, Children...>;
+
+/**
+ * @brief 把编译期样式写入元素（调用方需保证元素处于批量更新中）
+ */
+inline void ApplyStyle(VisualElement& element, const Style& s) {
+    element.SetWidth(s.width);
+    element.SetHeight(s.height);
+    element.SetMargin(widget::Margin::Top, s.margin[0]);
+    element.SetMargin(widget::Margin::Bottom, s.margin[1]);
+    element.SetMargin(widget::Margin::Left, s.margin[2]);
+    element.SetMargin(widget::Margin::Right, s.margin[3]);
+    element.SetPadding(widget::Padding::Top, s.padding[0]);
+    element.SetPadding(widget::Padding::Bottom, s.padding[1]);
+    element.SetPadding(widget::Padding::Left, s.padding[2]);
+    element.SetPadding(widget::Padding::Right, s.padding[3]);
+    element.SetBorderWidth(BorderWidth::All, s.borderWidth);
+    element.SetBorderRadius(BorderRadius::All, s.borderRadius);
+    element.SetBackgroundColor(s.backgroundColor);
+    element.SetForegroundColor(s.foregroundColor);
+    element.SetBorderColor(s.borderColor);
+    element.SetOpacity(s.opacity);
+    element.SetAlignment(s.alignment);
+    element.SetJustification(s.justification);
+    element.SetVisibility(s.visible);
+}
+
+/**
+ * @brief 实例化编译期场景模板
+ * 元素从一块预分配内存中创建，所有样式在一次批量更新中写入，
+ * 每个父节点按编译期已知的子节点数量一次性挂接子元素
+ * @tparam Root 根节点类型
+ * @return 根元素
+ */
+template<typename Root>
+boost::shared_ptr<typename Root::ElementType> Instantiate() {
+    static_assert(IsSceneNode<Root>::value, "Root must be a scene::Node/ElementNode type");
+    constexpr size_t N = Root::NodeCount;
+    static constexpr FlatScene<N> flat = Root::MakeFlat();
+    
+    boost::shared_ptr<SceneArenaBase> arena = boost::make_shared<SceneArena<Root::ArenaBytes>>();
+    SceneArenaAllocator<VisualElement> allocator(arena);
+    
+    std::array<boost::shared_ptr<VisualElement>, N> elements;
+    for (size_t i = 0; i < N; ++i) {
+        elements[i] = flat.makers[i](allocator);
+        elements[i]->BeginUpdate();
+        ApplyStyle(*elements[i], flat.styles[i]);
+    }
+    
+    for (size_t i = 0; i < N; ++i) {
+        if (flat.childCounts[i] == 0) {
+            continue;
+        }
+        std::vector<boost::shared_ptr<UIElement>> children;
+        children.reserve(flat.childCounts[i]);
+        for (size_t child = i + 1; children.size() < flat.childCounts[i]; child += flat.subtreeSizes[child]) {
+            children.push_back(elements[child]);
+        }
+        elements[i]->ReplaceChildren(children);
+    }
+    
+    for (auto& element : elements) {
+        element->EndUpdate();
+    }
+    return boost::static_pointer_cast<typename Root::ElementType>(elements[0]);
+}
+
+} // namespace scene
+} // namespace widget
+} // namespace KiUI
+
+#endif // SCENE_TEMPLATE_HPP
@@ -0,0 +1,92 @@
+#ifndef SCROLL_VIEWER_HPP
+#define SCROLL_VIEWER_HPP
+#pragma once
+
+#include "Box.hpp"
+#include <include/core/SkCanvas.h>
+#include <boost/shared_ptr.hpp>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief ScrollViewer 组件，在视口内滚动显示一个内容元素
+ * 内容按正常的 Yoga 布局排在视口内（滚动方向上不收缩，尺寸由内容决定），
+ * 滚动时不修改内容的位置、不触发布局：滚动偏移只在绘制和命中测试时作为子元素的平移。
+ * SceneRenderer 把内容缓存在视口大小的滚动图层中，内容没有变化时滚动只平移图层，
+ * 再光栅化新露出的一条区域；内容变化后整个图层重新绘制。
+ * 滚动偏移取整到像素，保证平移后的图层与重新绘制的结果逐像素一致
+ */
+class ScrollViewer : public Box {
+public:
+    ScrollViewer();
+    virtual ~ScrollViewer();
+
+    /**
+     * @brief 设置内容元素（替换已有的子元素）
+     */
+    void SetContent(boost::shared_ptr<VisualElement> content);
+
+    /**
+     * @brief 获取内容元素
+     */
+    boost::shared_ptr<VisualElement> GetContent() const;
+
+    /**
+     * @brief 设置滚动偏移，限制在内容范围内并取整到像素
+     * 只让父级内容失效（自身版本不变，滚动图层可以复用），不触发布局
+     * @param x 横向偏移
+     * @param y 纵向偏移
+     */
+    void SetScrollOffset(float x, float y);
+
+    /**
+     * @brief 相对当前位置滚动（滚轮、触控板）
+     */
+    void ScrollBy(float dx, float dy);
+
+    /**
+     * @brief 获取横向滚动偏移
+     */
+    float GetScrollX() const { return scrollX_; }
+
+    /**
+     * @brief 获取纵向滚动偏移
+     */
+    float GetScrollY() const { return scrollY_; }
+
+    /**
+     * @brief 最大横向滚动偏移（内容宽度超出视口的部分）
+     */
+    float GetMaxScrollX() const;
+
+    /**
+     * @brief 最大纵向滚动偏移（内容高度超出视口的部分）
+     */
+    float GetMaxScrollY() const;
+
+    /**
+     * @brief 子元素按滚动偏移平移
+     */
+    bool GetChildScrollOffset(SkPoint* offset) const override;
+
+protected:
+    /**
+     * @brief 布局内容后重新限制滚动偏移（内容可能变小）
+     */
+    void LayoutChildren(float width, float height) override;
+
+private:
+    /**
+     * @brief 把偏移限制在内容范围内并取整，返回偏移是否改变
+     */
+    bool ApplyScrollOffset(float x, float y);
+
+    float scrollX_ = 0.0f;
+    float scrollY_ = 0.0f;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // SCROLL_VIEWER_HPP
@@ -0,0 +1,115 @@
+#ifndef TEXT_HPP
+#define TEXT_HPP
+#pragma once
+
+#include "VisualElement.hpp"
+#include <TextEngine.hpp>
+#include <include/core/SkCanvas.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief Text 组件，显示一行文字
+ * 文字通过 graphics::TextEngine 用 HarfBuzz 排版，结果在引擎中按（文字、字体、字号、特性）缓存，
+ * 相同的标签在所有元素之间只排版一次；元素自己也持有排版结果，内容不变时不再查询缓存。
+ * 字形光栅化进共享的 graphics::GlyphAtlas，整段文字用一次绘制调用完成。
+ * 没有设置宽高时由 Yoga 按内容测量，测量结果缓存在 TextMeasureCache 中。
+ * 文字颜色使用 ForegroundColor
+ */
+class Text : public VisualElement {
+public:
+    /**
+     * @brief 默认字号（像素）
+     */
+    static constexpr float kDefaultFontSize = 14.0f;
+
+    Text();
+    virtual ~Text();
+
+    /**
+     * @brief 设置文字
+     * @param text UTF-8 文字
+     */
+    void SetText(const std::string& text);
+
+    /**
+     * @brief 获取文字
+     */
+    const std::string& GetText() const { return text_; }
+
+    /**
+     * @brief 设置字体
+     * @param fontId graphics::TextEngine::LoadFont 返回的字体 id，-1 表示默认字体
+     */
+    void SetFont(int fontId);
+
+    /**
+     * @brief 获取字体 id（-1 表示默认字体）
+     */
+    int GetFont() const { return fontId_; }
+
+    /**
+     * @brief 设置字号
+     * @param fontSize 字号（像素）
+     */
+    void SetFontSize(float fontSize);
+
+    /**
+     * @brief 获取字号
+     */
+    float GetFontSize() const { return fontSize_; }
+
+    /**
+     * @brief 设置 OpenType 特性（例如 "tnum" 等宽数字、"kern=0" 关闭字距调整）
+     * @param features 特性列表
+     */
+    void SetFontFeatures(const std::vector<std::string>& features);
+
+    /**
+     * @brief 获取 OpenType 特性
+     */
+    const std::vector<std::string>& GetFontFeatures() const { return features_; }
+
+    /**
+     * @brief 获取排版结果（需要时重新排版）
+     * @return 排版结果，没有可用字体时返回空指针
+     */
+    boost::shared_ptr<const graphics::ShapedRun> GetShapedRun();
+
+    /**
+     * @brief 渲染文字（基线位于元素顶部下方 ascent 处）
+     * @param canvas 画布
+     */
+    virtual void Render(SkCanvas* canvas) override;
+
+protected:
+    /**
+     * @brief 按内容测量尺寸（Yoga 回调），先查 TextMeasureCache
+     * 宽度为排版宽度（向上取整），高度为行高；按约束模式截断
+     */
+    virtual SkSize MeasureContent(float width, YGMeasureMode widthMode, float height, YGMeasureMode heightMode) override;
+
+private:
+    /**
+     * @brief 内容或字体变化后丢弃排版结果，并让 Yoga 重新测量
+     */
+    void InvalidateShape();
+
+    std::string text_;
+    int fontId_ = -1;
+    float fontSize_ = kDefaultFontSize;
+    std::vector<std::string> features_;
+    uint64_t contentHash_;      // 文字内容哈希，测量时不必每次重新计算
+    uint64_t featuresHash_;
+    boost::shared_ptr<const graphics::ShapedRun> run_;  // 排版结果（与其他显示相同文字的元素共享）
+    bool shapeValid_ = false;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // TEXT_HPP
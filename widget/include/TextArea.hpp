@@ -0,0 +1,189 @@
+#ifndef TEXT_AREA_HPP
+#define TEXT_AREA_HPP
+#pragma once
+
+#include "VisualElement.hpp"
+#include "TextBuffer.hpp"
+#include <TextEngine.hpp>
+#include <include/core/SkCanvas.h>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief TextArea 组件，显示和编辑多行文字（日志、配置文件等大文档）
+ * 文字存放在 TextBuffer（piece table）中，按换行分成段落，每个段落单独排版和断行：
+ * 编辑只让涉及的段落失效，渲染时只排版可见的段落，离开可见区域的段落只保留行数。
+ * 没有排版过的段落按一行估算高度，第一次显示时再修正。
+ * 元素尺寸由布局决定（视口），内容通过 SetScrollOffset 在视口内纵向滚动；文字颜色使用 ForegroundColor
+ */
+class TextArea : public VisualElement {
+public:
+    /**
+     * @brief 默认字号（像素）
+     */
+    static constexpr float kDefaultFontSize = 14.0f;
+
+    /**
+     * @brief 排版统计
+     */
+    struct Stats {
+        uint64_t paragraphsBroken = 0;  ///< 累计排版、断行的段落数
+        size_t shapedParagraphs = 0;    ///< 当前持有排版结果的段落数
+    };
+
+    TextArea();
+    virtual ~TextArea();
+
+    /**
+     * @brief 替换全部文字（所有段落重新排版）
+     * @param text UTF-8 文字
+     */
+    void SetText(const std::string& text);
+
+    /**
+     * @brief 获取全部文字
+     */
+    std::string GetText() const { return buffer_.GetText(); }
+
+    /**
+     * @brief 获取文字缓冲区
+     */
+    const TextBuffer& GetBuffer() const { return buffer_; }
+
+    /**
+     * @brief 插入文字，只有插入位置所在的段落需要重新断行
+     * @param offset 插入位置（UTF-8 字节偏移）
+     * @param text 文字
+     */
+    void Insert(size_t offset, const std::string& text);
+
+    /**
+     * @brief 删除文字，删除范围内的段落合并为一个并重新断行
+     * @param offset 起始偏移（UTF-8 字节偏移）
+     * @param length 长度
+     */
+    void Erase(size_t offset, size_t length);
+
+    /**
+     * @brief 段落数
+     */
+    size_t GetParagraphCount() const { return paragraphs_.size(); }
+
+    /**
+     * @brief 设置字体
+     * @param fontId graphics::TextEngine::LoadFont 返回的字体 id，-1 表示默认字体
+     */
+    void SetFont(int fontId);
+
+    /**
+     * @brief 获取字体 id（-1 表示默认字体）
+     */
+    int GetFont() const { return fontId_; }
+
+    /**
+     * @brief 设置字号
+     * @param fontSize 字号（像素）
+     */
+    void SetFontSize(float fontSize);
+
+    /**
+     * @brief 获取字号
+     */
+    float GetFontSize() const { return fontSize_; }
+
+    /**
+     * @brief 设置是否按视口宽度自动换行
+     */
+    void SetWrap(bool wrap);
+
+    /**
+     * @brief 是否自动换行
+     */
+    bool GetWrap() const { return wrap_; }
+
+    /**
+     * @brief 设置纵向滚动位置
+     * @param offset 内容顶部被滚出视口的距离（像素）
+     */
+    void SetScrollOffset(float offset);
+
+    /**
+     * @brief 获取纵向滚动位置
+     */
+    float GetScrollOffset() const { return scrollOffset_; }
+
+    /**
+     * @brief 行高（按像素取整）
+     */
+    float GetLineHeight() const;
+
+    /**
+     * @brief 内容总高度（含内边距，未排版的段落按一行估算）
+     */
+    float GetContentHeight();
+
+    /**
+     * @brief 获取排版统计
+     */
+    Stats GetStats() const;
+
+    /**
+     * @brief 渲染可见的行
+     * @param canvas 画布
+     */
+    virtual void Render(SkCanvas* canvas) override;
+
+private:
+    struct Paragraph {
+        uint32_t lineCount = 0;     // 断行后的行数，0 表示还没有断行（按一行估算）
+        std::vector<boost::shared_ptr<const graphics::ShapedRun>> lines;  // 只有可见的段落持有
+    };
+
+    /**
+     * @brief 段落 first 被编辑：它后面 removed 个段落并入它，之后新增 inserted 个段落
+     */
+    void InvalidateParagraphs(size_t first, size_t removed, size_t inserted);
+    /**
+     * @brief 丢弃所有段落的排版结果（字体、字号或换行宽度变化后）
+     */
+    void ResetLayout();
+    /**
+     * @brief 排版一个段落并按宽度断行
+     * @param wrapWidth 换行宽度，0 表示不换行
+     */
+    void BreakParagraph(size_t index, float wrapWidth);
+    /**
+     * @brief 补全失效部分的行号前缀和
+     */
+    void EnsureLineIndex();
+    /**
+     * @brief 查找包含第 line 行（断行后的行）的段落
+     */
+    size_t FindParagraphAtLine(size_t line) const;
+    int ResolveFont() const;
+
+    TextBuffer buffer_;
+    std::vector<Paragraph> paragraphs_;
+    std::vector<size_t> lineStarts_;    // lineStarts_[i] 为段落 i 的首行行号，最后一项为总行数
+    size_t lineIndexValid_ = 0;         // lineStarts_[0..lineIndexValid_] 有效
+    int fontId_ = -1;
+    float fontSize_ = kDefaultFontSize;
+    bool wrap_ = true;
+    float scrollOffset_ = 0.0f;
+    float layoutWidth_ = -1.0f;         // 当前排版结果使用的换行宽度
+    int layoutFont_ = -1;               // 当前排版结果使用的字体（已解析默认字体）
+    size_t shapedFirst_ = 0;            // 持有排版结果的段落范围 [shapedFirst_, shapedLast_)
+    size_t shapedLast_ = 0;
+    uint64_t paragraphsBroken_ = 0;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // TEXT_AREA_HPP
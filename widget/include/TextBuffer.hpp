@@ -0,0 +1,133 @@
+#ifndef TEXT_BUFFER_HPP
+#define TEXT_BUFFER_HPP
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 可编辑文字缓冲区（piece table）
+ * 原始文字和追加文字各存一份且不再移动，文档由一串指向这两份数据的片段组成，
+ * 插入、删除只拆分或调整片段，不复制文字；连续输入会并入同一个片段。
+ * 两份数据的换行位置各自建有有序索引，片段内的换行数和行首位置用二分查找得到，
+ * 行号与偏移互相换算只需要遍历片段。偏移和长度都以 UTF-8 字节计
+ */
+class TextBuffer {
+public:
+    TextBuffer();
+    explicit TextBuffer(std::string text);
+
+    /**
+     * @brief 替换全部内容
+     */
+    void SetText(std::string text);
+
+    /**
+     * @brief 获取全部内容
+     */
+    std::string GetText() const;
+
+    /**
+     * @brief 获取一段内容
+     * @param offset 起始偏移
+     * @param length 长度（超出末尾时截断）
+     */
+    std::string GetText(size_t offset, size_t length) const;
+
+    /**
+     * @brief 内容长度（字节）
+     */
+    size_t GetLength() const { return length_; }
+
+    /**
+     * @brief 行数（换行符个数 + 1）
+     */
+    size_t GetLineCount() const { return newlineCount_ + 1; }
+
+    /**
+     * @brief 片段数量
+     */
+    size_t GetPieceCount() const { return pieces_.size(); }
+
+    /**
+     * @brief 插入文字
+     * @param offset 插入位置（超出末尾时追加到末尾）
+     * @param text 文字
+     */
+    void Insert(size_t offset, const std::string& text);
+
+    /**
+     * @brief 删除文字
+     * @param offset 起始偏移
+     * @param length 长度（超出末尾时截断）
+     */
+    void Erase(size_t offset, size_t length);
+
+    /**
+     * @brief 获取行首偏移
+     * @param line 行号（超出时返回内容长度）
+     */
+    size_t GetLineStart(size_t line) const;
+
+    /**
+     * @brief 获取行的长度（不含换行符）
+     */
+    size_t GetLineLength(size_t line) const;
+
+    /**
+     * @brief 获取一行文字（不含换行符）
+     */
+    std::string GetLineText(size_t line) const;
+
+    /**
+     * @brief 获取偏移所在的行号
+     */
+    size_t GetLineFromOffset(size_t offset) const;
+
+private:
+    enum class Source : uint8_t {
+        Original,
+        Added,
+    };
+
+    struct Piece {
+        Source source = Source::Original;
+        size_t start = 0;       // 在来源数据中的起始位置
+        size_t length = 0;
+        size_t newlines = 0;    // 片段内的换行符个数
+    };
+
+    const std::string& GetSource(Source source) const;
+    const std::vector<size_t>& GetNewlines(Source source) const;
+    size_t CountNewlines(Source source, size_t start, size_t length) const;
+    Piece MakePiece(Source source, size_t start, size_t length) const;
+    /**
+     * @brief 查找包含偏移的片段
+     * @param offset 文档偏移
+     * @param pieceOffset 输出偏移在片段内的位置
+     * @return 片段索引，offset 等于内容长度时返回片段数量
+     */
+    size_t FindPiece(size_t offset, size_t* pieceOffset) const;
+    /**
+     * @brief 在片段内部拆分，返回后半段的索引
+     */
+    size_t SplitPiece(size_t index, size_t at);
+
+    std::string original_;
+    std::string added_;
+    std::vector<size_t> originalNewlines_;  // 换行符在 original_ 中的位置（升序）
+    std::vector<size_t> addedNewlines_;     // 换行符在 added_ 中的位置（追加时保持升序）
+    std::vector<Piece> pieces_;
+    size_t length_ = 0;
+    size_t newlineCount_ = 0;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // TEXT_BUFFER_HPP
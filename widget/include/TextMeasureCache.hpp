@@ -0,0 +1,129 @@
+#ifndef TEXT_MEASURE_CACHE_HPP
+#define TEXT_MEASURE_CACHE_HPP
+#pragma once
+
+#include <include/core/SkSize.h>
+#include <yoga/Yoga.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+/**
+ * @brief 文字测量缓存
+ * 以（内容哈希、字体、字号、特性、宽度约束、测量模式）为键缓存 Yoga 测量结果。
+ * Yoga 在一次布局中会用不同的约束多次测量同一个节点，表格里也常有大量相同的自适应标签，
+ * 这些测量只有第一次需要排版。按 LRU 淘汰，可以在任意线程访问
+ */
+class TextMeasureCache {
+public:
+    /**
+     * @brief 默认容量（条目数）
+     */
+    static constexpr size_t kDefaultCapacity = 8192;
+
+    /**
+     * @brief 缓存键
+     */
+    struct Key {
+        uint64_t contentHash = 0;   ///< 文字内容哈希（HashContent）
+        uint64_t featuresHash = 0;  ///< OpenType 特性哈希（HashFeatures）
+        int fontId = -1;            ///< 实际使用的字体 id（已解析默认字体）
+        float fontSize = 0.0f;
+        float width = 0.0f;         ///< 宽度约束，模式为 Undefined 时为 0
+        YGMeasureMode widthMode = YGMeasureModeUndefined;
+
+        bool operator==(const Key& other) const {
+            return contentHash == other.contentHash && featuresHash == other.featuresHash &&
+                   fontId == other.fontId && fontSize == other.fontSize &&
+                   width == other.width && widthMode == other.widthMode;
+        }
+    };
+
+    /**
+     * @brief 缓存统计
+     */
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t entryCount = 0;
+    };
+
+    static TextMeasureCache& GetSharedInstance();
+
+    /**
+     * @brief 构造缓存键，宽度约束按测量模式归一化
+     */
+    static Key MakeKey(uint64_t contentHash, uint64_t featuresHash, int fontId, float fontSize,
+                       float width, YGMeasureMode widthMode);
+
+    /**
+     * @brief 计算文字内容哈希（FNV-1a 64）
+     */
+    static uint64_t HashContent(const std::string& text);
+
+    /**
+     * @brief 计算 OpenType 特性列表的哈希
+     */
+    static uint64_t HashFeatures(const std::vector<std::string>& features);
+
+    /**
+     * @brief 查找测量结果
+     * @return 是否命中
+     */
+    bool Find(const Key& key, SkSize* size);
+
+    /**
+     * @brief 写入测量结果
+     */
+    void Insert(const Key& key, const SkSize& size);
+
+    /**
+     * @brief 设置容量，超出的条目立即淘汰
+     */
+    void SetCapacity(size_t entries);
+
+    /**
+     * @brief 清空缓存（例如字体被替换后）
+     */
+    void Clear();
+
+    /**
+     * @brief 获取统计信息
+     */
+    Stats GetStats() const;
+
+private:
+    TextMeasureCache() = default;
+    TextMeasureCache(const TextMeasureCache&) = delete;
+    TextMeasureCache& operator=(const TextMeasureCache&) = delete;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    using EntryList = std::list<std::pair<Key, SkSize>>;
+
+    /**
+     * @brief 淘汰超出容量的条目（调用方持有锁）
+     */
+    void EvictLocked();
+
+    mutable std::mutex mutex_;
+    EntryList lru_;     // 头部是最近使用的条目
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+    size_t capacity_ = kDefaultCapacity;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // TEXT_MEASURE_CACHE_HPP
@@ -0,0 +1,322 @@
+#ifndef TILED_VIEW_HPP
+#define TILED_VIEW_HPP
+#pragma once
+
+#include "Box.hpp"
+#include <include/core/SkCanvas.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPicture.h>
+#include <include/core/SkRefCnt.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/signals2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+class GrDirectContext;
+
+namespace KiUI {
+namespace widget {
+
+class SceneRenderer;
+
+/**
+ * @brief TiledView 组件，平移、缩放显示一个很大的内容元素（画布、地图、文档）
+ * 内容子树变化后只录制一次 SkPicture；按当前缩放把内容切成固定大小的瓦片，
+ * 在 WindowManager 的后台线程池中回放图片光栅化，结果放进按字节预算 LRU 淘汰的瓦片缓存。
+ * 绘制时只合成已经就绪的瓦片，尚未就绪的瓦片先用其他缩放或旧内容的瓦片缩放填充，
+ * 就绪后再重新绘制，平移、缩放期间不会因为光栅化阻塞帧。
+ * 在 GPU 画布上绘制时，瓦片在主线程上传为纹理并和光栅图片一起缓存
+ */
+class TiledView : public Box {
+public:
+    /**
+     * @brief 默认瓦片边长（设备像素）
+     */
+    static constexpr int kDefaultTileSize = 256;
+
+    /**
+     * @brief 默认瓦片缓存预算（字节）
+     */
+    static constexpr size_t kDefaultTileBudget = 64 * 1024 * 1024;
+
+    /**
+     * @brief 同时在后台光栅化的瓦片数上限
+     */
+    static constexpr size_t kMaxPendingTiles = 8;
+
+    /**
+     * @brief 缩放范围
+     */
+    static constexpr float kMinZoom = 1.0f / 32.0f;
+    static constexpr float kMaxZoom = 32.0f;
+
+    /**
+     * @brief 统计信息（计数累计，缓存和排队为当前值）
+     */
+    struct Stats {
+        uint64_t pictureRecords = 0;    ///< 录制内容图片的次数
+        uint64_t tilesDrawn = 0;        ///< 绘制的就绪瓦片数
+        uint64_t tilesMissing = 0;      ///< 绘制时尚未就绪的瓦片数
+        uint64_t tilesRasterized = 0;   ///< 光栅化完成的瓦片数
+        uint64_t tilesUploaded = 0;     ///< 上传为纹理的瓦片数
+        uint64_t tilesEvicted = 0;      ///< 超出预算淘汰的瓦片数
+        size_t cachedTiles = 0;         ///< 缓存中的瓦片数
+        size_t cachedBytes = 0;         ///< 缓存占用的字节数
+        size_t pendingTiles = 0;        ///< 正在后台光栅化的瓦片数
+    };
+
+    TiledView();
+    virtual ~TiledView();
+
+    /**
+     * @brief 设置内容元素（替换已有的子元素）
+     */
+    void SetContent(boost::shared_ptr<VisualElement> content);
+
+    /**
+     * @brief 获取内容元素
+     */
+    boost::shared_ptr<VisualElement> GetContent() const;
+
+    /**
+     * @brief 设置视图偏移（缩放后的内容坐标），限制在内容范围内并取整到像素
+     * @param x 横向偏移
+     * @param y 纵向偏移
+     */
+    void SetViewOffset(float x, float y);
+
+    /**
+     * @brief 相对当前位置平移
+     */
+    void PanBy(float dx, float dy);
+
+    /**
+     * @brief 获取横向视图偏移
+     */
+    float GetViewX() const { return viewX_; }
+
+    /**
+     * @brief 获取纵向视图偏移
+     */
+    float GetViewY() const { return viewY_; }
+
+    /**
+     * @brief 设置缩放比例（以视图左上角为锚点），限制在 [kMinZoom, kMaxZoom]
+     */
+    void SetZoom(float zoom);
+
+    /**
+     * @brief 以组件内的一点为锚点缩放，锚点下的内容位置保持不变（滚轮、捏合缩放）
+     * @param zoom 新的缩放比例
+     * @param anchorX 锚点横坐标（组件局部坐标）
+     * @param anchorY 锚点纵坐标（组件局部坐标）
+     */
+    void ZoomAt(float zoom, float anchorX, float anchorY);
+
+    /**
+     * @brief 获取缩放比例
+     */
+    float GetZoom() const { return zoom_; }
+
+    /**
+     * @brief 最大横向视图偏移
+     */
+    float GetMaxViewX() const;
+
+    /**
+     * @brief 最大纵向视图偏移
+     */
+    float GetMaxViewY() const;
+
+    /**
+     * @brief 设置瓦片边长（设备像素），会清空瓦片缓存
+     */
+    void SetTileSize(int size);
+
+    /**
+     * @brief 获取瓦片边长
+     */
+    int GetTileSize() const { return tileSize_; }
+
+    /**
+     * @brief 设置瓦片缓存预算，超出的部分立即淘汰
+     * @param bytes 字节数，应至少能容纳一屏瓦片
+     */
+    void SetTileBudget(size_t bytes);
+
+    /**
+     * @brief 获取瓦片缓存预算
+     */
+    size_t GetTileBudget() const { return tileBudget_; }
+
+    /**
+     * @brief 设置是否在后台线程光栅化瓦片（默认开启）
+     * 关闭后缺少的瓦片在绘制时同步光栅化；没有被 shared_ptr 持有时也总是同步光栅化
+     */
+    void SetBackgroundRasterization(bool enabled) { backgroundRasterization_ = enabled; }
+
+    /**
+     * @brief 是否在后台线程光栅化瓦片
+     */
+    bool IsBackgroundRasterization() const { return backgroundRasterization_; }
+
+    /**
+     * @brief 丢弃所有缓存的瓦片
+     */
+    void ClearTiles();
+
+    /**
+     * @brief 获取统计信息
+     */
+    Stats GetStats() const;
+
+    /**
+     * @brief 内容由瓦片绘制，SceneRenderer 不再逐个绘制子元素
+     */
+    bool DrawsChildren() const override;
+
+    /**
+     * @brief 绘制背景后合成可见的瓦片
+     */
+    void Render(SkCanvas* canvas) override;
+
+    /**
+     * @brief 瓦片需要直接在画布上合成，不记录到命令缓冲区
+     */
+    bool Record(::KiUI::graphics::DrawCommandBuffer& buffer) override;
+
+protected:
+    /**
+     * @brief 命中测试时按视图偏移和缩放换算到内容坐标
+     */
+    SkPoint MapPointToChildren(float x, float y) const override;
+
+    /**
+     * @brief 布局内容后重新限制视图偏移（内容可能变小）
+     */
+    void LayoutChildren(float width, float height) override;
+
+private:
+    /**
+     * @brief 瓦片键：光栅化比例 + 瓦片行列
+     */
+    struct TileKey {
+        float scale = 1.0f;
+        int column = 0;
+        int row = 0;
+
+        bool operator==(const TileKey& other) const {
+            return scale == other.scale && column == other.column && row == other.row;
+        }
+    };
+
+    struct TileKeyHash {
+        size_t operator()(const TileKey& key) const;
+    };
+
+    /**
+     * @brief 缓存的瓦片
+     */
+    struct Tile {
+        sk_sp<SkImage> image;                   ///< 光栅图片
+        sk_sp<SkImage> texture;                 ///< 上传后的纹理，可能为空
+        GrDirectContext* textureContext = nullptr; ///< 纹理所属的上下文，只和当前画布的上下文比较
+        uint64_t generation = 0;                ///< 光栅化时的内容图片代数
+        size_t bytes = 0;                       ///< 占用的字节数（光栅 + 纹理）
+        std::list<TileKey>::iterator lruIt;     ///< 在 LRU 链表中的位置
+    };
+
+    /**
+     * @brief 内容子树变化后重新录制图片，返回图片是否可用
+     */
+    bool EnsurePicture();
+
+    /**
+     * @brief 光栅化一个瓦片（可以在任意线程调用）
+     */
+    static sk_sp<SkImage> RasterizeTile(const sk_sp<SkPicture>& picture, const TileKey& key, int tileSize,
+                                        float originX, float originY);
+
+    /**
+     * @brief 后台光栅化一个瓦片
+     * @param self 指向自身的 shared_ptr，为空时同步光栅化
+     */
+    void RequestTile(const TileKey& key, const boost::shared_ptr<TiledView>& self);
+
+    /**
+     * @brief 后台光栅化完成
+     */
+    void OnTileRasterized(const TileKey& key, uint64_t generation, sk_sp<SkImage> image);
+
+    /**
+     * @brief 插入或替换瓦片，然后按预算淘汰
+     */
+    void InsertTile(const TileKey& key, uint64_t generation, sk_sp<SkImage> image);
+
+    /**
+     * @brief 查找瓦片并移到最近使用，不存在时返回空
+     */
+    Tile* FindTile(const TileKey& key);
+
+    /**
+     * @brief 按预算淘汰最久未使用的瓦片
+     */
+    void EvictTiles();
+
+    /**
+     * @brief 把偏移限制在内容范围内并取整，返回偏移是否改变
+     */
+    bool ApplyViewOffset(float x, float y);
+
+    /**
+     * @brief 按当前视图把瓦片绘制到组件局部坐标
+     * @param fallback 是否作为缺少瓦片的替代绘制（线性采样，不上传纹理）
+     */
+    void DrawTile(SkCanvas* canvas, const TileKey& key, Tile& tile, bool fallback);
+
+    /**
+     * @brief 释放瓦片的纹理（保留光栅图片）
+     * @param context 只释放属于该上下文的纹理
+     */
+    void ReleaseTextures(GrDirectContext* context);
+
+    /**
+     * @brief 释放一个瓦片的纹理并从预算中扣除
+     */
+    void DropTexture(Tile& tile);
+
+    float viewX_ = 0.0f;
+    float viewY_ = 0.0f;
+    float zoom_ = 1.0f;
+    int tileSize_ = kDefaultTileSize;
+    size_t tileBudget_ = kDefaultTileBudget;
+    bool backgroundRasterization_ = true;
+
+    // 内容图片及其对应的内容子树版本；recorder_ 只通过 RenderSubtree 录制，不开始新的一帧
+    std::unique_ptr<SceneRenderer> recorder_;
+    sk_sp<SkPicture> picture_;
+    SkRect pictureBounds_ = SkRect::MakeEmpty();
+    uint64_t pictureVersion_ = 0;
+    uint64_t pictureGeneration_ = 0;
+    const VisualElement* pictureContent_ = nullptr;
+
+    // 瓦片缓存，链表头部为最近使用
+    std::unordered_map<TileKey, Tile, TileKeyHash> tiles_;
+    std::list<TileKey> lru_;
+    size_t tileBytes_ = 0;
+
+    // 正在后台光栅化的瓦片（键 -> 请求时的内容代数）
+    std::unordered_map<TileKey, uint64_t, TileKeyHash> pending_;
+    size_t inFlight_ = 0;
+
+    Stats stats_;
+    boost::signals2::scoped_connection shutdownConnection_;
+};
+
+} // namespace widget
+} // namespace KiUI
+
+#endif // TILED_VIEW_HPP
@@ -4,6 +4,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <vector>
+#include <cstddef>
 
 namespace KiUI {
 namespace widget {
@@ -13,16 +14,55 @@ class VisualElement;
 class UIElement : public boost::enable_shared_from_this<UIElement> {
     public:
     /*
-    * @brief Add a child to the UI element
+    * @brief Index value returned when an element has no parent
+    */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    /*
+    * @brief Add a child to the end of the UI element's children
     * @param child the child to add
     */
     void AddChild(boost::shared_ptr<UIElement> child);
     /*
+    * @brief Insert a child at the given position
+    * @param index the position to insert at (clamped to the children count)
+    * @param child the child to insert
+    */
+    void InsertChildAt(size_t index, boost::shared_ptr<UIElement> child);
+    /*
+    * @brief Insert a range of children at the given position in a single pass
+    * @param index the position to insert at (clamped to the children count)
+    * @param children the children to insert, in order
+    */
+    void InsertChildrenAt(size_t index, const std::vector<boost::shared_ptr<UIElement>>& children);
+    /*
     * @brief Remove a child from the UI element
     * @param child the child to remove
+    * @note The child is located through its index in parent, no search is performed
     */
     void RemoveChild(boost::shared_ptr<UIElement> child);
     /*
+    * @brief Remove the child at the given position
+    * @param index the position of the child to remove
+    */
+    void RemoveChildAt(size_t index);
+    /*
+    * @brief Remove a contiguous range of children in a single pass
+    * @param index the position of the first child to remove
+    * @param count the number of children to remove
+    */
+    void RemoveChildren(size_t index, size_t count);
+    /*
+    * @brief Move a child to another position among its siblings
+    * @param from the current position of the child
+    * @param to the new position of the child
+    */
+    void MoveChild(size_t from, size_t to);
+    /*
+    * @brief Replace all children with the given list in a single pass
+    * @param children the new children, in order
+    */
+    void ReplaceChildren(const std::vector<boost::shared_ptr<UIElement>>& children);
+    /*
     * @brief Get the children of the UI element
     * @return the children of the UI element
     */
@@ -33,6 +73,11 @@ class UIElement : public boost::enable_shared_from_this<UIElement> {
     */
     boost::shared_ptr<UIElement> GetParent() const { return Parent_; }
     /*
+    * @brief Get the position of this element in its parent's children
+    * @return the index in parent, or npos if the element has no parent
+    */
+    size_t GetIndexInParent() const { return IndexInParent_; }
+    /*
     * @brief Get the children count of the UI element
     * @return the children count of the UI element
     */
@@ -53,11 +98,51 @@ class UIElement : public boost::enable_shared_from_this<UIElement> {
     UIElement& operator=(const UIElement& other) = delete; // copy assignment operator is deleted
     
     protected:
+    /*
+    * @brief Called after children in [first, last) were inserted
+    * @param first index of the first inserted child
+    * @param last index one past the last inserted child
+    */
+    virtual void OnChildrenInserted(size_t first, size_t last) {}
+    /*
+    * @brief Called after children were detached from this element
+    * @param first former index of the first removed child (removed children need not be contiguous)
+    * @param removed the detached children, in their former order
+    */
+    virtual void OnChildrenRemoved(size_t first, const std::vector<boost::shared_ptr<UIElement>>& removed) {}
+    /*
+    * @brief Called after a child moved from one position to another
+    * @param from the former position
+    * @param to the new position
+    */
+    virtual void OnChildMoved(size_t from, size_t to) {}
+    /*
+    * @brief Called after the whole children list was replaced
+    * @param removed the children that were detached
+    */
+    virtual void OnChildrenReplaced(const std::vector<boost::shared_ptr<UIElement>>& removed) {}
+
     boost::shared_ptr<UIElement> Parent_;
     std::vector<boost::shared_ptr<UIElement>> Children_;
     private:
+    /*
+    * @brief Detach the child from its current parent (if any) before it is adopted
+    */
+    static void DetachFromParent(const boost::shared_ptr<UIElement>& child);
+    /*
+    * @brief Detach children from their current parents, compacting each old parent's children once
+    * @param children the children to detach (null and repeated entries are skipped)
+    * @param index a position in this element's children, moved back past detached children before it
+    */
+    void DetachChildren(const std::vector<boost::shared_ptr<UIElement>>& children, size_t& index);
+    /*
+    * @brief Refresh IndexInParent_ for children in [first, last)
+    */
+    void ReindexChildren(size_t first, size_t last);
+
+    size_t IndexInParent_ = npos;
 };
 
 } // namespace widget
 } // namespace KiUI
-#endif // UIELEMENT_HPP
\ No newline at end of file
+#endif // UIELEMENT_HPP
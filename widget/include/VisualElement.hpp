@@ -6,8 +6,15 @@
 #include <include/core/SkColor.h>
 #include <yoga/Yoga.h>
 #include <include/core/SkCanvas.h>
+#include <include/core/SkPoint.h>
+#include <include/core/SkRect.h>
+#include <include/core/SkSize.h>
+#include <cstdint>
 
 namespace KiUI {
+namespace graphics {
+class DrawCommandBuffer;
+}
 namespace widget {
 enum class Margin{
     Top,
@@ -63,6 +70,26 @@ enum class Justification{
     End,
     Stretch,
 };
+/*
+* @brief The frame pipeline phases an element has to go through again after a property change
+* @note Setters mark only the phases they affect, so e.g. a color change never reaches layout or hit testing
+*/
+enum class DirtyFlags : uint8_t {
+    None = 0,
+    Style = 1 << 0,     // the Yoga node does not reflect the element's properties yet
+    Layout = 1 << 1,    // the element's layout has to be recalculated
+    Paint = 1 << 2,     // what the element draws changed
+    HitTest = 1 << 3,   // the area where the element (or its children) can be hit changed
+};
+inline DirtyFlags operator|(DirtyFlags a, DirtyFlags b) {
+    return static_cast<DirtyFlags>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
+}
+inline DirtyFlags operator&(DirtyFlags a, DirtyFlags b) {
+    return static_cast<DirtyFlags>(static_cast<uint8_t>(a) & static_cast<uint8_t>(b));
+}
+inline DirtyFlags operator~(DirtyFlags a) {
+    return static_cast<DirtyFlags>(~static_cast<uint8_t>(a));
+}
 class VisualElement : public UIElement {
 public:
     VisualElement();
@@ -99,10 +126,29 @@ public:
     * @return the transform of the visual element
     */
     const SkMatrix& GetTransform() const { return transform_; }
+    /*
+    * @brief Set the transform from components: scale and rotate around the element's center, then translate
+    * @param translateX the horizontal translation
+    * @param translateY the vertical translation
+    * @param scaleX the horizontal scale
+    * @param scaleY the vertical scale
+    * @param rotation the rotation in degrees
+    * @note Replaces the matrix of SetTransform(). The center follows the element's size: the matrix is rebuilt
+    *       whenever the size changes, until SetTransform() sets a matrix directly. Does not affect layout
+    */
+    void SetRenderTransform(float translateX, float translateY, float scaleX, float scaleY, float rotation);
+    /*
+    * @brief Get the transform components last passed to SetRenderTransform()
+    */
+    float GetTranslateX() const { return TransformX_; }
+    float GetTranslateY() const { return TransformY_; }
+    float GetScaleX() const { return ScaleX_; }
+    float GetScaleY() const { return ScaleY_; }
+    float GetRotation() const { return Rotate_; }
 
     /*
     * @brief Set the width of the visual element
-    * @param width the width of the visual element
+    * @param width the width of the visual element, 0 for auto (content-sized when measured)
     */
     void SetWidth(float width);
     /*
@@ -111,8 +157,13 @@ public:
     */
     float GetWidth() const { return width_; }
     /*
+    * @brief Whether the width was set through SetWidth (otherwise GetWidth is the last layout result)
+    * @return true if the width is explicit, false if it is auto
+    */
+    bool HasExplicitWidth() const { return explicitWidth_; }
+    /*
     * @brief Set the height of the visual element
-    * @param height the height of the visual element
+    * @param height the height of the visual element, 0 for auto (content-sized when measured)
     */
     void SetHeight(float height);
     /*
@@ -121,6 +172,11 @@ public:
     */
     float GetHeight() const { return height_; }
     /*
+    * @brief Whether the height was set through SetHeight (otherwise GetHeight is the last layout result)
+    * @return true if the height is explicit, false if it is auto
+    */
+    bool HasExplicitHeight() const { return explicitHeight_; }
+    /*
     * @brief Set the left position of the visual element (relative to parent)
     * @param left the left position
     */
@@ -141,6 +197,52 @@ public:
     */
     float GetTop() const { return top_; }
     /*
+    * @brief Clip the children of the visual element to its bounds (overflow hidden)
+    * @param clip true to clip the children to [0, width] x [0, height]
+    */
+    void SetClipToBounds(bool clip);
+    /*
+    * @brief Check whether the children are clipped to the bounds of the visual element
+    * @return true if the children are clipped
+    */
+    bool GetClipToBounds() const { return clipToBounds_; }
+    /*
+    * @brief Get the bounds of what this element itself draws, in its local space
+    * @return the local bounds, before transform_ is applied
+    * @note Derived classes that draw outside [0, width] x [0, height] should override this
+    */
+    virtual SkRect GetLocalBounds() const;
+    /*
+    * @brief Check whether the opacity applies to the element and its children as one group
+    * @return true if opacity is below 1 and there is at least one visible child
+    * @note Groups are composited through an offscreen layer; a lone element folds opacity into its paint
+    */
+    bool UsesGroupOpacity() const;
+    /*
+    * @brief Get the version of the element's subtree content
+    * @return a counter that changes whenever anything painted by the subtree changes
+    * @note The element's own opacity is not part of the content, so fading a group keeps its version
+    */
+    uint64_t GetSubtreeVersion() const { return subtreeVersion_; }
+    /*
+    * @brief Get the part of this element that its own Render() covers with fully opaque pixels
+    * @param rect receives the opaque rect in local space, before transform_ is applied
+    * @return true if the element paints such a rect
+    * @note Used by SceneRenderer to skip content hidden below; the default implementation reports nothing
+    */
+    virtual bool GetOpaqueBounds(SkRect* rect) const;
+    /*
+    * @brief Get the bounds of this element and all its visible descendants, in its local space
+    * @return the cached subtree bounds (transform_ and clipping already applied)
+    * @note The cache is rebuilt lazily after any geometry, visibility or children change in the subtree
+    */
+    const SkRect& GetSubtreeBounds();
+    /*
+    * @brief Check whether some visible descendant reaches outside [0, width] x [0, height]
+    * @return true if clipping the children would hide something
+    */
+    bool HasOverflowingChildren();
+    /*
     * @brief Set the alignment of the visual element (cross-axis alignment)
     * @param alignment the alignment value
     */
@@ -170,19 +272,69 @@ public:
     void CalculateLayout(float parentWidth, float parentHeight, 
                        float parentPaddingLeft = 0.0f, float parentPaddingTop = 0.0f);
     /*
+    * @brief Place this element directly, without running Yoga on it
+    * @param left x position relative to the parent
+    * @param top y position relative to the parent
+    * @param width layout width
+    * @param height layout height
+    * @param layoutChildren true to lay out the children even if the size did not change (e.g. their content changed)
+    * @note For containers that arrange their children (see SetArrangesChildren). The element's own children
+    *       are laid out through LayoutChildren() only when its size changes or layoutChildren is set,
+    *       so a leaf element never touches Yoga
+    */
+    void Arrange(float left, float top, float width, float height, bool layoutChildren = false);
+    /*
+    * @brief Whether a style change in this subtree has invalidated the last layout
+    * @note Checks the subtree's Style/Layout dirty flags and Yoga's own dirtiness (which Yoga
+    *       propagates to the root), so checking the root covers the whole tree
+    */
+    bool IsLayoutDirty() const;
+    /*
     * @brief Update Yoga node properties from current VisualElement properties
+    * @note Visits the whole subtree; prefer UpdateStyles(), which only visits elements marked Style dirty
     */
     void UpdateYogaNode();
     /*
-    * @brief Add a child to the visual element (overrides UIElement::AddChild)
-    * @param child the child to add
+    * @brief Get the Yoga node backing this element
+    * @note Children that are not part of the Yoga tree (arranged or measured parents) are detached from it
+    */
+    YGNodeRef GetYogaNode() const { return yogaNode_; }
+    /*
+    * @brief Run the style phase: sync the Yoga nodes of the elements in this subtree marked Style dirty
+    * @note Layout-affecting setters only mark the style dirty; CalculateLayout() calls this first.
+    *       Clean subtrees are skipped, and elements inside a batch (BeginUpdate) wait for its end
+    */
+    void UpdateStyles();
+    /*
+    * @brief Get the phases this element itself has to go through again
+    */
+    DirtyFlags GetDirtyFlags() const { return dirtyFlags_; }
+    /*
+    * @brief Get the phases some element in this subtree (including this one) has to go through again
     */
-    void AddChild(boost::shared_ptr<UIElement> child);
+    DirtyFlags GetSubtreeDirtyFlags() const { return dirtyFlags_ | childDirtyFlags_; }
     /*
-    * @brief Remove a child from the visual element (overrides UIElement::RemoveChild)
-    * @param child the child to remove
+    * @brief Clear dirty flags once their phase has run over this subtree
+    * @param flags the phases to clear
+    * @note Only descends into children whose subtree carries one of the flags
     */
-    void RemoveChild(boost::shared_ptr<UIElement> child);
+    void ClearDirtyFlags(DirtyFlags flags);
+    /*
+    * @brief Start a batch of property changes
+    * @note Layout-affecting setters only mark the style dirty; while a batch is open the style phase
+    *       leaves this element alone, so its Yoga node is synced once with the final values. Batches may be nested.
+    */
+    void BeginUpdate();
+    /*
+    * @brief Finish a batch of property changes started with BeginUpdate()
+    * @note After the outermost EndUpdate() the next style phase syncs the Yoga node if any setter changed it
+    */
+    void EndUpdate();
+    /*
+    * @brief Check whether a batch of property changes is in progress
+    * @return true between BeginUpdate() and the matching EndUpdate()
+    */
+    bool IsUpdating() const { return updateDepth_ > 0; }
     /*
     * @brief Set the margin of the visual element
     * @param edge the edge to set (Top/Bottom/Left/Right/All)
@@ -262,6 +414,11 @@ public:
     */
     SkColor GetForegroundColor() const { return foregroundColor_; }
     /*
+    * @brief Check whether Yoga sizes this element from its content through MeasureContent()
+    * @return true if the element has a measure function
+    */
+    bool IsMeasured() const { return measured_; }
+    /*
     * @brief Convert this UIElement to VisualElement
     * @return shared_ptr to this VisualElement
     * @note Overrides UIElement::AsVisualElement() to avoid expensive dynamic_cast
@@ -283,17 +440,188 @@ public:
     */
     virtual bool HitTestLocal(float x, float y) const;
     /*
+    * @brief Get the offset by which this element scrolls its children
+    * @param offset output scroll offset; children are drawn and hit tested moved by (-x, -y)
+    * @return true if the children scroll, so SceneRenderer keeps them in a scroll layer
+    * @note The default returns false. Scrolling must only call InvalidateParentVisual(): the element's
+    *       own version has to stay unchanged for the cached content to be reused
+    */
+    virtual bool GetChildScrollOffset(SkPoint* offset) const;
+    /*
+    * @brief Get the areas that cover every change of the children since an earlier subtree version
+    * @param version a subtree version this element had before
+    * @param damage receives the changed areas in the children's space (before scrolling)
+    * @return true if every change since version lies inside damage, so a cached scroll layer only
+    *         needs those areas repainted; false if the changes are unknown and the whole layer is stale
+    * @note The default returns false. Only consulted for elements whose children scroll
+    */
+    virtual bool GetChildDamage(uint64_t version, std::vector<SkRect>* damage) const;
+    /*
+    * @brief Check whether Render() draws the children itself (e.g. from a cached picture)
+    * @return true to keep SceneRenderer from visiting the children; hit testing still descends into them
+    * @note The default returns false
+    */
+    virtual bool DrawsChildren() const;
+    /*
     * @brief Render the visual element
     * @param canvas the canvas to render the visual element
     */
     virtual void Render(SkCanvas* canvas) = 0;
+    /*
+    * @brief Record the visual element into a draw command buffer instead of drawing immediately
+    * @param buffer the command buffer, whose current matrix maps this element's local space to the device
+    * @return true if the element was recorded, false if it must be drawn with Render()
+    * @note The default implementation returns false; SceneRenderer flushes the buffer and falls back to Render()
+    */
+    virtual bool Record(graphics::DrawCommandBuffer& buffer);
 protected:
+    /*
+    * @brief Keep the Yoga child list in sync with inserted children
+    */
+    void OnChildrenInserted(size_t first, size_t last) override;
+    /*
+    * @brief Keep the Yoga child list in sync with removed children
+    */
+    void OnChildrenRemoved(size_t first, const std::vector<boost::shared_ptr<UIElement>>& removed) override;
+    /*
+    * @brief Keep the Yoga child list in sync with a reordered child
+    */
+    void OnChildMoved(size_t from, size_t to) override;
+    /*
+    * @brief Rebuild the Yoga child list after the children were replaced
+    */
+    void OnChildrenReplaced(const std::vector<boost::shared_ptr<UIElement>>& removed) override;
+    /*
+    * @brief Rebuild the Yoga child list from the visual children in one pass
+    */
+    void SyncYogaChildren();
+    /*
+    * @brief Check whether every child owns a Yoga node at the same index
+    * @param pendingDelta children count change not yet applied to the Yoga node
+    */
+    bool IsYogaChildListAligned(std::ptrdiff_t pendingDelta) const;
+    /*
+    * @brief Mark the Yoga node stale; it is synced in the next style phase (see UpdateStyles)
+    */
+    void InvalidateYogaNode();
+    /*
+    * @brief Push this element's own properties into its Yoga node (children are not visited)
+    */
+    void SyncYogaStyle();
+    /*
+    * @brief Mark phases this element has to go through again and let its ancestors know
+    * @param flags the phases to mark
+    * @note Ancestors only record that some descendant is dirty, so every phase can skip clean subtrees.
+    *       Style and Layout stop at containers that arrange their children themselves
+    */
+    void MarkDirty(DirtyFlags flags);
+    /*
+    * @brief Mark what a change of the child list affects: bounds, painting, hit testing and (for Yoga children) layout
+    */
+    void InvalidateChildList();
+    /*
+    * @brief Let Yoga size this element from its content through MeasureContent()
+    * @param measured true to install the measure function
+    * @note Only leaf elements can be measured; a measured element must not get visual children
+    */
+    void SetMeasured(bool measured);
+    /*
+    * @brief Keep the children out of this element's Yoga node and position them in LayoutChildren()
+    * @param arranges true to detach the children's Yoga nodes; each child then lays out as its own Yoga root
+    * @note For virtualizing containers, whose children are a small realized window over a large item set
+    */
+    void SetArrangesChildren(bool arranges);
+    /*
+    * @brief Check whether the children are positioned by LayoutChildren() instead of Yoga
+    */
+    bool ArrangesChildren() const { return arrangesChildren_; }
+    /*
+    * @brief Lay out the children once this element's own layout is known
+    * @param width the content width (layout width minus horizontal padding)
+    * @param height the content height (layout height minus vertical padding)
+    * @note Called at the end of CalculateLayout(); the default calls CalculateLayout() on every visual child
+    */
+    virtual void LayoutChildren(float width, float height);
+    /*
+    * @brief Map a point from this element's local space into the space its children are positioned in
+    * @note Used by HitTest(). The default applies GetChildScrollOffset(); override it together with
+    *       DrawsChildren() when the children are drawn with another transform
+    */
+    virtual SkPoint MapPointToChildren(float x, float y) const;
+    /*
+    * @brief Tell Yoga the measured content changed so the next layout measures again
+    * @note Does nothing for elements that are not measured
+    */
+    void InvalidateMeasure();
+    /*
+    * @brief Measure the content size for Yoga
+    * @param width the width constraint, undefined when widthMode is YGMeasureModeUndefined
+    * @param widthMode how the width constraint applies (exactly / at most / undefined)
+    * @param height the height constraint, undefined when heightMode is YGMeasureModeUndefined
+    * @param heightMode how the height constraint applies
+    * @return the content size; the default implementation returns an empty size
+    * @note Yoga may call this several times per layout pass with different constraints
+    */
+    virtual SkSize MeasureContent(float width, YGMeasureMode widthMode, float height, YGMeasureMode heightMode);
+    /*
+    * @brief Yoga measure function trampoline, forwards to MeasureContent() of the node's element
+    */
+    static YGSize YogaMeasure(YGNodeConstRef node, float width, YGMeasureMode widthMode,
+                              float height, YGMeasureMode heightMode);
+    /*
+    * @brief Drop the cached subtree bounds of this element and all its ancestors
+    */
+    void InvalidateBounds();
+    /*
+    * @brief Store a new layout position and size, invalidating what the change affects
+    * @note A size change alters what this element draws; a move only alters the parent's content
+    */
+    void SetLayoutFrame(float left, float top, float width, float height);
+    /*
+    * @brief Mark the painted content of this element changed (bumps the subtree version up to the root)
+    * @note Derived classes call this when state only they know about changes what Render() draws.
+    *       Marks the element Paint dirty
+    */
+    void InvalidateVisual();
+    /*
+    * @brief Mark the parent's content changed without touching this element's own version
+    * @note For position, visibility and opacity: they change how the subtree is composited, not what it draws.
+    *       Without a visual parent (the root) the element itself is marked Paint dirty
+    */
+    void InvalidateParentVisual();
+    /*
+    * @brief Get the opacity to fold into this element's own paint
+    * @return 1 when the opacity is applied by a group layer, otherwise the element's opacity
+    */
+    float GetPaintOpacity() const;
+    /*
+    * @brief Common start of Render(): apply transform_ and draw the background, border and corner radii
+    * @param canvas the canvas to draw on
+    * @return true if the canvas state was saved; the caller restores it at the end of Render()
+    */
+    bool BeginRender(SkCanvas* canvas);
+    /*
+    * @brief Get the border width (the average when the sides differ), 0 without a border
+    */
+    float GetAverageBorderWidth() const;
+    /*
+    * @brief Whether any corner radius is set
+    */
+    bool HasBorderRadius() const;
+
+    /*
+    * @brief Rebuild transform_ from the SetRenderTransform() components around the current center
+    * @note Does nothing while the transform was set directly with SetTransform(); callers mark dirty flags
+    */
+    void RebuildRenderTransform();
+
     YGNodeRef yogaNode_;
     float TransformX_ = 0.0f;
     float TransformY_ = 0.0f;
     float ScaleX_ = 1.0f;
     float ScaleY_ = 1.0f;
     float Rotate_ = 0.0f;
+    bool hasRenderTransform_ = false;  // transform_ is built from the components above
     float opacity_ = 1.0f;
     
     // Margin values
@@ -329,6 +657,11 @@ protected:
     
     float width_ = 0.0f;
     float height_ = 0.0f;
+    // Whether width_/height_ were set through SetWidth/SetHeight (a measured element's layout result is not pinned)
+    bool explicitWidth_ = false;
+    bool explicitHeight_ = false;
+    bool measured_ = false;
+    bool arrangesChildren_ = false;
     float left_ = 0.0f;  // Position relative to parent (calculated by Yoga)
     float top_ = 0.0f;   // Position relative to parent (calculated by Yoga)
     bool visible_ = true;
@@ -337,6 +670,20 @@ protected:
     // Layout properties
     Alignment alignment_ = Alignment::Stretch;
     Justification justification_ = Justification::Start;
+    
+    // Clipping and cached subtree bounds (see GetSubtreeBounds)
+    bool clipToBounds_ = false;
+    bool boundsValid_ = false;
+    bool childrenOverflow_ = false;
+    SkRect subtreeBounds_ = SkRect::MakeEmpty();
+    uint64_t subtreeVersion_ = 0;
+    
+    // Frame pipeline state (see DirtyFlags): this element's own phases and the union of its descendants'
+    DirtyFlags dirtyFlags_ = DirtyFlags::Style | DirtyFlags::Layout | DirtyFlags::Paint | DirtyFlags::HitTest;
+    DirtyFlags childDirtyFlags_ = DirtyFlags::None;
+    
+    // Batched update state (see BeginUpdate/EndUpdate)
+    unsigned int updateDepth_ = 0;
 };
 
 } // namespace widget
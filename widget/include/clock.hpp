@@ -7,17 +7,46 @@
 namespace KiUI {
 namespace widget {
 
-// Clock widget class
-// TODO: Implement clock widget
+/**
+ * @brief 合成时钟，每帧开始时前进一次，为动画提供帧间隔
+ * 使用 steady_clock 计时；第一次 Tick 只记录起点，帧间隔为 0
+ * 帧间隔如实报告，卡顿造成的长间隔不会被改写，动画据此直接跳到正确的进度
+ */
 class CompositionClock{
     public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
     CompositionClock();
     ~CompositionClock();
+
+    /**
+     * @brief 以当前时间前进一帧
+     */
     void Tick();
+
+    /**
+     * @brief 以指定时间前进一帧（测试或外部驱动的时钟）
+     * @param now 本帧的时间点，不早于上一帧
+     */
+    void Tick(TimePoint now);
+
+    /**
+     * @brief 重新开始计时，下一次 Tick 的帧间隔为 0
+     */
+    void Reset();
+
+    /**
+     * @brief 获取上一帧的间隔（毫秒）
+     */
     float GetDeltaTime() const;
+
+    /**
+     * @brief 获取累计时间（毫秒）
+     */
     float GetTotalTime() const;
     private:
-    std::chrono::steady_clock::time_point lastTickTime_;
+    TimePoint lastTickTime_;
+    bool started_ = false;
     float deltaTime_ = 0.0f;
     float totalTime_ = 0.0f;
 };
@@ -26,4 +55,3 @@ class CompositionClock{
 } // namespace KiUI
 
 #endif // CLOCK_HPP
-
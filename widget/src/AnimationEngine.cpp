@@ -0,0 +1,455 @@
+#include "AnimationEngine.hpp"
+#include <logger.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+// 二分求解贝塞尔参数的步数（精度约为 1e-3），之后再做几次牛顿迭代
+constexpr int kBisectionSteps = 10;
+constexpr int kNewtonSteps = 3;
+
+// 最短时长（毫秒），时长为 0 的动画在第一次 Tick 时直接跳到终点
+constexpr float kMinDuration = 0.001f;
+
+// 端点为 0 和 1 的三次贝塞尔曲线在参数 s 处的一个坐标分量
+inline float Bezier(float s, float p1, float p2) {
+    const float inv = 1.0f - s;
+    return 3.0f * inv * inv * s * p1 + 3.0f * inv * s * s * p2 + s * s * s;
+}
+
+// 坐标分量对参数 s 的导数
+inline float BezierSlope(float s, float p1, float p2) {
+    const float inv = 1.0f - s;
+    return 3.0f * inv * inv * p1 + 6.0f * inv * s * (p2 - p1) + 3.0f * s * s * (1.0f - p2);
+}
+
+// 先按 x 二分求曲线参数，再用牛顿迭代修正，最后求 y；
+// 步数固定且只有条件选择，批量计算时可以向量化
+inline float SolveEasing(float t, float x1, float y1, float x2, float y2) {
+    float lo = 0.0f;
+    float hi = 1.0f;
+    for (int step = 0; step < kBisectionSteps; ++step) {
+        const float mid = 0.5f * (lo + hi);
+        const bool below = Bezier(mid, x1, x2) < t;
+        lo = below ? mid : lo;
+        hi = below ? hi : mid;
+    }
+    float s = 0.5f * (lo + hi);
+    for (int step = 0; step < kNewtonSteps; ++step) {
+        const float slope = BezierSlope(s, x1, x2);
+        const float next = s - (Bezier(s, x1, x2) - t) / (slope > 1e-6f ? slope : 1.0f);
+        s = slope > 1e-6f ? std::clamp(next, lo, hi) : s;
+    }
+    const float y = Bezier(s, y1, y2);
+    return t <= 0.0f ? 0.0f : (t >= 1.0f ? 1.0f : y);
+}
+
+U8CPU ToChannel(float value) {
+    return static_cast<U8CPU>(std::lround(std::clamp(value, 0.0f, 255.0f)));
+}
+
+} // namespace
+
+float Easing::Evaluate(float t) const {
+    return SolveEasing(t, x1, y1, x2, y2);
+}
+
+size_t AnimationEngine::SlotKeyHash::operator()(const SlotKey& key) const {
+    return std::hash<const VisualElement*>()(key.target) ^ (static_cast<size_t>(key.property) * 0x9e3779b9);
+}
+
+AnimationEngine::AnimationEngine() {
+}
+
+AnimationEngine::~AnimationEngine() {
+}
+
+bool AnimationEngine::AffectsLayout(AnimatedProperty property) {
+    return property == AnimatedProperty::Width || property == AnimatedProperty::Height;
+}
+
+bool AnimationEngine::IsColorProperty(AnimatedProperty property) {
+    return property == AnimatedProperty::BackgroundColor || property == AnimatedProperty::BorderColor ||
+           property == AnimatedProperty::ForegroundColor;
+}
+
+AnimationId AnimationEngine::Animate(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property,
+                                     float to, const AnimationOptions& options) {
+    if (!target) {
+        return 0;
+    }
+    float from[kChannels] = {};
+    ReadValue(*target, property, from);
+    return Animate(target, property, from[0], to, options);
+}
+
+AnimationId AnimationEngine::Animate(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property,
+                                     float from, float to, const AnimationOptions& options) {
+    if (IsColorProperty(property)) {
+        foundation::Logger::Error("AnimationEngine: property {0} is a color, use AnimateColor", static_cast<int>(property));
+        return 0;
+    }
+    const float fromValues[kChannels] = {from, 0.0f, 0.0f, 0.0f};
+    const float toValues[kChannels] = {to, 0.0f, 0.0f, 0.0f};
+    return Add(target, property, fromValues, toValues, options);
+}
+
+AnimationId AnimationEngine::AnimateColor(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property,
+                                          SkColor to, const AnimationOptions& options) {
+    if (!target) {
+        return 0;
+    }
+    float from[kChannels] = {};
+    ReadValue(*target, property, from);
+    return AnimateColor(target, property,
+                        SkColorSetARGB(ToChannel(from[0]), ToChannel(from[1]), ToChannel(from[2]), ToChannel(from[3])),
+                        to, options);
+}
+
+AnimationId AnimationEngine::AnimateColor(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property,
+                                          SkColor from, SkColor to, const AnimationOptions& options) {
+    if (!IsColorProperty(property)) {
+        foundation::Logger::Error("AnimationEngine: property {0} is not a color, use Animate", static_cast<int>(property));
+        return 0;
+    }
+    const float fromValues[kChannels] = {
+        static_cast<float>(SkColorGetA(from)), static_cast<float>(SkColorGetR(from)),
+        static_cast<float>(SkColorGetG(from)), static_cast<float>(SkColorGetB(from))};
+    const float toValues[kChannels] = {
+        static_cast<float>(SkColorGetA(to)), static_cast<float>(SkColorGetR(to)),
+        static_cast<float>(SkColorGetG(to)), static_cast<float>(SkColorGetB(to))};
+    return Add(target, property, fromValues, toValues, options);
+}
+
+AnimationId AnimationEngine::Add(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property,
+                                 const float* from, const float* to, const AnimationOptions& options) {
+    if (!target) {
+        return 0;
+    }
+
+    // 同一属性上的旧动画停在当前值，新动画从这里开始
+    const SlotKey slot{target.get(), property};
+    auto existing = idBySlot_.find(slot);
+    if (existing != idBySlot_.end()) {
+        Cancel(existing->second);
+    }
+
+    const AnimationId id = nextId_++;
+    indexById_[id] = ids_.size();
+    idBySlot_[slot] = id;
+
+    ids_.push_back(id);
+    targets_.push_back(target);
+    targetKeys_.push_back(target.get());
+    properties_.push_back(property);
+    elapsed_.push_back(0.0f);
+    delays_.push_back(std::max(options.delay, 0.0f));
+    durations_.push_back(std::max(options.duration, kMinDuration));
+    repeats_.push_back(options.repeatCount == 0 ? std::numeric_limits<float>::infinity()
+                                                : static_cast<float>(options.repeatCount));
+    reverses_.push_back(options.autoReverse ? 1.0f : 0.0f);
+    // x 限制在 [0, 1] 内，保证曲线关于时间单调，可以二分求解
+    x1_.push_back(std::clamp(options.easing.x1, 0.0f, 1.0f));
+    y1_.push_back(options.easing.y1);
+    x2_.push_back(std::clamp(options.easing.x2, 0.0f, 1.0f));
+    y2_.push_back(options.easing.y2);
+    from_.insert(from_.end(), from, from + kChannels);
+    to_.insert(to_.end(), to, to + kChannels);
+    return id;
+}
+
+bool AnimationEngine::Cancel(AnimationId id) {
+    auto it = indexById_.find(id);
+    if (it == indexById_.end()) {
+        return false;
+    }
+    RemoveAt(it->second);
+    return true;
+}
+
+void AnimationEngine::CancelAll(const VisualElement* target) {
+    for (size_t i = ids_.size(); i > 0; --i) {
+        if (targetKeys_[i - 1] == target) {
+            RemoveAt(i - 1);
+        }
+    }
+}
+
+bool AnimationEngine::IsActive(AnimationId id) const {
+    return indexById_.find(id) != indexById_.end();
+}
+
+void AnimationEngine::RemoveAt(size_t index) {
+    const size_t last = ids_.size() - 1;
+    const AnimationId id = ids_[index];
+    auto slot = idBySlot_.find(SlotKey{targetKeys_[index], properties_[index]});
+    if (slot != idBySlot_.end() && slot->second == id) {
+        idBySlot_.erase(slot);
+    }
+    indexById_.erase(id);
+
+    if (index != last) {
+        ids_[index] = ids_[last];
+        targets_[index] = std::move(targets_[last]);
+        targetKeys_[index] = targetKeys_[last];
+        properties_[index] = properties_[last];
+        elapsed_[index] = elapsed_[last];
+        delays_[index] = delays_[last];
+        durations_[index] = durations_[last];
+        repeats_[index] = repeats_[last];
+        reverses_[index] = reverses_[last];
+        x1_[index] = x1_[last];
+        y1_[index] = y1_[last];
+        x2_[index] = x2_[last];
+        y2_[index] = y2_[last];
+        std::copy_n(from_.begin() + last * kChannels, kChannels, from_.begin() + index * kChannels);
+        std::copy_n(to_.begin() + last * kChannels, kChannels, to_.begin() + index * kChannels);
+        indexById_[ids_[index]] = index;
+    }
+
+    ids_.pop_back();
+    targets_.pop_back();
+    targetKeys_.pop_back();
+    properties_.pop_back();
+    elapsed_.pop_back();
+    delays_.pop_back();
+    durations_.pop_back();
+    repeats_.pop_back();
+    reverses_.pop_back();
+    x1_.pop_back();
+    y1_.pop_back();
+    x2_.pop_back();
+    y2_.pop_back();
+    from_.resize(last * kChannels);
+    to_.resize(last * kChannels);
+}
+
+void AnimationEngine::Tick(const CompositionClock& clock) {
+    Tick(clock.GetDeltaTime());
+}
+
+void AnimationEngine::Tick(float deltaMs) {
+    finished_.clear();
+    stats_ = Stats();
+    const size_t count = ids_.size();
+    if (count == 0) {
+        return;
+    }
+    deltaMs = std::max(deltaMs, 0.0f);
+
+    progress_.resize(count);
+    eased_.resize(count);
+    values_.resize(count * kChannels);
+    done_.resize(count);
+
+    float* elapsed = elapsed_.data();
+    const float* delays = delays_.data();
+    const float* durations = durations_.data();
+    const float* repeats = repeats_.data();
+    const float* reverses = reverses_.data();
+    float* progress = progress_.data();
+    uint8_t* done = done_.data();
+
+    // 1. 推进时间，计算本次播放内的进度（往返播放的奇数次反向）
+    for (size_t i = 0; i < count; ++i) {
+        elapsed[i] += deltaMs;
+        const float cycles = std::max(elapsed[i] - delays[i], 0.0f) / durations[i];
+        const float iteration = std::min(std::floor(cycles), repeats[i] - 1.0f);
+        const float fraction = std::min(cycles - iteration, 1.0f);
+        const float odd = reverses[i] * std::fmod(iteration, 2.0f);
+        progress[i] = fraction + odd * (1.0f - 2.0f * fraction);
+        done[i] = cycles >= repeats[i] ? 1 : 0;
+        // 无限循环的动画把时间折回前两次播放之内，长时间运行后精度不下降
+        elapsed[i] -= std::isinf(repeats[i]) ? std::floor(cycles * 0.5f) * 2.0f * durations[i] : 0.0f;
+    }
+
+    // 2. 缓动
+    const float* x1 = x1_.data();
+    const float* y1 = y1_.data();
+    const float* x2 = x2_.data();
+    const float* y2 = y2_.data();
+    float* eased = eased_.data();
+    for (size_t i = 0; i < count; ++i) {
+        eased[i] = SolveEasing(progress[i], x1[i], y1[i], x2[i], y2[i]);
+    }
+
+    // 3. 插值所有通道
+    const float* from = from_.data();
+    const float* to = to_.data();
+    float* values = values_.data();
+    for (size_t k = 0; k < count * kChannels; ++k) {
+        values[k] = from[k] + (to[k] - from[k]) * eased[k / kChannels];
+    }
+
+    // 4. 写回组件；目标已经销毁的动画直接结束
+    transformWrites_.clear();
+    transformIndex_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        auto target = targets_[i].lock();
+        if (!target) {
+            done[i] = 1;
+            continue;
+        }
+        if (WriteValue(target, properties_[i], values + i * kChannels)) {
+            ++stats_.propertyWrites;
+            if (AffectsLayout(properties_[i])) {
+                ++stats_.layoutWrites;
+            }
+        }
+    }
+    FlushTransforms();
+
+    // 5. 移除结束的动画（从后往前，交换删除不影响还没检查的位置）
+    for (size_t i = count; i > 0; --i) {
+        if (done_[i - 1]) {
+            finished_.push_back(ids_[i - 1]);
+            RemoveAt(i - 1);
+        }
+    }
+
+    stats_.evaluated = count;
+    stats_.activeAnimations = ids_.size();
+}
+
+void AnimationEngine::ReadValue(const VisualElement& target, AnimatedProperty property, float* value) {
+    SkColor color = SK_ColorTRANSPARENT;
+    switch (property) {
+    case AnimatedProperty::Opacity:
+        value[0] = target.GetOpacity();
+        return;
+    case AnimatedProperty::TranslateX:
+        value[0] = target.GetTranslateX();
+        return;
+    case AnimatedProperty::TranslateY:
+        value[0] = target.GetTranslateY();
+        return;
+    case AnimatedProperty::ScaleX:
+        value[0] = target.GetScaleX();
+        return;
+    case AnimatedProperty::ScaleY:
+        value[0] = target.GetScaleY();
+        return;
+    case AnimatedProperty::Rotation:
+        value[0] = target.GetRotation();
+        return;
+    case AnimatedProperty::Width:
+        value[0] = target.GetWidth();
+        return;
+    case AnimatedProperty::Height:
+        value[0] = target.GetHeight();
+        return;
+    case AnimatedProperty::BackgroundColor:
+        color = target.GetBackgroundColor();
+        break;
+    case AnimatedProperty::BorderColor:
+        color = target.GetBorderColor();
+        break;
+    case AnimatedProperty::ForegroundColor:
+        color = target.GetForegroundColor();
+        break;
+    }
+    value[0] = static_cast<float>(SkColorGetA(color));
+    value[1] = static_cast<float>(SkColorGetR(color));
+    value[2] = static_cast<float>(SkColorGetG(color));
+    value[3] = static_cast<float>(SkColorGetB(color));
+}
+
+bool AnimationEngine::WriteValue(const boost::shared_ptr<VisualElement>& element, AnimatedProperty property,
+                                 const float* value) {
+    VisualElement& target = *element;
+    switch (property) {
+    case AnimatedProperty::Opacity: {
+        const float opacity = std::clamp(value[0], 0.0f, 1.0f);
+        if (opacity == target.GetOpacity()) {
+            return false;
+        }
+        target.SetOpacity(opacity);
+        return true;
+    }
+    case AnimatedProperty::TranslateX:
+    case AnimatedProperty::TranslateY:
+    case AnimatedProperty::ScaleX:
+    case AnimatedProperty::ScaleY:
+    case AnimatedProperty::Rotation: {
+        // 先记下分量，所有动画写完后每个组件只重建一次矩阵
+        auto it = transformIndex_.find(&target);
+        if (it == transformIndex_.end()) {
+            TransformWrite write;
+            write.target = element;
+            write.components[0] = target.GetTranslateX();
+            write.components[1] = target.GetTranslateY();
+            write.components[2] = target.GetScaleX();
+            write.components[3] = target.GetScaleY();
+            write.components[4] = target.GetRotation();
+            write.changed = false;
+            it = transformIndex_.emplace(&target, transformWrites_.size()).first;
+            transformWrites_.push_back(write);
+        }
+        TransformWrite& write = transformWrites_[it->second];
+        const size_t component = static_cast<size_t>(property) - static_cast<size_t>(AnimatedProperty::TranslateX);
+        if (write.components[component] == value[0]) {
+            return false;
+        }
+        write.components[component] = value[0];
+        write.changed = true;
+        return true;
+    }
+    case AnimatedProperty::Width:
+    case AnimatedProperty::Height: {
+        const float size = std::max(value[0], 0.0f);
+        const bool width = property == AnimatedProperty::Width;
+        if (size == (width ? target.GetWidth() : target.GetHeight())) {
+            return false;
+        }
+        if (width) {
+            target.SetWidth(size);
+        } else {
+            target.SetHeight(size);
+        }
+        return true;
+    }
+    case AnimatedProperty::BackgroundColor:
+    case AnimatedProperty::BorderColor:
+    case AnimatedProperty::ForegroundColor: {
+        const SkColor color = SkColorSetARGB(ToChannel(value[0]), ToChannel(value[1]), ToChannel(value[2]), ToChannel(value[3]));
+        if (property == AnimatedProperty::BackgroundColor) {
+            if (color == target.GetBackgroundColor()) {
+                return false;
+            }
+            target.SetBackgroundColor(color);
+        } else if (property == AnimatedProperty::BorderColor) {
+            if (color == target.GetBorderColor()) {
+                return false;
+            }
+            target.SetBorderColor(color);
+        } else {
+            if (color == target.GetForegroundColor()) {
+                return false;
+            }
+            target.SetForegroundColor(color);
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+void AnimationEngine::FlushTransforms() {
+    for (const TransformWrite& write : transformWrites_) {
+        if (write.changed) {
+            write.target->SetRenderTransform(write.components[0], write.components[1], write.components[2],
+                                             write.components[3], write.components[4]);
+        }
+    }
+    transformWrites_.clear();
+    transformIndex_.clear();
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -1,5 +1,6 @@
 #include "Box.hpp"
-#include <Shapes.hpp>
+#include <DrawCommandBuffer.hpp>
+#include <algorithm>
 
 namespace KiUI {
 namespace widget {
@@ -15,55 +16,73 @@ void Box::Render(SkCanvas* canvas) {
         return;
     }
     
-    // Save canvas state
-    canvas->save();
-    
-    // Apply transform if any
-    if (!transform_.isIdentity()) {
-        canvas->concat(transform_);
+    if (BeginRender(canvas)) {
+        canvas->restore();
+    }
+}
+
+bool Box::Record(::KiUI::graphics::DrawCommandBuffer& buffer) {
+    if (!GetVisibility()) {
+        return true;
     }
     
-    // Calculate border width (use average if different sides have different widths)
-    float avgBorderWidth = 0.0f;
-    bool hasBorder = false;
-    if (borderWidthTop_ > 0.0f || borderWidthBottom_ > 0.0f || 
-        borderWidthLeft_ > 0.0f || borderWidthRight_ > 0.0f) {
-        hasBorder = true;
-        avgBorderWidth = (borderWidthTop_ + borderWidthBottom_ + 
-                         borderWidthLeft_ + borderWidthRight_) / 4.0f;
+    // 变换直接折算进命令矩阵，不需要画布 save/concat/restore
+    const SkMatrix parentMatrix = buffer.GetMatrix();
+    const bool hasTransform = !transform_.isIdentity();
+    if (hasTransform) {
+        buffer.SetMatrix(SkMatrix::Concat(parentMatrix, transform_));
     }
     
-    // Check if we have border radius
-    bool hasBorderRadius = (borderRadiusTopLeft_ > 0.0f || borderRadiusTopRight_ > 0.0f || 
-                           borderRadiusBottomLeft_ > 0.0f || borderRadiusBottomRight_ > 0.0f);
+    float avgBorderWidth = GetAverageBorderWidth();
+    bool hasBorder = avgBorderWidth > 0.0f;
     
-    // Use graphics layer's Shapes class for drawing
-    if (hasBorderRadius) {
-        // Draw rounded rectangle with different corner radii
-        ::KiUI::graphics::Shapes::DrawRoundedRectangle(
-            canvas,
+    if (HasBorderRadius()) {
+        buffer.AddRoundedRectangle(
             0.0f, 0.0f, width_, height_,
             borderRadiusTopLeft_, borderRadiusTopRight_,
             borderRadiusBottomRight_, borderRadiusBottomLeft_,
             backgroundColor_,
             hasBorder ? borderColor_ : SK_ColorTRANSPARENT,
             hasBorder ? avgBorderWidth : 0.0f,
-            opacity_
+            GetPaintOpacity()
         );
     } else {
-        // Draw regular rectangle
-        ::KiUI::graphics::Shapes::DrawRectangle(
-            canvas,
+        buffer.AddRectangle(
             0.0f, 0.0f, width_, height_,
             backgroundColor_,
             hasBorder ? borderColor_ : SK_ColorTRANSPARENT,
             hasBorder ? avgBorderWidth : 0.0f,
-            opacity_
+            GetPaintOpacity()
         );
     }
     
-    // Restore canvas state
-    canvas->restore();
+    if (hasTransform) {
+        buffer.SetMatrix(parentMatrix);
+    }
+    return true;
+}
+
+bool Box::GetOpaqueBounds(SkRect* rect) const {
+    if (SkColorGetA(backgroundColor_) != 0xFF || opacity_ < 1.0f || width_ <= 0.0f || height_ <= 0.0f) {
+        return false;
+    }
+    
+    if (!HasBorderRadius()) {
+        *rect = SkRect::MakeWH(width_, height_);
+        return true;
+    }
+    
+    // 圆角处不是完全覆盖：取横向和纵向两条避开圆角的矩形带中面积较大的一条
+    const float maxRadius = std::min(width_, height_) / 2.0f;
+    const float top = std::min(std::max(borderRadiusTopLeft_, borderRadiusTopRight_), maxRadius);
+    const float bottom = std::min(std::max(borderRadiusBottomLeft_, borderRadiusBottomRight_), maxRadius);
+    const float left = std::min(std::max(borderRadiusTopLeft_, borderRadiusBottomLeft_), maxRadius);
+    const float right = std::min(std::max(borderRadiusTopRight_, borderRadiusBottomRight_), maxRadius);
+    
+    SkRect horizontal = SkRect::MakeLTRB(0.0f, top, width_, height_ - bottom);
+    SkRect vertical = SkRect::MakeLTRB(left, 0.0f, width_ - right, height_);
+    *rect = horizontal.width() * horizontal.height() >= vertical.width() * vertical.height() ? horizontal : vertical;
+    return !rect->isEmpty();
 }
 
 boost::shared_ptr<VisualElement> Box::HitTest(float x, float y) {
@@ -73,4 +92,3 @@ boost::shared_ptr<VisualElement> Box::HitTest(float x, float y) {
 
 } // namespace widget
 } // namespace KiUI
-
@@ -0,0 +1,236 @@
+#include "CompositorAnimator.hpp"
+#include <logger.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+// 最短时长（毫秒），时长为 0 的动画在第一次采样时直接跳到终点
+constexpr double kMinDuration = 0.001;
+
+} // namespace
+
+bool LayerProperties::IsIdentityTransform() const {
+    return translateX == 0.0f && translateY == 0.0f && scaleX == 1.0f && scaleY == 1.0f && rotation == 0.0f;
+}
+
+SkMatrix LayerProperties::GetMatrix(float centerX, float centerY) const {
+    // 与 VisualElement::SetRenderTransform 相同：T(t + c) · R · S · T(-c)
+    SkMatrix matrix = SkMatrix::Translate(translateX + centerX, translateY + centerY);
+    matrix.preRotate(rotation);
+    matrix.preScale(scaleX, scaleY);
+    matrix.preTranslate(-centerX, -centerY);
+    return matrix;
+}
+
+CompositorAnimator::CompositorAnimator() {
+}
+
+CompositorAnimator::~CompositorAnimator() {
+}
+
+bool CompositorAnimator::IsSupported(AnimatedProperty property) {
+    switch (property) {
+    case AnimatedProperty::Opacity:
+    case AnimatedProperty::TranslateX:
+    case AnimatedProperty::TranslateY:
+    case AnimatedProperty::ScaleX:
+    case AnimatedProperty::ScaleY:
+    case AnimatedProperty::Rotation:
+        return true;
+    default:
+        return false;
+    }
+}
+
+float& CompositorAnimator::Component(LayerProperties& properties, AnimatedProperty property) {
+    switch (property) {
+    case AnimatedProperty::TranslateX:
+        return properties.translateX;
+    case AnimatedProperty::TranslateY:
+        return properties.translateY;
+    case AnimatedProperty::ScaleX:
+        return properties.scaleX;
+    case AnimatedProperty::ScaleY:
+        return properties.scaleY;
+    case AnimatedProperty::Rotation:
+        return properties.rotation;
+    default:
+        return properties.opacity;
+    }
+}
+
+AnimationId CompositorAnimator::Animate(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property,
+                                        float to, const AnimationOptions& options) {
+    if (!target) {
+        return 0;
+    }
+    LayerProperties current;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = layers_.find(target.get());
+        if (it != layers_.end() && it->second.element.lock() == target) {
+            current = it->second.properties;
+        }
+    }
+    return Animate(target, property, Component(current, property), to, options);
+}
+
+AnimationId CompositorAnimator::Animate(const boost::shared_ptr<VisualElement>& target, AnimatedProperty property,
+                                        float from, float to, const AnimationOptions& options) {
+    if (!target) {
+        return 0;
+    }
+    if (!IsSupported(property)) {
+        foundation::Logger::Error("CompositorAnimator: property {0} cannot be animated on the compositor",
+                                  static_cast<int>(property));
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 地址可能被新组件复用：旧组件留下的图层属性不能带到新组件上
+    Layer& layer = layers_[target.get()];
+    if (layer.element.lock() != target) {
+        animations_.erase(std::remove_if(animations_.begin(), animations_.end(),
+                                         [&](const Animation& animation) { return animation.target == target.get(); }),
+                          animations_.end());
+        layer.element = target;
+        layer.properties = LayerProperties();
+    }
+
+    // 同一属性上的旧动画停在当前值，新动画替换它
+    for (auto it = animations_.begin(); it != animations_.end(); ++it) {
+        if (it->target == target.get() && it->property == property) {
+            finished_.push_back(it->id);
+            animations_.erase(it);
+            break;
+        }
+    }
+
+    Animation animation;
+    animation.id = nextId_++;
+    animation.target = target.get();
+    animation.property = property;
+    animation.from = from;
+    animation.to = to;
+    animation.options = options;
+    animation.started = false;
+    animations_.push_back(animation);
+    Component(layer.properties, property) = from;
+    return animation.id;
+}
+
+bool CompositorAnimator::Cancel(AnimationId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = animations_.begin(); it != animations_.end(); ++it) {
+        if (it->id == id) {
+            animations_.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CompositorAnimator::RemoveLayer(const VisualElement* target) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    animations_.erase(std::remove_if(animations_.begin(), animations_.end(),
+                                     [&](const Animation& animation) { return animation.target == target; }),
+                      animations_.end());
+    layers_.erase(target);
+}
+
+bool CompositorAnimator::IsActive(AnimationId id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::any_of(animations_.begin(), animations_.end(),
+                       [id](const Animation& animation) { return animation.id == id; });
+}
+
+size_t CompositorAnimator::GetActiveCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return animations_.size();
+}
+
+bool CompositorAnimator::Sample(TimePoint now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 目标已经销毁：只检查是否过期而不 lock，避免组件在合成线程上被析构
+    for (auto it = layers_.begin(); it != layers_.end(); ) {
+        if (it->second.element.expired()) {
+            const VisualElement* target = it->first;
+            for (auto animation = animations_.begin(); animation != animations_.end(); ) {
+                if (animation->target == target) {
+                    finished_.push_back(animation->id);
+                    animation = animations_.erase(animation);
+                } else {
+                    ++animation;
+                }
+            }
+            it = layers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // 时间按开始后的绝对时长计算，合成频率变化或 UI 线程卡顿都不会让动画变快或变慢
+    for (auto it = animations_.begin(); it != animations_.end(); ) {
+        Animation& animation = *it;
+        if (!animation.started) {
+            animation.start = now;
+            animation.started = true;
+        }
+        const double elapsed = std::chrono::duration<double, std::milli>(now - animation.start).count();
+        const double duration = std::max(static_cast<double>(animation.options.duration), kMinDuration);
+        const double repeats = animation.options.repeatCount == 0
+            ? std::numeric_limits<double>::infinity()
+            : static_cast<double>(animation.options.repeatCount);
+        const double cycles = std::max(elapsed - animation.options.delay, 0.0) / duration;
+        const double iteration = std::min(std::floor(cycles), repeats - 1.0);
+        const float fraction = static_cast<float>(std::min(cycles - iteration, 1.0));
+        const bool reversed = animation.options.autoReverse && std::fmod(iteration, 2.0) == 1.0;
+        const float progress = reversed ? 1.0f - fraction : fraction;
+        const float eased = animation.options.easing.Evaluate(progress);
+
+        Component(layers_[animation.target].properties, animation.property) =
+            animation.from + (animation.to - animation.from) * eased;
+
+        if (cycles >= repeats) {
+            finished_.push_back(animation.id);
+            it = animations_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return !animations_.empty();
+}
+
+bool CompositorAnimator::GetLayerProperties(const VisualElement* target, LayerProperties* properties) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = layers_.find(target);
+    if (it == layers_.end()) {
+        return false;
+    }
+    *properties = it->second.properties;
+    return true;
+}
+
+void CompositorAnimator::GetLayers(std::unordered_set<const VisualElement*>* layers) const {
+    layers->clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : layers_) {
+        layers->insert(entry.first);
+    }
+}
+
+std::vector<AnimationId> CompositorAnimator::TakeFinished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<AnimationId> finished;
+    finished.swap(finished_);
+    return finished;
+}
+
+} // namespace widget
+} // namespace KiUI
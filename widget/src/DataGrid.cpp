@@ -0,0 +1,553 @@
+#include "DataGrid.hpp"
+#include <logger.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace KiUI {
+namespace widget {
+
+DataGridPane::DataGridPane() {
+    // 单元格由 DataGrid 摆放，不挂到分区的 Yoga 节点上
+    SetArrangesChildren(true);
+    SetClipToBounds(true);
+}
+
+DataGridPane::~DataGridPane() {
+}
+
+void DataGridPane::SetScrollOffset(float x, float y) {
+    if (x != scrollX_ || y != scrollY_) {
+        scrollX_ = x;
+        scrollY_ = y;
+        MarkDirty(DirtyFlags::HitTest);
+        InvalidateParentVisual();
+    }
+}
+
+void DataGridPane::RecordDamage(uint64_t versionBefore, std::vector<SkRect> areas) {
+    if (subtreeVersion_ == versionBefore) {
+        return;
+    }
+    if (versionBefore != damageTo_) {
+        // 上一次记录之后有未记录的变化，更早的版本无法只重新绘制部分区域
+        damageLog_.clear();
+        damageFrom_ = versionBefore;
+    }
+    damageLog_.push_back({subtreeVersion_, std::move(areas)});
+    damageTo_ = subtreeVersion_;
+    while (damageLog_.size() > kMaxDamageEntries) {
+        damageFrom_ = damageLog_.front().version;
+        damageLog_.pop_front();
+    }
+}
+
+bool DataGridPane::GetChildScrollOffset(SkPoint* offset) const {
+    *offset = SkPoint::Make(scrollX_, scrollY_);
+    return true;
+}
+
+bool DataGridPane::GetChildDamage(uint64_t version, std::vector<SkRect>* damage) const {
+    if (subtreeVersion_ != damageTo_ || version < damageFrom_) {
+        return false;
+    }
+    for (const auto& entry : damageLog_) {
+        if (entry.version > version) {
+            damage->insert(damage->end(), entry.areas.begin(), entry.areas.end());
+        }
+    }
+    return true;
+}
+
+void DataGridPane::LayoutChildren(float, float) {
+}
+
+DataGrid::DataGrid() {
+    rowExtents_.Reset(0, kDefaultRowHeight);
+    columnExtents_.Reset(0, kDefaultColumnWidth);
+    // 分区由 Realize 摆放，不挂到表格的 Yoga 节点上
+    SetArrangesChildren(true);
+    SetClipToBounds(true);
+}
+
+DataGrid::~DataGrid() {
+}
+
+void DataGrid::SetRowCount(size_t count) {
+    if (rowExtents_.GetCount() != count) {
+        rowExtents_.Resize(count);
+        // 截断到冻结行以内时冻结区域的高度变了
+        MarkCellsForArrange();
+        Realize();
+    }
+}
+
+void DataGrid::SetColumnCount(size_t count) {
+    if (columnExtents_.GetCount() != count) {
+        columnExtents_.Resize(count);
+        MarkCellsForArrange();
+        Realize();
+    }
+}
+
+void DataGrid::SetCellFactory(CellFactory factory) {
+    RecycleAll();
+    for (auto& state : panes_) {
+        state.pools.clear();
+        if (state.pane) {
+            state.pane->RemoveChildren(0, state.pane->GetChildrenCount());
+        }
+    }
+    factory_ = std::move(factory);
+    Realize();
+}
+
+void DataGrid::SetCellBinder(CellBinder binder) {
+    binder_ = std::move(binder);
+    InvalidateCells();
+}
+
+void DataGrid::SetTemplateSelector(TemplateSelector selector) {
+    selector_ = std::move(selector);
+    InvalidateCells();
+}
+
+void DataGrid::SetDefaultRowHeight(float height) {
+    height = std::max(1.0f, height);
+    if (!rowExtents_.IsUniform() || rowExtents_.GetDefaultExtent() != height) {
+        rowExtents_.Reset(rowExtents_.GetCount(), height);
+        MarkCellsForArrange();
+        Realize();
+    }
+}
+
+void DataGrid::SetDefaultColumnWidth(float width) {
+    width = std::max(1.0f, width);
+    if (!columnExtents_.IsUniform() || columnExtents_.GetDefaultExtent() != width) {
+        columnExtents_.Reset(columnExtents_.GetCount(), width);
+        MarkCellsForArrange();
+        Realize();
+    }
+}
+
+void DataGrid::SetRowHeight(size_t row, float height) {
+    height = std::max(1.0f, height);
+    if (row < rowExtents_.GetCount() && rowExtents_.GetExtent(row) != height) {
+        rowExtents_.SetExtent(row, height);
+        MarkCellsForArrange();
+        Realize();
+    }
+}
+
+void DataGrid::SetColumnWidth(size_t column, float width) {
+    width = std::max(1.0f, width);
+    if (column < columnExtents_.GetCount() && columnExtents_.GetExtent(column) != width) {
+        columnExtents_.SetExtent(column, width);
+        MarkCellsForArrange();
+        Realize();
+    }
+}
+
+void DataGrid::SetFrozenRowCount(size_t count) {
+    if (frozenRows_ != count) {
+        frozenRows_ = count;
+        MarkCellsForArrange();
+        Realize();
+    }
+}
+
+void DataGrid::SetFrozenColumnCount(size_t count) {
+    if (frozenColumns_ != count) {
+        frozenColumns_ = count;
+        MarkCellsForArrange();
+        Realize();
+    }
+}
+
+void DataGrid::SetOverscan(size_t rows, size_t columns) {
+    if (rowOverscan_ != rows || columnOverscan_ != columns) {
+        rowOverscan_ = rows;
+        columnOverscan_ = columns;
+        Realize();
+    }
+}
+
+void DataGrid::SetScrollOffset(double x, double y) {
+    // 取整到像素，平移后的滚动图层与重新绘制的结果逐像素一致
+    x = std::round(x);
+    y = std::round(y);
+    if (x != scrollX_ || y != scrollY_) {
+        scrollX_ = x;
+        scrollY_ = y;
+        Realize();
+    }
+}
+
+double DataGrid::GetMaxScrollX() const {
+    const double frozen = GetFrozenWidth();
+    const double viewport = GetViewportWidth() - std::min(frozen, static_cast<double>(GetViewportWidth()));
+    return std::max(0.0, std::floor(columnExtents_.GetTotal() - frozen - viewport));
+}
+
+double DataGrid::GetMaxScrollY() const {
+    const double frozen = GetFrozenHeight();
+    const double viewport = GetViewportHeight() - std::min(frozen, static_cast<double>(GetViewportHeight()));
+    return std::max(0.0, std::floor(rowExtents_.GetTotal() - frozen - viewport));
+}
+
+void DataGrid::ScrollIntoView(size_t row, size_t column) {
+    double x = scrollX_;
+    double y = scrollY_;
+    if (column >= frozenColumns_ && column < columnExtents_.GetCount()) {
+        const double frozen = GetFrozenWidth();
+        const double viewport = GetViewportWidth() - std::min(frozen, static_cast<double>(GetViewportWidth()));
+        const double left = columnExtents_.GetOffset(column) - frozen;
+        const double right = left + columnExtents_.GetExtent(column);
+        if (left < x) {
+            x = std::floor(left);
+        } else if (right > x + viewport) {
+            x = std::ceil(right - viewport);
+        }
+    }
+    if (row >= frozenRows_ && row < rowExtents_.GetCount()) {
+        const double frozen = GetFrozenHeight();
+        const double viewport = GetViewportHeight() - std::min(frozen, static_cast<double>(GetViewportHeight()));
+        const double top = rowExtents_.GetOffset(row) - frozen;
+        const double bottom = top + rowExtents_.GetExtent(row);
+        if (top < y) {
+            y = std::floor(top);
+        } else if (bottom > y + viewport) {
+            y = std::ceil(bottom - viewport);
+        }
+    }
+    SetScrollOffset(x, y);
+}
+
+void DataGrid::InvalidateCell(size_t row, size_t column) {
+    if (row >= rowExtents_.GetCount() || column >= columnExtents_.GetCount()) {
+        return;
+    }
+    PaneState& state = panes_[GetPaneIndex(row, column)];
+    const size_t position = FindCell(state, row, column);
+    if (position == UIElement::npos || !state.cells[position].element) {
+        // 没有显示的单元格下次显示时总会重新绑定
+        return;
+    }
+    RealizedCell& cell = state.cells[position];
+    const uint64_t version = state.pane->GetSubtreeVersion();
+    std::vector<SkRect> damage;
+    const int templateId = selector_ ? selector_(row, column) : 0;
+    if (templateId != cell.templateId) {
+        Recycle(state, cell, &damage);
+        Acquire(state, row, column, &cell);
+    } else {
+        AddCellDamage(*cell.element, &damage);
+        if (binder_) {
+            binder_(row, column, *cell.element);
+        }
+        ++cellsBound_;
+        cell.needsLayout = true;
+    }
+    if (cell.element) {
+        ArrangeCell(cell, row, column, &damage);
+    }
+    state.pane->RecordDamage(version, std::move(damage));
+}
+
+void DataGrid::InvalidateCells() {
+    RecycleAll();
+    Realize();
+}
+
+boost::shared_ptr<VisualElement> DataGrid::GetRealizedCell(size_t row, size_t column) const {
+    const PaneState& state = panes_[GetPaneIndex(row, column)];
+    const size_t position = FindCell(state, row, column);
+    return position == UIElement::npos ? nullptr : state.cells[position].element;
+}
+
+bool DataGrid::GetCellIndex(const boost::shared_ptr<VisualElement>& element, size_t* row, size_t* column) const {
+    boost::shared_ptr<UIElement> current = element;
+    while (current) {
+        auto parent = current->GetParent();
+        for (const auto& state : panes_) {
+            if (!state.pane || parent.get() != state.pane.get()) {
+                continue;
+            }
+            for (size_t i = 0; i < state.cells.size(); ++i) {
+                if (state.cells[i].element.get() == current.get()) {
+                    *row = state.rows.first + i / state.columns.Size();
+                    *column = state.columns.first + i % state.columns.Size();
+                    return true;
+                }
+            }
+            return false;
+        }
+        current = parent;
+    }
+    return false;
+}
+
+DataGrid::Stats DataGrid::GetStats() const {
+    Stats stats;
+    for (const auto& state : panes_) {
+        for (const auto& cell : state.cells) {
+            if (cell.element) {
+                ++stats.realizedCells;
+            }
+        }
+        for (const auto& pool : state.pools) {
+            stats.pooledCells += pool.second.size();
+        }
+    }
+    stats.cellsCreated = cellsCreated_;
+    stats.cellsBound = cellsBound_;
+    stats.cellsArranged = cellsArranged_;
+    return stats;
+}
+
+void DataGrid::LayoutChildren(float, float) {
+    Realize();
+}
+
+void DataGrid::EnsurePanes() {
+    for (auto& state : panes_) {
+        if (!state.pane) {
+            state.pane = boost::make_shared<DataGridPane>();
+            AddChild(state.pane);
+        }
+    }
+}
+
+void DataGrid::Realize() {
+    EnsurePanes();
+    const size_t rowCount = rowExtents_.GetCount();
+    const size_t columnCount = columnExtents_.GetCount();
+    const float viewportWidth = GetViewportWidth();
+    const float viewportHeight = GetViewportHeight();
+    if (!factory_ || rowCount == 0 || columnCount == 0 || viewportWidth <= 0.0f || viewportHeight <= 0.0f) {
+        RecycleAll();
+        return;
+    }
+    ClampScrollOffset();
+
+    // 冻结的行列占据视口的左上部分，其余部分是主体
+    const float frozenWidth = std::min(static_cast<float>(GetFrozenWidth()), viewportWidth);
+    const float frozenHeight = std::min(static_cast<float>(GetFrozenHeight()), viewportHeight);
+    const float bodyWidth = viewportWidth - frozenWidth;
+    const float bodyHeight = viewportHeight - frozenHeight;
+    panes_[kCornerPane].pane->Arrange(paddingLeft_, paddingTop_, frozenWidth, frozenHeight);
+    panes_[kColumnHeaderPane].pane->Arrange(paddingLeft_ + frozenWidth, paddingTop_, bodyWidth, frozenHeight);
+    panes_[kRowHeaderPane].pane->Arrange(paddingLeft_, paddingTop_ + frozenHeight, frozenWidth, bodyHeight);
+    panes_[kBodyPane].pane->Arrange(paddingLeft_ + frozenWidth, paddingTop_ + frozenHeight, bodyWidth, bodyHeight);
+
+    // 滚动跨过一个步长时所有单元格按新的原点重新摆放
+    const double originX = std::floor(scrollX_ / kOriginStep) * kOriginStep;
+    const double originY = std::floor(scrollY_ / kOriginStep) * kOriginStep;
+    if (originX != originX_ || originY != originY_) {
+        originX_ = originX;
+        originY_ = originY;
+        MarkCellsForArrange();
+    }
+    const float scrollX = static_cast<float>(scrollX_ - originX_);
+    const float scrollY = static_cast<float>(scrollY_ - originY_);
+    panes_[kCornerPane].pane->SetScrollOffset(0.0f, 0.0f);
+    panes_[kColumnHeaderPane].pane->SetScrollOffset(scrollX, 0.0f);
+    panes_[kRowHeaderPane].pane->SetScrollOffset(0.0f, scrollY);
+    panes_[kBodyPane].pane->SetScrollOffset(scrollX, scrollY);
+
+    const size_t frozenRowCount = std::min(frozenRows_, rowCount);
+    const size_t frozenColumnCount = std::min(frozenColumns_, columnCount);
+    Range frozenRows;
+    frozenRows.last = frozenHeight > 0.0f ? std::min(frozenRowCount, rowExtents_.FindIndex(frozenHeight) + 1) : 0;
+    Range frozenColumns;
+    frozenColumns.last = frozenWidth > 0.0f ? std::min(frozenColumnCount, columnExtents_.FindIndex(frozenWidth) + 1) : 0;
+
+    Range rows;
+    if (rowCount > frozenRowCount && bodyHeight > 0.0f) {
+        const double top = GetFrozenHeight() + scrollY_;
+        const size_t anchor = rowExtents_.FindIndex(top);
+        rows.first = std::max(frozenRowCount, anchor > rowOverscan_ ? anchor - rowOverscan_ : 0);
+        rows.last = std::min(rowCount, rowExtents_.FindIndex(top + bodyHeight) + 1 + rowOverscan_);
+    }
+    Range columns;
+    if (columnCount > frozenColumnCount && bodyWidth > 0.0f) {
+        const double left = GetFrozenWidth() + scrollX_;
+        const size_t anchor = columnExtents_.FindIndex(left);
+        columns.first = std::max(frozenColumnCount, anchor > columnOverscan_ ? anchor - columnOverscan_ : 0);
+        columns.last = std::min(columnCount, columnExtents_.FindIndex(left + bodyWidth) + 1 + columnOverscan_);
+    }
+
+    RealizePane(panes_[kCornerPane], frozenRows, frozenColumns);
+    RealizePane(panes_[kColumnHeaderPane], frozenRows, columns);
+    RealizePane(panes_[kRowHeaderPane], rows, frozenColumns);
+    RealizePane(panes_[kBodyPane], rows, columns);
+}
+
+void DataGrid::RealizePane(PaneState& state, Range rows, Range columns) {
+    if (rows.Size() == 0 || columns.Size() == 0) {
+        rows = Range();
+        columns = Range();
+    }
+    const uint64_t version = state.pane->GetSubtreeVersion();
+    std::vector<SkRect> damage;
+
+    if (!(rows == state.rows && columns == state.columns)) {
+        std::vector<RealizedCell> cells(rows.Size() * columns.Size());
+        // 先回收离开范围的单元格，新进入范围的单元格可以复用它们
+        for (size_t row = state.rows.first; row < state.rows.last; ++row) {
+            for (size_t column = state.columns.first; column < state.columns.last; ++column) {
+                RealizedCell& cell = state.cells[(row - state.rows.first) * state.columns.Size() + column - state.columns.first];
+                if (!cell.element) {
+                    continue;
+                }
+                if (rows.Contains(row) && columns.Contains(column)) {
+                    cells[(row - rows.first) * columns.Size() + column - columns.first] = std::move(cell);
+                } else {
+                    Recycle(state, cell, &damage);
+                }
+            }
+        }
+        for (size_t row = rows.first; row < rows.last; ++row) {
+            for (size_t column = columns.first; column < columns.last; ++column) {
+                RealizedCell& cell = cells[(row - rows.first) * columns.Size() + column - columns.first];
+                if (!cell.element) {
+                    Acquire(state, row, column, &cell);
+                }
+            }
+        }
+        state.cells.swap(cells);
+        state.rows = rows;
+        state.columns = columns;
+    }
+
+    // 范围不变时滚动不修改任何单元格
+    for (size_t row = rows.first; row < rows.last; ++row) {
+        for (size_t column = columns.first; column < columns.last; ++column) {
+            RealizedCell& cell = state.cells[(row - rows.first) * columns.Size() + column - columns.first];
+            if (cell.element && cell.needsArrange) {
+                ArrangeCell(cell, row, column, &damage);
+            }
+        }
+    }
+    state.pane->RecordDamage(version, std::move(damage));
+}
+
+bool DataGrid::Acquire(PaneState& state, size_t row, size_t column, RealizedCell* cell) {
+    const int templateId = selector_ ? selector_(row, column) : 0;
+    boost::shared_ptr<VisualElement> element;
+    auto& pool = state.pools[templateId];
+    if (!pool.empty()) {
+        element = std::move(pool.back());
+        pool.pop_back();
+    } else {
+        element = factory_(templateId);
+        if (!element) {
+            foundation::Logger::Error("DataGrid: cell factory returned no element for template {0}", templateId);
+            return false;
+        }
+        // 摆放之前保持隐藏，不在原来的位置留下变化区域
+        element->SetVisibility(false);
+        state.pane->AddChild(element);
+        ++cellsCreated_;
+    }
+    if (binder_) {
+        binder_(row, column, *element);
+    }
+    ++cellsBound_;
+
+    cell->element = std::move(element);
+    cell->templateId = templateId;
+    cell->needsArrange = true;
+    cell->needsLayout = true;
+    return true;
+}
+
+void DataGrid::Recycle(PaneState& state, RealizedCell& cell, std::vector<SkRect>* damage) {
+    if (!cell.element) {
+        return;
+    }
+    AddCellDamage(*cell.element, damage);
+    cell.element->SetVisibility(false);
+    state.pools[cell.templateId].push_back(std::move(cell.element));
+    cell.element.reset();
+}
+
+void DataGrid::RecycleAll() {
+    for (auto& state : panes_) {
+        if (!state.pane) {
+            continue;
+        }
+        const uint64_t version = state.pane->GetSubtreeVersion();
+        std::vector<SkRect> damage;
+        for (auto& cell : state.cells) {
+            Recycle(state, cell, &damage);
+        }
+        state.cells.clear();
+        state.rows = Range();
+        state.columns = Range();
+        state.pane->RecordDamage(version, std::move(damage));
+    }
+}
+
+void DataGrid::ArrangeCell(RealizedCell& cell, size_t row, size_t column, std::vector<SkRect>* damage) {
+    VisualElement& element = *cell.element;
+    // 冻结的行列从分区原点开始，其余的行列相对冻结区域之后的滚动原点
+    const double x = columnExtents_.GetOffset(column) - (column < frozenColumns_ ? 0.0 : GetFrozenWidth() + originX_);
+    const double y = rowExtents_.GetOffset(row) - (row < frozenRows_ ? 0.0 : GetFrozenHeight() + originY_);
+    const float left = static_cast<float>(x);
+    const float top = static_cast<float>(y);
+    const float width = columnExtents_.GetExtent(column);
+    const float height = rowExtents_.GetExtent(row);
+    cell.needsArrange = false;
+    if (element.GetVisibility() && !cell.needsLayout && element.GetLeft() == left && element.GetTop() == top &&
+        element.GetWidth() == width && element.GetHeight() == height) {
+        return;
+    }
+
+    AddCellDamage(element, damage);
+    if (!element.GetVisibility()) {
+        element.SetVisibility(true);
+    }
+    element.Arrange(left, top, width, height, cell.needsLayout);
+    AddCellDamage(element, damage);
+    cell.needsLayout = false;
+    ++cellsArranged_;
+}
+
+void DataGrid::MarkCellsForArrange() {
+    for (auto& state : panes_) {
+        for (auto& cell : state.cells) {
+            cell.needsArrange = true;
+        }
+    }
+}
+
+void DataGrid::ClampScrollOffset() {
+    scrollX_ = std::clamp(scrollX_, 0.0, GetMaxScrollX());
+    scrollY_ = std::clamp(scrollY_, 0.0, GetMaxScrollY());
+}
+
+DataGrid::PaneIndex DataGrid::GetPaneIndex(size_t row, size_t column) const {
+    return static_cast<PaneIndex>((row >= frozenRows_ ? kRowHeaderPane : kCornerPane) |
+                                  (column >= frozenColumns_ ? kColumnHeaderPane : kCornerPane));
+}
+
+size_t DataGrid::FindCell(const PaneState& state, size_t row, size_t column) {
+    if (!state.rows.Contains(row) || !state.columns.Contains(column)) {
+        return UIElement::npos;
+    }
+    return (row - state.rows.first) * state.columns.Size() + column - state.columns.first;
+}
+
+void DataGrid::AddCellDamage(VisualElement& element, std::vector<SkRect>* damage) {
+    if (!element.GetVisibility()) {
+        return;
+    }
+    const SkRect bounds = element.GetSubtreeBounds().makeOffset(element.GetLeft(), element.GetTop());
+    if (!bounds.isEmpty()) {
+        damage->push_back(bounds);
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
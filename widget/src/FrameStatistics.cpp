@@ -0,0 +1,233 @@
+#include "FrameStatistics.hpp"
+#include <algorithm>
+#include <cmath>
+
+#ifdef TRACY_ENABLE
+#include <tracy/Tracy.hpp>
+#endif
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+const char* const kPhaseNames[] = {"Events", "Tasks", "Animation", "Style", "Layout", "Paint", "Flush", "Swap"};
+
+#ifdef TRACY_ENABLE
+// Tracy 图表名称需要在整个程序运行期间保持有效
+const char* const kPhasePlots[] = {
+    "Frame Events (ms)", "Frame Tasks (ms)", "Frame Animation (ms)", "Frame Style (ms)",
+    "Frame Layout (ms)", "Frame Paint (ms)", "Frame Flush (ms)", "Frame Swap (ms)"};
+#endif
+
+float ToMilliseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<float, std::milli>(duration).count();
+}
+
+} // namespace
+
+static_assert(sizeof(kPhaseNames) / sizeof(kPhaseNames[0]) == FrameStatistics::kPhaseCount,
+              "every FramePhase needs a name");
+
+FrameStatistics::FrameStatistics(size_t capacity)
+    : ring_(std::max<size_t>(capacity, 1)),
+      histograms_(kSeriesCount) {
+    Reset();
+}
+
+FrameStatistics::~FrameStatistics() {
+}
+
+const char* FrameStatistics::GetPhaseName(FramePhase phase) {
+    const size_t index = static_cast<size_t>(phase);
+    return index < kPhaseCount ? kPhaseNames[index] : "Unknown";
+}
+
+void FrameStatistics::SetFrameBudget(float milliseconds) {
+    if (milliseconds > 0.0f) {
+        budget_ = milliseconds;
+    }
+}
+
+void FrameStatistics::BeginFrame(TimePoint now) {
+    current_ = FrameTiming();
+    current_.frameIndex = frameIndex_;
+    frameStart_ = now;
+    inFrame_ = true;
+}
+
+void FrameStatistics::MarkIdle() {
+    // 空闲期间本来就不需要画帧，这段间隔不是卡顿
+    hasLastFrame_ = false;
+}
+
+void FrameStatistics::RecordPhase(FramePhase phase, float milliseconds) {
+    const size_t index = static_cast<size_t>(phase);
+    if (!inFrame_ || index >= kPhaseCount) {
+        return;
+    }
+    current_.phases[index] += std::max(milliseconds, 0.0f);
+}
+
+void FrameStatistics::EndFrame(TimePoint now) {
+    if (!inFrame_) {
+        return;
+    }
+    inFrame_ = false;
+    current_.total = std::max(ToMilliseconds(now - frameStart_), 0.0f);
+    // 交换缓冲区阻塞到垂直同步是在等待显示，不是本帧的工作量
+    current_.work = std::max(current_.total - current_.GetPhase(FramePhase::Swap), 0.0f);
+
+    // 两帧开始时间的间隔超过预算的整数倍，说明中间错过了显示刷新
+    if (hasLastFrame_) {
+        current_.interval = std::max(ToMilliseconds(frameStart_ - lastFrameStart_), 0.0f);
+        const long missed = std::lround(current_.interval / budget_) - 1;
+        current_.droppedFrames = missed > 0 ? static_cast<uint32_t>(missed) : 0;
+    }
+    lastFrameStart_ = frameStart_;
+    hasLastFrame_ = true;
+    ++frameIndex_;
+    droppedFrames_ += current_.droppedFrames;
+
+    // 覆盖最旧的一帧：先把它从直方图中移除
+    if (count_ == ring_.size()) {
+        AddToHistograms(ring_[next_], -1);
+    } else {
+        ++count_;
+    }
+    ring_[next_] = current_;
+    AddToHistograms(current_, 1);
+    next_ = (next_ + 1) % ring_.size();
+    lastFrame_ = current_;
+
+#ifdef TRACY_ENABLE
+    TracyPlot("Frame Time (ms)", current_.total);
+    TracyPlot("Frame Interval (ms)", current_.interval);
+    TracyPlot("Dropped Frames", static_cast<int64_t>(current_.droppedFrames));
+    for (size_t phase = 0; phase < kPhaseCount; ++phase) {
+        TracyPlot(kPhasePlots[phase], current_.phases[phase]);
+    }
+#endif
+
+    if (current_.work > budget_) {
+        ++overBudgetFrames_;
+        OnFrameOverBudget(lastFrame_);
+    }
+}
+
+FrameStatistics::ScopedPhase::ScopedPhase(FrameStatistics& statistics, FramePhase phase)
+    : statistics_(statistics), phase_(phase), start_(std::chrono::steady_clock::now()) {
+}
+
+FrameStatistics::ScopedPhase::~ScopedPhase() {
+    statistics_.RecordPhase(phase_, ToMilliseconds(std::chrono::steady_clock::now() - start_));
+}
+
+size_t FrameStatistics::BucketOf(float milliseconds) {
+    const float bucket = std::floor(milliseconds / kBucketWidth);
+    return bucket >= static_cast<float>(kBucketCount) ? kBucketCount : static_cast<size_t>(std::max(bucket, 0.0f));
+}
+
+float FrameStatistics::SeriesValue(const FrameTiming& frame, size_t series) {
+    return series == 0 ? frame.total : frame.phases[series - 1];
+}
+
+void FrameStatistics::AddToHistograms(const FrameTiming& frame, int delta) {
+    for (size_t series = 0; series < kSeriesCount; ++series) {
+        histograms_[series][BucketOf(SeriesValue(frame, series))] += delta;
+    }
+}
+
+float FrameStatistics::Percentile(size_t series, float percentile) const {
+    if (count_ == 0) {
+        return 0.0f;
+    }
+    // 最近秩：第 rank 小的帧（从 1 开始）
+    const float clamped = std::clamp(percentile, 0.0f, 100.0f);
+    const size_t rank = std::max<size_t>(static_cast<size_t>(std::ceil(clamped / 100.0f * count_)), 1);
+
+    const Histogram& histogram = histograms_[series];
+    size_t seen = 0;
+    for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+        seen += histogram[bucket];
+        if (seen >= rank) {
+            return bucket * kBucketWidth;           // 桶的下界
+        }
+    }
+
+    // 落在溢出桶：这些慢帧很少，回到环形缓冲区中精确查找
+    overflow_.clear();
+    const float limit = kBucketCount * kBucketWidth;
+    for (size_t i = 0; i < count_; ++i) {
+        const float value = SeriesValue(ring_[i], series);
+        if (BucketOf(value) == kBucketCount) {
+            overflow_.push_back(value);
+        }
+    }
+    if (overflow_.empty()) {
+        return limit;
+    }
+    const size_t index = std::min(rank - seen - 1, overflow_.size() - 1);
+    std::nth_element(overflow_.begin(), overflow_.begin() + index, overflow_.end());
+    return overflow_[index];
+}
+
+float FrameStatistics::GetPercentile(float percentile) const {
+    return Percentile(0, percentile);
+}
+
+float FrameStatistics::GetPhasePercentile(FramePhase phase, float percentile) const {
+    const size_t index = static_cast<size_t>(phase);
+    return index < kPhaseCount ? Percentile(index + 1, percentile) : 0.0f;
+}
+
+FrameStatistics::Summary FrameStatistics::GetSummary() const {
+    Summary summary;
+    summary.frames = count_;
+    summary.overBudgetFrames = overBudgetFrames_;
+    summary.droppedFrames = droppedFrames_;
+    if (count_ == 0) {
+        return summary;
+    }
+    summary.p50 = Percentile(0, 50.0f);
+    summary.p95 = Percentile(0, 95.0f);
+    summary.p99 = Percentile(0, 99.0f);
+    float sum = 0.0f;
+    for (size_t i = 0; i < count_; ++i) {
+        sum += ring_[i].total;
+        summary.max = std::max(summary.max, ring_[i].total);
+    }
+    summary.average = sum / static_cast<float>(count_);
+    for (size_t phase = 0; phase < kPhaseCount; ++phase) {
+        summary.phaseP95[phase] = Percentile(phase + 1, 95.0f);
+    }
+    return summary;
+}
+
+std::vector<FrameTiming> FrameStatistics::GetFrames() const {
+    std::vector<FrameTiming> frames;
+    frames.reserve(count_);
+    const size_t first = count_ == ring_.size() ? next_ : 0;
+    for (size_t i = 0; i < count_; ++i) {
+        frames.push_back(ring_[(first + i) % ring_.size()]);
+    }
+    return frames;
+}
+
+void FrameStatistics::Reset() {
+    next_ = 0;
+    count_ = 0;
+    for (auto& histogram : histograms_) {
+        histogram.fill(0);
+    }
+    inFrame_ = false;
+    hasLastFrame_ = false;
+    current_ = FrameTiming();
+    lastFrame_ = FrameTiming();
+    frameIndex_ = 0;
+    overBudgetFrames_ = 0;
+    droppedFrames_ = 0;
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,360 @@
+#include "Image.hpp"
+#include <Shapes.hpp>
+#include <window.hpp>
+#include <logger.hpp>
+#include <include/core/SkSamplingOptions.h>
+#include <include/gpu/ganesh/GrDirectContext.h>
+#include <include/gpu/ganesh/GrRecordingContext.h>
+#include <include/gpu/ganesh/SkImageGanesh.h>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+// 预算对所有 Image 生效；剩余量按渲染线程分别计算（共享上下文的多窗口各自在自己的线程上传）
+std::atomic<size_t> g_uploadBudget{Image::kDefaultUploadBudget};
+thread_local size_t t_uploadRemaining = Image::kDefaultUploadBudget;
+thread_local bool t_uploadedThisFrame = false;
+
+bool TryConsumeUploadBudget(size_t bytes) {
+    // 每帧至少放行一次，否则超过预算的大图永远不会上传
+    if (t_uploadedThisFrame && bytes > t_uploadRemaining) {
+        return false;
+    }
+    t_uploadRemaining = bytes > t_uploadRemaining ? 0 : t_uploadRemaining - bytes;
+    t_uploadedThisFrame = true;
+    return true;
+}
+
+} // namespace
+
+Image::Image() {
+}
+
+Image::~Image() {
+}
+
+void Image::SetSource(const std::string& path) {
+    if (path == source_ && state_ != ImageState::Failed) {
+        return;
+    }
+
+    source_ = path;
+    cacheKey_ = ImageCache::Key();
+    sourceWidth_ = 0;
+    sourceHeight_ = 0;
+    if (path.empty()) {
+        ++loadGeneration_;
+        loadPending_ = false;
+        image_.reset();
+        texture_.reset();
+        state_ = ImageState::Empty;
+        InvalidateVisual();
+        return;
+    }
+
+    if (width_ <= 0.0f || height_ <= 0.0f) {
+        // 尺寸还没确定，按原图解码会浪费内存；等第一次渲染拿到布局结果再解码
+        ++loadGeneration_;
+        loadPending_ = true;
+        image_.reset();
+        texture_.reset();
+        state_ = ImageState::Loading;
+        InvalidateVisual();
+        return;
+    }
+
+    StartLoad(ComputeDecodeTarget(), false);
+}
+
+ImageDecoder::TargetSize Image::ComputeDecodeTarget() const {
+    ImageDecoder::TargetSize target;
+    target.width = static_cast<int>(std::ceil(width_ * deviceScale_));
+    target.height = static_cast<int>(std::ceil(height_ * deviceScale_));
+    target.cover = stretch_ != ImageStretch::Uniform;
+    return target;
+}
+
+void Image::StartLoad(const ImageDecoder::TargetSize& target, bool keepCurrent) {
+    const uint64_t generation = ++loadGeneration_;
+    loadPending_ = false;
+    reloading_ = keepCurrent;
+    if (!keepCurrent) {
+        image_.reset();
+        texture_.reset();
+        state_ = ImageState::Loading;
+        InvalidateVisual();
+    }
+
+    ImageCache::Key key;
+    key.source = source_;
+    key.target = target;
+
+    ImageCache::Entry cached;
+    if (ImageCache::GetSharedInstance().Find(key, &cached)) {
+        OnDecoded(generation, key, cached, std::string());
+        return;
+    }
+
+    // 解码结果在后台线程直接写入缓存，元素在解码期间被销毁也不会浪费这次解码
+    auto decode = [key]() {
+        ImageDecoder::Result result = ImageDecoder::DecodeFile(key.source, key.target);
+        ImageCache::Entry entry;
+        entry.image = result.image;
+        entry.sourceWidth = result.sourceWidth;
+        entry.sourceHeight = result.sourceHeight;
+        if (entry.image) {
+            ImageCache::GetSharedInstance().Insert(key, entry);
+        }
+        return std::make_pair(entry, result.error);
+    };
+
+    boost::shared_ptr<Image> self;
+    try {
+        self = boost::static_pointer_cast<Image>(shared_from_this());
+    } catch (const boost::bad_weak_ptr&) {
+    }
+
+    if (!self) {
+        // 没有被 shared_ptr 持有时无法安全地异步回调，只能同步解码
+        auto decoded = decode();
+        OnDecoded(generation, key, decoded.first, decoded.second);
+        return;
+    }
+
+    foundation::WindowManager::GetSharedInstance().ExecuteBackgroundTask(
+        self,
+        decode,
+        [generation, key](boost::shared_ptr<Image> image, const std::pair<ImageCache::Entry, std::string>& decoded) {
+            image->OnDecoded(generation, key, decoded.first, decoded.second);
+        });
+}
+
+void Image::OnDecoded(uint64_t generation, const ImageCache::Key& key, const ImageCache::Entry& entry, const std::string& error) {
+    // 解码期间换了图片，丢弃过期结果
+    if (generation != loadGeneration_) {
+        return;
+    }
+
+    const bool wasReloading = reloading_;
+    reloading_ = false;
+    if (!entry.image) {
+        if (wasReloading) {
+            // 放大重新解码失败时保留当前图片
+            return;
+        }
+        foundation::Logger::Error("Image: Failed to load {0}: {1}", source_, error);
+        state_ = ImageState::Failed;
+        InvalidateVisual();
+        OnLoaded(false);
+        return;
+    }
+
+    cacheKey_ = key;
+    image_ = entry.image;
+    texture_.reset();
+    sourceWidth_ = entry.sourceWidth;
+    sourceHeight_ = entry.sourceHeight;
+    state_ = ImageState::Decoded;
+    InvalidateVisual();
+    if (!wasReloading) {
+        OnLoaded(true);
+    }
+}
+
+void Image::ReloadIfTooSmall() {
+    if (source_.empty() || reloading_ || !image_ || cacheKey_.source.empty()) {
+        return;
+    }
+
+    // 留 25% 余量，避免尺寸小幅变化（例如动画）反复解码
+    const ImageDecoder::TargetSize target = ComputeDecodeTarget();
+    const SkISize wanted = ImageDecoder::ComputeScaledSize(sourceWidth_, sourceHeight_, target);
+    if (wanted.width() * 4 > image_->width() * 5 || wanted.height() * 4 > image_->height() * 5) {
+        StartLoad(target, true);
+    }
+}
+
+void Image::SetImage(sk_sp<SkImage> image) {
+    ++loadGeneration_;
+    loadPending_ = false;
+    reloading_ = false;
+    source_.clear();
+    cacheKey_ = ImageCache::Key();
+    image_ = std::move(image);
+    texture_.reset();
+    state_ = image_ ? ImageState::Decoded : ImageState::Empty;
+    InvalidateVisual();
+}
+
+void Image::SetStretch(ImageStretch stretch) {
+    if (stretch_ != stretch) {
+        stretch_ = stretch;
+        InvalidateVisual();
+    }
+}
+
+void Image::SetPlaceholderColor(SkColor color) {
+    if (placeholderColor_ != color) {
+        placeholderColor_ = color;
+        InvalidateVisual();
+    }
+}
+
+void Image::SetUploadBudget(size_t bytesPerFrame) {
+    g_uploadBudget = bytesPerFrame;
+}
+
+size_t Image::GetUploadBudget() {
+    return g_uploadBudget;
+}
+
+void Image::BeginFrame() {
+    t_uploadRemaining = g_uploadBudget;
+    t_uploadedThisFrame = false;
+}
+
+bool Image::EnsureDrawable(SkCanvas* canvas, bool needMipmaps) {
+    if (!image_) {
+        return false;
+    }
+
+    GrRecordingContext* recordingContext = canvas->recordingContext();
+    GrDirectContext* directContext = recordingContext ? recordingContext->asDirectContext() : nullptr;
+    if (!directContext) {
+        // 光栅画布直接绘制 CPU 图片
+        if (image_->isTextureBacked()) {
+            return false;
+        }
+        state_ = ImageState::Ready;
+        return true;
+    }
+
+    if (texture_ && texture_->isValid(recordingContext) && (!needMipmaps || texture_->hasMipmaps())) {
+        return true;
+    }
+    if (image_->isTextureBacked() && image_->isValid(recordingContext)) {
+        texture_ = image_;
+        state_ = ImageState::Ready;
+        return true;
+    }
+
+    // 其他显示同一张图片的元素可能已经在这个上下文上上传过
+    ImageCache& cache = ImageCache::GetSharedInstance();
+    if (!cacheKey_.source.empty()) {
+        sk_sp<SkImage> cached = cache.FindTexture(cacheKey_, directContext);
+        if (cached && cached->isValid(recordingContext) && (!needMipmaps || cached->hasMipmaps())) {
+            texture_ = std::move(cached);
+            state_ = ImageState::Ready;
+            return true;
+        }
+    }
+
+    // 直接在 GPU 画布上绘制光栅图片会在绘制时同步上传；这里显式上传并限制每帧的上传量
+    size_t uploadBytes = image_->imageInfo().computeMinByteSize();
+    if (needMipmaps) {
+        uploadBytes += uploadBytes / 3;
+    }
+    if (!TryConsumeUploadBudget(uploadBytes)) {
+        // 本帧预算已用完：先画占位，确保下一帧（包括缓存的透明度图层）会重新绘制
+        InvalidateVisual();
+        return false;
+    }
+
+    texture_ = SkImages::TextureFromImage(directContext, image_.get(),
+                                          needMipmaps ? skgpu::Mipmapped::kYes : skgpu::Mipmapped::kNo,
+                                          skgpu::Budgeted::kYes);
+    if (!texture_) {
+        foundation::Logger::Error("Image: Failed to upload texture for {0}", source_);
+        state_ = ImageState::Failed;
+        return false;
+    }
+    if (!cacheKey_.source.empty()) {
+        cache.SetTexture(cacheKey_, directContext, texture_);
+    }
+    state_ = ImageState::Ready;
+    return true;
+}
+
+void Image::ComputeRects(SkRect* src, SkRect* dst) const {
+    const float imageWidth = static_cast<float>(image_->width());
+    const float imageHeight = static_cast<float>(image_->height());
+    *src = SkRect::MakeWH(imageWidth, imageHeight);
+    *dst = SkRect::MakeWH(width_, height_);
+    if (stretch_ == ImageStretch::Fill || imageWidth <= 0.0f || imageHeight <= 0.0f ||
+        width_ <= 0.0f || height_ <= 0.0f) {
+        return;
+    }
+
+    const float scaleX = width_ / imageWidth;
+    const float scaleY = height_ / imageHeight;
+    if (stretch_ == ImageStretch::Uniform) {
+        // 居中显示完整图片
+        const float scale = std::min(scaleX, scaleY);
+        const float width = imageWidth * scale;
+        const float height = imageHeight * scale;
+        *dst = SkRect::MakeXYWH((width_ - width) / 2.0f, (height_ - height) / 2.0f, width, height);
+    } else {
+        // 只取图片中间与元素宽高比相同的部分，不需要额外裁剪
+        const float scale = std::max(scaleX, scaleY);
+        const float width = width_ / scale;
+        const float height = height_ / scale;
+        *src = SkRect::MakeXYWH((imageWidth - width) / 2.0f, (imageHeight - height) / 2.0f, width, height);
+    }
+}
+
+void Image::Render(SkCanvas* canvas) {
+    if (!canvas || !GetVisibility()) {
+        return;
+    }
+
+    const bool hasTransform = BeginRender(canvas);
+
+    // 画布缩放（DPI 缩放和祖先的变换）决定需要的设备像素；透视变换下 getMaxScale 返回负值，保持上次的结果
+    const float deviceScale = canvas->getTotalMatrix().getMaxScale();
+    if (deviceScale > 0.0f) {
+        deviceScale_ = deviceScale;
+    }
+    if (loadPending_) {
+        StartLoad(ComputeDecodeTarget(), false);
+    } else {
+        ReloadIfTooSmall();
+    }
+
+    const float opacity = GetPaintOpacity();
+    SkRect src;
+    SkRect dst;
+    bool needMipmaps = false;
+    if (image_) {
+        // 解码已经缩小到显示尺寸，通常不需要 mipmap；只有被缩小到一半以下绘制（例如缩放动画）才生成
+        ComputeRects(&src, &dst);
+        needMipmaps = dst.width() * deviceScale_ * 2.0f < src.width() ||
+                      dst.height() * deviceScale_ * 2.0f < src.height();
+    }
+
+    if (EnsureDrawable(canvas, needMipmaps)) {
+        SkPaint paint;
+        paint.setAlphaf(opacity);
+        const SkSamplingOptions sampling = needMipmaps
+            ? SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kLinear)
+            : SkSamplingOptions(SkFilterMode::kLinear);
+        canvas->drawImageRect(texture_ ? texture_ : image_, src, dst, sampling, &paint,
+                              SkCanvas::kFast_SrcRectConstraint);
+    } else if (SkColorGetA(placeholderColor_) != 0) {
+        ::KiUI::graphics::Shapes::DrawRectangle(canvas, 0.0f, 0.0f, width_, height_,
+                                                placeholderColor_, SK_ColorTRANSPARENT, 0.0f, opacity);
+    }
+
+    if (hasTransform) {
+        canvas->restore();
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,226 @@
+#include "ImageCache.hpp"
+#include <RenderContext.hpp>
+#include <algorithm>
+#include <functional>
+
+namespace KiUI {
+namespace widget {
+
+size_t ImageCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<std::string>()(key.source);
+    hash ^= std::hash<int>()(key.target.width) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int>()(key.target.height) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= static_cast<size_t>(key.target.cover);
+    return hash;
+}
+
+ImageCache::ImageCache() {
+    // 上下文关闭时它的纹理还在缓存里，必须在 Skia 上下文释放之前、在它的线程上放掉
+    shutdownConnection_ = graphics::RenderContext::OnContextShutdown().connect(
+        [this](GrDirectContext* context) { ReleaseTextures(context); });
+}
+
+ImageCache& ImageCache::GetSharedInstance() {
+    static ImageCache instance;
+    return instance;
+}
+
+size_t ImageCache::ComputeBytes(const sk_sp<SkImage>& image) {
+    if (!image) {
+        return 0;
+    }
+    if (image->isTextureBacked()) {
+        return image->textureSize();
+    }
+    return image->imageInfo().computeMinByteSize();
+}
+
+size_t ImageCache::ComputeNodeBytes(const Node& node) {
+    size_t bytes = ComputeBytes(node.entry.image);
+    for (const Texture& texture : node.textures) {
+        bytes += ComputeBytes(texture.image);
+    }
+    return bytes;
+}
+
+void ImageCache::SetBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+    EvictLocked();
+}
+
+size_t ImageCache::GetBudget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+bool ImageCache::Find(const Key& key, Entry* entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++misses_;
+        return false;
+    }
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    if (entry) {
+        *entry = it->second->entry;
+    }
+    return true;
+}
+
+void ImageCache::Insert(const Key& key, const Entry& entry) {
+    if (!entry.image) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // 替换的条目可能带着纹理，而 Insert 通常在后台解码线程上调用
+        RetireTexturesLocked(*it->second);
+        usedBytes_ -= it->second->bytes;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    Node node;
+    node.key = key;
+    node.entry = entry;
+    node.bytes = ComputeNodeBytes(node);
+    lru_.push_front(std::move(node));
+    index_[key] = lru_.begin();
+    usedBytes_ += lru_.front().bytes;
+    EvictLocked();
+}
+
+sk_sp<SkImage> ImageCache::FindTexture(const Key& key, GrDirectContext* context) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    for (const Texture& texture : it->second->textures) {
+        if (texture.context == context) {
+            return texture.image;
+        }
+    }
+    return nullptr;
+}
+
+void ImageCache::SetTexture(const Key& key, GrDirectContext* context, sk_sp<SkImage> texture) {
+    // 在锁外释放被替换的纹理：调用方就是该上下文的线程
+    sk_sp<SkImage> replaced;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end() || !context) {
+        return;
+    }
+    Node& node = *it->second;
+    usedBytes_ -= node.bytes;
+    auto existing = std::find_if(node.textures.begin(), node.textures.end(),
+                                 [context](const Texture& entry) { return entry.context == context; });
+    if (existing == node.textures.end()) {
+        node.textures.push_back(Texture{context, std::move(texture)});
+    } else {
+        replaced = std::move(existing->image);
+        existing->image = std::move(texture);
+    }
+    node.bytes = ComputeNodeBytes(node);
+    usedBytes_ += node.bytes;
+    EvictLocked();
+}
+
+void ImageCache::ReleaseRetiredTextures(GrDirectContext* context) {
+    std::vector<sk_sp<SkImage>> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = retiredTextures_.find(context);
+        if (it == retiredTextures_.end()) {
+            return;
+        }
+        released.swap(it->second);
+        retiredTextures_.erase(it);
+        retiredCount_ -= released.size();
+    }
+    // 离开锁之后才真正释放 GPU 资源
+    released.clear();
+}
+
+void ImageCache::ReleaseTextures(GrDirectContext* context) {
+    std::vector<sk_sp<SkImage>> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Node& node : lru_) {
+            auto last = std::remove_if(node.textures.begin(), node.textures.end(),
+                                       [context](const Texture& texture) { return texture.context == context; });
+            if (last == node.textures.end()) {
+                continue;
+            }
+            for (auto it = last; it != node.textures.end(); ++it) {
+                released.push_back(std::move(it->image));
+            }
+            node.textures.erase(last, node.textures.end());
+            usedBytes_ -= node.bytes;
+            node.bytes = ComputeNodeBytes(node);
+            usedBytes_ += node.bytes;
+        }
+        auto retired = retiredTextures_.find(context);
+        if (retired != retiredTextures_.end()) {
+            retiredCount_ -= retired->second.size();
+            for (auto& texture : retired->second) {
+                released.push_back(std::move(texture));
+            }
+            retiredTextures_.erase(retired);
+        }
+    }
+    released.clear();
+}
+
+void ImageCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Node& node : lru_) {
+        RetireTexturesLocked(node);
+    }
+    lru_.clear();
+    index_.clear();
+    usedBytes_ = 0;
+}
+
+ImageCache::Stats ImageCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.entryCount = lru_.size();
+    stats.usedBytes = usedBytes_;
+    stats.retiredTextures = retiredCount_;
+    return stats;
+}
+
+void ImageCache::EvictLocked() {
+    // 至少保留最近使用的一项，单张超过预算的图片也能显示
+    while (usedBytes_ > budget_ && lru_.size() > 1) {
+        Node& victim = lru_.back();
+        RetireTexturesLocked(victim);
+        usedBytes_ -= victim.bytes;
+        index_.erase(victim.key);
+        lru_.pop_back();
+        ++evictions_;
+    }
+}
+
+void ImageCache::RetireTexturesLocked(Node& node) {
+    // 淘汰可能发生在任意线程，纹理只能交给所属上下文的线程释放
+    for (Texture& texture : node.textures) {
+        if (texture.image) {
+            retiredTextures_[texture.context].push_back(std::move(texture.image));
+            ++retiredCount_;
+        }
+    }
+    node.textures.clear();
+}
+
+} // namespace widget
+} // namespace KiUI
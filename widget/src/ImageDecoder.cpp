@@ -0,0 +1,172 @@
+#include "ImageDecoder.hpp"
+#include <include/core/SkData.h>
+#include <include/core/SkImageInfo.h>
+#include <include/core/SkPixmap.h>
+#include <include/core/SkSamplingOptions.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#ifdef WIDGET_USE_STB
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#include <stb_image.h>
+#endif
+
+namespace KiUI {
+namespace widget {
+
+#ifdef WIDGET_USE_STB
+namespace {
+
+// 2x2 盒式滤波把预乘 RGBA 缩小一半（奇数边丢弃最后一行/列），大倍率缩小时逐级减半再做最后一次插值，避免走样
+void HalveRgba(const stbi_uc* src, int width, int height, std::vector<stbi_uc>* dst) {
+    const int halfWidth = width / 2;
+    const int halfHeight = height / 2;
+    dst->resize(static_cast<size_t>(halfWidth) * halfHeight * 4);
+    const size_t srcRow = static_cast<size_t>(width) * 4;
+    for (int y = 0; y < halfHeight; ++y) {
+        const stbi_uc* row0 = src + (y * 2) * srcRow;
+        const stbi_uc* row1 = row0 + srcRow;
+        stbi_uc* out = dst->data() + static_cast<size_t>(y) * halfWidth * 4;
+        for (int x = 0; x < halfWidth; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                const unsigned sum = row0[x * 8 + c] + row0[x * 8 + 4 + c] + row1[x * 8 + c] + row1[x * 8 + 4 + c];
+                out[x * 4 + c] = static_cast<stbi_uc>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+} // namespace
+#endif
+
+SkISize ImageDecoder::ComputeScaledSize(int sourceWidth, int sourceHeight, const TargetSize& target) {
+    if (target.width <= 0 || target.height <= 0 || sourceWidth <= 0 || sourceHeight <= 0) {
+        return SkISize::Make(sourceWidth, sourceHeight);
+    }
+    const float scaleX = static_cast<float>(target.width) / sourceWidth;
+    const float scaleY = static_cast<float>(target.height) / sourceHeight;
+    const float scale = target.cover ? std::max(scaleX, scaleY) : std::min(scaleX, scaleY);
+    if (scale >= 1.0f) {
+        return SkISize::Make(sourceWidth, sourceHeight);
+    }
+    // 向上取整保证不小于目标；减去一点余量，避免浮点误差让刚好整除的尺寸多出一个像素
+    return SkISize::Make(std::max(1, static_cast<int>(std::ceil(sourceWidth * scale - 0.01f))),
+                         std::max(1, static_cast<int>(std::ceil(sourceHeight * scale - 0.01f))));
+}
+
+ImageDecoder::Result ImageDecoder::DecodeFile(const std::string& path) {
+    return DecodeFile(path, TargetSize());
+}
+
+ImageDecoder::Result ImageDecoder::DecodeMemory(const void* data, size_t size) {
+    return DecodeMemory(data, size, TargetSize());
+}
+
+ImageDecoder::Result ImageDecoder::DecodeFile(const std::string& path, const TargetSize& target) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return Result{nullptr, "cannot open " + path, 0, 0};
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.empty()) {
+        return Result{nullptr, "empty file " + path, 0, 0};
+    }
+    return DecodeMemory(bytes.data(), bytes.size(), target);
+}
+
+ImageDecoder::Result ImageDecoder::DecodeMemory(const void* data, size_t size, const TargetSize& target) {
+#ifdef WIDGET_USE_STB
+    if (!data || size == 0 || size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        return Result{nullptr, "invalid image data", 0, 0};
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_uc* pixels = stbi_load_from_memory(static_cast<const stbi_uc*>(data), static_cast<int>(size),
+                                            &width, &height, &channels, 4);
+    if (!pixels) {
+        return Result{nullptr, stbi_failure_reason(), 0, 0};
+    }
+
+    // 在解码线程完成预乘，绘制和上传纹理时不再需要格式转换
+    const size_t pixelCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        stbi_uc* p = pixels + i * 4;
+        const unsigned alpha = p[3];
+        if (alpha != 255) {
+            p[0] = static_cast<stbi_uc>((p[0] * alpha + 127) / 255);
+            p[1] = static_cast<stbi_uc>((p[1] * alpha + 127) / 255);
+            p[2] = static_cast<stbi_uc>((p[2] * alpha + 127) / 255);
+        }
+    }
+
+    Result result;
+    result.sourceWidth = width;
+    result.sourceHeight = height;
+    const SkISize scaled = ComputeScaledSize(width, height, target);
+
+    if (scaled.width() == width && scaled.height() == height) {
+        // 像素内存直接交给 SkData 管理，不再复制
+        const size_t rowBytes = static_cast<size_t>(width) * 4;
+        sk_sp<SkData> pixelData = SkData::MakeWithProc(
+            pixels, rowBytes * static_cast<size_t>(height),
+            [](const void* ptr, void*) { stbi_image_free(const_cast<void*>(ptr)); }, nullptr);
+
+        SkImageInfo info = SkImageInfo::Make(width, height, kRGBA_8888_SkColorType, kPremul_SkAlphaType);
+        result.image = SkImages::RasterFromData(info, std::move(pixelData), rowBytes);
+    } else {
+        // 先逐级减半到不小于两倍目标的尺寸，再插值到目标尺寸；原尺寸像素在这里就释放
+        std::vector<stbi_uc> current;
+        std::vector<stbi_uc> next;
+        const stbi_uc* source = pixels;
+        int currentWidth = width;
+        int currentHeight = height;
+        while (currentWidth / 2 >= scaled.width() && currentHeight / 2 >= scaled.height()) {
+            HalveRgba(source, currentWidth, currentHeight, &next);
+            currentWidth /= 2;
+            currentHeight /= 2;
+            current.swap(next);
+            source = current.data();
+            if (pixels) {
+                stbi_image_free(pixels);
+                pixels = nullptr;
+            }
+        }
+
+        const SkImageInfo sourceInfo = SkImageInfo::Make(currentWidth, currentHeight, kRGBA_8888_SkColorType, kPremul_SkAlphaType);
+        const SkImageInfo scaledInfo = SkImageInfo::Make(scaled.width(), scaled.height(), kRGBA_8888_SkColorType, kPremul_SkAlphaType);
+        sk_sp<SkData> scaledData = SkData::MakeUninitialized(scaledInfo.computeMinByteSize());
+        SkPixmap sourcePixmap(sourceInfo, source, static_cast<size_t>(currentWidth) * 4);
+        SkPixmap scaledPixmap(scaledInfo, scaledData->writable_data(), scaledInfo.minRowBytes());
+        const bool ok = sourcePixmap.scalePixels(scaledPixmap, SkSamplingOptions(SkFilterMode::kLinear));
+        if (pixels) {
+            stbi_image_free(pixels);
+        }
+        if (!ok) {
+            result.error = "failed to scale decoded pixels";
+            return result;
+        }
+        result.image = SkImages::RasterFromData(scaledInfo, std::move(scaledData), scaledInfo.minRowBytes());
+    }
+
+    if (!result.image) {
+        result.error = "failed to wrap decoded pixels";
+    }
+    return result;
+#else
+    (void)data;
+    (void)size;
+    (void)target;
+    return Result{nullptr, "image decoding is not available (built without stb)", 0, 0};
+#endif
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,127 @@
+#include "ItemExtentIndex.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+size_t LowBit(size_t value) {
+    return value & (~value + 1);
+}
+
+} // namespace
+
+void ItemExtentIndex::Reset(size_t count, float extent) {
+    count_ = count;
+    defaultExtent_ = extent;
+    extents_.clear();
+    extents_.shrink_to_fit();
+    tree_.clear();
+    tree_.shrink_to_fit();
+}
+
+void ItemExtentIndex::Resize(size_t count) {
+    if (IsUniform()) {
+        count_ = count;
+        return;
+    }
+    if (count <= count_) {
+        // 树状数组的第 i 项只覆盖以 i 结尾的区间，截断后前面的项仍然有效
+        extents_.resize(count);
+        tree_.resize(count + 1);
+        count_ = count;
+        return;
+    }
+    extents_.reserve(count);
+    tree_.reserve(count + 1);
+    while (count_ < count) {
+        const size_t position = count_ + 1;
+        extents_.push_back(defaultExtent_);
+        tree_.push_back(defaultExtent_ + GetOffset(count_) - GetOffset(position - LowBit(position)));
+        count_ = position;
+    }
+}
+
+void ItemExtentIndex::SetExtent(size_t index, float extent) {
+    if (index >= count_) {
+        return;
+    }
+    if (IsUniform()) {
+        if (extent == defaultExtent_) {
+            return;
+        }
+        BuildTree();
+    }
+    const double delta = static_cast<double>(extent) - extents_[index];
+    if (delta == 0.0) {
+        return;
+    }
+    extents_[index] = extent;
+    for (size_t position = index + 1; position <= count_; position += LowBit(position)) {
+        tree_[position] += delta;
+    }
+}
+
+float ItemExtentIndex::GetExtent(size_t index) const {
+    if (index >= count_) {
+        return 0.0f;
+    }
+    return IsUniform() ? defaultExtent_ : extents_[index];
+}
+
+double ItemExtentIndex::GetOffset(size_t index) const {
+    index = std::min(index, count_);
+    if (IsUniform()) {
+        return static_cast<double>(index) * defaultExtent_;
+    }
+    double offset = 0.0;
+    for (size_t position = index; position > 0; position -= LowBit(position)) {
+        offset += tree_[position];
+    }
+    return offset;
+}
+
+size_t ItemExtentIndex::FindIndex(double offset) const {
+    if (count_ == 0 || offset <= 0.0) {
+        return 0;
+    }
+    if (IsUniform()) {
+        if (defaultExtent_ <= 0.0f) {
+            return 0;
+        }
+        const double index = std::floor(offset / defaultExtent_);
+        return index >= static_cast<double>(count_) ? count_ - 1 : static_cast<size_t>(index);
+    }
+
+    // 在树状数组上二分：找到前缀和不超过 offset 的最多条目数
+    size_t step = 1;
+    while (step * 2 <= count_) {
+        step *= 2;
+    }
+    size_t position = 0;
+    double remaining = offset;
+    for (; step > 0; step /= 2) {
+        if (position + step <= count_ && tree_[position + step] <= remaining) {
+            position += step;
+            remaining -= tree_[position];
+        }
+    }
+    return std::min(position, count_ - 1);
+}
+
+void ItemExtentIndex::BuildTree() {
+    extents_.assign(count_, defaultExtent_);
+    tree_.assign(count_ + 1, 0.0);
+    for (size_t position = 1; position <= count_; ++position) {
+        tree_[position] += defaultExtent_;
+        const size_t parent = position + LowBit(position);
+        if (parent <= count_) {
+            tree_[parent] += tree_[position];
+        }
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,333 @@
+#include "ListView.hpp"
+#include <logger.hpp>
+#include <algorithm>
+
+namespace KiUI {
+namespace widget {
+
+ListView::ListView() {
+    extents_.Reset(0, rowHeight_);
+    // 行元素由 Realize 摆放，不挂到列表的 Yoga 节点上
+    SetArrangesChildren(true);
+    SetClipToBounds(true);
+}
+
+ListView::~ListView() {
+}
+
+void ListView::SetItemCount(size_t count) {
+    if (extents_.GetCount() != count) {
+        extents_.Resize(count);
+        Realize();
+    }
+}
+
+void ListView::SetRowFactory(RowFactory factory) {
+    RecycleAll();
+    pools_.clear();
+    RemoveChildren(0, GetChildrenCount());
+    factory_ = std::move(factory);
+    Realize();
+}
+
+void ListView::SetRowBinder(RowBinder binder) {
+    binder_ = std::move(binder);
+    InvalidateItems();
+}
+
+void ListView::SetTemplateSelector(TemplateSelector selector) {
+    selector_ = std::move(selector);
+    InvalidateItems();
+}
+
+void ListView::SetRowHeightMode(RowHeightMode mode) {
+    if (rowHeightMode_ != mode) {
+        rowHeightMode_ = mode;
+        extents_.Reset(extents_.GetCount(), rowHeight_);
+        for (auto& row : realized_) {
+            row.needsLayout = true;
+        }
+        Realize();
+    }
+}
+
+void ListView::SetRowHeight(float height) {
+    height = std::max(1.0f, height);
+    if (rowHeight_ != height) {
+        rowHeight_ = height;
+        extents_.Reset(extents_.GetCount(), rowHeight_);
+        for (auto& row : realized_) {
+            row.needsLayout = true;
+        }
+        Realize();
+    }
+}
+
+void ListView::SetOverscan(size_t rows) {
+    if (overscan_ != rows) {
+        overscan_ = rows;
+        Realize();
+    }
+}
+
+void ListView::SetScrollOffset(double offset) {
+    if (scrollOffset_ != offset) {
+        scrollOffset_ = offset;
+        Realize();
+    }
+}
+
+void ListView::ScrollIntoView(size_t index) {
+    if (index >= extents_.GetCount()) {
+        return;
+    }
+    const double top = extents_.GetOffset(index);
+    const double bottom = top + extents_.GetExtent(index);
+    if (top < scrollOffset_) {
+        SetScrollOffset(top);
+    } else if (bottom > scrollOffset_ + GetViewportHeight()) {
+        SetScrollOffset(bottom - GetViewportHeight());
+    }
+}
+
+void ListView::InvalidateItem(size_t index) {
+    const size_t position = FindRealized(index);
+    if (position == UIElement::npos) {
+        // 没有显示的条目下次显示时总会重新绑定和测量
+        return;
+    }
+    RealizedRow& row = realized_[position];
+    const int templateId = selector_ ? selector_(index) : 0;
+    if (templateId != row.templateId) {
+        Recycle(row);
+        Acquire(index, &row);
+    } else {
+        if (binder_) {
+            binder_(index, *row.element);
+        }
+        ++rowsBound_;
+        row.needsLayout = true;
+    }
+    Realize();
+}
+
+void ListView::InvalidateItems() {
+    if (rowHeightMode_ == RowHeightMode::Measured) {
+        extents_.Reset(extents_.GetCount(), rowHeight_);
+    }
+    RecycleAll();
+    Realize();
+}
+
+boost::shared_ptr<VisualElement> ListView::GetRealizedRow(size_t index) const {
+    const size_t position = FindRealized(index);
+    return position == UIElement::npos ? nullptr : realized_[position].element;
+}
+
+bool ListView::GetItemIndex(const boost::shared_ptr<VisualElement>& element, size_t* index) const {
+    boost::shared_ptr<UIElement> current = element;
+    while (current) {
+        auto parent = current->GetParent();
+        if (parent.get() == this) {
+            for (const auto& row : realized_) {
+                if (row.element.get() == current.get()) {
+                    *index = row.index;
+                    return true;
+                }
+            }
+            return false;
+        }
+        current = parent;
+    }
+    return false;
+}
+
+ListView::Stats ListView::GetStats() const {
+    Stats stats;
+    stats.realizedRows = realized_.size();
+    for (const auto& pool : pools_) {
+        stats.pooledRows += pool.second.size();
+    }
+    stats.rowsCreated = rowsCreated_;
+    stats.rowsBound = rowsBound_;
+    stats.rowsMeasured = rowsMeasured_;
+    return stats;
+}
+
+void ListView::LayoutChildren(float, float) {
+    Realize();
+}
+
+void ListView::Realize() {
+    if (!factory_ || extents_.GetCount() == 0 || GetViewportWidth() <= 0.0f || GetViewportHeight() <= 0.0f) {
+        RecycleAll();
+        return;
+    }
+    if (GetViewportWidth() != layoutWidth_) {
+        layoutWidth_ = GetViewportWidth();
+        for (auto& row : realized_) {
+            row.needsLayout = true;
+        }
+    }
+
+    ClampScrollOffset();
+    RealizeRange();
+    // 测量出的行比估算的矮时内容变短，滚动位置被限制后可见范围变了
+    if (ClampScrollOffset()) {
+        RealizeRange();
+    }
+
+    for (const auto& row : realized_) {
+        const float left = paddingLeft_;
+        const float top = paddingTop_ + static_cast<float>(extents_.GetOffset(row.index) - scrollOffset_);
+        // SetLeft/SetTop 总是让父级内容失效，位置不变的行不调用
+        if (row.element->GetLeft() != left) {
+            row.element->SetLeft(left);
+        }
+        if (row.element->GetTop() != top) {
+            row.element->SetTop(top);
+        }
+    }
+}
+
+void ListView::RealizeRange() {
+    const size_t count = extents_.GetCount();
+    const double viewportBottom = scrollOffset_ + GetViewportHeight();
+    const size_t anchor = extents_.FindIndex(scrollOffset_);
+    const size_t first = anchor > overscan_ ? anchor - overscan_ : 0;
+    const size_t last = std::min(count, extents_.FindIndex(viewportBottom) + 1 + overscan_);
+
+    // 先回收离开范围的行，新进入范围的条目可以复用它们
+    for (auto& row : realized_) {
+        if (row.element && (row.index < first || row.index >= last)) {
+            Recycle(row);
+        }
+    }
+
+    std::vector<RealizedRow> rows;
+    rows.reserve(last - first);
+    size_t previous = 0;
+    size_t trailing = 0;
+    double y = extents_.GetOffset(first);
+    for (size_t index = first; index < count; ++index) {
+        // Measured 模式下行高在测量后才确定，按累加的位置判断是否已经填满视口
+        if (y >= scrollOffset_ + GetViewportHeight() && trailing++ >= overscan_) {
+            break;
+        }
+        while (previous < realized_.size() && realized_[previous].index < index) {
+            ++previous;
+        }
+        RealizedRow row;
+        if (previous < realized_.size() && realized_[previous].index == index && realized_[previous].element) {
+            row = std::move(realized_[previous++]);
+        } else if (!Acquire(index, &row)) {
+            y += extents_.GetExtent(index);
+            continue;
+        }
+        if (row.needsLayout) {
+            LayoutRow(row, anchor);
+        }
+        y += extents_.GetExtent(index);
+        rows.push_back(std::move(row));
+    }
+
+    for (auto& row : realized_) {
+        if (row.element) {
+            Recycle(row);
+        }
+    }
+    realized_.swap(rows);
+}
+
+bool ListView::ClampScrollOffset() {
+    const double maxOffset = std::max(0.0, extents_.GetTotal() - GetViewportHeight());
+    const double offset = std::clamp(scrollOffset_, 0.0, maxOffset);
+    if (offset == scrollOffset_) {
+        return false;
+    }
+    scrollOffset_ = offset;
+    return true;
+}
+
+bool ListView::Acquire(size_t index, RealizedRow* row) {
+    const int templateId = selector_ ? selector_(index) : 0;
+    boost::shared_ptr<VisualElement> element;
+    auto& pool = pools_[templateId];
+    if (!pool.empty()) {
+        element = std::move(pool.back());
+        pool.pop_back();
+        element->SetVisibility(true);
+    } else {
+        element = factory_(templateId);
+        if (!element) {
+            foundation::Logger::Error("ListView: row factory returned no element for template {0}", templateId);
+            return false;
+        }
+        AddChild(element);
+        ++rowsCreated_;
+    }
+    if (binder_) {
+        binder_(index, *element);
+    }
+    ++rowsBound_;
+
+    row->index = index;
+    row->templateId = templateId;
+    row->element = std::move(element);
+    row->needsLayout = true;
+    return true;
+}
+
+void ListView::Recycle(RealizedRow& row) {
+    if (!row.element) {
+        return;
+    }
+    row.element->SetVisibility(false);
+    pools_[row.templateId].push_back(std::move(row.element));
+    row.element.reset();
+}
+
+void ListView::RecycleAll() {
+    for (auto& row : realized_) {
+        Recycle(row);
+    }
+    realized_.clear();
+}
+
+void ListView::LayoutRow(RealizedRow& row, size_t anchor) {
+    VisualElement& element = *row.element;
+    const bool fixed = rowHeightMode_ == RowHeightMode::Fixed;
+
+    // 行宽跟随视口；Measured 模式下高度设为 0（由内容决定），不限制可用高度
+    element.BeginUpdate();
+    element.SetWidth(layoutWidth_);
+    element.SetHeight(fixed ? rowHeight_ : 0.0f);
+    element.EndUpdate();
+    element.CalculateLayout(width_, fixed ? height_ : YGUndefined, paddingLeft_, paddingTop_);
+    row.needsLayout = false;
+    ++rowsMeasured_;
+
+    if (!fixed) {
+        const float measured = element.GetHeight();
+        const float previous = extents_.GetExtent(row.index);
+        if (measured != previous) {
+            extents_.SetExtent(row.index, measured);
+            // 视口上方的行高度变化时同步移动滚动位置，锚点行在屏幕上的位置保持不变
+            if (row.index < anchor) {
+                scrollOffset_ += measured - previous;
+            }
+        }
+    }
+}
+
+size_t ListView::FindRealized(size_t index) const {
+    const auto it = std::lower_bound(realized_.begin(), realized_.end(), index,
+                                     [](const RealizedRow& row, size_t value) { return row.index < value; });
+    if (it == realized_.end() || it->index != index || !it->element) {
+        return UIElement::npos;
+    }
+    return static_cast<size_t>(it - realized_.begin());
+}
+
+} // namespace widget
+} // namespace KiUI
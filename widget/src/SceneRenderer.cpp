@@ -1,10 +1,26 @@
 #include "SceneRenderer.hpp"
+#include "Box.hpp"
+#include "Image.hpp"
 #include <RenderSurface.hpp>
+#include <RenderContext.hpp>
+#include <GlyphAtlas.hpp>
 #include <window.hpp>
 #include <window_class.hpp>
 #include <GLFW/glfw3.h>
 #include <logger.hpp>
 #include <boost/optional.hpp>
+#include <boost/make_shared.hpp>
+#include <include/core/SkSurface.h>
+#include <include/core/SkSamplingOptions.h>
+#include <include/core/SkPicture.h>
+#include <include/core/SkPictureRecorder.h>
+#include <include/gpu/ganesh/GrDirectContext.h>
+#include <include/gpu/ganesh/GrRecordingContext.h>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef TRACY_ENABLE
 #include <tracy/Tracy.hpp>
@@ -13,7 +29,23 @@
 namespace KiUI {
 namespace widget {
 
-SceneRenderer::SceneRenderer() {
+/**
+ * @brief 线程合成运行期间 UI 线程与合成线程共享的状态，所有成员由 mutex 保护
+ */
+struct SceneRenderer::CompositorThread {
+    std::mutex mutex;
+    std::condition_variable wake;       // 通知合成线程：新的一帧、可见性变化、释放资源或退出
+    std::condition_variable consumed;   // 通知 UI 线程：待合成的帧已被取走
+    sk_sp<SkDrawable> pending;          // UI 线程最近录制、还没有被取走的帧
+    std::vector<sk_sp<SkDrawable>> retired;  // 等待在合成线程上释放的帧和合成层
+    bool visible = true;
+    bool releaseResources = false;
+    bool stop = false;
+    std::thread thread;
+};
+
+SceneRenderer::SceneRenderer()
+    : compositorCounters_(boost::make_shared<CompositorCounters>()) {
 }
 
 SceneRenderer::~SceneRenderer() {
@@ -21,6 +53,38 @@ SceneRenderer::~SceneRenderer() {
 
 void SceneRenderer::SetRoot(boost::shared_ptr<VisualElement> root) {
     root_ = root;
+    layoutValid_ = false;
+    frameRequested_ = true;
+    ++hitTestVersion_;
+}
+
+void SceneRenderer::UpdateStyles() {
+    if (root_ && (root_->GetSubtreeDirtyFlags() & DirtyFlags::Style) != DirtyFlags::None) {
+        root_->UpdateStyles();
+    }
+}
+
+bool SceneRenderer::NeedsFrame(float viewportWidth, float viewportHeight) const {
+    if (frameRequested_) {
+        return true;
+    }
+    if (!root_) {
+        return false;
+    }
+    if (!layoutValid_ || viewportWidth != layoutWidth_ || viewportHeight != layoutHeight_ ||
+        animations_.GetActiveCount() > 0) {
+        return true;
+    }
+    // IsLayoutDirty 包含样式和布局标记
+    return (root_->GetSubtreeDirtyFlags() & DirtyFlags::Paint) != DirtyFlags::None || root_->IsLayoutDirty();
+}
+
+uint64_t SceneRenderer::GetHitTestVersion() {
+    if (root_ && (root_->GetSubtreeDirtyFlags() & DirtyFlags::HitTest) != DirtyFlags::None) {
+        ++hitTestVersion_;
+        root_->ClearDirtyFlags(DirtyFlags::HitTest);
+    }
+    return hitTestVersion_;
 }
 
 void SceneRenderer::CalculateLayout(float viewportWidth, float viewportHeight) {
@@ -28,8 +92,17 @@ void SceneRenderer::CalculateLayout(float viewportWidth, float viewportHeight) {
         return;
     }
     
+    // 约束没有变化，上一次的布局结果仍然有效
+    if (layoutValid_ && viewportWidth == layoutWidth_ && viewportHeight == layoutHeight_ &&
+        !root_->IsLayoutDirty()) {
+        return;
+    }
+    
     // 从根组件开始递归计算布局
     root_->CalculateLayout(viewportWidth, viewportHeight, 0.0f, 0.0f);
+    layoutValid_ = true;
+    layoutWidth_ = viewportWidth;
+    layoutHeight_ = viewportHeight;
 }
 
 void SceneRenderer::Render(SkCanvas* canvas) {
@@ -37,15 +110,710 @@ void SceneRenderer::Render(SkCanvas* canvas) {
     ZoneScopedN("SceneRenderer::Render");
 #endif
     
-    if (!canvas || !root_) {
+    if (!canvas) {
+        return;
+    }
+    frameRequested_ = false;
+    if (!root_) {
+        return;
+    }
+    // 绘制阶段：先清除标记，绘制中组件再标记的变化留给下一帧
+    root_->ClearDirtyFlags(DirtyFlags::Paint);
+    
+    ++frameIndex_;
+    Image::BeginFrame();
+    // 其他线程上淘汰的缓存纹理属于本线程的上下文，在这里释放
+    GrRecordingContext* recordingContext = canvas->recordingContext();
+    if (GrDirectContext* directContext = recordingContext ? recordingContext->asDirectContext() : nullptr) {
+        directContext_ = directContext;
+        ImageCache::GetSharedInstance().ReleaseRetiredTextures(directContext);
+    }
+    culledCount_ = 0;
+    occludedCount_ = 0;
+    groupLayerHits_ = 0;
+    groupLayerRenders_ = 0;
+    scrollLayerHits_ = 0;
+    scrollLayerScrolls_ = 0;
+    scrollLayerDamageUpdates_ = 0;
+    scrollLayerRenders_ = 0;
+    scrollLayerPixels_ = 0;
+    compositorLayerRecords_ = 0;
+    compositor_.GetLayers(&compositorLayerSet_);
+    occludedSubtrees_.clear();
+    occludedElements_.clear();
+    if (occlusionCullingEnabled_) {
+#ifdef TRACY_ENABLE
+        ZoneScopedN("SceneRenderer::CollectOcclusion");
+#endif
+        occluderRegion_.setEmpty();
+        CollectOcclusion(root_, canvas->getTotalMatrix(), SkRect::Make(canvas->getDeviceClipBounds()));
+    }
+    
+    if (!batchingEnabled_) {
+        // 从根组件开始递归渲染
+        RenderElement(root_, canvas, 0.0f, 0.0f);
+        return;
+    }
+    
+    // 先记录整棵树，再一次性提交重排合并后的命令
+    commandBuffer_.Clear();
+    batchStats_ = KiUI::graphics::DrawCommandBuffer::Stats();
+    RecordElement(root_, canvas, canvas->getTotalMatrix(), SkRect::Make(canvas->getDeviceClipBounds()));
+    FlushCommands(canvas);
+    
+    // 丢弃一段时间没有用到的图层（组件已销毁、被隐藏或不再半透明）
+    for (auto it = groupLayers_.begin(); it != groupLayers_.end(); ) {
+        if (it->second.element.expired() || frameIndex_ - it->second.lastUsedFrame > kGroupLayerKeepFrames) {
+            it = groupLayers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = scrollLayers_.begin(); it != scrollLayers_.end(); ) {
+        if (it->second.element.expired() || frameIndex_ - it->second.lastUsedFrame > kGroupLayerKeepFrames) {
+            it = scrollLayers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = compositorLayers_.begin(); it != compositorLayers_.end(); ) {
+        if (it->second.element.expired() || frameIndex_ - it->second.lastUsedFrame > kGroupLayerKeepFrames) {
+            RetireDrawable(std::move(it->second.layer));
+            it = compositorLayers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SceneRenderer::RenderSubtree(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas) {
+    if (!element || !canvas) {
+        return;
+    }
+    if (!batchingEnabled_) {
+        RenderElement(element, canvas, 0.0f, 0.0f);
+        return;
+    }
+    commandBuffer_.Clear();
+    RecordElement(element, canvas, canvas->getTotalMatrix(), SkRect::Make(canvas->getDeviceClipBounds()));
+    FlushCommands(canvas);
+}
+
+sk_sp<SkDrawable> SceneRenderer::RecordFrame(float width, float height) {
+#ifdef TRACY_ENABLE
+    ZoneScopedN("SceneRenderer::RecordFrame");
+#endif
+    
+    if (!root_) {
+        return nullptr;
+    }
+    SkPictureRecorder recorder;
+    Render(recorder.beginRecording(SkRect::MakeWH(width, height)));
+    // 以 drawable 结束录制：帧中的合成层不会被拍成静态图片，回放时仍然读取动画的当前值
+    return recorder.finishRecordingAsDrawable();
+}
+
+void SceneRenderer::CollectOcclusion(const boost::shared_ptr<VisualElement>& element,
+                                     const SkMatrix& parentMatrix, const SkRect& deviceClip) {
+    if (!element || !element->GetVisibility()) {
+        return;
+    }
+    
+    // 合成层的位置和透明度在合成时才确定，既不遮挡别人，也不会被遮挡
+    if (HasCompositorLayer(element.get())) {
+        return;
+    }
+    
+    SkMatrix matrix = parentMatrix;
+    matrix.preTranslate(element->GetLeft(), element->GetTop());
+    
+    // 不在裁剪区域内的子树渲染时会被直接剔除，这里也不必处理
+    SkRect deviceBounds = matrix.mapRect(element->GetSubtreeBounds());
+    deviceBounds.outset(1.0f, 1.0f);
+    if (!SkRect::Intersects(deviceBounds, deviceClip)) {
+        return;
+    }
+    
+    // 整棵子树的可见部分都落在已覆盖区域内（裁剪区域外的像素本来就不会绘制）
+    deviceBounds.intersect(deviceClip);
+    if (occluderRegion_.contains(deviceBounds.roundOut())) {
+        occludedSubtrees_.insert(element.get());
+        return;
+    }
+    
+    // 透明度分组整体是半透明的，既不遮挡别人，组内也不做剔除（图层缓存的内容不能依赖组外的遮挡关系）
+    if (element->UsesGroupOpacity()) {
+        return;
+    }
+    
+    // 滚动图层同理：缓存的内容滚动后还要复用，不依赖当前帧的遮挡关系
+    // 自己绘制子元素的组件（DrawsChildren）不会按子元素逐个绘制，也不在这里处理
+    SkPoint scroll;
+    const bool scrollsChildren = element->GetChildScrollOffset(&scroll);
+    
+    // 子元素在自身之后绘制，所以先从最后一个子元素开始处理
+    const auto& children = element->GetChildren();
+    if (!children.empty() && !scrollsChildren && !element->DrawsChildren()) {
+        SkRect childClip = deviceClip;
+        bool childrenVisible = true;
+        if (element->GetClipToBounds() && element->HasOverflowingChildren()) {
+            childrenVisible = childClip.intersect(matrix.mapRect(SkRect::MakeWH(element->GetWidth(), element->GetHeight())));
+        }
+        if (childrenVisible) {
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                auto visualChild = (*it)->AsVisualElement();
+                if (visualChild) {
+                    CollectOcclusion(visualChild, matrix, childClip);
+                }
+            }
+        }
+    }
+    
+    // 再处理组件自身：已被覆盖则跳过绘制，否则把它的不透明背景加入覆盖区域
+    SkMatrix elementMatrix = matrix;
+    elementMatrix.preConcat(element->GetTransform());
+    SkRect ownBounds = elementMatrix.mapRect(element->GetLocalBounds());
+    ownBounds.outset(1.0f, 1.0f);
+    if (!ownBounds.intersect(deviceClip) || occluderRegion_.contains(ownBounds.roundOut())) {
+        occludedElements_.insert(element.get());
+        return;
+    }
+    
+    SkRect opaque;
+    if (element->GetOpaqueBounds(&opaque) && elementMatrix.rectStaysRect()) {
+        // 只计入完整覆盖的像素（向内取整），部分覆盖的抗锯齿边缘不算
+        SkRect deviceOpaque = elementMatrix.mapRect(opaque);
+        if (deviceOpaque.intersect(deviceClip)) {
+            SkIRect pixels = deviceOpaque.roundIn();
+            if (!pixels.isEmpty()) {
+                occluderRegion_.op(pixels, SkRegion::kUnion_Op);
+            }
+        }
+    }
+}
+
+void SceneRenderer::FlushCommands(SkCanvas* canvas) {
+#ifdef TRACY_ENABLE
+    ZoneScopedN("DrawCommandBuffer::Flush");
+#endif
+    
+    if (commandBuffer_.IsEmpty()) {
+        return;
+    }
+    commandBuffer_.Flush(canvas);
+    const auto& stats = commandBuffer_.GetLastFlushStats();
+    batchStats_.commands += stats.commands;
+    batchStats_.batches += stats.batches;
+    batchStats_.drawCalls += stats.drawCalls;
+    batchStats_.mergedRects += stats.mergedRects;
+}
+
+void SceneRenderer::RecordElement(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas,
+                                  const SkMatrix& parentMatrix, const SkRect& deviceClip, bool asGroupContent) {
+    if (!element || !element->GetVisibility()) {
+        return;
+    }
+    if (IsSubtreeOccluded(element.get())) {
+        ++occludedCount_;
+        return;
+    }
+    
+    // 移动到元素位置
+    SkMatrix matrix = parentMatrix;
+    matrix.preTranslate(element->GetLeft(), element->GetTop());
+    
+    // 合成层可能被动画移入裁剪区域，不按自身的包围盒剔除
+    if (!asGroupContent && HasCompositorLayer(element.get())) {
+        DrawCompositorLayer(element, canvas, matrix);
+        return;
+    }
+    
+    // 整棵子树都在当前裁剪区域之外时直接跳过（外扩 1 像素覆盖抗锯齿边缘）
+    SkRect deviceBounds = matrix.mapRect(element->GetSubtreeBounds());
+    deviceBounds.outset(1.0f, 1.0f);
+    if (!SkRect::Intersects(deviceBounds, deviceClip)) {
+        ++culledCount_;
+        return;
+    }
+    
+    if (!asGroupContent && element->UsesGroupOpacity()) {
+        DrawGroupLayer(element, canvas, parentMatrix, matrix, deviceClip);
+        return;
+    }
+    
+    commandBuffer_.SetMatrix(matrix);
+    
+    if (IsElementOccluded(element.get())) {
+        ++occludedCount_;
+    } else if (!element->Record(commandBuffer_)) {
+        // 不支持记录的组件：先提交之前的命令以保持绘制顺序，再立即绘制
+        FlushCommands(canvas);
+        canvas->save();
+        canvas->setMatrix(matrix);
+        element->Render(canvas);
+        canvas->restore();
+    }
+    
+    const auto& children = element->GetChildren();
+    if (children.empty() || element->DrawsChildren()) {
+        return;
+    }
+    
+    SkPoint scroll;
+    if (element->GetChildScrollOffset(&scroll)) {
+        DrawScrollLayer(element, canvas, matrix, scroll, deviceClip);
         return;
     }
     
-    // 从根组件开始递归渲染
-    RenderElement(root_, canvas, 0.0f, 0.0f);
+    // 子元素超出自身范围时才真正需要裁剪；裁剪前后都要提交命令，保证批次不跨越裁剪边界
+    const bool clipChildren = element->GetClipToBounds() && element->HasOverflowingChildren();
+    SkRect childClip = deviceClip;
+    if (clipChildren) {
+        const SkRect clipRect = SkRect::MakeWH(element->GetWidth(), element->GetHeight());
+        if (!childClip.intersect(matrix.mapRect(clipRect))) {
+            return;
+        }
+        FlushCommands(canvas);
+        canvas->save();
+        canvas->setMatrix(matrix);
+        canvas->clipRect(clipRect, true);
+    }
+    
+    // 子元素的位置是相对于父元素的
+    for (const auto& child : children) {
+        auto visualChild = child->AsVisualElement();
+        if (visualChild) {
+            RecordElement(visualChild, canvas, matrix, childClip);
+        }
+    }
+    
+    if (clipChildren) {
+        FlushCommands(canvas);
+        canvas->restore();
+    }
 }
 
-void SceneRenderer::RenderElement(boost::shared_ptr<VisualElement> element, SkCanvas* canvas, float offsetX, float offsetY) {
+namespace {
+
+// b 与 a 是否只差一个整数像素平移（此时设备空间图层可以原样平移复用）
+bool IsIntegerTranslationOf(const SkMatrix& a, const SkMatrix& b, float* dx, float* dy) {
+    if (a.hasPerspective() || b.hasPerspective() ||
+        a.getScaleX() != b.getScaleX() || a.getScaleY() != b.getScaleY() ||
+        a.getSkewX() != b.getSkewX() || a.getSkewY() != b.getSkewY()) {
+        return false;
+    }
+    *dx = b.getTranslateX() - a.getTranslateX();
+    *dy = b.getTranslateY() - a.getTranslateY();
+    return *dx == std::round(*dx) && *dy == std::round(*dy);
+}
+
+// 合成层光栅化的最大尺寸（设备像素），超过时每次合成直接回放录制的内容
+constexpr int kMaxCompositorLayerSize = 4096;
+
+} // namespace
+
+/**
+ * @brief 合成层：组件整棵子树在其局部空间录制的图片
+ * 回放时读取合成器动画的当前值，把光栅化缓存的图层按图层属性合成到画布上；
+ * 画布矩阵与上次光栅化时只差整数平移时直接复用。录制后内容不再改变，
+ * 光栅化缓存只在回放的线程上访问（直接渲染时是 UI 线程，线程合成时是合成线程）
+ */
+class CompositorLayer : public SkDrawable {
+public:
+    CompositorLayer(const CompositorAnimator* animator, const VisualElement* element, sk_sp<SkPicture> content,
+                    const SkRect& bounds, float centerX, float centerY,
+                    boost::shared_ptr<SceneRenderer::CompositorCounters> counters)
+        : animator_(animator), element_(element), content_(std::move(content)), bounds_(bounds),
+          centerX_(centerX), centerY_(centerY), counters_(std::move(counters)) {
+    }
+    
+    /**
+     * @brief 设置组件的分组透明度（UI 线程随时更新，下一次合成生效）
+     */
+    void SetGroupOpacity(float opacity) { groupOpacity_.store(opacity, std::memory_order_relaxed); }
+
+protected:
+    SkRect onGetBounds() override { return bounds_; }
+    
+    void onDraw(SkCanvas* canvas) override {
+        // 图层属性刚被移除时按默认值合成，下一次录制的帧会恢复普通绘制
+        LayerProperties properties;
+        animator_->GetLayerProperties(element_, &properties);
+        const float opacity = groupOpacity_.load(std::memory_order_relaxed) * properties.opacity;
+        if (opacity <= 0.0f) {
+            return;
+        }
+        ++counters_->composites;
+        
+        const SkMatrix matrix = canvas->getTotalMatrix();
+        const SkMatrix layerMatrix = properties.GetMatrix(centerX_, centerY_);
+        float dx = 0.0f;
+        float dy = 0.0f;
+        if (!image_ || !IsIntegerTranslationOf(rasterMatrix_, matrix, &dx, &dy)) {
+            dx = 0.0f;
+            dy = 0.0f;
+            if (!Rasterize(canvas, matrix)) {
+                // 图层过大或画布不支持离屏表面（例如又被录制进图片）：直接回放内容
+                canvas->save();
+                canvas->concat(layerMatrix);
+                canvas->saveLayerAlphaf(&bounds_, opacity);
+                canvas->drawPicture(content_);
+                canvas->restore();
+                canvas->restore();
+                return;
+            }
+        }
+        
+        // 图层位于设备空间，图层变换在局部空间：设备空间中的合成矩阵为 M · L · M⁻¹
+        SkMatrix inverse;
+        if (!matrix.invert(&inverse)) {
+            return;
+        }
+        SkMatrix device = SkMatrix::Concat(matrix, layerMatrix);
+        device.preConcat(inverse);
+        SkPaint paint;
+        paint.setAlphaf(opacity);
+        const SkSamplingOptions sampling = properties.IsIdentityTransform()
+            ? SkSamplingOptions() : SkSamplingOptions(SkFilterMode::kLinear);
+        canvas->save();
+        canvas->setMatrix(device);
+        canvas->drawImage(image_, rasterBounds_.left() + dx, rasterBounds_.top() + dy, sampling, &paint);
+        canvas->restore();
+    }
+
+private:
+    // 在画布当前矩阵下光栅化内容（不含图层变换：动画缩放时放大已有的图层，而不是重新光栅化）
+    bool Rasterize(SkCanvas* canvas, const SkMatrix& matrix) {
+        SkRect deviceBounds = matrix.mapRect(bounds_);
+        deviceBounds.outset(1.0f, 1.0f);
+        const SkIRect rasterBounds = deviceBounds.roundOut();
+        if (rasterBounds.isEmpty() ||
+            rasterBounds.width() > kMaxCompositorLayerSize || rasterBounds.height() > kMaxCompositorLayerSize) {
+            return false;
+        }
+        sk_sp<SkSurface> surface = canvas->makeSurface(
+            SkImageInfo::MakeN32Premul(rasterBounds.width(), rasterBounds.height()));
+        if (!surface) {
+            return false;
+        }
+        SkCanvas* layerCanvas = surface->getCanvas();
+        layerCanvas->clear(SK_ColorTRANSPARENT);
+        layerCanvas->translate(static_cast<float>(-rasterBounds.left()), static_cast<float>(-rasterBounds.top()));
+        layerCanvas->concat(matrix);
+        layerCanvas->drawPicture(content_);
+        image_ = surface->makeImageSnapshot();
+        rasterMatrix_ = matrix;
+        rasterBounds_ = rasterBounds;
+        ++counters_->rasterizations;
+        return image_ != nullptr;
+    }
+    
+    const CompositorAnimator* animator_;
+    const VisualElement* element_;      // 只用作查找图层属性的键
+    const sk_sp<SkPicture> content_;
+    const SkRect bounds_;
+    const float centerX_;
+    const float centerY_;
+    const boost::shared_ptr<SceneRenderer::CompositorCounters> counters_;
+    std::atomic<float> groupOpacity_{1.0f};
+    
+    // 光栅化缓存
+    sk_sp<SkImage> image_;
+    SkMatrix rasterMatrix_;
+    SkIRect rasterBounds_ = SkIRect::MakeEmpty();
+};
+
+void SceneRenderer::DrawGroupLayer(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas,
+                                   const SkMatrix& parentMatrix, const SkMatrix& matrix, const SkRect& deviceClip) {
+#ifdef TRACY_ENABLE
+    ZoneScopedN("SceneRenderer::DrawGroupLayer");
+#endif
+    
+    const float opacity = element->GetOpacity();
+    if (opacity <= 0.0f) {
+        return;
+    }
+    
+    // 分组内容与前后的批次之间不能重排
+    FlushCommands(canvas);
+    
+    SkRect deviceBounds = matrix.mapRect(element->GetSubtreeBounds());
+    deviceBounds.outset(1.0f, 1.0f);
+    const SkIRect layerBounds = deviceBounds.roundOut();
+    if (layerBounds.isEmpty()) {
+        return;
+    }
+    
+    GroupLayer& layer = groupLayers_[element.get()];
+    layer.lastUsedFrame = frameIndex_;
+    
+    float dx = 0.0f;
+    float dy = 0.0f;
+    const bool reusable = layer.image &&
+                          layer.element.lock() == element &&
+                          layer.version == element->GetSubtreeVersion() &&
+                          IsIntegerTranslationOf(layer.matrix, matrix, &dx, &dy);
+    
+    if (reusable) {
+        ++groupLayerHits_;
+    } else {
+        layer.image.reset();
+        sk_sp<SkSurface> surface;
+        if (layerBounds.width() <= kMaxGroupLayerSize && layerBounds.height() <= kMaxGroupLayerSize) {
+            surface = canvas->makeSurface(SkImageInfo::MakeN32Premul(layerBounds.width(), layerBounds.height()));
+        }
+        
+        if (!surface) {
+            // 图层过大或画布不支持离屏表面：退化为本帧的 saveLayer
+            groupLayers_.erase(element.get());
+            canvas->save();
+            canvas->setMatrix(parentMatrix);
+            SkRect localBounds = element->GetSubtreeBounds().makeOffset(element->GetLeft(), element->GetTop());
+            canvas->saveLayerAlphaf(&localBounds, opacity);
+            RecordElement(element, canvas, parentMatrix, deviceClip, true);
+            FlushCommands(canvas);
+            canvas->restore();
+            canvas->restore();
+            return;
+        }
+        
+        // 先记下版本：绘制过程中再次失效的内容（例如图片本帧未上传）下一帧要重新绘制
+        const uint64_t version = element->GetSubtreeVersion();
+        
+        // 以完整不透明度把整棵子树画到图层里，图层原点对应设备坐标 layerBounds 左上角
+        SkCanvas* layerCanvas = surface->getCanvas();
+        layerCanvas->clear(SK_ColorTRANSPARENT);
+        SkMatrix layerParentMatrix = parentMatrix;
+        layerParentMatrix.postTranslate(static_cast<float>(-layerBounds.left()), static_cast<float>(-layerBounds.top()));
+        RecordElement(element, layerCanvas, layerParentMatrix,
+                      SkRect::MakeWH(static_cast<float>(layerBounds.width()), static_cast<float>(layerBounds.height())), true);
+        FlushCommands(layerCanvas);
+        
+        layer.element = element;
+        layer.image = surface->makeImageSnapshot();
+        layer.matrix = matrix;
+        layer.bounds = layerBounds;
+        layer.version = version;
+        ++groupLayerRenders_;
+    }
+    
+    SkPaint paint;
+    paint.setAlphaf(opacity);
+    canvas->save();
+    canvas->setMatrix(SkMatrix::I());
+    canvas->drawImage(layer.image, layer.bounds.left() + dx, layer.bounds.top() + dy, SkSamplingOptions(), &paint);
+    canvas->restore();
+}
+
+void SceneRenderer::DrawCompositorLayer(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas,
+                                        const SkMatrix& matrix) {
+#ifdef TRACY_ENABLE
+    ZoneScopedN("SceneRenderer::DrawCompositorLayer");
+#endif
+    
+    // 合成层与前后的批次之间不能重排
+    FlushCommands(canvas);
+    
+    CompositorLayerEntry& entry = compositorLayers_[element.get()];
+    entry.lastUsedFrame = frameIndex_;
+    
+    // 组件自身不分组时透明度画在自己的内容里，变化时需要重新录制；分组透明度在合成时应用
+    const uint64_t version = element->GetSubtreeVersion();
+    const bool groupOpacity = element->UsesGroupOpacity();
+    const float paintOpacity = groupOpacity ? 1.0f : element->GetOpacity();
+    if (!entry.layer || entry.element.lock() != element || entry.version != version ||
+        entry.paintOpacity != paintOpacity) {
+        // 在组件局部空间录制整棵子树，与设备矩阵无关，组件或祖先移动时仍可复用
+        const SkRect bounds = element->GetSubtreeBounds();
+        SkPictureRecorder recorder;
+        SkCanvas* recordingCanvas = recorder.beginRecording(bounds);
+        if (batchingEnabled_) {
+            RecordElement(element, recordingCanvas, SkMatrix::Translate(-element->GetLeft(), -element->GetTop()),
+                          bounds, true);
+            FlushCommands(recordingCanvas);
+        } else {
+            RenderElement(element, recordingCanvas, -element->GetLeft(), -element->GetTop(), true);
+        }
+        
+        RetireDrawable(std::move(entry.layer));
+        entry.element = element;
+        entry.layer = sk_make_sp<CompositorLayer>(&compositor_, element.get(), recorder.finishRecordingAsPicture(),
+                                                  bounds, element->GetWidth() * 0.5f, element->GetHeight() * 0.5f,
+                                                  compositorCounters_);
+        entry.version = version;
+        entry.paintOpacity = paintOpacity;
+        ++compositorLayerRecords_;
+    }
+    entry.layer->SetGroupOpacity(groupOpacity ? element->GetOpacity() : 1.0f);
+    
+    canvas->save();
+    canvas->setMatrix(matrix);
+    canvas->drawDrawable(entry.layer.get());
+    canvas->restore();
+}
+
+void SceneRenderer::RetireDrawable(sk_sp<SkDrawable> drawable) {
+    if (!drawable || !compositorThread_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(compositorThread_->mutex);
+    compositorThread_->retired.push_back(std::move(drawable));
+}
+
+void SceneRenderer::DrawScrollLayer(const boost::shared_ptr<VisualElement>& element, SkCanvas* canvas,
+                                    const SkMatrix& matrix, const SkPoint& scroll, const SkRect& deviceClip) {
+#ifdef TRACY_ENABLE
+    ZoneScopedN("SceneRenderer::DrawScrollLayer");
+#endif
+    
+    // 图层内容与前后的批次之间不能重排
+    FlushCommands(canvas);
+    
+    const SkRect viewport = SkRect::MakeWH(element->GetWidth(), element->GetHeight());
+    const SkRect deviceViewport = matrix.mapRect(viewport);
+    SkRect childClip = deviceClip;
+    if (!childClip.intersect(deviceViewport)) {
+        return;
+    }
+    SkMatrix contentMatrix = matrix;
+    contentMatrix.preTranslate(-scroll.x(), -scroll.y());
+    
+    // 图层覆盖整个视口而不只是当前可见部分，容器部分移出屏幕时仍然可以平移复用
+    const SkIRect layerBounds = deviceViewport.roundOut();
+    sk_sp<SkSurface> surface;
+    ScrollLayer* layer = nullptr;
+    if (matrix.rectStaysRect() && !layerBounds.isEmpty() &&
+        layerBounds.width() <= kMaxScrollLayerSize && layerBounds.height() <= kMaxScrollLayerSize) {
+        layer = &scrollLayers_[element.get()];
+        layer->lastUsedFrame = frameIndex_;
+        
+        float dx = 0.0f;
+        float dy = 0.0f;
+        const bool reusable = layer->image &&
+                              layer->element.lock() == element &&
+                              layer->bounds == layerBounds &&
+                              IsIntegerTranslationOf(layer->contentMatrix, contentMatrix, &dx, &dy);
+        const bool sameContent = reusable && layer->version == element->GetSubtreeVersion();
+        // 内容有变化但容器能给出变化的范围时，只重新绘制这块区域
+        std::vector<SkRect> damage;
+        const bool damaged = reusable && !sameContent && element->GetChildDamage(layer->version, &damage);
+        if (sameContent && dx == 0.0f && dy == 0.0f) {
+            ++scrollLayerHits_;
+            canvas->save();
+            canvas->setMatrix(SkMatrix::I());
+            canvas->drawImage(layer->image, static_cast<float>(layerBounds.left()), static_cast<float>(layerBounds.top()));
+            canvas->restore();
+            return;
+        }
+        
+        // 写入当前图像来源之外的另一块表面
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(layerBounds.width(), layerBounds.height());
+        sk_sp<SkSurface>& back = layer->surfaces[layer->front ^ 1];
+        if (!back || back->width() != layerBounds.width() || back->height() != layerBounds.height()) {
+            back = canvas->makeSurface(info);
+        }
+        surface = back;
+        
+        if (surface) {
+            // 先记下版本：绘制过程中再次失效的内容下一帧要重新绘制
+            const uint64_t version = element->GetSubtreeVersion();
+            SkCanvas* layerCanvas = surface->getCanvas();
+            SkMatrix layerContentMatrix = contentMatrix;
+            layerContentMatrix.postTranslate(static_cast<float>(-layerBounds.left()), static_cast<float>(-layerBounds.top()));
+            
+            const int width = layerBounds.width();
+            const int height = layerBounds.height();
+            const int shiftX = static_cast<int>(dx);
+            const int shiftY = static_cast<int>(dy);
+            if ((sameContent || damaged) && std::abs(shiftX) < width && std::abs(shiftY) < height) {
+                // 上一帧的图层整体平移，只有新露出的横条和竖条以及内容变化的区域需要光栅化
+                SkPaint copy;
+                copy.setBlendMode(SkBlendMode::kSrc);
+                layerCanvas->drawImage(layer->image, dx, dy, SkSamplingOptions(), &copy);
+                SkRegion stale;
+                if (shiftY != 0) {
+                    stale.op(shiftY > 0 ? SkIRect::MakeLTRB(0, 0, width, shiftY)
+                                        : SkIRect::MakeLTRB(0, height + shiftY, width, height),
+                             SkRegion::kUnion_Op);
+                }
+                if (shiftX != 0) {
+                    stale.op(shiftX > 0 ? SkIRect::MakeLTRB(0, 0, shiftX, height)
+                                        : SkIRect::MakeLTRB(width + shiftX, 0, width, height),
+                             SkRegion::kUnion_Op);
+                }
+                if (damaged) {
+                    for (const SkRect& area : damage) {
+                        SkIRect damageArea = layerContentMatrix.mapRect(area).roundOut();
+                        if (damageArea.intersect(SkIRect::MakeWH(width, height))) {
+                            stale.op(damageArea, SkRegion::kUnion_Op);
+                        }
+                    }
+                    ++scrollLayerDamageUpdates_;
+                }
+                for (SkRegion::Iterator it(stale); !it.done(); it.next()) {
+                    RasterizeScrollArea(element, layerCanvas, layerContentMatrix, it.rect());
+                }
+                if (shiftX != 0 || shiftY != 0) {
+                    ++scrollLayerScrolls_;
+                }
+            } else {
+                RasterizeScrollArea(element, layerCanvas, layerContentMatrix, SkIRect::MakeWH(width, height));
+                ++scrollLayerRenders_;
+            }
+            
+            layer->element = element;
+            layer->image = surface->makeImageSnapshot();
+            layer->front ^= 1;
+            layer->contentMatrix = contentMatrix;
+            layer->bounds = layerBounds;
+            layer->version = version;
+            
+            canvas->save();
+            canvas->setMatrix(SkMatrix::I());
+            canvas->drawImage(layer->image, static_cast<float>(layerBounds.left()), static_cast<float>(layerBounds.top()));
+            canvas->restore();
+            return;
+        }
+    }
+    
+    // 视口过大、带旋转或画布不支持离屏表面：每帧直接绘制
+    scrollLayers_.erase(element.get());
+    canvas->save();
+    canvas->setMatrix(matrix);
+    canvas->clipRect(viewport, true);
+    for (const auto& child : element->GetChildren()) {
+        auto visualChild = child->AsVisualElement();
+        if (visualChild) {
+            RecordElement(visualChild, canvas, contentMatrix, childClip);
+        }
+    }
+    FlushCommands(canvas);
+    canvas->restore();
+}
+
+void SceneRenderer::RasterizeScrollArea(const boost::shared_ptr<VisualElement>& element, SkCanvas* layerCanvas,
+                                        const SkMatrix& contentMatrix, const SkIRect& area) {
+    if (area.isEmpty()) {
+        return;
+    }
+    const SkRect areaRect = SkRect::Make(area);
+    layerCanvas->save();
+    layerCanvas->clipRect(areaRect);
+    layerCanvas->clear(SK_ColorTRANSPARENT);
+    // 子树包围盒不与该区域相交的子元素直接剔除，只绘制新露出的内容
+    for (const auto& child : element->GetChildren()) {
+        auto visualChild = child->AsVisualElement();
+        if (visualChild) {
+            RecordElement(visualChild, layerCanvas, contentMatrix, areaRect);
+        }
+    }
+    FlushCommands(layerCanvas);
+    layerCanvas->restore();
+    scrollLayerPixels_ += static_cast<uint64_t>(area.width()) * static_cast<uint64_t>(area.height());
+}
+
+void SceneRenderer::RenderElement(boost::shared_ptr<VisualElement> element, SkCanvas* canvas, float offsetX, float offsetY,
+                                  bool asLayerContent) {
 #ifdef TRACY_ENABLE
     ZoneScopedN("SceneRenderer::RenderElement");
 #endif
@@ -53,17 +821,42 @@ void SceneRenderer::RenderElement(boost::shared_ptr<VisualElement> element, SkCa
     if (!element || !element->GetVisibility()) {
         return;
     }
+    if (IsSubtreeOccluded(element.get())) {
+        ++occludedCount_;
+        return;
+    }
     
     // 保存画布状态
-    canvas->save();
+    const int saveCount = canvas->save();
     
     // 移动到元素位置
     float x = offsetX + element->GetLeft();
     float y = offsetY + element->GetTop();
     canvas->translate(x, y);
     
+    // 合成层可能被动画移入裁剪区域，不按自身的包围盒剔除
+    if (!asLayerContent && HasCompositorLayer(element.get())) {
+        DrawCompositorLayer(element, canvas, canvas->getTotalMatrix());
+        canvas->restore();
+        return;
+    }
+    
+    // 整棵子树都在当前裁剪区域之外时直接跳过
+    if (canvas->quickReject(element->GetSubtreeBounds())) {
+        ++culledCount_;
+        canvas->restore();
+        return;
+    }
+    
+    // 透明度分组：整棵子树先合成到图层再整体乘以透明度（立即绘制路径不缓存图层；合成层在合成时应用）
+    if (!asLayerContent && element->UsesGroupOpacity()) {
+        canvas->saveLayerAlphaf(&element->GetSubtreeBounds(), element->GetOpacity());
+    }
+    
     // 渲染元素本身
-    {
+    if (IsElementOccluded(element.get())) {
+        ++occludedCount_;
+    } else {
 #ifdef TRACY_ENABLE
         ZoneScopedN("VisualElement::Render");
 #endif
@@ -72,10 +865,18 @@ void SceneRenderer::RenderElement(boost::shared_ptr<VisualElement> element, SkCa
     
     // 递归渲染子元素
     const auto& children = element->GetChildren();
-    if (!children.empty()) {
+    if (!children.empty() && !element->DrawsChildren()) {
 #ifdef TRACY_ENABLE
         ZoneScopedN("Render Children");
 #endif
+        SkPoint scroll;
+        const bool scrollsChildren = element->GetChildScrollOffset(&scroll);
+        if (scrollsChildren || (element->GetClipToBounds() && element->HasOverflowingChildren())) {
+            canvas->clipRect(SkRect::MakeWH(element->GetWidth(), element->GetHeight()), true);
+        }
+        if (scrollsChildren) {
+            canvas->translate(-scroll.x(), -scroll.y());
+        }
         for (const auto& child : children) {
             auto visualChild = boost::dynamic_pointer_cast<VisualElement>(child);
             if (visualChild) {
@@ -85,8 +886,8 @@ void SceneRenderer::RenderElement(boost::shared_ptr<VisualElement> element, SkCa
         }
     }
     
-    // 恢复画布状态
-    canvas->restore();
+    // 恢复画布状态（包括透明度分组的图层）
+    canvas->restoreToCount(saveCount);
 }
 
 void SceneRenderer::Run(boost::shared_ptr<KiUI::graphics::RenderSurface> renderSurface,
@@ -95,32 +896,349 @@ void SceneRenderer::Run(boost::shared_ptr<KiUI::graphics::RenderSurface> renderS
     if (!renderSurface || !window) {
         return;
     }
+    if (threadedCompositing_) {
+        RunThreaded(renderSurface, window, windowManager);
+        return;
+    }
+    
+    // 放在最前面，RenderContext 的自动回收执行时这些图层已经不再被引用
+    boost::signals2::scoped_connection hiddenConnection = windowManager.OnAllWindowsHidden.connect(
+        [this]() { ReleaseCachedResources(); }, boost::signals2::at_front);
     
     // 主渲染循环（内部管理所有细节，包括性能追踪）
     while (!window->ShouldClose()) {
+        // 窗口不可见时绘制的内容不会被看到，阻塞等待事件而不是空转
+        if (!windowManager.IsOnScreen(window)) {
+            // 重新显示时表面的内容不可靠（缓存的图层也可能已释放），至少重画一帧
+            frameRequested_ = true;
+            glfwWaitEventsTimeout(0.1);
+            windowManager.PollMainThreadTasks();
+            continue;
+        }
+        
+        // 没有任何阶段需要执行：跳过整帧，等待事件或下一个帧预算
+        const bool compositing = compositor_.GetActiveCount() > 0;
+        if (!compositing && !NeedsFrame(static_cast<float>(window->GetFramebufferWidth()),
+                                        static_cast<float>(window->GetFramebufferHeight()))) {
+            frameStatistics_.MarkIdle();
+            glfwWaitEventsTimeout(frameStatistics_.GetFrameBudget() / 1000.0);
+            // 时钟保持前进，空闲后开始的动画不会把等待的时间算作第一帧的间隔
+            clock_.Tick();
+            windowManager.PollMainThreadTasks();
+            continue;
+        }
+        
 #ifdef TRACY_ENABLE
         FrameMark;
 #endif
+        frameStatistics_.BeginFrame();
+        
+        // 推进动画：只影响绘制的属性不会让下面的布局重新计算
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Animation);
+            clock_.Tick();
+            animations_.Tick(clock_);
+            compositor_.Sample(std::chrono::steady_clock::now());
+        }
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Style);
+            UpdateStyles();
+        }
         
         // 开始绘制
         auto canvasOpt = renderSurface->BeginFrame();
         if (canvasOpt) {
             SkCanvas& canvas = canvasOpt->get();
+            // 表面尺寸在 BeginFrame 中已按帧合并；尺寸不变且没有布局脏标记时 CalculateLayout 直接返回
+            {
+                FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Layout);
+                CalculateLayout(static_cast<float>(renderSurface->GetWidth()),
+                                static_cast<float>(renderSurface->GetHeight()));
+            }
             // 渲染场景（内部已包含性能追踪）
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Paint);
             Render(&canvas);
         }
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Flush);
+            renderSurface->Flush();
+        }
         
         // 结束绘制并显示
-        renderSurface->EndFrame();
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Swap);
+            renderSurface->EndFrame();
+        }
         
         // 处理事件
-        glfwPollEvents();
-        windowManager.PollMainThreadTasks();
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Events);
+            glfwPollEvents();
+        }
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Tasks);
+            windowManager.PollMainThreadTasks();
+        }
+        frameStatistics_.EndFrame();
+    }
+}
+
+void SceneRenderer::RunThreaded(boost::shared_ptr<KiUI::graphics::RenderSurface> renderSurface,
+                                boost::shared_ptr<KiUI::foundation::Window> window,
+                                KiUI::foundation::WindowManager& windowManager) {
+    // 表面（和它的上下文）从这里开始只由合成线程使用
+    renderSurface->ReleaseCurrent();
+    compositorThread_.reset(new CompositorThread());
+    CompositorThread& state = *compositorThread_;
+    
+    state.thread = std::thread([this, renderSurface, &state]() {
+        sk_sp<SkDrawable> frame;
+        bool animating = false;
+        GrDirectContext* directContext = nullptr;
+        while (true) {
+            std::vector<sk_sp<SkDrawable>> retired;
+            bool release = false;
+            bool visible = false;
+            {
+                // 没有新帧、也没有运行中的合成器动画时不必重新合成
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.wake.wait(lock, [&]() {
+                    return state.stop || state.pending || state.releaseResources ||
+                           (animating && state.visible && frame);
+                });
+                if (state.stop) {
+                    break;
+                }
+                if (state.pending) {
+                    frame = std::move(state.pending);
+                    state.consumed.notify_one();
+                }
+                retired.swap(state.retired);
+                release = state.releaseResources;
+                state.releaseResources = false;
+                visible = state.visible;
+            }
+            // 合成层的 GPU 图片属于本线程的上下文，在这里释放
+            retired.clear();
+            if (release) {
+                frame.reset();
+                animating = false;
+                if (directContext) {
+                    ImageCache::GetSharedInstance().ReleaseTextures(directContext);
+                    KiUI::graphics::GlyphAtlas::GetSharedInstance().ReleaseTextures(directContext);
+                }
+                continue;
+            }
+            if (!visible || !frame) {
+                continue;
+            }
+            
+#ifdef TRACY_ENABLE
+            FrameMark;
+#endif
+            animating = compositor_.Sample(std::chrono::steady_clock::now());
+            auto canvasOpt = renderSurface->BeginFrame();
+            if (canvasOpt) {
+#ifdef TRACY_ENABLE
+                ZoneScopedN("SceneRenderer::Composite");
+#endif
+                GrRecordingContext* recordingContext = canvasOpt->get().recordingContext();
+                directContext = recordingContext ? recordingContext->asDirectContext() : nullptr;
+                if (directContext) {
+                    ImageCache::GetSharedInstance().ReleaseRetiredTextures(directContext);
+                }
+                frame->draw(&canvasOpt->get());
+            }
+            // 交换缓冲区按显示刷新率阻塞，合成线程因此按显示节奏运行
+            renderSurface->EndFrame();
+        }
+        
+        // 退出前在本线程释放所有帧和合成层，再解除上下文绑定，之后 UI 线程可以继续使用表面
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.pending.reset();
+            state.retired.clear();
+        }
+        frame.reset();
+        renderSurface->ReleaseCurrent();
+    });
+    
+    // 所有窗口隐藏时由 ReleaseCachedResources 通知合成线程释放纹理
+    boost::signals2::scoped_connection hiddenConnection = windowManager.OnAllWindowsHidden.connect(
+        [this]() { ReleaseCachedResources(); }, boost::signals2::at_front);
+    
+    while (!window->ShouldClose()) {
+        const bool visible = windowManager.IsOnScreen(window);
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.visible != visible) {
+                state.visible = visible;
+                state.wake.notify_one();
+            }
+        }
+        if (!visible) {
+            frameRequested_ = true;
+            glfwWaitEventsTimeout(0.1);
+            windowManager.PollMainThreadTasks();
+            continue;
+        }
+        
+        // 表面尺寸属于合成线程，布局按窗口的帧缓冲尺寸计算
+        const float width = static_cast<float>(window->GetFramebufferWidth());
+        const float height = static_cast<float>(window->GetFramebufferHeight());
+        
+        // 组件树没有变化时不必重新录制：合成线程继续按合成器动画合成上一帧
+        if (!NeedsFrame(width, height)) {
+            frameStatistics_.MarkIdle();
+            glfwWaitEventsTimeout(frameStatistics_.GetFrameBudget() / 1000.0);
+            clock_.Tick();
+            windowManager.PollMainThreadTasks();
+            continue;
+        }
+        
+        frameStatistics_.BeginFrame();
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Animation);
+            clock_.Tick();
+            animations_.Tick(clock_);
+        }
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Style);
+            UpdateStyles();
+        }
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Layout);
+            CalculateLayout(width, height);
+        }
+        sk_sp<SkDrawable> frame;
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Paint);
+            frame = RecordFrame(width, height);
+        }
+        
+        {
+            // 等待合成线程取走帧相当于等待显示刷新，记为交换阶段，不算作本帧的工作量
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Swap);
+            std::unique_lock<std::mutex> lock(state.mutex);
+            if (state.pending) {
+                state.retired.push_back(std::move(state.pending));
+            }
+            state.pending = std::move(frame);
+            state.wake.notify_one();
+            // 等合成线程取走这一帧再处理事件，UI 线程的录制因此也按显示节奏进行
+            state.consumed.wait_for(lock, std::chrono::milliseconds(100),
+                                    [&state]() { return !state.pending || state.stop; });
+        }
+        
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Events);
+            glfwPollEvents();
+        }
+        {
+            FrameStatistics::ScopedPhase phase(frameStatistics_, FramePhase::Tasks);
+            windowManager.PollMainThreadTasks();
+        }
+        frameStatistics_.EndFrame();
+    }
+    
+    // 可能持有 GPU 图片的合成层交给合成线程释放，然后等它退出
+    for (auto& entry : compositorLayers_) {
+        RetireDrawable(std::move(entry.second.layer));
+    }
+    compositorLayers_.clear();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stop = true;
+        state.wake.notify_one();
+    }
+    state.thread.join();
+    compositorThread_.reset();
+}
+
+bool SceneRenderer::WarmUpShaders(KiUI::graphics::RenderContext& context) {
+    auto makeBox = [](float x, float y, float width, float height, SkColor color) {
+        auto box = boost::make_shared<Box>();
+        box->SetLeft(x);
+        box->SetTop(y);
+        box->SetWidth(width);
+        box->SetHeight(height);
+        box->SetBackgroundColor(color);
+        return box;
+    };
+    
+    auto root = makeBox(0.0f, 0.0f, 256.0f, 256.0f, SK_ColorWHITE);
+    
+    auto bordered = makeBox(8.0f, 8.0f, 64.0f, 40.0f, SkColorSetRGB(240, 240, 240));
+    bordered->SetBorderWidth(BorderWidth::All, 1.0f);
+    bordered->SetBorderColor(SkColorSetRGB(128, 128, 128));
+    root->AddChild(bordered);
+    
+    auto rounded = makeBox(80.0f, 8.0f, 64.0f, 40.0f, SkColorSetRGB(66, 133, 244));
+    rounded->SetBorderRadius(BorderRadius::All, 8.0f);
+    rounded->SetBorderWidth(BorderWidth::All, 2.0f);
+    rounded->SetBorderColor(SkColorSetRGB(32, 32, 32));
+    root->AddChild(rounded);
+    
+    auto corners = makeBox(152.0f, 8.0f, 64.0f, 40.0f, SkColorSetRGB(52, 168, 83));
+    corners->SetBorderRadius(BorderRadius::TopLeft, 12.0f);
+    corners->SetBorderRadius(BorderRadius::BottomRight, 4.0f);
+    root->AddChild(corners);
+    
+    auto rotated = makeBox(8.0f, 64.0f, 64.0f, 40.0f, SkColorSetRGB(251, 188, 5));
+    rotated->SetTransform(SkMatrix::RotateDeg(10.0f, SkPoint::Make(40.0f, 84.0f)));
+    root->AddChild(rotated);
+    
+    auto clipped = makeBox(80.0f, 64.0f, 64.0f, 40.0f, SkColorSetRGB(234, 67, 53));
+    clipped->SetClipToBounds(true);
+    clipped->AddChild(makeBox(32.0f, 20.0f, 64.0f, 40.0f, SkColorSetRGB(32, 32, 32)));
+    root->AddChild(clipped);
+    
+    auto group = makeBox(152.0f, 64.0f, 64.0f, 64.0f, SK_ColorTRANSPARENT);
+    group->SetOpacity(0.5f);
+    group->AddChild(makeBox(0.0f, 0.0f, 40.0f, 40.0f, SK_ColorRED));
+    group->AddChild(makeBox(20.0f, 20.0f, 40.0f, 40.0f, SK_ColorBLUE));
+    root->AddChild(group);
+    
+    auto faded = makeBox(8.0f, 136.0f, 64.0f, 40.0f, SkColorSetRGB(66, 133, 244));
+    faded->SetOpacity(0.5f);
+    root->AddChild(faded);
+    
+    SceneRenderer renderer;
+    renderer.SetRoot(root);
+    return context.WarmUpShaders([&renderer](SkCanvas* canvas) {
+        for (bool batching : {false, true}) {
+            renderer.SetBatchingEnabled(batching);
+            renderer.Render(canvas);
+        }
+    });
+}
+
+void SceneRenderer::ReleaseCachedResources() {
+    groupLayers_.clear();
+    scrollLayers_.clear();
+    for (auto& entry : compositorLayers_) {
+        RetireDrawable(std::move(entry.second.layer));
+    }
+    compositorLayers_.clear();
+    if (compositorThread_) {
+        // 纹理属于合成线程的上下文
+        std::lock_guard<std::mutex> lock(compositorThread_->mutex);
+        compositorThread_->releaseResources = true;
+        compositorThread_->wake.notify_one();
+        return;
+    }
+    // 光栅图片和字形像素保留，窗口重新显示时只需重新上传
+    if (directContext_) {
+        ImageCache::GetSharedInstance().ReleaseTextures(directContext_);
+        KiUI::graphics::GlyphAtlas::GetSharedInstance().ReleaseTextures(directContext_);
     }
 }
 
 void SceneRenderer::Clear() {
     root_.reset();
+    layoutValid_ = false;
+    frameRequested_ = true;
+    ++hitTestVersion_;
 }
 
 } // namespace widget
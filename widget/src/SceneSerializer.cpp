@@ -0,0 +1,307 @@
+#include "SceneSerializer.hpp"
+#include "Box.hpp"
+#include <logger.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+/**
+ * @brief 元素类型注册表（类型 ID <-> 运行时类型 <-> 工厂函数）
+ */
+struct ElementTypeRegistry {
+    std::mutex mutex;
+    std::unordered_map<uint32_t, SceneSerializer::ElementFactory> factories;
+    std::unordered_map<std::type_index, uint32_t> typeIds;
+    
+    ElementTypeRegistry() {
+        factories[SceneSerializer::BoxTypeId] = []() -> boost::shared_ptr<VisualElement> {
+            return boost::make_shared<Box>();
+        };
+        typeIds.emplace(std::type_index(typeid(Box)), SceneSerializer::BoxTypeId);
+    }
+    
+    static ElementTypeRegistry& Instance() {
+        static ElementTypeRegistry registry;
+        return registry;
+    }
+};
+
+const char SceneMagic[4] = { 'K', 'I', 'S', 'C' };
+
+void FillRecord(const VisualElement& element, uint32_t typeId, uint32_t childCount, SceneNodeRecord& record) {
+    std::memset(&record, 0, sizeof(record));
+    record.typeId = typeId;
+    record.childCount = childCount;
+    // GetWidth/GetHeight 对自动尺寸的元素返回的是布局结果，只保存显式尺寸，避免加载后被固定
+    if (element.HasExplicitWidth()) {
+        record.width = element.GetWidth();
+        record.explicitSize |= SceneExplicitWidth;
+    }
+    if (element.HasExplicitHeight()) {
+        record.height = element.GetHeight();
+        record.explicitSize |= SceneExplicitHeight;
+    }
+    record.left = element.GetLeft();
+    record.top = element.GetTop();
+    
+    record.margin[0] = element.GetMargin(Margin::Top);
+    record.margin[1] = element.GetMargin(Margin::Bottom);
+    record.margin[2] = element.GetMargin(Margin::Left);
+    record.margin[3] = element.GetMargin(Margin::Right);
+    
+    record.padding[0] = element.GetPadding(Padding::Top);
+    record.padding[1] = element.GetPadding(Padding::Bottom);
+    record.padding[2] = element.GetPadding(Padding::Left);
+    record.padding[3] = element.GetPadding(Padding::Right);
+    
+    record.borderWidth[0] = element.GetBorderWidth(BorderWidth::Top);
+    record.borderWidth[1] = element.GetBorderWidth(BorderWidth::Bottom);
+    record.borderWidth[2] = element.GetBorderWidth(BorderWidth::Left);
+    record.borderWidth[3] = element.GetBorderWidth(BorderWidth::Right);
+    
+    record.borderRadius[0] = element.GetBorderRadius(BorderRadius::TopLeft);
+    record.borderRadius[1] = element.GetBorderRadius(BorderRadius::TopRight);
+    record.borderRadius[2] = element.GetBorderRadius(BorderRadius::BottomLeft);
+    record.borderRadius[3] = element.GetBorderRadius(BorderRadius::BottomRight);
+    
+    record.backgroundColor = element.GetBackgroundColor();
+    record.foregroundColor = element.GetForegroundColor();
+    record.borderColor = element.GetBorderColor();
+    record.opacity = element.GetOpacity();
+    element.GetTransform().get9(record.transform);
+    
+    record.alignment = static_cast<uint8_t>(element.GetAlignment());
+    record.justification = static_cast<uint8_t>(element.GetJustification());
+    record.visible = element.GetVisibility() ? 1 : 0;
+}
+
+// 调用方需保证 element 处于 BeginUpdate() 批量更新中
+void ApplyRecord(VisualElement& element, const SceneNodeRecord& record) {
+    element.SetWidth((record.explicitSize & SceneExplicitWidth) ? record.width : 0.0f);
+    element.SetHeight((record.explicitSize & SceneExplicitHeight) ? record.height : 0.0f);
+    element.SetLeft(record.left);
+    element.SetTop(record.top);
+    
+    element.SetMargin(Margin::Top, record.margin[0]);
+    element.SetMargin(Margin::Bottom, record.margin[1]);
+    element.SetMargin(Margin::Left, record.margin[2]);
+    element.SetMargin(Margin::Right, record.margin[3]);
+    
+    element.SetPadding(Padding::Top, record.padding[0]);
+    element.SetPadding(Padding::Bottom, record.padding[1]);
+    element.SetPadding(Padding::Left, record.padding[2]);
+    element.SetPadding(Padding::Right, record.padding[3]);
+    
+    element.SetBorderWidth(BorderWidth::Top, record.borderWidth[0]);
+    element.SetBorderWidth(BorderWidth::Bottom, record.borderWidth[1]);
+    element.SetBorderWidth(BorderWidth::Left, record.borderWidth[2]);
+    element.SetBorderWidth(BorderWidth::Right, record.borderWidth[3]);
+    
+    element.SetBorderRadius(BorderRadius::TopLeft, record.borderRadius[0]);
+    element.SetBorderRadius(BorderRadius::TopRight, record.borderRadius[1]);
+    element.SetBorderRadius(BorderRadius::BottomLeft, record.borderRadius[2]);
+    element.SetBorderRadius(BorderRadius::BottomRight, record.borderRadius[3]);
+    
+    element.SetBackgroundColor(record.backgroundColor);
+    element.SetForegroundColor(record.foregroundColor);
+    element.SetBorderColor(record.borderColor);
+    element.SetOpacity(record.opacity);
+    
+    SkMatrix transform;
+    transform.set9(record.transform);
+    element.SetTransform(transform);
+    
+    element.SetAlignment(static_cast<Alignment>(std::min<uint8_t>(record.alignment, static_cast<uint8_t>(Alignment::Stretch))));
+    element.SetJustification(static_cast<Justification>(std::min<uint8_t>(record.justification, static_cast<uint8_t>(Justification::Stretch))));
+    element.SetVisibility(record.visible != 0);
+}
+
+bool AppendSubtree(const boost::shared_ptr<VisualElement>& element,
+                   const std::unordered_map<std::type_index, uint32_t>& typeIds,
+                   std::vector<SceneNodeRecord>& records) {
+    auto it = typeIds.find(std::type_index(typeid(*element)));
+    if (it == typeIds.end()) {
+        foundation::Logger::Error("SceneSerializer: unregistered element type {0}", typeid(*element).name());
+        return false;
+    }
+    
+    std::vector<boost::shared_ptr<VisualElement>> visualChildren;
+    visualChildren.reserve(element->GetChildrenCount());
+    for (const auto& child : element->GetChildren()) {
+        if (auto visualChild = child->AsVisualElement()) {
+            visualChildren.push_back(visualChild);
+        }
+    }
+    
+    records.emplace_back();
+    FillRecord(*element, it->second, static_cast<uint32_t>(visualChildren.size()), records.back());
+    
+    for (const auto& child : visualChildren) {
+        if (!AppendSubtree(child, typeIds, records)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void SceneSerializer::RegisterElementType(uint32_t typeId, std::type_index type, ElementFactory factory) {
+    if (typeId == 0 || !factory) {
+        return;
+    }
+    auto& registry = ElementTypeRegistry::Instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.factories[typeId] = factory;
+    registry.typeIds[type] = typeId;
+}
+
+bool SceneSerializer::SaveToBuffer(const boost::shared_ptr<VisualElement>& root, std::vector<uint8_t>& buffer) {
+    buffer.clear();
+    if (!root) {
+        return false;
+    }
+    
+    std::vector<SceneNodeRecord> records;
+    {
+        auto& registry = ElementTypeRegistry::Instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (!AppendSubtree(root, registry.typeIds, records)) {
+            return false;
+        }
+    }
+    
+    SceneFileHeader header;
+    std::memcpy(header.magic, SceneMagic, sizeof(header.magic));
+    header.version = FormatVersion;
+    header.nodeCount = static_cast<uint32_t>(records.size());
+    header.recordSize = sizeof(SceneNodeRecord);
+    
+    buffer.resize(sizeof(header) + records.size() * sizeof(SceneNodeRecord));
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + sizeof(header), records.data(), records.size() * sizeof(SceneNodeRecord));
+    return true;
+}
+
+bool SceneSerializer::Save(const boost::shared_ptr<VisualElement>& root, const std::string& path) {
+    std::vector<uint8_t> buffer;
+    if (!SaveToBuffer(root, buffer)) {
+        return false;
+    }
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        foundation::Logger::Error("SceneSerializer: failed to open {0} for writing", path);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(file);
+}
+
+boost::shared_ptr<VisualElement> SceneSerializer::LoadFromMemory(const void* data, size_t size) {
+    if (!data || size < sizeof(SceneFileHeader)) {
+        return nullptr;
+    }
+    
+    SceneFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, SceneMagic, sizeof(header.magic)) != 0 ||
+        header.version != FormatVersion ||
+        header.recordSize != sizeof(SceneNodeRecord) ||
+        header.nodeCount == 0 ||
+        (size - sizeof(header)) / sizeof(SceneNodeRecord) < header.nodeCount) {
+        foundation::Logger::Error("SceneSerializer: invalid or incompatible scene data");
+        return nullptr;
+    }
+    
+    // 记录直接从映射内存中读取，不做额外拷贝
+    const auto* records = reinterpret_cast<const SceneNodeRecord*>(static_cast<const uint8_t*>(data) + sizeof(header));
+    
+    struct PendingParent {
+        boost::shared_ptr<VisualElement> element;
+        uint32_t remaining;
+        std::vector<boost::shared_ptr<UIElement>> children;
+    };
+    
+    std::vector<boost::shared_ptr<VisualElement>> elements;
+    elements.reserve(header.nodeCount);
+    std::vector<PendingParent> stack;
+    boost::shared_ptr<VisualElement> root;
+    
+    auto& registry = ElementTypeRegistry::Instance();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+    
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        const SceneNodeRecord& record = records[i];
+        auto factory = registry.factories.find(record.typeId);
+        if (factory == registry.factories.end()) {
+            foundation::Logger::Error("SceneSerializer: unknown element type id {0}", record.typeId);
+            return nullptr;
+        }
+        
+        auto element = factory->second();
+        if (!element) {
+            return nullptr;
+        }
+        // 所有样式在批量更新中写入，结束时每个节点只同步一次 Yoga
+        element->BeginUpdate();
+        ApplyRecord(*element, record);
+        elements.push_back(element);
+        
+        if (!stack.empty()) {
+            stack.back().children.push_back(element);
+            --stack.back().remaining;
+        } else if (!root) {
+            root = element;
+        } else {
+            foundation::Logger::Error("SceneSerializer: scene data contains more than one root");
+            return nullptr;
+        }
+        
+        stack.push_back(PendingParent{ element, record.childCount, {} });
+        stack.back().children.reserve(std::min<size_t>(record.childCount, header.nodeCount - i - 1));
+        
+        // 子元素收集完毕的父节点一次性挂接全部子元素
+        while (!stack.empty() && stack.back().remaining == 0) {
+            if (!stack.back().children.empty()) {
+                stack.back().element->ReplaceChildren(stack.back().children);
+            }
+            stack.pop_back();
+        }
+    }
+    lock.unlock();
+    
+    if (!stack.empty()) {
+        foundation::Logger::Error("SceneSerializer: scene data is truncated");
+        return nullptr;
+    }
+    
+    for (auto& element : elements) {
+        element->EndUpdate();
+    }
+    return root;
+}
+
+boost::shared_ptr<VisualElement> SceneSerializer::Load(const std::string& path) {
+    namespace bip = boost::interprocess;
+    try {
+        bip::file_mapping file(path.c_str(), bip::read_only);
+        bip::mapped_region region(file, bip::read_only);
+        return LoadFromMemory(region.get_address(), region.get_size());
+    } catch (const bip::interprocess_exception& e) {
+        foundation::Logger::Error("SceneSerializer: failed to map {0}: {1}", path, e.what());
+        return nullptr;
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,86 @@
+#include "ScrollViewer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+ScrollViewer::ScrollViewer() {
+    SetClipToBounds(true);
+}
+
+ScrollViewer::~ScrollViewer() {
+}
+
+void ScrollViewer::SetContent(boost::shared_ptr<VisualElement> content) {
+    std::vector<boost::shared_ptr<UIElement>> children;
+    if (content) {
+        children.push_back(content);
+    }
+    ReplaceChildren(children);
+    ApplyScrollOffset(0.0f, 0.0f);
+}
+
+boost::shared_ptr<VisualElement> ScrollViewer::GetContent() const {
+    const auto& children = GetChildren();
+    return children.empty() ? nullptr : children.front()->AsVisualElement();
+}
+
+void ScrollViewer::SetScrollOffset(float x, float y) {
+    if (ApplyScrollOffset(x, y)) {
+        // 内容本身没有变化：只让祖先的缓存失效，滚动图层按偏移平移复用
+        InvalidateParentVisual();
+    }
+}
+
+void ScrollViewer::ScrollBy(float dx, float dy) {
+    SetScrollOffset(scrollX_ + dx, scrollY_ + dy);
+}
+
+float ScrollViewer::GetMaxScrollX() const {
+    auto content = GetContent();
+    if (!content) {
+        return 0.0f;
+    }
+    // 内容从左内边距开始排列，右侧同样保留内边距
+    const float extent = content->GetLeft() + content->GetWidth() + paddingRight_;
+    return std::max(0.0f, std::floor(extent - width_));
+}
+
+float ScrollViewer::GetMaxScrollY() const {
+    auto content = GetContent();
+    if (!content) {
+        return 0.0f;
+    }
+    const float extent = content->GetTop() + content->GetHeight() + paddingBottom_;
+    return std::max(0.0f, std::floor(extent - height_));
+}
+
+bool ScrollViewer::GetChildScrollOffset(SkPoint* offset) const {
+    *offset = SkPoint::Make(scrollX_, scrollY_);
+    return true;
+}
+
+void ScrollViewer::LayoutChildren(float width, float height) {
+    VisualElement::LayoutChildren(width, height);
+    if (ApplyScrollOffset(scrollX_, scrollY_)) {
+        InvalidateParentVisual();
+    }
+}
+
+bool ScrollViewer::ApplyScrollOffset(float x, float y) {
+    x = std::clamp(std::round(x), 0.0f, GetMaxScrollX());
+    y = std::clamp(std::round(y), 0.0f, GetMaxScrollY());
+    if (x == scrollX_ && y == scrollY_) {
+        return false;
+    }
+    scrollX_ = x;
+    scrollY_ = y;
+    // 子元素在命中测试中的位置随滚动偏移变化
+    MarkDirty(DirtyFlags::HitTest);
+    return true;
+}
+
+} // namespace widget
+} // namespace KiUI
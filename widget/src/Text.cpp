@@ -0,0 +1,120 @@
+#include "Text.hpp"
+#include "TextMeasureCache.hpp"
+#include <GlyphAtlas.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace KiUI {
+namespace widget {
+
+Text::Text()
+    : contentHash_(TextMeasureCache::HashContent(std::string())),
+      featuresHash_(TextMeasureCache::HashFeatures(std::vector<std::string>())) {
+    SetMeasured(true);
+}
+
+Text::~Text() {
+}
+
+void Text::SetText(const std::string& text) {
+    if (text_ != text) {
+        text_ = text;
+        contentHash_ = TextMeasureCache::HashContent(text_);
+        InvalidateShape();
+    }
+}
+
+void Text::SetFont(int fontId) {
+    if (fontId_ != fontId) {
+        fontId_ = fontId;
+        InvalidateShape();
+    }
+}
+
+void Text::SetFontSize(float fontSize) {
+    if (fontSize_ != fontSize) {
+        fontSize_ = fontSize;
+        InvalidateShape();
+    }
+}
+
+void Text::SetFontFeatures(const std::vector<std::string>& features) {
+    if (features_ != features) {
+        features_ = features;
+        featuresHash_ = TextMeasureCache::HashFeatures(features_);
+        InvalidateShape();
+    }
+}
+
+void Text::InvalidateShape() {
+    shapeValid_ = false;
+    run_.reset();
+    InvalidateMeasure();
+    InvalidateVisual();
+}
+
+boost::shared_ptr<const graphics::ShapedRun> Text::GetShapedRun() {
+    graphics::TextEngine& engine = graphics::TextEngine::GetSharedInstance();
+    // 使用默认字体时，默认字体可能在排版之后才加载或被替换
+    const int resolvedFont = fontId_ >= 0 ? fontId_ : engine.GetDefaultFont();
+    if (shapeValid_ && (!run_ || run_->fontId == resolvedFont)) {
+        return run_;
+    }
+
+    run_ = engine.Shape(text_, resolvedFont, fontSize_, features_);
+    shapeValid_ = resolvedFont >= 0;
+    return run_;
+}
+
+SkSize Text::MeasureContent(float width, YGMeasureMode widthMode, float height, YGMeasureMode heightMode) {
+    graphics::TextEngine& engine = graphics::TextEngine::GetSharedInstance();
+    const int resolvedFont = fontId_ >= 0 ? fontId_ : engine.GetDefaultFont();
+    TextMeasureCache& cache = TextMeasureCache::GetSharedInstance();
+    const TextMeasureCache::Key key =
+        TextMeasureCache::MakeKey(contentHash_, featuresHash_, resolvedFont, fontSize_, width, widthMode);
+
+    SkSize size;
+    if (!cache.Find(key, &size)) {
+        auto run = GetShapedRun();
+        float measuredWidth = run ? std::ceil(run->advance) : 0.0f;
+        const float measuredHeight = run ? std::ceil(run->metrics.GetLineHeight()) : 0.0f;
+        if (widthMode == YGMeasureModeExactly) {
+            measuredWidth = width;
+        } else if (widthMode == YGMeasureModeAtMost) {
+            measuredWidth = std::min(measuredWidth, width);
+        }
+        size = SkSize::Make(measuredWidth, measuredHeight);
+        cache.Insert(key, size);
+    }
+
+    // 高度约束不影响单行文字的排版，命中缓存后再截断
+    float measuredHeight = size.height();
+    if (heightMode == YGMeasureModeExactly) {
+        measuredHeight = height;
+    } else if (heightMode == YGMeasureModeAtMost) {
+        measuredHeight = std::min(measuredHeight, height);
+    }
+    return SkSize::Make(size.width(), measuredHeight);
+}
+
+void Text::Render(SkCanvas* canvas) {
+    if (!canvas || !GetVisibility()) {
+        return;
+    }
+
+    const bool hasTransform = BeginRender(canvas);
+
+    const float opacity = GetPaintOpacity();
+    auto run = GetShapedRun();
+    if (run && !run->glyphs.empty()) {
+        graphics::GlyphAtlas::GetSharedInstance().DrawRun(canvas, *run, 0.0f, run->metrics.ascent,
+                                                          foregroundColor_, opacity);
+    }
+
+    if (hasTransform) {
+        canvas->restore();
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
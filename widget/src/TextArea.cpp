@@ -0,0 +1,290 @@
+#include "TextArea.hpp"
+#include <GlyphAtlas.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+bool IsSpaceAt(const std::string& text, uint32_t cluster) {
+    return cluster < text.size() && (text[cluster] == ' ' || text[cluster] == '\t');
+}
+
+// 复制 [first, last) 的字形作为一行，横坐标从 0 开始
+boost::shared_ptr<const graphics::ShapedRun> MakeLine(const graphics::ShapedRun& run, size_t first, size_t last) {
+    auto line = boost::make_shared<graphics::ShapedRun>();
+    line->fontId = run.fontId;
+    line->fontSize = run.fontSize;
+    line->metrics = run.metrics;
+    const float startX = run.glyphs[first].x;
+    const float endX = last < run.glyphs.size() ? run.glyphs[last].x : run.advance;
+    line->glyphs.assign(run.glyphs.begin() + first, run.glyphs.begin() + last);
+    for (auto& glyph : line->glyphs) {
+        glyph.x -= startX;
+    }
+    line->advance = endX - startX;
+    return line;
+}
+
+} // namespace
+
+TextArea::TextArea() {
+    paragraphs_.resize(1);
+}
+
+TextArea::~TextArea() {
+}
+
+void TextArea::SetText(const std::string& text) {
+    buffer_.SetText(text);
+    paragraphs_.assign(buffer_.GetLineCount(), Paragraph());
+    lineIndexValid_ = 0;
+    shapedFirst_ = 0;
+    shapedLast_ = 0;
+    InvalidateVisual();
+}
+
+void TextArea::Insert(size_t offset, const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    offset = std::min(offset, buffer_.GetLength());
+    const size_t line = buffer_.GetLineFromOffset(offset);
+    buffer_.Insert(offset, text);
+    InvalidateParagraphs(line, 0, static_cast<size_t>(std::count(text.begin(), text.end(), '\n')));
+    InvalidateVisual();
+}
+
+void TextArea::Erase(size_t offset, size_t length) {
+    if (offset >= buffer_.GetLength() || length == 0) {
+        return;
+    }
+    length = std::min(length, buffer_.GetLength() - offset);
+    const size_t first = buffer_.GetLineFromOffset(offset);
+    const size_t last = buffer_.GetLineFromOffset(offset + length);
+    buffer_.Erase(offset, length);
+    InvalidateParagraphs(first, last - first, 0);
+    InvalidateVisual();
+}
+
+void TextArea::SetFont(int fontId) {
+    if (fontId_ != fontId) {
+        fontId_ = fontId;
+        ResetLayout();
+        InvalidateVisual();
+    }
+}
+
+void TextArea::SetFontSize(float fontSize) {
+    if (fontSize_ != fontSize) {
+        fontSize_ = fontSize;
+        ResetLayout();
+        InvalidateVisual();
+    }
+}
+
+void TextArea::SetWrap(bool wrap) {
+    if (wrap_ != wrap) {
+        wrap_ = wrap;
+        ResetLayout();
+        InvalidateVisual();
+    }
+}
+
+void TextArea::SetScrollOffset(float offset) {
+    offset = std::max(0.0f, offset);
+    if (scrollOffset_ != offset) {
+        scrollOffset_ = offset;
+        InvalidateVisual();
+    }
+}
+
+float TextArea::GetLineHeight() const {
+    const float lineHeight =
+        graphics::TextEngine::GetSharedInstance().GetMetrics(ResolveFont(), fontSize_).GetLineHeight();
+    return std::ceil(lineHeight > 0.0f ? lineHeight : fontSize_);
+}
+
+float TextArea::GetContentHeight() {
+    EnsureLineIndex();
+    return lineStarts_.back() * GetLineHeight() + paddingTop_ + paddingBottom_;
+}
+
+TextArea::Stats TextArea::GetStats() const {
+    Stats stats;
+    stats.paragraphsBroken = paragraphsBroken_;
+    for (size_t i = shapedFirst_; i < std::min(shapedLast_, paragraphs_.size()); ++i) {
+        if (!paragraphs_[i].lines.empty()) {
+            ++stats.shapedParagraphs;
+        }
+    }
+    return stats;
+}
+
+void TextArea::InvalidateParagraphs(size_t first, size_t removed, size_t inserted) {
+    paragraphs_[first] = Paragraph();
+    paragraphs_.erase(paragraphs_.begin() + first + 1, paragraphs_.begin() + first + 1 + removed);
+    paragraphs_.insert(paragraphs_.begin() + first + 1, inserted, Paragraph());
+    lineIndexValid_ = std::min(lineIndexValid_, first);
+
+    // 排版范围跟着段落一起移动，渲染时才能释放移出视口的段落
+    const auto shift = [&](size_t index) {
+        if (index <= first) {
+            return index;
+        }
+        return index <= first + removed ? first + 1 : index + inserted - removed;
+    };
+    shapedFirst_ = shift(shapedFirst_);
+    shapedLast_ = shift(shapedLast_);
+}
+
+void TextArea::ResetLayout() {
+    for (auto& paragraph : paragraphs_) {
+        paragraph = Paragraph();
+    }
+    lineIndexValid_ = 0;
+    shapedFirst_ = 0;
+    shapedLast_ = 0;
+}
+
+void TextArea::BreakParagraph(size_t index, float wrapWidth) {
+    std::string text = buffer_.GetLineText(index);
+    if (!text.empty() && text.back() == '\r') {
+        text.pop_back();
+    }
+    ++paragraphsBroken_;
+
+    // 段落文字一般只出现一次，不放入引擎的排版缓存
+    Paragraph& paragraph = paragraphs_[index];
+    paragraph.lines.clear();
+    auto run = graphics::TextEngine::GetSharedInstance().ShapeUncached(text, ResolveFont(), fontSize_);
+    if (run) {
+        const auto& glyphs = run->glyphs;
+        if (wrapWidth <= 0.0f || run->advance <= wrapWidth || glyphs.empty()) {
+            paragraph.lines.push_back(run);
+        } else {
+            // 贪心断行：优先在空格之后断开，单词比一行还宽时在字形之间断开；
+            // 按字形的视觉顺序断行，只适用于从左到右的段落
+            size_t lineStart = 0;
+            size_t lastBreak = 0;
+            for (size_t i = 0; i < glyphs.size(); ++i) {
+                if (i > lineStart && IsSpaceAt(text, glyphs[i - 1].cluster)) {
+                    lastBreak = i;
+                }
+                const float right = i + 1 < glyphs.size() ? glyphs[i + 1].x : run->advance;
+                if (i > lineStart && right - glyphs[lineStart].x > wrapWidth && !IsSpaceAt(text, glyphs[i].cluster)) {
+                    const size_t breakAt = lastBreak > lineStart ? lastBreak : i;
+                    paragraph.lines.push_back(MakeLine(*run, lineStart, breakAt));
+                    lineStart = breakAt;
+                    lastBreak = breakAt;
+                }
+            }
+            paragraph.lines.push_back(MakeLine(*run, lineStart, glyphs.size()));
+        }
+    }
+
+    const uint32_t lineCount = static_cast<uint32_t>(std::max<size_t>(1, paragraph.lines.size()));
+    if (paragraph.lineCount != lineCount) {
+        // 估算的行数被修正，后面段落的行号需要重新累加
+        lineIndexValid_ = std::min(lineIndexValid_, index);
+    }
+    paragraph.lineCount = lineCount;
+}
+
+void TextArea::EnsureLineIndex() {
+    const size_t count = paragraphs_.size();
+    if (lineStarts_.size() != count + 1) {
+        lineStarts_.resize(count + 1);
+        lineIndexValid_ = std::min(lineIndexValid_, count);
+    }
+    lineStarts_[0] = 0;
+    for (size_t i = lineIndexValid_; i < count; ++i) {
+        lineStarts_[i + 1] = lineStarts_[i] + std::max<uint32_t>(1, paragraphs_[i].lineCount);
+    }
+    lineIndexValid_ = count;
+}
+
+size_t TextArea::FindParagraphAtLine(size_t line) const {
+    const auto it = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), line);
+    const size_t index = it == lineStarts_.begin() ? 0 : static_cast<size_t>(it - lineStarts_.begin()) - 1;
+    return std::min(index, paragraphs_.size() - 1);
+}
+
+int TextArea::ResolveFont() const {
+    return fontId_ >= 0 ? fontId_ : graphics::TextEngine::GetSharedInstance().GetDefaultFont();
+}
+
+void TextArea::Render(SkCanvas* canvas) {
+    if (!canvas || !GetVisibility()) {
+        return;
+    }
+
+    const bool hasTransform = BeginRender(canvas);
+
+    const float opacity = GetPaintOpacity();
+    graphics::TextEngine& engine = graphics::TextEngine::GetSharedInstance();
+    const int font = ResolveFont();
+    const SkRect viewport = SkRect::MakeLTRB(paddingLeft_, paddingTop_, width_ - paddingRight_, height_ - paddingBottom_);
+    if (engine.IsValidFont(font) && !viewport.isEmpty()) {
+        const float wrapWidth = wrap_ ? viewport.width() : 0.0f;
+        if (wrapWidth != layoutWidth_ || font != layoutFont_) {
+            ResetLayout();
+            layoutWidth_ = wrapWidth;
+            layoutFont_ = font;
+        }
+
+        canvas->save();
+        canvas->clipRect(viewport);
+        // 可见范围同时受视口和外部裁剪（例如滚动容器）限制，换算到内容坐标
+        SkRect clip;
+        if (canvas->getLocalClipBounds(&clip) && clip.intersect(viewport)) {
+            const float lineHeight = GetLineHeight();
+            const float ascent = engine.GetMetrics(font, fontSize_).ascent;
+            const float visibleTop = clip.top() - viewport.top() + scrollOffset_;
+            const float visibleBottom = clip.bottom() - viewport.top() + scrollOffset_;
+
+            EnsureLineIndex();
+            const size_t first = FindParagraphAtLine(static_cast<size_t>(std::max(0.0f, visibleTop / lineHeight)));
+            float y = lineStarts_[first] * lineHeight;
+            size_t last = first;
+            graphics::GlyphAtlas& atlas = graphics::GlyphAtlas::GetSharedInstance();
+            while (last < paragraphs_.size() && y < visibleBottom) {
+                Paragraph& paragraph = paragraphs_[last];
+                if (paragraph.lines.empty()) {
+                    BreakParagraph(last, wrapWidth);
+                }
+                for (const auto& line : paragraph.lines) {
+                    if (y + lineHeight > visibleTop && y < visibleBottom && !line->glyphs.empty()) {
+                        atlas.DrawRun(canvas, *line, viewport.left(), viewport.top() + y - scrollOffset_ + ascent,
+                                      foregroundColor_, opacity);
+                    }
+                    y += lineHeight;
+                }
+                if (paragraph.lines.empty()) {
+                    y += lineHeight;
+                }
+                ++last;
+            }
+
+            // 释放移出可见范围的段落的排版结果，只保留行数
+            for (size_t i = shapedFirst_; i < std::min(shapedLast_, paragraphs_.size()); ++i) {
+                if (i < first || i >= last) {
+                    paragraphs_[i].lines.clear();
+                }
+            }
+            shapedFirst_ = first;
+            shapedLast_ = last;
+        }
+        canvas->restore();
+    }
+
+    if (hasTransform) {
+        canvas->restore();
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,220 @@
+#include "TextBuffer.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+void IndexNewlines(const std::string& text, size_t from, std::vector<size_t>* newlines) {
+    for (size_t pos = text.find('\n', from); pos != std::string::npos; pos = text.find('\n', pos + 1)) {
+        newlines->push_back(pos);
+    }
+}
+
+} // namespace
+
+TextBuffer::TextBuffer() {
+}
+
+TextBuffer::TextBuffer(std::string text) {
+    SetText(std::move(text));
+}
+
+void TextBuffer::SetText(std::string text) {
+    original_ = std::move(text);
+    added_.clear();
+    originalNewlines_.clear();
+    addedNewlines_.clear();
+    IndexNewlines(original_, 0, &originalNewlines_);
+
+    pieces_.clear();
+    length_ = original_.size();
+    newlineCount_ = originalNewlines_.size();
+    if (length_ > 0) {
+        pieces_.push_back(MakePiece(Source::Original, 0, length_));
+    }
+}
+
+std::string TextBuffer::GetText() const {
+    return GetText(0, length_);
+}
+
+std::string TextBuffer::GetText(size_t offset, size_t length) const {
+    std::string result;
+    if (offset >= length_) {
+        return result;
+    }
+    length = std::min(length, length_ - offset);
+    result.reserve(length);
+
+    size_t pieceOffset = 0;
+    for (size_t i = FindPiece(offset, &pieceOffset); i < pieces_.size() && length > 0; ++i) {
+        const Piece& piece = pieces_[i];
+        const size_t count = std::min(length, piece.length - pieceOffset);
+        result.append(GetSource(piece.source), piece.start + pieceOffset, count);
+        length -= count;
+        pieceOffset = 0;
+    }
+    return result;
+}
+
+void TextBuffer::Insert(size_t offset, const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    offset = std::min(offset, length_);
+
+    const size_t addedStart = added_.size();
+    added_.append(text);
+    IndexNewlines(added_, addedStart, &addedNewlines_);
+    const Piece inserted = MakePiece(Source::Added, addedStart, text.size());
+    length_ += inserted.length;
+    newlineCount_ += inserted.newlines;
+
+    size_t pieceOffset = 0;
+    size_t index = FindPiece(offset, &pieceOffset);
+    if (pieceOffset == 0 && index > 0) {
+        // 连续输入：前一个片段正好结束在追加数据的末尾时直接延长它
+        Piece& previous = pieces_[index - 1];
+        if (previous.source == Source::Added && previous.start + previous.length == addedStart) {
+            previous.length += inserted.length;
+            previous.newlines += inserted.newlines;
+            return;
+        }
+    }
+    if (pieceOffset > 0) {
+        index = SplitPiece(index, pieceOffset);
+    }
+    pieces_.insert(pieces_.begin() + index, inserted);
+}
+
+void TextBuffer::Erase(size_t offset, size_t length) {
+    if (offset >= length_ || length == 0) {
+        return;
+    }
+    length = std::min(length, length_ - offset);
+
+    size_t pieceOffset = 0;
+    size_t first = FindPiece(offset, &pieceOffset);
+    if (pieceOffset > 0) {
+        first = SplitPiece(first, pieceOffset);
+    }
+
+    // 整段删除完全覆盖的片段，最后一个片段只删除开头
+    size_t last = first;
+    size_t remaining = length;
+    while (last < pieces_.size() && remaining >= pieces_[last].length) {
+        remaining -= pieces_[last].length;
+        newlineCount_ -= pieces_[last].newlines;
+        ++last;
+    }
+    if (remaining > 0) {
+        Piece& piece = pieces_[last];
+        const Piece trimmed = MakePiece(piece.source, piece.start + remaining, piece.length - remaining);
+        newlineCount_ -= piece.newlines - trimmed.newlines;
+        piece = trimmed;
+    }
+    pieces_.erase(pieces_.begin() + first, pieces_.begin() + last);
+    length_ -= length;
+}
+
+size_t TextBuffer::GetLineStart(size_t line) const {
+    if (line == 0) {
+        return 0;
+    }
+    if (line > newlineCount_) {
+        return length_;
+    }
+
+    size_t offset = 0;
+    size_t newlinesBefore = 0;
+    for (const Piece& piece : pieces_) {
+        if (newlinesBefore + piece.newlines >= line) {
+            // 第 line 个换行符在这个片段中，直接从来源数据的换行索引中取出它的位置
+            const auto& newlines = GetNewlines(piece.source);
+            const auto firstInPiece = std::lower_bound(newlines.begin(), newlines.end(), piece.start);
+            const size_t position = *(firstInPiece + (line - newlinesBefore - 1));
+            return offset + (position - piece.start) + 1;
+        }
+        newlinesBefore += piece.newlines;
+        offset += piece.length;
+    }
+    return length_;
+}
+
+size_t TextBuffer::GetLineLength(size_t line) const {
+    const size_t start = GetLineStart(line);
+    if (line >= newlineCount_) {
+        return length_ - start;
+    }
+    return GetLineStart(line + 1) - 1 - start;
+}
+
+std::string TextBuffer::GetLineText(size_t line) const {
+    const size_t start = GetLineStart(line);
+    const size_t end = line >= newlineCount_ ? length_ : GetLineStart(line + 1) - 1;
+    return GetText(start, end - start);
+}
+
+size_t TextBuffer::GetLineFromOffset(size_t offset) const {
+    offset = std::min(offset, length_);
+    size_t line = 0;
+    size_t position = 0;
+    for (const Piece& piece : pieces_) {
+        if (offset < position + piece.length) {
+            return line + CountNewlines(piece.source, piece.start, offset - position);
+        }
+        line += piece.newlines;
+        position += piece.length;
+    }
+    return line;
+}
+
+const std::string& TextBuffer::GetSource(Source source) const {
+    return source == Source::Original ? original_ : added_;
+}
+
+const std::vector<size_t>& TextBuffer::GetNewlines(Source source) const {
+    return source == Source::Original ? originalNewlines_ : addedNewlines_;
+}
+
+size_t TextBuffer::CountNewlines(Source source, size_t start, size_t length) const {
+    const auto& newlines = GetNewlines(source);
+    const auto first = std::lower_bound(newlines.begin(), newlines.end(), start);
+    const auto last = std::lower_bound(first, newlines.end(), start + length);
+    return static_cast<size_t>(last - first);
+}
+
+TextBuffer::Piece TextBuffer::MakePiece(Source source, size_t start, size_t length) const {
+    Piece piece;
+    piece.source = source;
+    piece.start = start;
+    piece.length = length;
+    piece.newlines = CountNewlines(source, start, length);
+    return piece;
+}
+
+size_t TextBuffer::FindPiece(size_t offset, size_t* pieceOffset) const {
+    size_t position = 0;
+    for (size_t i = 0; i < pieces_.size(); ++i) {
+        if (offset < position + pieces_[i].length) {
+            *pieceOffset = offset - position;
+            return i;
+        }
+        position += pieces_[i].length;
+    }
+    *pieceOffset = 0;
+    return pieces_.size();
+}
+
+size_t TextBuffer::SplitPiece(size_t index, size_t at) {
+    const Piece piece = pieces_[index];
+    pieces_[index] = MakePiece(piece.source, piece.start, at);
+    pieces_.insert(pieces_.begin() + index + 1, MakePiece(piece.source, piece.start + at, piece.length - at));
+    return index + 1;
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,127 @@
+#include "TextMeasureCache.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ull;
+constexpr uint64_t kFnvPrime = 0x100000001b3ull;
+
+uint64_t HashBytes(uint64_t hash, const void* bytes, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(bytes);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+template <typename T>
+uint64_t HashValue(uint64_t hash, const T& value) {
+    return HashBytes(hash, &value, sizeof(value));
+}
+
+} // namespace
+
+size_t TextMeasureCache::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = HashValue(kFnvOffset, key.contentHash);
+    hash = HashValue(hash, key.featuresHash);
+    hash = HashValue(hash, key.fontId);
+    hash = HashValue(hash, key.fontSize);
+    hash = HashValue(hash, key.width);
+    hash = HashValue(hash, static_cast<int>(key.widthMode));
+    return static_cast<size_t>(hash);
+}
+
+TextMeasureCache& TextMeasureCache::GetSharedInstance() {
+    static TextMeasureCache instance;
+    return instance;
+}
+
+TextMeasureCache::Key TextMeasureCache::MakeKey(uint64_t contentHash, uint64_t featuresHash, int fontId,
+                                                float fontSize, float width, YGMeasureMode widthMode) {
+    Key key;
+    key.contentHash = contentHash;
+    key.featuresHash = featuresHash;
+    key.fontId = fontId;
+    key.fontSize = fontSize;
+    key.widthMode = widthMode;
+    // Undefined 模式下宽度是 NaN，NaN 不等于自身，归一化后才能命中
+    key.width = (widthMode == YGMeasureModeUndefined || std::isnan(width)) ? 0.0f : width;
+    return key;
+}
+
+uint64_t TextMeasureCache::HashContent(const std::string& text) {
+    return HashBytes(kFnvOffset, text.data(), text.size());
+}
+
+uint64_t TextMeasureCache::HashFeatures(const std::vector<std::string>& features) {
+    uint64_t hash = kFnvOffset;
+    for (const auto& feature : features) {
+        hash = HashBytes(hash, feature.data(), feature.size());
+        hash = HashValue(hash, ',');
+    }
+    return hash;
+}
+
+bool TextMeasureCache::Find(const Key& key, SkSize* size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++misses_;
+        return false;
+    }
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    if (size) {
+        *size = it->second->second;
+    }
+    return true;
+}
+
+void TextMeasureCache::Insert(const Key& key, const SkSize& size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->second = size;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+    lru_.emplace_front(key, size);
+    index_[key] = lru_.begin();
+    EvictLocked();
+}
+
+void TextMeasureCache::SetCapacity(size_t entries) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = entries;
+    EvictLocked();
+}
+
+void TextMeasureCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+}
+
+TextMeasureCache::Stats TextMeasureCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.entryCount = lru_.size();
+    return stats;
+}
+
+void TextMeasureCache::EvictLocked() {
+    while (lru_.size() > capacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
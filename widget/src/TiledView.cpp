@@ -0,0 +1,570 @@
+#include "TiledView.hpp"
+#include "ImageCache.hpp"
+#include "SceneRenderer.hpp"
+#include <window.hpp>
+#include <RenderContext.hpp>
+#include <logger.hpp>
+#include <include/core/SkPictureRecorder.h>
+#include <include/core/SkSamplingOptions.h>
+#include <include/core/SkSurface.h>
+#include <include/gpu/ganesh/GrDirectContext.h>
+#include <include/gpu/ganesh/GrRecordingContext.h>
+#include <include/gpu/ganesh/SkImageGanesh.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+// 可见瓦片的范围（包含 first，不包含 last）
+struct TileRange {
+    int firstColumn = 0;
+    int lastColumn = 0;
+    int firstRow = 0;
+    int lastRow = 0;
+
+    bool IsEmpty() const { return firstColumn >= lastColumn || firstRow >= lastRow; }
+    bool Contains(int column, int row) const {
+        return column >= firstColumn && column < lastColumn && row >= firstRow && row < lastRow;
+    }
+};
+
+} // namespace
+
+size_t TiledView::TileKeyHash::operator()(const TileKey& key) const {
+    size_t hash = std::hash<float>()(key.scale);
+    hash ^= std::hash<int>()(key.column) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int>()(key.row) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+TiledView::TiledView() {
+    SetClipToBounds(true);
+    // 瓦片纹理属于上传它的上下文，必须在该上下文释放之前放掉
+    shutdownConnection_ = graphics::RenderContext::OnContextShutdown().connect(
+        [this](GrDirectContext* context) { ReleaseTextures(context); });
+}
+
+TiledView::~TiledView() {
+}
+
+void TiledView::SetContent(boost::shared_ptr<VisualElement> content) {
+    std::vector<boost::shared_ptr<UIElement>> children;
+    if (content) {
+        children.push_back(content);
+    }
+    ReplaceChildren(children);
+    // 新内容的瓦片从头光栅化，旧内容不再作为替代显示
+    recorder_.reset();
+    picture_.reset();
+    pictureContent_ = nullptr;
+    ClearTiles();
+    ApplyViewOffset(0.0f, 0.0f);
+    InvalidateVisual();
+}
+
+boost::shared_ptr<VisualElement> TiledView::GetContent() const {
+    const auto& children = GetChildren();
+    return children.empty() ? nullptr : children.front()->AsVisualElement();
+}
+
+void TiledView::SetViewOffset(float x, float y) {
+    if (ApplyViewOffset(x, y)) {
+        // 内容图片和瓦片都不变，只需要重新合成
+        InvalidateVisual();
+    }
+}
+
+void TiledView::PanBy(float dx, float dy) {
+    SetViewOffset(viewX_ + dx, viewY_ + dy);
+}
+
+void TiledView::SetZoom(float zoom) {
+    ZoomAt(zoom, paddingLeft_, paddingTop_);
+}
+
+void TiledView::ZoomAt(float zoom, float anchorX, float anchorY) {
+    zoom = std::clamp(zoom, kMinZoom, kMaxZoom);
+    if (zoom == zoom_) {
+        return;
+    }
+    // 锚点下的内容坐标在缩放前后保持不变
+    const float contentX = (anchorX - paddingLeft_ + viewX_) / zoom_;
+    const float contentY = (anchorY - paddingTop_ + viewY_) / zoom_;
+    zoom_ = zoom;
+    MarkDirty(DirtyFlags::HitTest);
+    ApplyViewOffset(contentX * zoom_ - anchorX + paddingLeft_, contentY * zoom_ - anchorY + paddingTop_);
+    InvalidateVisual();
+}
+
+float TiledView::GetMaxViewX() const {
+    auto content = GetContent();
+    if (!content) {
+        return 0.0f;
+    }
+    const float extent = (content->GetLeft() + content->GetWidth() - paddingLeft_) * zoom_;
+    return std::max(0.0f, std::floor(paddingLeft_ + extent + paddingRight_ - width_));
+}
+
+float TiledView::GetMaxViewY() const {
+    auto content = GetContent();
+    if (!content) {
+        return 0.0f;
+    }
+    const float extent = (content->GetTop() + content->GetHeight() - paddingTop_) * zoom_;
+    return std::max(0.0f, std::floor(paddingTop_ + extent + paddingBottom_ - height_));
+}
+
+void TiledView::SetTileSize(int size) {
+    size = std::max(size, 16);
+    if (size == tileSize_) {
+        return;
+    }
+    tileSize_ = size;
+    ClearTiles();
+    InvalidateVisual();
+}
+
+void TiledView::SetTileBudget(size_t bytes) {
+    tileBudget_ = bytes;
+    EvictTiles();
+}
+
+void TiledView::ClearTiles() {
+    tiles_.clear();
+    lru_.clear();
+    tileBytes_ = 0;
+    // 丢弃还在后台光栅化的结果
+    pending_.clear();
+    ++pictureGeneration_;
+}
+
+TiledView::Stats TiledView::GetStats() const {
+    Stats stats = stats_;
+    stats.cachedTiles = tiles_.size();
+    stats.cachedBytes = tileBytes_;
+    stats.pendingTiles = inFlight_;
+    return stats;
+}
+
+bool TiledView::DrawsChildren() const {
+    return true;
+}
+
+bool TiledView::Record(::KiUI::graphics::DrawCommandBuffer& buffer) {
+    (void)buffer;
+    return false;
+}
+
+SkPoint TiledView::MapPointToChildren(float x, float y) const {
+    return SkPoint::Make((x - paddingLeft_ + viewX_) / zoom_ + paddingLeft_,
+                         (y - paddingTop_ + viewY_) / zoom_ + paddingTop_);
+}
+
+void TiledView::LayoutChildren(float width, float height) {
+    VisualElement::LayoutChildren(width, height);
+    if (ApplyViewOffset(viewX_, viewY_)) {
+        InvalidateVisual();
+    }
+}
+
+bool TiledView::ApplyViewOffset(float x, float y) {
+    x = std::clamp(std::round(x), 0.0f, GetMaxViewX());
+    y = std::clamp(std::round(y), 0.0f, GetMaxViewY());
+    if (x == viewX_ && y == viewY_) {
+        return false;
+    }
+    viewX_ = x;
+    viewY_ = y;
+    MarkDirty(DirtyFlags::HitTest);
+    return true;
+}
+
+bool TiledView::EnsurePicture() {
+    auto content = GetContent();
+    if (!content || !content->GetVisibility()) {
+        picture_.reset();
+        pictureContent_ = nullptr;
+        return false;
+    }
+
+    const uint64_t version = content->GetSubtreeVersion();
+    if (picture_ && content.get() == pictureContent_ && version == pictureVersion_) {
+        return true;
+    }
+
+    // 按内容在本组件中的位置录制（与子元素的布局坐标一致）
+    const SkRect bounds = content->GetSubtreeBounds().makeOffset(content->GetLeft(), content->GetTop());
+    if (bounds.isEmpty()) {
+        picture_.reset();
+        return false;
+    }
+    if (!recorder_) {
+        recorder_ = std::make_unique<SceneRenderer>();
+    }
+
+    // 录制发生在外层渲染器的帧内：只绘制子树，不重置图片上传预算、帧序号和 Paint 标记
+    SkPictureRecorder pictureRecorder;
+    recorder_->RenderSubtree(content, pictureRecorder.beginRecording(bounds));
+    picture_ = pictureRecorder.finishRecordingAsPicture();
+    if (!picture_) {
+        foundation::Logger::Error("TiledView: Failed to record content picture");
+        return false;
+    }
+    pictureBounds_ = bounds;
+    pictureVersion_ = version;
+    pictureContent_ = content.get();
+    // 旧代数的瓦片留在缓存中，新瓦片就绪前作为替代显示
+    ++pictureGeneration_;
+    ++stats_.pictureRecords;
+    return true;
+}
+
+sk_sp<SkImage> TiledView::RasterizeTile(const sk_sp<SkPicture>& picture, const TileKey& key, int tileSize,
+                                        float originX, float originY) {
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(tileSize, tileSize));
+    if (!surface) {
+        return nullptr;
+    }
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->clear(SK_ColorTRANSPARENT);
+    canvas->translate(-static_cast<float>(key.column) * tileSize, -static_cast<float>(key.row) * tileSize);
+    canvas->scale(key.scale, key.scale);
+    canvas->translate(-originX, -originY);
+    canvas->drawPicture(picture);
+    return surface->makeImageSnapshot();
+}
+
+void TiledView::RequestTile(const TileKey& key, const boost::shared_ptr<TiledView>& self) {
+    const uint64_t generation = pictureGeneration_;
+    if (!self) {
+        // 同步模式，或没有被 shared_ptr 持有而无法安全地异步回调
+        auto image = RasterizeTile(picture_, key, tileSize_, paddingLeft_, paddingTop_);
+        if (image) {
+            ++stats_.tilesRasterized;
+            InsertTile(key, generation, image);
+        }
+        return;
+    }
+
+    pending_[key] = generation;
+    ++inFlight_;
+    // 图片不可变，可以在后台线程回放
+    auto rasterize = [picture = picture_, key, tileSize = tileSize_, originX = paddingLeft_, originY = paddingTop_]() {
+        return RasterizeTile(picture, key, tileSize, originX, originY);
+    };
+    foundation::WindowManager::GetSharedInstance().ExecuteBackgroundTask(
+        self,
+        rasterize,
+        [key, generation](boost::shared_ptr<TiledView> view, const sk_sp<SkImage>& image) {
+            view->OnTileRasterized(key, generation, image);
+        });
+}
+
+void TiledView::OnTileRasterized(const TileKey& key, uint64_t generation, sk_sp<SkImage> image) {
+    if (inFlight_ > 0) {
+        --inFlight_;
+    }
+    auto it = pending_.find(key);
+    if (it != pending_.end() && it->second == generation) {
+        pending_.erase(it);
+    }
+    // 光栅化期间内容已经重新录制，丢弃过期结果
+    if (generation != pictureGeneration_ || !image) {
+        return;
+    }
+    ++stats_.tilesRasterized;
+    InsertTile(key, generation, std::move(image));
+    InvalidateVisual();
+}
+
+void TiledView::InsertTile(const TileKey& key, uint64_t generation, sk_sp<SkImage> image) {
+    auto it = tiles_.find(key);
+    if (it != tiles_.end()) {
+        tileBytes_ -= it->second.bytes;
+        lru_.erase(it->second.lruIt);
+        tiles_.erase(it);
+    }
+    lru_.push_front(key);
+    Tile& tile = tiles_[key];
+    tile.image = std::move(image);
+    tile.generation = generation;
+    tile.bytes = ImageCache::ComputeBytes(tile.image);
+    tile.lruIt = lru_.begin();
+    tileBytes_ += tile.bytes;
+    EvictTiles();
+}
+
+TiledView::Tile* TiledView::FindTile(const TileKey& key) {
+    auto it = tiles_.find(key);
+    if (it == tiles_.end()) {
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lruIt);
+    return &it->second;
+}
+
+void TiledView::EvictTiles() {
+    // 至少保留最近使用的一个瓦片
+    while (tileBytes_ > tileBudget_ && lru_.size() > 1) {
+        auto it = tiles_.find(lru_.back());
+        tileBytes_ -= it->second.bytes;
+        tiles_.erase(it);
+        lru_.pop_back();
+        ++stats_.tilesEvicted;
+    }
+}
+
+void TiledView::DrawTile(SkCanvas* canvas, const TileKey& key, Tile& tile, bool fallback) {
+    // 瓦片 (i, j) 覆盖内容按 scale 缩放后的 [i*T, (i+1)*T)，再按当前缩放映射到局部坐标
+    const float factor = zoom_ / key.scale;
+    const float size = tileSize_ * factor;
+    const SkRect dst = SkRect::MakeXYWH(paddingLeft_ - viewX_ + key.column * size,
+                                        paddingTop_ - viewY_ + key.row * size, size, size);
+
+    GrRecordingContext* recordingContext = canvas->recordingContext();
+    GrDirectContext* directContext = recordingContext ? recordingContext->asDirectContext() : nullptr;
+    // 纹理只能在上传它的上下文上使用；上下文丢失后纹理也会失效，需要重新上传
+    const bool textureUsable = tile.texture && tile.textureContext == directContext &&
+                               tile.texture->isValid(recordingContext);
+    if (!fallback && directContext && !textureUsable) {
+        DropTexture(tile);
+        // 显式上传并缓存纹理，之后的帧直接合成
+        tile.texture = SkImages::TextureFromImage(directContext, tile.image.get(),
+                                                  skgpu::Mipmapped::kNo, skgpu::Budgeted::kYes);
+        if (tile.texture) {
+            tile.textureContext = directContext;
+            const size_t bytes = ImageCache::ComputeBytes(tile.texture);
+            tile.bytes += bytes;
+            tileBytes_ += bytes;
+            ++stats_.tilesUploaded;
+        }
+    }
+
+    const bool useTexture = tile.texture && tile.textureContext == directContext &&
+                            (textureUsable || !fallback);
+    const sk_sp<SkImage>& image = useTexture ? tile.texture : tile.image;
+    const SkSamplingOptions sampling = fallback ? SkSamplingOptions(SkFilterMode::kLinear) : SkSamplingOptions();
+    canvas->drawImageRect(image, dst, sampling);
+}
+
+void TiledView::DropTexture(Tile& tile) {
+    if (!tile.texture) {
+        return;
+    }
+    const size_t bytes = ImageCache::ComputeBytes(tile.texture);
+    tile.bytes -= bytes;
+    tileBytes_ -= bytes;
+    tile.texture.reset();
+    tile.textureContext = nullptr;
+}
+
+void TiledView::ReleaseTextures(GrDirectContext* context) {
+    for (auto& entry : tiles_) {
+        if (entry.second.textureContext == context) {
+            DropTexture(entry.second);
+        }
+    }
+}
+
+void TiledView::Render(SkCanvas* canvas) {
+    if (!canvas || !GetVisibility()) {
+        return;
+    }
+
+    Box::Render(canvas);
+    if (!EnsurePicture()) {
+        return;
+    }
+
+    canvas->save();
+    if (!transform_.isIdentity()) {
+        canvas->concat(transform_);
+    }
+    canvas->clipRect(SkRect::MakeWH(width_, height_));
+
+    // 光栅化比例包含画布自身的缩放（高 DPI），瓦片与设备像素一一对应
+    const SkMatrix& matrix = canvas->getTotalMatrix();
+    float deviceScale = 1.0f;
+    if (matrix.isScaleTranslate()) {
+        deviceScale = std::max(std::fabs(matrix.getScaleX()), std::fabs(matrix.getScaleY()));
+        if (deviceScale <= 0.0f) {
+            deviceScale = 1.0f;
+        }
+    }
+    const float scale = zoom_ * deviceScale;
+    const float tile = static_cast<float>(tileSize_);
+
+    // 视口与内容在瓦片空间（内容按 scale 缩放、以内边距为原点）中的范围
+    const float visibleLeft = std::max((viewX_ - paddingLeft_) * deviceScale, (pictureBounds_.left() - paddingLeft_) * scale);
+    const float visibleTop = std::max((viewY_ - paddingTop_) * deviceScale, (pictureBounds_.top() - paddingTop_) * scale);
+    const float visibleRight = std::min((viewX_ - paddingLeft_ + width_) * deviceScale, (pictureBounds_.right() - paddingLeft_) * scale);
+    const float visibleBottom = std::min((viewY_ - paddingTop_ + height_) * deviceScale, (pictureBounds_.bottom() - paddingTop_) * scale);
+
+    TileRange visible;
+    visible.firstColumn = static_cast<int>(std::floor(visibleLeft / tile));
+    visible.lastColumn = static_cast<int>(std::ceil(visibleRight / tile));
+    visible.firstRow = static_cast<int>(std::floor(visibleTop / tile));
+    visible.lastRow = static_cast<int>(std::ceil(visibleBottom / tile));
+    if (visible.IsEmpty()) {
+        canvas->restore();
+        return;
+    }
+
+    // 靠近视口中心的瓦片先光栅化
+    const float centerX = (visibleLeft + visibleRight) * 0.5f;
+    const float centerY = (visibleTop + visibleBottom) * 0.5f;
+    auto byDistance = [tile, centerX, centerY](const TileKey& a, const TileKey& b) {
+        const float ax = (a.column + 0.5f) * tile - centerX;
+        const float ay = (a.row + 0.5f) * tile - centerY;
+        const float bx = (b.column + 0.5f) * tile - centerX;
+        const float by = (b.row + 0.5f) * tile - centerY;
+        return ax * ax + ay * ay < bx * bx + by * by;
+    };
+
+    auto isReady = [this](const TileKey& key) {
+        Tile* cached = FindTile(key);
+        return cached && cached->generation == pictureGeneration_;
+    };
+    auto isPending = [this](const TileKey& key) {
+        auto it = pending_.find(key);
+        return it != pending_.end() && it->second == pictureGeneration_;
+    };
+
+    std::vector<TileKey> missing;
+    for (int row = visible.firstRow; row < visible.lastRow; ++row) {
+        for (int column = visible.firstColumn; column < visible.lastColumn; ++column) {
+            TileKey key;
+            key.scale = scale;
+            key.column = column;
+            key.row = row;
+            if (!isReady(key)) {
+                missing.push_back(key);
+            }
+        }
+    }
+    std::sort(missing.begin(), missing.end(), byDistance);
+
+    boost::shared_ptr<TiledView> self;
+    if (backgroundRasterization_) {
+        try {
+            self = boost::static_pointer_cast<TiledView>(shared_from_this());
+        } catch (const boost::bad_weak_ptr&) {
+        }
+    }
+    const bool background = self != nullptr;
+    for (const TileKey& key : missing) {
+        if (background && (inFlight_ >= kMaxPendingTiles || isPending(key))) {
+            continue;
+        }
+        RequestTile(key, self);
+    }
+
+    // 后台还有余量时预取视口外一圈的瓦片，平移时尽量不露出空白
+    if (background && inFlight_ < kMaxPendingTiles) {
+        TileRange prefetch = visible;
+        prefetch.firstColumn = std::max(visible.firstColumn - 1,
+                                        static_cast<int>(std::floor((pictureBounds_.left() - paddingLeft_) * scale / tile)));
+        prefetch.lastColumn = std::min(visible.lastColumn + 1,
+                                       static_cast<int>(std::ceil((pictureBounds_.right() - paddingLeft_) * scale / tile)));
+        prefetch.firstRow = std::max(visible.firstRow - 1,
+                                     static_cast<int>(std::floor((pictureBounds_.top() - paddingTop_) * scale / tile)));
+        prefetch.lastRow = std::min(visible.lastRow + 1,
+                                    static_cast<int>(std::ceil((pictureBounds_.bottom() - paddingTop_) * scale / tile)));
+        std::vector<TileKey> ring;
+        for (int row = prefetch.firstRow; row < prefetch.lastRow; ++row) {
+            for (int column = prefetch.firstColumn; column < prefetch.lastColumn; ++column) {
+                TileKey key;
+                key.scale = scale;
+                key.column = column;
+                key.row = row;
+                if (!visible.Contains(column, row) && !isPending(key)) {
+                    auto it = tiles_.find(key);
+                    if (it == tiles_.end() || it->second.generation != pictureGeneration_) {
+                        ring.push_back(key);
+                    }
+                }
+            }
+        }
+        std::sort(ring.begin(), ring.end(), byDistance);
+        for (size_t i = 0; i < ring.size() && inFlight_ < kMaxPendingTiles; ++i) {
+            RequestTile(ring[i], self);
+        }
+    }
+
+    // 合成已经就绪的瓦片（同步光栅化的瓦片此时也已就绪）
+    missing.clear();
+    for (int row = visible.firstRow; row < visible.lastRow; ++row) {
+        for (int column = visible.firstColumn; column < visible.lastColumn; ++column) {
+            TileKey key;
+            key.scale = scale;
+            key.column = column;
+            key.row = row;
+            Tile* cached = FindTile(key);
+            if (cached && cached->generation == pictureGeneration_) {
+                DrawTile(canvas, key, *cached, false);
+                ++stats_.tilesDrawn;
+            } else {
+                missing.push_back(key);
+            }
+        }
+    }
+    stats_.tilesMissing += missing.size();
+
+    if (!missing.empty()) {
+        // 用其他缩放或旧内容的瓦片填充缺少的区域：差距最大的先画，最接近的最后画
+        struct Fallback {
+            TileKey key;
+            Tile* tile;
+            float distance;
+            bool stale;
+        };
+        std::vector<Fallback> fallbacks;
+        const SkRect viewport = SkRect::MakeWH(width_, height_);
+        for (auto& entry : tiles_) {
+            const TileKey& key = entry.first;
+            Tile& cached = entry.second;
+            if (key.scale == scale && cached.generation == pictureGeneration_) {
+                continue;
+            }
+            const float size = tileSize_ * zoom_ / key.scale;
+            const SkRect dst = SkRect::MakeXYWH(paddingLeft_ - viewX_ + key.column * size,
+                                                paddingTop_ - viewY_ + key.row * size, size, size);
+            if (!SkRect::Intersects(dst, viewport)) {
+                continue;
+            }
+            fallbacks.push_back({key, &cached, std::fabs(std::log(key.scale / scale)),
+                                 cached.generation != pictureGeneration_});
+        }
+        std::sort(fallbacks.begin(), fallbacks.end(), [](const Fallback& a, const Fallback& b) {
+            if (a.distance != b.distance) {
+                return a.distance > b.distance;
+            }
+            return a.stale && !b.stale;
+        });
+
+        if (!fallbacks.empty()) {
+            const float size = tile / deviceScale;
+            for (const TileKey& key : missing) {
+                canvas->save();
+                canvas->clipRect(SkRect::MakeXYWH(paddingLeft_ - viewX_ + key.column * size,
+                                                  paddingTop_ - viewY_ + key.row * size, size, size));
+                for (auto& fallback : fallbacks) {
+                    DrawTile(canvas, fallback.key, *fallback.tile, true);
+                }
+                canvas->restore();
+            }
+        }
+    }
+
+    canvas->restore();
+    EvictTiles();
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -12,37 +12,196 @@ UIElement::~UIElement() {
     for (auto& child : Children_) {
         if (child) {
             child->Parent_.reset();
+            child->IndexInParent_ = npos;
         }
     }
     Children_.clear();
 }
 
+void UIElement::DetachFromParent(const boost::shared_ptr<UIElement>& child) {
+    // 如果子元素已经有父元素，先从旧父元素中移除
+    if (auto oldParent = child->GetParent()) {
+        oldParent->RemoveChildAt(child->IndexInParent_);
+    }
+}
+
+void UIElement::DetachChildren(const std::vector<boost::shared_ptr<UIElement>>& children, size_t& index) {
+    // 用 npos 标记待摘下的子元素，同时记下每个旧父元素中最靠前的位置
+    std::vector<std::pair<boost::shared_ptr<UIElement>, size_t>> parents;
+    for (const auto& child : children) {
+        if (!child || !child->Parent_ || child->IndexInParent_ == npos) continue;
+        const size_t oldIndex = child->IndexInParent_;
+        if (child->Parent_.get() == this && oldIndex < index) {
+            --index;
+        }
+        auto it = std::find_if(parents.begin(), parents.end(),
+                               [&child](const auto& entry) { return entry.first == child->Parent_; });
+        if (it == parents.end()) {
+            parents.emplace_back(child->Parent_, oldIndex);
+        } else {
+            it->second = std::min(it->second, oldIndex);
+        }
+        child->IndexInParent_ = npos;
+    }
+    
+    for (auto& [parent, first] : parents) {
+        // 从最靠前的位置开始一次压缩，剩余兄弟依次前移
+        auto& siblings = parent->Children_;
+        std::vector<boost::shared_ptr<UIElement>> removed;
+        size_t write = first;
+        for (size_t read = first; read < siblings.size(); ++read) {
+            if (siblings[read]->IndexInParent_ == npos) {
+                removed.push_back(std::move(siblings[read]));
+            } else {
+                siblings[write++] = std::move(siblings[read]);
+            }
+        }
+        siblings.resize(write);
+        parent->ReindexChildren(first, siblings.size());
+        
+        for (auto& child : removed) {
+            child->Parent_.reset();
+        }
+        parent->OnChildrenRemoved(first, removed);
+    }
+}
+
+void UIElement::ReindexChildren(size_t first, size_t last) {
+    last = std::min(last, Children_.size());
+    for (size_t i = first; i < last; ++i) {
+        Children_[i]->IndexInParent_ = i;
+    }
+}
+
 void UIElement::AddChild(boost::shared_ptr<UIElement> child) {
+    InsertChildAt(Children_.size(), child);
+}
+
+void UIElement::InsertChildAt(size_t index, boost::shared_ptr<UIElement> child) {
     if (!child) return;
     
-    // 如果子元素已经有父元素，先从旧父元素中移除
-    if (auto oldParent = child->GetParent()) {
-        oldParent->RemoveChild(child);
+    // 同一父元素内的重新插入：旧位置在插入点之前时，移除后插入点需要前移
+    if (child->Parent_.get() == this && child->IndexInParent_ < index) {
+        --index;
     }
+    DetachFromParent(child);
+    
+    index = std::min(index, Children_.size());
     
     // 设置子元素的父引用（使用 shared_ptr）
     child->Parent_ = shared_from_this();
     
-    // 添加到子元素列表
-    Children_.push_back(child);
+    // 插入子元素列表，并更新插入点之后所有兄弟的索引
+    Children_.insert(Children_.begin() + index, child);
+    ReindexChildren(index, Children_.size());
+    
+    OnChildrenInserted(index, index + 1);
+}
+
+void UIElement::InsertChildrenAt(size_t index, const std::vector<boost::shared_ptr<UIElement>>& children) {
+    if (children.empty()) return;
+    
+    // 第一遍：把所有子元素从旧父元素上摘下来（每个旧父元素只压缩一次）
+    DetachChildren(children, index);
+    
+    index = std::min(index, Children_.size());
+    
+    // 第二遍：一次性插入（重复出现的子元素只保留第一次）
+    auto self = shared_from_this();
+    std::vector<boost::shared_ptr<UIElement>> adopted;
+    adopted.reserve(children.size());
+    for (const auto& child : children) {
+        if (!child || child->Parent_ == self) continue;
+        child->Parent_ = self;
+        adopted.push_back(child);
+    }
+    if (adopted.empty()) return;
+    
+    Children_.insert(Children_.begin() + index, adopted.begin(), adopted.end());
+    ReindexChildren(index, Children_.size());
+    
+    OnChildrenInserted(index, index + adopted.size());
 }
 
 void UIElement::RemoveChild(boost::shared_ptr<UIElement> child) {
-    if (!child) return;
+    if (!child || child->Parent_.get() != this) return;
+    
+    // 通过子元素记录的索引直接定位，无需搜索
+    RemoveChildAt(child->IndexInParent_);
+}
+
+void UIElement::RemoveChildAt(size_t index) {
+    RemoveChildren(index, 1);
+}
+
+void UIElement::RemoveChildren(size_t index, size_t count) {
+    if (index >= Children_.size() || count == 0) return;
+    
+    count = std::min(count, Children_.size() - index);
+    auto first = Children_.begin() + index;
+    std::vector<boost::shared_ptr<UIElement>> removed(first, first + count);
+    
+    // 从子元素列表中移除，并更新剩余兄弟的索引
+    Children_.erase(first, first + count);
+    ReindexChildren(index, Children_.size());
+    
+    // 清除子元素的父引用
+    for (auto& child : removed) {
+        child->Parent_.reset();
+        child->IndexInParent_ = npos;
+    }
     
-    // 从子元素列表中移除
-    auto it = std::remove(Children_.begin(), Children_.end(), child);
-    if (it != Children_.end()) {
-        Children_.erase(it, Children_.end());
-        // 清除子元素的父引用
+    OnChildrenRemoved(index, removed);
+}
+
+void UIElement::MoveChild(size_t from, size_t to) {
+    if (from >= Children_.size()) return;
+    to = std::min(to, Children_.size() - 1);
+    if (from == to) return;
+    
+    // 只旋转 [from, to] 之间的元素，区间外兄弟的索引保持不变
+    if (from < to) {
+        std::rotate(Children_.begin() + from, Children_.begin() + from + 1, Children_.begin() + to + 1);
+        ReindexChildren(from, to + 1);
+    } else {
+        std::rotate(Children_.begin() + to, Children_.begin() + from, Children_.begin() + from + 1);
+        ReindexChildren(to, from + 1);
+    }
+    
+    OnChildMoved(from, to);
+}
+
+void UIElement::ReplaceChildren(const std::vector<boost::shared_ptr<UIElement>>& children) {
+    auto self = shared_from_this();
+    std::vector<boost::shared_ptr<UIElement>> previous;
+    previous.swap(Children_);
+    for (auto& child : previous) {
         child->Parent_.reset();
+        child->IndexInParent_ = npos;
     }
+    
+    // 其他父元素上的子元素一次摘下（每个旧父元素只压缩一次）；原来的子元素已经解除了父引用
+    size_t index = 0;
+    DetachChildren(children, index);
+    
+    Children_.reserve(children.size());
+    for (const auto& child : children) {
+        if (!child || child->Parent_ == self) continue;
+        child->Parent_ = self;
+        child->IndexInParent_ = Children_.size();
+        Children_.push_back(child);
+    }
+    
+    // 只把真正被移出的元素交给派生类处理
+    std::vector<boost::shared_ptr<UIElement>> removed;
+    for (auto& child : previous) {
+        if (child->Parent_ != self) {
+            removed.push_back(child);
+        }
+    }
+    
+    OnChildrenReplaced(removed);
 }
 
 } // namespace widget
-} // namespace KiUI
\ No newline at end of file
+} // namespace KiUI
@@ -1,6 +1,8 @@
 #include "VisualElement.hpp"
+#include <Shapes.hpp>
 #include <logger.hpp>
 #include <vector>
+#include <algorithm>
 #include "logger.hpp"
 namespace KiUI {
 namespace widget {
@@ -23,43 +25,107 @@ VisualElement::~VisualElement() {
 }
 
 void VisualElement::SetOpacity(float opacity) {
+    // Fully transparent elements are skipped by hit testing
+    if ((opacity <= 0.0f) != (opacity_ <= 0.0f)) {
+        MarkDirty(DirtyFlags::HitTest);
+    }
     opacity_ = opacity;
+    // A group layer is rendered at full opacity, so only the layers of ancestors
+    // (and a childless element's own paint, which they contain) go stale
+    InvalidateParentVisual();
 }
 
 void VisualElement::SetVisibility(bool visible) {
     visible_ = visible;
+    MarkDirty(DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateParentVisual();
 }
 
 void VisualElement::SetTransform(const SkMatrix& matrix) {
     transform_ = matrix;
+    hasRenderTransform_ = false;
+    MarkDirty(DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateVisual();
+}
+
+void VisualElement::SetRenderTransform(float translateX, float translateY, float scaleX, float scaleY, float rotation) {
+    TransformX_ = translateX;
+    TransformY_ = translateY;
+    ScaleX_ = scaleX;
+    ScaleY_ = scaleY;
+    Rotate_ = rotation;
+    hasRenderTransform_ = true;
+    RebuildRenderTransform();
+    MarkDirty(DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateVisual();
+}
+
+void VisualElement::RebuildRenderTransform() {
+    if (!hasRenderTransform_) {
+        return;
+    }
+    // Scale and rotate around the center of the current size, then translate
+    const float centerX = width_ * 0.5f;
+    const float centerY = height_ * 0.5f;
+    transform_ = SkMatrix::Translate(TransformX_ + centerX, TransformY_ + centerY);
+    transform_.preRotate(Rotate_);
+    transform_.preScale(ScaleX_, ScaleY_);
+    transform_.preTranslate(-centerX, -centerY);
 }
 
 void VisualElement::SetWidth(float width) {
     width_ = width;
-    UpdateYogaNode();
+    explicitWidth_ = width > 0.0f;
+    RebuildRenderTransform();
+    InvalidateYogaNode();
+    MarkDirty(DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateVisual();
 }
 
 void VisualElement::SetHeight(float height) {
     height_ = height;
-    UpdateYogaNode();
+    explicitHeight_ = height > 0.0f;
+    RebuildRenderTransform();
+    InvalidateYogaNode();
+    MarkDirty(DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateVisual();
 }
 
 void VisualElement::SetLeft(float left) {
     left_ = left;
+    MarkDirty(DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateParentVisual();
 }
 
 void VisualElement::SetTop(float top) {
     top_ = top;
+    MarkDirty(DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateParentVisual();
+}
+
+void VisualElement::SetClipToBounds(bool clip) {
+    if (clipToBounds_ != clip) {
+        clipToBounds_ = clip;
+        InvalidateBounds();
+        InvalidateVisual();
+    }
 }
 
 void VisualElement::SetAlignment(Alignment alignment) {
     alignment_ = alignment;
-    UpdateYogaNode();
+    InvalidateYogaNode();
 }
 
 void VisualElement::SetJustification(Justification justification) {
     justification_ = justification;
-    UpdateYogaNode();
+    InvalidateYogaNode();
 }
 
 // Margin methods
@@ -81,7 +147,7 @@ void VisualElement::SetMargin(Margin edge, float margin) {
             marginTop_ = marginBottom_ = marginLeft_ = marginRight_ = margin;
             break;
     }
-    UpdateYogaNode();
+    InvalidateYogaNode();
 }
 
 float VisualElement::GetMargin(Margin edge) const {
@@ -119,7 +185,7 @@ void VisualElement::SetPadding(Padding edge, float padding) {
             paddingTop_ = paddingBottom_ = paddingLeft_ = paddingRight_ = padding;
             break;
     }
-    UpdateYogaNode();
+    InvalidateYogaNode();
 }
 
 float VisualElement::GetPadding(Padding edge) const {
@@ -157,6 +223,8 @@ void VisualElement::SetBorderWidth(BorderWidth edge, float width) {
             borderWidthTop_ = borderWidthBottom_ = borderWidthLeft_ = borderWidthRight_ = width;
             break;
     }
+    InvalidateBounds();
+    InvalidateVisual();
 }
 
 float VisualElement::GetBorderWidth(BorderWidth edge) const {
@@ -178,6 +246,7 @@ float VisualElement::GetBorderWidth(BorderWidth edge) const {
 // Border color methods
 void VisualElement::SetBorderColor(SkColor color) {
     borderColor_ = color;
+    InvalidateVisual();
 }
 
 // Border radius methods
@@ -199,6 +268,7 @@ void VisualElement::SetBorderRadius(BorderRadius corner, float radius) {
             borderRadiusTopLeft_ = borderRadiusTopRight_ = borderRadiusBottomLeft_ = borderRadiusBottomRight_ = radius;
             break;
     }
+    InvalidateVisual();
 }
 
 float VisualElement::GetBorderRadius(BorderRadius corner) const {
@@ -220,51 +290,239 @@ float VisualElement::GetBorderRadius(BorderRadius corner) const {
 // Background color methods
 void VisualElement::SetBackgroundColor(SkColor color) {
     backgroundColor_ = color;
+    InvalidateVisual();
 }
 
 // Foreground color methods
 void VisualElement::SetForegroundColor(SkColor color) {
     foregroundColor_ = color;
+    InvalidateVisual();
 }
 
-// Override AddChild and RemoveChild to manage Yoga node tree
-void VisualElement::AddChild(boost::shared_ptr<UIElement> child) {
-    // Call parent's AddChild first
-    UIElement::AddChild(child);
+// Keep the Yoga tree in sync with UIElement child list changes
+bool VisualElement::IsYogaChildListAligned(std::ptrdiff_t pendingDelta) const {
+    // Yoga indices match child indices only while every child is a VisualElement
+    return static_cast<std::ptrdiff_t>(YGNodeGetChildCount(yogaNode_)) + pendingDelta ==
+           static_cast<std::ptrdiff_t>(Children_.size());
+}
+
+void VisualElement::SyncYogaChildren() {
+    // Yoga refuses children on nodes with a measure function; arranged children stay detached
+    if (!yogaNode_ || measured_ || arrangesChildren_) {
+        return;
+    }
     
-    // Add child's Yoga node to this node's Yoga tree
-    auto visualChild = boost::dynamic_pointer_cast<VisualElement>(child);
-    if (visualChild && visualChild->yogaNode_ && yogaNode_) {
-        YGNodeInsertChild(yogaNode_, visualChild->yogaNode_, YGNodeGetChildCount(yogaNode_));
-        visualChild->UpdateYogaNode();
+    std::vector<YGNodeRef> nodes;
+    nodes.reserve(Children_.size());
+    for (const auto& child : Children_) {
+        auto visualChild = child->AsVisualElement();
+        if (visualChild && visualChild->yogaNode_) {
+            nodes.push_back(visualChild->yogaNode_);
+        }
     }
+    YGNodeSetChildren(yogaNode_, nodes.data(), nodes.size());
 }
 
-void VisualElement::RemoveChild(boost::shared_ptr<UIElement> child) {
-    // Remove child's Yoga node from this node's Yoga tree
-    auto visualChild = boost::dynamic_pointer_cast<VisualElement>(child);
-    if (visualChild && visualChild->yogaNode_ && yogaNode_) {
+void VisualElement::OnChildrenInserted(size_t first, size_t last) {
+    if (!yogaNode_ || measured_ || arrangesChildren_) {
+        if (measured_) {
+            foundation::Logger::Error("AddChild: children of a measured element are not laid out");
+        }
+        InvalidateChildList();
+        for (size_t i = first; i < last; ++i) {
+            if (auto visualChild = Children_[i]->AsVisualElement()) {
+                visualChild->InvalidateYogaNode();
+                visualChild->MarkDirty(visualChild->GetSubtreeDirtyFlags());
+            }
+        }
+        return;
+    }
+    
+    bool allVisual = true;
+    for (size_t i = first; i < last; ++i) {
+        auto visualChild = Children_[i]->AsVisualElement();
+        allVisual = allVisual && visualChild && visualChild->yogaNode_;
+    }
+    
+    // Single insert keeps Yoga's own insert; bulk inserts are applied in one pass
+    if (last - first == 1 && allVisual &&
+        IsYogaChildListAligned(static_cast<std::ptrdiff_t>(last - first))) {
+        auto visualChild = Children_[first]->AsVisualElement();
+        YGNodeInsertChild(yogaNode_, visualChild->yogaNode_, first);
+    } else {
+        SyncYogaChildren();
+    }
+    
+    InvalidateChildList();
+    
+    // Children use alignSelf/margins depending on having a parent; this also tells the
+    // new ancestors about any phases the inserted subtrees still have to go through
+    for (size_t i = first; i < last; ++i) {
+        if (auto visualChild = Children_[i]->AsVisualElement()) {
+            visualChild->InvalidateYogaNode();
+            visualChild->MarkDirty(visualChild->GetSubtreeDirtyFlags());
+        }
+    }
+}
+
+void VisualElement::OnChildrenRemoved(size_t first, const std::vector<boost::shared_ptr<UIElement>>& removed) {
+    // Detached children become roots, whose Yoga margins and alignment are set differently
+    for (const auto& child : removed) {
+        if (auto visualChild = child->AsVisualElement()) {
+            visualChild->InvalidateYogaNode();
+        }
+    }
+    InvalidateChildList();
+    if (!yogaNode_ || arrangesChildren_) {
+        return;
+    }
+    
+    if (removed.size() == 1 && IsYogaChildListAligned(-1)) {
+        auto visualChild = removed.front()->AsVisualElement();
+        if (visualChild && visualChild->yogaNode_) {
+            YGNodeRemoveChild(yogaNode_, visualChild->yogaNode_);
+            return;
+        }
+    }
+    SyncYogaChildren();
+}
+
+void VisualElement::OnChildMoved(size_t from, size_t to) {
+    InvalidateChildList();
+    if (!yogaNode_ || arrangesChildren_) {
+        return;
+    }
+    
+    auto visualChild = Children_[to]->AsVisualElement();
+    if (visualChild && visualChild->yogaNode_ && IsYogaChildListAligned(0)) {
         YGNodeRemoveChild(yogaNode_, visualChild->yogaNode_);
+        YGNodeInsertChild(yogaNode_, visualChild->yogaNode_, to);
+    } else {
+        SyncYogaChildren();
     }
+}
+
+void VisualElement::OnChildrenReplaced(const std::vector<boost::shared_ptr<UIElement>>& removed) {
+    InvalidateChildList();
+    SyncYogaChildren();
     
-    // Call parent's RemoveChild
-    UIElement::RemoveChild(child);
+    for (const auto& child : removed) {
+        if (auto visualChild = child->AsVisualElement()) {
+            visualChild->InvalidateYogaNode();
+        }
+    }
+    for (const auto& child : Children_) {
+        if (auto visualChild = child->AsVisualElement()) {
+            visualChild->InvalidateYogaNode();
+            visualChild->MarkDirty(visualChild->GetSubtreeDirtyFlags());
+        }
+    }
+}
+
+// Batched style updates
+void VisualElement::BeginUpdate() {
+    ++updateDepth_;
+}
+
+void VisualElement::EndUpdate() {
+    if (updateDepth_ == 0) {
+        return;
+    }
+    // A style phase during the batch skipped this element and cleared its ancestors' flags
+    if (--updateDepth_ == 0 && (dirtyFlags_ & DirtyFlags::Style) != DirtyFlags::None) {
+        MarkDirty(DirtyFlags::Style | DirtyFlags::Layout);
+    }
+}
+
+void VisualElement::InvalidateYogaNode() {
+    // The Yoga node is synced once in the next style phase, however many setters run before it
+    MarkDirty(DirtyFlags::Style | DirtyFlags::Layout);
+}
+
+void VisualElement::MarkDirty(DirtyFlags flags) {
+    dirtyFlags_ = dirtyFlags_ | flags;
+    // An ancestor that already knows about these flags has told its own ancestors too
+    auto firstParent = GetParent();
+    VisualElement* element = firstParent ? firstParent->AsVisualElement().get() : nullptr;
+    while (element && flags != DirtyFlags::None && (element->childDirtyFlags_ & flags) != flags) {
+        // Children that are not part of the Yoga tree are laid out by their container
+        // (LayoutChildren), so their style and layout changes stop there, like Yoga's dirtiness
+        if (!element->yogaNode_ || element->measured_ || element->arrangesChildren_) {
+            flags = flags & ~(DirtyFlags::Style | DirtyFlags::Layout);
+        }
+        element->childDirtyFlags_ = element->childDirtyFlags_ | flags;
+        auto parent = element->GetParent();
+        element = parent ? parent->AsVisualElement().get() : nullptr;
+    }
+}
+
+void VisualElement::InvalidateChildList() {
+    // Arranged children are positioned by this element, not by a Yoga pass over the tree
+    const bool yogaChildren = yogaNode_ && !measured_ && !arrangesChildren_;
+    MarkDirty(yogaChildren ? DirtyFlags::Layout | DirtyFlags::HitTest : DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateVisual();
+}
+
+void VisualElement::ClearDirtyFlags(DirtyFlags flags) {
+    const bool descend = (childDirtyFlags_ & flags) != DirtyFlags::None;
+    dirtyFlags_ = dirtyFlags_ & ~flags;
+    childDirtyFlags_ = childDirtyFlags_ & ~flags;
+    if (!descend) {
+        return;
+    }
+    for (const auto& child : GetChildren()) {
+        auto visualChild = child->AsVisualElement();
+        if (visualChild && (visualChild->GetSubtreeDirtyFlags() & flags) != DirtyFlags::None) {
+            visualChild->ClearDirtyFlags(flags);
+        }
+    }
+}
+
+void VisualElement::UpdateStyles() {
+    if ((dirtyFlags_ & DirtyFlags::Style) != DirtyFlags::None && updateDepth_ == 0) {
+        SyncYogaStyle();
+    }
+    if ((childDirtyFlags_ & DirtyFlags::Style) == DirtyFlags::None) {
+        return;
+    }
+    childDirtyFlags_ = childDirtyFlags_ & ~DirtyFlags::Style;
+    for (const auto& child : GetChildren()) {
+        auto visualChild = child->AsVisualElement();
+        if (visualChild && (visualChild->GetSubtreeDirtyFlags() & DirtyFlags::Style) != DirtyFlags::None) {
+            visualChild->UpdateStyles();
+        }
+    }
 }
 
 // Layout methods
 void VisualElement::UpdateYogaNode() {
+    SyncYogaStyle();
+    
+    // Update children's Yoga nodes (but don't insert them here, that should be done in AddChild)
+    for (const auto& child : GetChildren()) {
+        auto visualChild = boost::dynamic_pointer_cast<VisualElement>(child);
+        if (visualChild) {
+            visualChild->UpdateYogaNode();
+        }
+    }
+}
+
+void VisualElement::SyncYogaStyle() {
     if (!yogaNode_) {
         return;
     }
+    dirtyFlags_ = dirtyFlags_ & ~DirtyFlags::Style;
     
-    // Set width and height
-    if (width_ > 0.0f) {
+    // Only sizes set through SetWidth/SetHeight are pinned: width_/height_ also hold the last layout
+    // result, which must not turn into a fixed size (measured content can then grow or shrink)
+    if (width_ > 0.0f && explicitWidth_) {
         YGNodeStyleSetWidth(yogaNode_, width_);
     } else {
         YGNodeStyleSetWidthAuto(yogaNode_);
     }
     
-    if (height_ > 0.0f) {
+    if (height_ > 0.0f && explicitHeight_) {
         YGNodeStyleSetHeight(yogaNode_, height_);
     } else {
         YGNodeStyleSetHeightAuto(yogaNode_);
@@ -390,14 +648,6 @@ void VisualElement::UpdateYogaNode() {
         }
         YGNodeStyleSetJustifyContent(yogaNode_, yogaJustify);
     }
-    
-    // Update children's Yoga nodes (but don't insert them here, that should be done in AddChild)
-    for (const auto& child : GetChildren()) {
-        auto visualChild = boost::dynamic_pointer_cast<VisualElement>(child);
-        if (visualChild) {
-            visualChild->UpdateYogaNode();
-        }
-    }
 }
 
 void VisualElement::CalculateLayout(float parentWidth, float parentHeight, 
@@ -406,8 +656,8 @@ void VisualElement::CalculateLayout(float parentWidth, float parentHeight,
         return;
     }
     
-    // Update Yoga node properties
-    UpdateYogaNode();
+    // Style phase: only elements whose properties changed since the last layout
+    UpdateStyles();
 
     auto parent = GetParent();
     float parentPaddingRight = 0.0f;
@@ -426,23 +676,119 @@ void VisualElement::CalculateLayout(float parentWidth, float parentHeight,
     // Calculate layout with Yoga
     YGNodeCalculateLayout(yogaNode_, availableWidth, availableHeight, YGDirectionLTR);
     
-    left_ = YGNodeLayoutGetLeft(yogaNode_) + parentPaddingLeft;
-    top_ = YGNodeLayoutGetTop(yogaNode_) + parentPaddingTop;
-    width_ = YGNodeLayoutGetWidth(yogaNode_);
-    height_ = YGNodeLayoutGetHeight(yogaNode_);
-    
-    float childParentWidth = width_ - paddingLeft_ - paddingRight_;
-    float childParentHeight = height_ - paddingTop_ - paddingBottom_;
+    float left = YGNodeLayoutGetLeft(yogaNode_) + parentPaddingLeft;
+    float top = YGNodeLayoutGetTop(yogaNode_) + parentPaddingTop;
+    float width = YGNodeLayoutGetWidth(yogaNode_);
+    float height = YGNodeLayoutGetHeight(yogaNode_);
+    SetLayoutFrame(left, top, width, height);
     
+    LayoutChildren(width_ - paddingLeft_ - paddingRight_, height_ - paddingTop_ - paddingBottom_);
+    ClearDirtyFlags(DirtyFlags::Layout);
+}
+
+void VisualElement::Arrange(float left, float top, float width, float height, bool layoutChildren) {
+    const bool resized = width != width_ || height != height_;
+    SetLayoutFrame(left, top, width, height);
+    if ((resized || layoutChildren) && GetChildrenCount() > 0) {
+        LayoutChildren(width_ - paddingLeft_ - paddingRight_, height_ - paddingTop_ - paddingBottom_);
+    }
+}
+
+void VisualElement::SetLayoutFrame(float left, float top, float width, float height) {
+    if (left != left_ || top != top_ || width != width_ || height != height_) {
+        MarkDirty(DirtyFlags::HitTest);
+    }
+    if (width != width_ || height != height_) {
+        InvalidateVisual();
+    } else if (left != left_ || top != top_) {
+        InvalidateParentVisual();
+    }
+    if (left != left_ || top != top_ || width != width_ || height != height_) {
+        left_ = left;
+        top_ = top;
+        width_ = width;
+        height_ = height;
+        // The render transform pivots around the center, which moves with the size
+        RebuildRenderTransform();
+        InvalidateBounds();
+    }
+}
+
+void VisualElement::LayoutChildren(float width, float height) {
     for (const auto& child : GetChildren()) {
         auto visualChild = boost::dynamic_pointer_cast<VisualElement>(child);
         if (visualChild) {
-            visualChild->CalculateLayout(childParentWidth, childParentHeight, 
-                                        paddingLeft_, paddingTop_);
+            visualChild->CalculateLayout(width, height, paddingLeft_, paddingTop_);
         }
     }
 }
 
+void VisualElement::SetArrangesChildren(bool arranges) {
+    if (!yogaNode_ || arrangesChildren_ == arranges) {
+        return;
+    }
+    if (arranges && measured_) {
+        foundation::Logger::Error("SetArrangesChildren: a measured element has no children to arrange");
+        return;
+    }
+    if (arranges) {
+        YGNodeRemoveAllChildren(yogaNode_);
+        arrangesChildren_ = true;
+    } else {
+        arrangesChildren_ = false;
+        SyncYogaChildren();
+    }
+    MarkDirty(DirtyFlags::Layout | DirtyFlags::HitTest);
+    InvalidateBounds();
+    InvalidateVisual();
+}
+
+void VisualElement::SetMeasured(bool measured) {
+    if (!yogaNode_ || measured_ == measured) {
+        return;
+    }
+    if (measured && (YGNodeGetChildCount(yogaNode_) > 0 || arrangesChildren_)) {
+        foundation::Logger::Error("SetMeasured: an element with children cannot be measured");
+        return;
+    }
+    measured_ = measured;
+    YGNodeSetContext(yogaNode_, measured ? this : nullptr);
+    YGNodeSetMeasureFunc(yogaNode_, measured ? &VisualElement::YogaMeasure : nullptr);
+    InvalidateYogaNode();
+}
+
+void VisualElement::InvalidateMeasure() {
+    // Yoga only lets nodes with a measure function mark themselves dirty
+    if (yogaNode_ && measured_) {
+        YGNodeMarkDirty(yogaNode_);
+    }
+}
+
+SkSize VisualElement::MeasureContent(float width, YGMeasureMode widthMode, float height, YGMeasureMode heightMode) {
+    (void)width;
+    (void)widthMode;
+    (void)height;
+    (void)heightMode;
+    return SkSize::MakeEmpty();
+}
+
+YGSize VisualElement::YogaMeasure(YGNodeConstRef node, float width, YGMeasureMode widthMode,
+                                  float height, YGMeasureMode heightMode) {
+    auto* element = static_cast<VisualElement*>(YGNodeGetContext(node));
+    if (!element) {
+        return YGSize{0.0f, 0.0f};
+    }
+    const SkSize size = element->MeasureContent(width, widthMode, height, heightMode);
+    return YGSize{size.width(), size.height()};
+}
+
+bool VisualElement::IsLayoutDirty() const {
+    if ((GetSubtreeDirtyFlags() & (DirtyFlags::Style | DirtyFlags::Layout)) != DirtyFlags::None) {
+        return true;
+    }
+    return yogaNode_ && YGNodeIsDirty(yogaNode_);
+}
+
 boost::shared_ptr<VisualElement> VisualElement::AsVisualElement() {
     return boost::static_pointer_cast<VisualElement>(shared_from_this());
 }
@@ -484,12 +830,17 @@ boost::shared_ptr<VisualElement> VisualElement::HitTest(float x, float y) {
 #ifdef TRACY_ENABLE
         ZoneScopedN("HitTest Children");
 #endif
+        // 子节点所在的空间（滚动容器的子节点整体平移了滚动偏移）
+        const SkPoint childPoint = MapPointToChildren(localX, localY);
+        const float childX = childPoint.x();
+        const float childY = childPoint.y();
+
         // 逆序遍历子节点（后画的在上层）
         const auto& children = GetChildren();
         for (auto it = children.rbegin(); it != children.rend(); ++it) {
             auto visualChild = (*it)->AsVisualElement();
             if (visualChild) {
-                auto hit = visualChild->HitTest(localX, localY);
+                auto hit = visualChild->HitTest(childX, childY);
                 if (hit) return hit;
             }
         }
@@ -512,5 +863,187 @@ bool VisualElement::HitTestLocal(float x, float y) const {
     return result;
 }
 
+SkRect VisualElement::GetLocalBounds() const {
+    // Borders are stroked on the edge, so half of the widest border lies outside
+    float borderOutset = std::max(std::max(borderWidthTop_, borderWidthBottom_),
+                                  std::max(borderWidthLeft_, borderWidthRight_)) / 2.0f;
+    return SkRect::MakeWH(width_, height_).makeOutset(borderOutset, borderOutset);
+}
+
+bool VisualElement::GetOpaqueBounds(SkRect* rect) const {
+    (void)rect;
+    return false;
+}
+
+const SkRect& VisualElement::GetSubtreeBounds() {
+    if (boundsValid_) {
+        return subtreeBounds_;
+    }
+    
+    SkRect bounds = transform_.mapRect(GetLocalBounds());
+    const SkRect clip = SkRect::MakeWH(width_, height_);
+    childrenOverflow_ = false;
+    
+    // Children are positioned in this element's untransformed space (see SceneRenderer)
+    for (const auto& child : GetChildren()) {
+        auto visualChild = child->AsVisualElement();
+        if (!visualChild || !visualChild->visible_) {
+            continue;
+        }
+        SkRect childBounds = visualChild->GetSubtreeBounds().makeOffset(visualChild->left_, visualChild->top_);
+        if (childBounds.isEmpty()) {
+            continue;
+        }
+        if (!clip.contains(childBounds)) {
+            childrenOverflow_ = true;
+        }
+        if (clipToBounds_ && !childBounds.intersect(clip)) {
+            continue;
+        }
+        bounds.join(childBounds);
+    }
+    
+    subtreeBounds_ = bounds;
+    boundsValid_ = true;
+    return subtreeBounds_;
+}
+
+bool VisualElement::HasOverflowingChildren() {
+    GetSubtreeBounds();
+    return childrenOverflow_;
+}
+
+bool VisualElement::UsesGroupOpacity() const {
+    if (opacity_ >= 1.0f) {
+        return false;
+    }
+    for (const auto& child : GetChildren()) {
+        auto visualChild = child->AsVisualElement();
+        if (visualChild && visualChild->visible_) {
+            return true;
+        }
+    }
+    return false;
+}
+
+float VisualElement::GetPaintOpacity() const {
+    return UsesGroupOpacity() ? 1.0f : opacity_;
+}
+
+float VisualElement::GetAverageBorderWidth() const {
+    // Calculate border width (use average if different sides have different widths)
+    if (borderWidthTop_ > 0.0f || borderWidthBottom_ > 0.0f || 
+        borderWidthLeft_ > 0.0f || borderWidthRight_ > 0.0f) {
+        return (borderWidthTop_ + borderWidthBottom_ + 
+                borderWidthLeft_ + borderWidthRight_) / 4.0f;
+    }
+    return 0.0f;
+}
+
+bool VisualElement::HasBorderRadius() const {
+    return (borderRadiusTopLeft_ > 0.0f || borderRadiusTopRight_ > 0.0f || 
+            borderRadiusBottomLeft_ > 0.0f || borderRadiusBottomRight_ > 0.0f);
+}
+
+bool VisualElement::BeginRender(SkCanvas* canvas) {
+    // Only a transform needs the canvas state saved and restored
+    const bool hasTransform = !transform_.isIdentity();
+    if (hasTransform) {
+        canvas->save();
+        canvas->concat(transform_);
+    }
+    
+    const float avgBorderWidth = GetAverageBorderWidth();
+    const bool hasBorder = avgBorderWidth > 0.0f && SkColorGetA(borderColor_) != 0;
+    if (SkColorGetA(backgroundColor_) == 0 && !hasBorder) {
+        return hasTransform;
+    }
+    
+    if (HasBorderRadius()) {
+        ::KiUI::graphics::Shapes::DrawRoundedRectangle(
+            canvas,
+            0.0f, 0.0f, width_, height_,
+            borderRadiusTopLeft_, borderRadiusTopRight_,
+            borderRadiusBottomRight_, borderRadiusBottomLeft_,
+            backgroundColor_,
+            hasBorder ? borderColor_ : SK_ColorTRANSPARENT,
+            hasBorder ? avgBorderWidth : 0.0f,
+            GetPaintOpacity()
+        );
+    } else {
+        ::KiUI::graphics::Shapes::DrawRectangle(
+            canvas,
+            0.0f, 0.0f, width_, height_,
+            backgroundColor_,
+            hasBorder ? borderColor_ : SK_ColorTRANSPARENT,
+            hasBorder ? avgBorderWidth : 0.0f,
+            GetPaintOpacity()
+        );
+    }
+    return hasTransform;
+}
+
+void VisualElement::InvalidateVisual() {
+    MarkDirty(DirtyFlags::Paint);
+    // Every ancestor may hold a cached layer that contains this element
+    for (VisualElement* element = this; element; ) {
+        ++element->subtreeVersion_;
+        auto parent = element->GetParent();
+        element = parent ? parent->AsVisualElement().get() : nullptr;
+    }
+}
+
+void VisualElement::InvalidateParentVisual() {
+    auto parent = GetParent();
+    if (auto visualParent = parent ? parent->AsVisualElement() : nullptr) {
+        visualParent->InvalidateVisual();
+    } else {
+        // The root has no parent to carry the change; mark it so the renderer still schedules a frame
+        MarkDirty(DirtyFlags::Paint);
+    }
+}
+
+void VisualElement::InvalidateBounds() {
+    // Hidden children are skipped by GetSubtreeBounds, so this element may already be
+    // invalid while its parent is not; from the parent on, an invalid cache implies
+    // invalid ancestors and the walk can stop there
+    boundsValid_ = false;
+    auto firstParent = GetParent();
+    VisualElement* element = firstParent ? firstParent->AsVisualElement().get() : nullptr;
+    while (element && element->boundsValid_) {
+        element->boundsValid_ = false;
+        auto parent = element->GetParent();
+        element = parent ? parent->AsVisualElement().get() : nullptr;
+    }
+}
+
+bool VisualElement::GetChildScrollOffset(SkPoint* offset) const {
+    (void)offset;
+    return false;
+}
+
+bool VisualElement::DrawsChildren() const {
+    return false;
+}
+
+SkPoint VisualElement::MapPointToChildren(float x, float y) const {
+    SkPoint scroll;
+    if (GetChildScrollOffset(&scroll)) {
+        return SkPoint::Make(x + scroll.x(), y + scroll.y());
+    }
+    return SkPoint::Make(x, y);
+}
+
+bool VisualElement::GetChildDamage(uint64_t version, std::vector<SkRect>* damage) const {
+    (void)version;
+    (void)damage;
+    return false;
+}
+
+bool VisualElement::Record(graphics::DrawCommandBuffer& buffer) {
+    (void)buffer;
+    return false;
+}
+
 } // namespace widget
 } // namespace KiUI
\ No newline at end of file
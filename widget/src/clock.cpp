@@ -5,9 +5,6 @@
 namespace KiUI {
 namespace widget {
 
-// Clock widget implementation
-// TODO: Implement clock widget
-
 CompositionClock::CompositionClock() {
 }
 
@@ -15,15 +12,29 @@ CompositionClock::~CompositionClock() {
 }
 
 void CompositionClock::Tick() {
-    auto now = std::chrono::high_resolution_clock::now();
+    Tick(std::chrono::steady_clock::now());
+}
+
+void CompositionClock::Tick(TimePoint now) {
+    if (!started_) {
+        // 第一帧没有上一帧可以比较
+        started_ = true;
+        lastTickTime_ = now;
+        deltaTime_ = 0.0f;
+        return;
+    }
     std::chrono::duration<float, std::milli> diff = now - lastTickTime_;
     deltaTime_ = diff.count();
     totalTime_ += deltaTime_;
     lastTickTime_ = now;
-    if (deltaTime_ > 100.0f) {
-        deltaTime_ = 8.0f; // if deltaTime is too large, set it to 8ms
-    }
 }
+
+void CompositionClock::Reset() {
+    started_ = false;
+    deltaTime_ = 0.0f;
+    totalTime_ = 0.0f;
+}
+
 float CompositionClock::GetDeltaTime() const {
     return deltaTime_;
 }
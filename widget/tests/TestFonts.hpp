@@ -0,0 +1,36 @@
+#ifndef TEST_FONTS_HPP
+#define TEST_FONTS_HPP
+#pragma once
+
+#include <TextEngine.hpp>
+#include <filesystem>
+
+namespace KiUI {
+namespace test {
+
+/**
+ * @brief 加载测试使用的系统字体（TextEngine 按路径去重，重复调用返回同一个 id）
+ * @return 字体 id；找不到任何候选字体时返回 -1，依赖字体的测试应跳过
+ */
+inline int LoadTestFont() {
+    static const char* kCandidates[] = {
+        "C:/Windows/Fonts/arial.ttf",
+        "C:/Windows/Fonts/segoeui.ttf",
+        "/System/Library/Fonts/Supplemental/Arial.ttf",
+        "/Library/Fonts/Arial.ttf",
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+        "/usr/share/fonts/TTF/DejaVuSans.ttf",
+        "/usr/share/fonts/dejavu/DejaVuSans.ttf",
+    };
+    for (const char* path : kCandidates) {
+        if (std::filesystem::exists(path)) {
+            return graphics::TextEngine::GetSharedInstance().LoadFont(path);
+        }
+    }
+    return -1;
+}
+
+} // namespace test
+} // namespace KiUI
+
+#endif // TEST_FONTS_HPP
@@ -0,0 +1,133 @@
+#ifndef TEST_RENDERING_HPP
+#define TEST_RENDERING_HPP
+#pragma once
+
+#include "AnimationEngine.hpp"
+#include "Box.hpp"
+#include "SceneRenderer.hpp"
+#include "VisualElement.hpp"
+#include <include/core/SkCanvas.h>
+#include <include/core/SkColor.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <include/core/SkSurface.h>
+#include <boost/make_shared.hpp>
+
+namespace KiUI {
+namespace test {
+
+/**
+ * @brief 创建光栅表面并清成指定颜色
+ * @param width 宽度（像素）
+ * @param height 高度（像素）
+ * @param clearColor 初始颜色
+ */
+inline sk_sp<SkSurface> MakeRasterSurface(int width, int height, SkColor clearColor = SK_ColorTRANSPARENT) {
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(width, height));
+    surface->getCanvas()->clear(clearColor);
+    return surface;
+}
+
+/**
+ * @brief 创建纯色的光栅图片
+ * @param width 宽度（像素）
+ * @param height 高度（像素）
+ * @param color 填充颜色
+ */
+inline sk_sp<SkImage> MakeSolidImage(int width, int height, SkColor color) {
+    return MakeRasterSurface(width, height, color)->makeImageSnapshot();
+}
+
+/**
+ * @brief 创建一个绝对定位、显式尺寸的纯色 Box
+ * @param x 相对父元素的左边距
+ * @param y 相对父元素的上边距
+ * @param width 宽度
+ * @param height 高度
+ * @param color 背景色
+ */
+inline boost::shared_ptr<widget::Box> MakePlacedBox(float x, float y, float width, float height, SkColor color = SK_ColorBLUE) {
+    auto box = boost::make_shared<widget::Box>();
+    box->SetLeft(x);
+    box->SetTop(y);
+    box->SetWidth(width);
+    box->SetHeight(height);
+    box->SetBackgroundColor(color);
+    return box;
+}
+
+/**
+ * @brief 用渲染器在透明的光栅表面上绘制一帧
+ * @return 绘制结果的快照
+ */
+inline sk_sp<SkImage> RenderScene(widget::SceneRenderer& renderer, int width, int height) {
+    auto surface = MakeRasterSurface(width, height);
+    renderer.Render(surface->getCanvas());
+    return surface->makeImageSnapshot();
+}
+
+/**
+ * @brief 不经过渲染器，直接调用组件的 Render 绘制到透明的光栅表面
+ * @return 绘制结果的快照
+ */
+inline sk_sp<SkImage> RenderElement(widget::VisualElement& element, int width, int height) {
+    auto surface = MakeRasterSurface(width, height);
+    element.Render(surface->getCanvas());
+    return surface->makeImageSnapshot();
+}
+
+/**
+ * @brief 读取光栅图片中一个像素的颜色
+ * @return 像素颜色，图片不能直接读取时返回透明
+ */
+inline SkColor PixelAt(const sk_sp<SkImage>& image, int x, int y) {
+    SkPixmap pixels;
+    return image && image->peekPixels(&pixels) ? pixels.getColor(x, y) : SK_ColorTRANSPARENT;
+}
+
+/**
+ * @brief 读取光栅表面当前内容中一个像素的颜色
+ */
+inline SkColor PixelAt(const sk_sp<SkSurface>& surface, int x, int y) {
+    return PixelAt(surface->makeImageSnapshot(), x, y);
+}
+
+/**
+ * @brief 线性缓动、指定时长的动画选项
+ * @param duration 时长（毫秒）
+ */
+inline widget::AnimationOptions Linear(float duration) {
+    widget::AnimationOptions options;
+    options.duration = duration;
+    options.easing = widget::Easing::Linear();
+    return options;
+}
+
+/**
+ * @brief 动画测试场景：布局完成的 200x200 白色根容器左上角放一个 50x50 的红色 Box
+ */
+struct AnimationScene {
+    static constexpr int kSize = 200;
+    boost::shared_ptr<widget::Box> root;
+    boost::shared_ptr<widget::Box> box;
+};
+
+inline AnimationScene CreateAnimationScene() {
+    AnimationScene scene;
+    scene.root = boost::make_shared<widget::Box>();
+    scene.root->SetWidth(AnimationScene::kSize);
+    scene.root->SetHeight(AnimationScene::kSize);
+    scene.root->SetBackgroundColor(SK_ColorWHITE);
+    scene.box = boost::make_shared<widget::Box>();
+    scene.box->SetWidth(50.0f);
+    scene.box->SetHeight(50.0f);
+    scene.box->SetBackgroundColor(SK_ColorRED);
+    scene.root->AddChild(scene.box);
+    scene.root->CalculateLayout(AnimationScene::kSize, AnimationScene::kSize);
+    return scene;
+}
+
+} // namespace test
+} // namespace KiUI
+
+#endif // TEST_RENDERING_HPP
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "AnimationEngine.hpp"
+#include "Box.hpp"
+#include "clock.hpp"
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+using test::Linear;
+
+} // namespace
+
+// 第一次 Tick 只记录起点；之后按 steady_clock 的时间差计算帧间隔
+TEST(AnimationTest, ClockMeasuresFrameInterval) {
+    CompositionClock clock;
+    const auto start = std::chrono::steady_clock::now();
+    clock.Tick(start);
+    EXPECT_FLOAT_EQ(clock.GetDeltaTime(), 0.0f);
+    clock.Tick(start + std::chrono::milliseconds(16));
+    EXPECT_FLOAT_EQ(clock.GetDeltaTime(), 16.0f);
+    clock.Tick(start + std::chrono::milliseconds(40));
+    EXPECT_FLOAT_EQ(clock.GetDeltaTime(), 24.0f);
+    EXPECT_FLOAT_EQ(clock.GetTotalTime(), 40.0f);
+}
+
+// 缓动曲线端点精确，对称曲线的中点为 0.5
+TEST(AnimationTest, EasingCurves) {
+    for (const Easing& easing : {Easing::Linear(), Easing::Ease(), Easing::EaseIn(), Easing::EaseOut(), Easing::EaseInOut()}) {
+        EXPECT_EQ(easing.Evaluate(0.0f), 0.0f);
+        EXPECT_EQ(easing.Evaluate(1.0f), 1.0f);
+    }
+    EXPECT_NEAR(Easing::Linear().Evaluate(0.3f), 0.3f, 1e-4f);
+    EXPECT_NEAR(Easing::EaseInOut().Evaluate(0.5f), 0.5f, 1e-4f);
+    EXPECT_LT(Easing::EaseIn().Evaluate(0.25f), 0.25f);
+    EXPECT_GT(Easing::EaseOut().Evaluate(0.25f), 0.25f);
+}
+
+// 透明度、颜色和变换只影响绘制，不会让布局失效；结束的动画在 Tick 后一次性报告
+TEST(AnimationTest, RenderPropertiesDoNotTriggerLayout) {
+    auto scene = test::CreateAnimationScene();
+    AnimationEngine engine;
+    const AnimationId opacity = engine.Animate(scene.box, AnimatedProperty::Opacity, 0.0f, Linear(100.0f));
+    engine.AnimateColor(scene.box, AnimatedProperty::BackgroundColor, SK_ColorBLACK, SK_ColorWHITE, Linear(100.0f));
+    engine.Animate(scene.box, AnimatedProperty::TranslateX, 40.0f, Linear(100.0f));
+    engine.Animate(scene.box, AnimatedProperty::Rotation, 90.0f, Linear(100.0f));
+    ASSERT_FALSE(scene.root->IsLayoutDirty());
+
+    engine.Tick(50.0f);
+    EXPECT_FALSE(scene.root->IsLayoutDirty());
+    EXPECT_EQ(engine.GetStats().layoutWrites, 0u);
+    EXPECT_NEAR(scene.box->GetOpacity(), 0.5f, 1e-3f);
+    EXPECT_EQ(scene.box->GetBackgroundColor(), SkColorSetARGB(255, 128, 128, 128));
+    EXPECT_NEAR(scene.box->GetTranslateX(), 20.0f, 1e-2f);
+    EXPECT_NEAR(scene.box->GetRotation(), 45.0f, 1e-2f);
+    EXPECT_FALSE(scene.box->GetTransform().isIdentity());
+
+    engine.Tick(60.0f);
+    EXPECT_EQ(engine.GetActiveCount(), 0u);
+    EXPECT_EQ(engine.GetFinished().size(), 4u);
+    EXPECT_NE(std::find(engine.GetFinished().begin(), engine.GetFinished().end(), opacity), engine.GetFinished().end());
+    EXPECT_FLOAT_EQ(scene.box->GetOpacity(), 0.0f);
+    EXPECT_EQ(scene.box->GetBackgroundColor(), SK_ColorWHITE);
+    EXPECT_FLOAT_EQ(scene.box->GetTranslateX(), 40.0f);
+    EXPECT_FALSE(scene.root->IsLayoutDirty());
+}
+
+// 尺寸动画会让布局失效
+TEST(AnimationTest, SizeAnimationInvalidatesLayout) {
+    auto scene = test::CreateAnimationScene();
+    AnimationEngine engine;
+    engine.Animate(scene.box, AnimatedProperty::Width, 150.0f, Linear(100.0f));
+    engine.Tick(50.0f);
+    EXPECT_FLOAT_EQ(scene.box->GetWidth(), 100.0f);
+    EXPECT_EQ(engine.GetStats().layoutWrites, 1u);
+    EXPECT_TRUE(scene.root->IsLayoutDirty());
+}
+
+// 变换分量绕组件中心缩放和旋转：之后尺寸变化（直接设置或由父组件排列）时中心跟着移动，
+// 直接设置的矩阵不再随尺寸重建
+TEST(AnimationTest, RenderTransformPivotFollowsSize) {
+    auto scene = test::CreateAnimationScene();
+    auto expectFixedPoint = [&](float x, float y) {
+        const SkPoint mapped = scene.box->GetTransform().mapXY(x, y);
+        EXPECT_NEAR(mapped.x(), x, 1e-3f);
+        EXPECT_NEAR(mapped.y(), y, 1e-3f);
+    };
+    scene.box->SetRenderTransform(0.0f, 0.0f, 2.0f, 2.0f, 90.0f);
+    expectFixedPoint(25.0f, 25.0f);
+
+    scene.box->SetWidth(100.0f);
+    scene.root->CalculateLayout(200.0f, 200.0f);
+    ASSERT_FLOAT_EQ(scene.box->GetWidth(), 100.0f);
+    expectFixedPoint(50.0f, 25.0f);
+
+    scene.box->Arrange(scene.box->GetLeft(), scene.box->GetTop(), 80.0f, 60.0f);
+    expectFixedPoint(40.0f, 30.0f);
+    EXPECT_FLOAT_EQ(scene.box->GetRotation(), 90.0f);
+
+    const SkMatrix matrix = SkMatrix::Translate(5.0f, 5.0f);
+    scene.box->SetTransform(matrix);
+    scene.box->Arrange(scene.box->GetLeft(), scene.box->GetTop(), 40.0f, 40.0f);
+    EXPECT_EQ(scene.box->GetTransform(), matrix);
+}
+
+// 延迟、往返、无限循环；新动画从当前值开始替换同一属性上的旧动画
+TEST(AnimationTest, DelayRepeatAndReplace) {
+    auto scene = test::CreateAnimationScene();
+    AnimationEngine engine;
+    AnimationOptions options = Linear(100.0f);
+    options.delay = 50.0f;
+    options.repeatCount = 0;
+    options.autoReverse = true;
+    const AnimationId spin = engine.Animate(scene.box, AnimatedProperty::ScaleX, 1.0f, 2.0f, options);
+
+    engine.Tick(25.0f);
+    EXPECT_FLOAT_EQ(scene.box->GetScaleX(), 1.0f);
+    EXPECT_EQ(engine.GetStats().propertyWrites, 0u);
+    engine.Tick(100.0f);   // 第一次播放的 75%
+    EXPECT_NEAR(scene.box->GetScaleX(), 1.75f, 1e-3f);
+    engine.Tick(50.0f);    // 反向播放的 25%
+    EXPECT_NEAR(scene.box->GetScaleX(), 1.75f, 1e-3f);
+    for (int i = 0; i < 1000; ++i) {
+        engine.Tick(16.0f);
+    }
+    EXPECT_TRUE(engine.IsActive(spin));
+    EXPECT_GE(scene.box->GetScaleX(), 1.0f);
+    EXPECT_LE(scene.box->GetScaleX(), 2.0f);
+
+    const float current = scene.box->GetScaleX();
+    const AnimationId replacement = engine.Animate(scene.box, AnimatedProperty::ScaleX, 3.0f, Linear(100.0f));
+    EXPECT_FALSE(engine.IsActive(spin));
+    EXPECT_EQ(engine.GetActiveCount(), 1u);
+    engine.Tick(50.0f);
+    EXPECT_NEAR(scene.box->GetScaleX(), (current + 3.0f) * 0.5f, 1e-3f);
+
+    EXPECT_TRUE(engine.Cancel(replacement));
+    EXPECT_FALSE(engine.Cancel(replacement));
+}
+
+// 数百个同时运行的动画一次 Tick 批量计算；目标销毁的动画自动结束
+TEST(AnimationTest, ManyConcurrentAnimations) {
+    constexpr int kCount = 500;
+    auto root = boost::make_shared<Box>();
+    std::vector<boost::shared_ptr<Box>> boxes;
+    AnimationEngine engine;
+    for (int i = 0; i < kCount; ++i) {
+        auto box = boost::make_shared<Box>();
+        root->AddChild(box);
+        boxes.push_back(box);
+        AnimationOptions options = Linear(100.0f + i);
+        engine.Animate(box, AnimatedProperty::Opacity, 0.0f, options);
+        engine.Animate(box, AnimatedProperty::TranslateY, 100.0f, options);
+    }
+    EXPECT_EQ(engine.GetActiveCount(), 2u * kCount);
+
+    engine.Tick(50.0f);
+    EXPECT_EQ(engine.GetStats().evaluated, 2u * kCount);
+    for (int i = 0; i < kCount; ++i) {
+        const float expected = 50.0f / (100.0f + i);
+        ASSERT_NEAR(boxes[i]->GetOpacity(), 1.0f - expected, 1e-3f) << i;
+        ASSERT_NEAR(boxes[i]->GetTranslateY(), 100.0f * expected, 1e-2f) << i;
+    }
+
+    root->RemoveChild(boxes[0]);
+    boxes[0].reset();
+    engine.Tick(10.0f);
+    EXPECT_EQ(engine.GetFinished().size(), 2u);
+    EXPECT_EQ(engine.GetActiveCount(), 2u * (kCount - 1));
+
+    engine.Tick(1000.0f);
+    EXPECT_EQ(engine.GetActiveCount(), 0u);
+    EXPECT_FLOAT_EQ(boxes[kCount - 1]->GetOpacity(), 0.0f);
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include "Box.hpp"
+#include <boost/make_shared.hpp>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+std::vector<boost::shared_ptr<UIElement>> MakeBoxes(size_t count) {
+    std::vector<boost::shared_ptr<UIElement>> boxes;
+    for (size_t i = 0; i < count; ++i) {
+        auto box = boost::make_shared<Box>();
+        box->SetWidth(10.0f);
+        box->SetHeight(10.0f);
+        boxes.push_back(box);
+    }
+    return boxes;
+}
+
+// 校验每个子元素的索引与其在父元素中的位置一致
+void ExpectIndicesConsistent(const boost::shared_ptr<UIElement>& parent) {
+    const auto& children = parent->GetChildren();
+    for (size_t i = 0; i < children.size(); ++i) {
+        EXPECT_EQ(children[i]->GetIndexInParent(), i);
+        EXPECT_EQ(children[i]->GetParent(), parent);
+    }
+}
+
+// 校验 Yoga 子节点的顺序与子元素列表一致
+void ExpectYogaOrderMatches(const boost::shared_ptr<Box>& parent) {
+    const auto& children = parent->GetChildren();
+    YGNodeRef node = parent->GetYogaNode();
+    ASSERT_EQ(YGNodeGetChildCount(node), children.size());
+    for (size_t i = 0; i < children.size(); ++i) {
+        EXPECT_EQ(YGNodeGetChild(node, i), children[i]->AsVisualElement()->GetYogaNode());
+    }
+}
+
+} // namespace
+
+// 追加子元素时记录索引
+TEST(ChildrenTest, AddChildRecordsIndex) {
+    auto parent = boost::make_shared<Box>();
+    auto boxes = MakeBoxes(3);
+    for (auto& box : boxes) {
+        parent->AddChild(box);
+    }
+    ASSERT_EQ(parent->GetChildrenCount(), 3u);
+    ExpectIndicesConsistent(parent);
+}
+
+// 在指定位置插入子元素
+TEST(ChildrenTest, InsertChildAt) {
+    auto parent = boost::make_shared<Box>();
+    auto boxes = MakeBoxes(3);
+    parent->AddChild(boxes[0]);
+    parent->AddChild(boxes[1]);
+    parent->InsertChildAt(1, boxes[2]);
+    
+    ASSERT_EQ(parent->GetChildrenCount(), 3u);
+    EXPECT_EQ(parent->GetChildren()[1], boxes[2]);
+    EXPECT_EQ(parent->GetChildren()[2], boxes[1]);
+    ExpectIndicesConsistent(parent);
+    ExpectYogaOrderMatches(parent);
+}
+
+// 移除子元素后清除父引用和索引
+TEST(ChildrenTest, RemoveChildClearsIndex) {
+    auto parent = boost::make_shared<Box>();
+    auto boxes = MakeBoxes(4);
+    parent->InsertChildrenAt(0, boxes);
+    
+    parent->RemoveChild(boxes[1]);
+    EXPECT_EQ(boxes[1]->GetParent(), nullptr);
+    EXPECT_EQ(boxes[1]->GetIndexInParent(), UIElement::npos);
+    
+    parent->RemoveChildAt(0);
+    ASSERT_EQ(parent->GetChildrenCount(), 2u);
+    EXPECT_EQ(parent->GetChildren()[0], boxes[2]);
+    ExpectIndicesConsistent(parent);
+}
+
+// 移除不属于自己的子元素不产生任何影响
+TEST(ChildrenTest, RemoveForeignChildIsIgnored) {
+    auto parent = boost::make_shared<Box>();
+    auto other = boost::make_shared<Box>();
+    auto boxes = MakeBoxes(2);
+    parent->AddChild(boxes[0]);
+    other->AddChild(boxes[1]);
+    
+    parent->RemoveChild(boxes[1]);
+    EXPECT_EQ(boxes[1]->GetParent(), other);
+    EXPECT_EQ(parent->GetChildrenCount(), 1u);
+}
+
+// 前移和后移子元素
+TEST(ChildrenTest, MoveChild) {
+    auto parent = boost::make_shared<Box>();
+    auto boxes = MakeBoxes(5);
+    parent->InsertChildrenAt(0, boxes);
+    
+    parent->MoveChild(0, 3);
+    EXPECT_EQ(parent->GetChildren()[3], boxes[0]);
+    EXPECT_EQ(parent->GetChildren()[0], boxes[1]);
+    ExpectIndicesConsistent(parent);
+    
+    ExpectYogaOrderMatches(parent);
+    
+    parent->MoveChild(4, 0);
+    EXPECT_EQ(parent->GetChildren()[0], boxes[4]);
+    ExpectIndicesConsistent(parent);
+    ExpectYogaOrderMatches(parent);
+}
+
+// 批量插入和批量移除
+TEST(ChildrenTest, RangeInsertAndRemove) {
+    auto parent = boost::make_shared<Box>();
+    auto first = MakeBoxes(2);
+    auto middle = MakeBoxes(3);
+    parent->InsertChildrenAt(0, first);
+    parent->InsertChildrenAt(1, middle);
+    
+    ASSERT_EQ(parent->GetChildrenCount(), 5u);
+    EXPECT_EQ(parent->GetChildren()[1], middle[0]);
+    EXPECT_EQ(parent->GetChildren()[4], first[1]);
+    ExpectIndicesConsistent(parent);
+    ExpectYogaOrderMatches(parent);
+    
+    parent->RemoveChildren(1, 3);
+    ASSERT_EQ(parent->GetChildrenCount(), 2u);
+    EXPECT_EQ(parent->GetChildren()[1], first[1]);
+    for (auto& box : middle) {
+        EXPECT_EQ(box->GetParent(), nullptr);
+    }
+    ExpectIndicesConsistent(parent);
+    ExpectYogaOrderMatches(parent);
+}
+
+// 替换全部子元素，保留的子元素继续挂在父元素下
+TEST(ChildrenTest, ReplaceChildren) {
+    auto parent = boost::make_shared<Box>();
+    auto boxes = MakeBoxes(4);
+    parent->InsertChildrenAt(0, {boxes[0], boxes[1]});
+    
+    parent->ReplaceChildren({boxes[3], boxes[1], boxes[2]});
+    ASSERT_EQ(parent->GetChildrenCount(), 3u);
+    EXPECT_EQ(parent->GetChildren()[0], boxes[3]);
+    EXPECT_EQ(parent->GetChildren()[1], boxes[1]);
+    EXPECT_EQ(boxes[0]->GetParent(), nullptr);
+    EXPECT_EQ(YGNodeGetOwner(boxes[0]->AsVisualElement()->GetYogaNode()), nullptr);
+    ExpectIndicesConsistent(parent);
+    ExpectYogaOrderMatches(parent);
+}
+
+// 替换时从另一个父元素批量摘下子元素，旧父元素的索引和 Yoga 子节点保持一致
+TEST(ChildrenTest, ReplaceChildrenTakesFromOtherParent) {
+    auto parent = boost::make_shared<Box>();
+    auto other = boost::make_shared<Box>();
+    auto own = MakeBoxes(2);
+    auto foreign = MakeBoxes(5);
+    parent->InsertChildrenAt(0, own);
+    other->InsertChildrenAt(0, foreign);
+    
+    parent->ReplaceChildren({foreign[3], own[1], foreign[0], foreign[3], foreign[2]});
+    ASSERT_EQ(parent->GetChildrenCount(), 4u);
+    EXPECT_EQ(parent->GetChildren()[0], foreign[3]);
+    EXPECT_EQ(parent->GetChildren()[1], own[1]);
+    EXPECT_EQ(parent->GetChildren()[2], foreign[0]);
+    EXPECT_EQ(parent->GetChildren()[3], foreign[2]);
+    EXPECT_EQ(own[0]->GetParent(), nullptr);
+    ExpectIndicesConsistent(parent);
+    ExpectYogaOrderMatches(parent);
+    
+    ASSERT_EQ(other->GetChildrenCount(), 2u);
+    EXPECT_EQ(other->GetChildren()[0], foreign[1]);
+    EXPECT_EQ(other->GetChildren()[1], foreign[4]);
+    ExpectIndicesConsistent(other);
+    ExpectYogaOrderMatches(other);
+}
+
+// 添加到新父元素时从旧父元素中移除
+TEST(ChildrenTest, ReparentChild) {
+    auto parent1 = boost::make_shared<Box>();
+    auto parent2 = boost::make_shared<Box>();
+    auto boxes = MakeBoxes(3);
+    parent1->InsertChildrenAt(0, boxes);
+    
+    parent2->AddChild(boxes[0]);
+    EXPECT_EQ(parent1->GetChildrenCount(), 2u);
+    EXPECT_EQ(parent2->GetChildrenCount(), 1u);
+    ExpectIndicesConsistent(parent1);
+    ExpectIndicesConsistent(parent2);
+    ExpectYogaOrderMatches(parent1);
+    ExpectYogaOrderMatches(parent2);
+}
+
+// 批量插入时从多个旧父元素和自身摘下子元素，每个旧父元素只压缩一次
+TEST(ChildrenTest, InsertChildrenAtDetachesFromSeveralParents) {
+    auto parent = boost::make_shared<Box>();
+    auto other = boost::make_shared<Box>();
+    auto own = MakeBoxes(4);
+    auto foreign = MakeBoxes(4);
+    parent->InsertChildrenAt(0, own);
+    other->InsertChildrenAt(0, foreign);
+    
+    // 自身插入点之前的 own[0] 被摘下后插入点前移；重复的 foreign[3] 只插入一次
+    parent->InsertChildrenAt(2, {foreign[1], own[0], foreign[3], foreign[3], own[3]});
+    ASSERT_EQ(parent->GetChildrenCount(), 6u);
+    EXPECT_EQ(parent->GetChildren()[0], own[1]);
+    EXPECT_EQ(parent->GetChildren()[1], foreign[1]);
+    EXPECT_EQ(parent->GetChildren()[2], own[0]);
+    EXPECT_EQ(parent->GetChildren()[3], foreign[3]);
+    EXPECT_EQ(parent->GetChildren()[4], own[3]);
+    EXPECT_EQ(parent->GetChildren()[5], own[2]);
+    ExpectIndicesConsistent(parent);
+    ExpectYogaOrderMatches(parent);
+    
+    ASSERT_EQ(other->GetChildrenCount(), 2u);
+    EXPECT_EQ(other->GetChildren()[0], foreign[0]);
+    EXPECT_EQ(other->GetChildren()[1], foreign[2]);
+    ExpectIndicesConsistent(other);
+    ExpectYogaOrderMatches(other);
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Box.hpp"
+#include "CompositorAnimator.hpp"
+#include "SceneRenderer.hpp"
+#include <include/core/SkSurface.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+using test::AnimationScene;
+using test::Linear;
+using test::PixelAt;
+
+constexpr int kSceneSize = AnimationScene::kSize;
+
+} // namespace
+
+// 动画在第一次采样时开始，按采样的绝对时间计算；值只写进图层属性，不写回组件
+TEST(CompositorAnimationTest, SampleAdvancesFromFirstSample) {
+    auto scene = test::CreateAnimationScene();
+    const uint64_t version = scene.root->GetSubtreeVersion();
+    CompositorAnimator animator;
+    EXPECT_EQ(animator.Animate(scene.box, AnimatedProperty::Width, 100.0f), 0u);
+    EXPECT_EQ(animator.Animate(scene.box, AnimatedProperty::BackgroundColor, 1.0f), 0u);
+    const AnimationId slide = animator.Animate(scene.box, AnimatedProperty::TranslateX, 0.0f, 100.0f, Linear(100.0f));
+    ASSERT_NE(slide, 0u);
+
+    const auto start = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    EXPECT_TRUE(animator.Sample(start));
+    LayerProperties properties;
+    ASSERT_TRUE(animator.GetLayerProperties(scene.box.get(), &properties));
+    EXPECT_FLOAT_EQ(properties.translateX, 0.0f);
+
+    EXPECT_TRUE(animator.Sample(start + std::chrono::milliseconds(50)));
+    ASSERT_TRUE(animator.GetLayerProperties(scene.box.get(), &properties));
+    EXPECT_NEAR(properties.translateX, 50.0f, 1e-3f);
+    EXPECT_FLOAT_EQ(properties.opacity, 1.0f);
+
+    // 结束后图层保持终点的值
+    EXPECT_FALSE(animator.Sample(start + std::chrono::milliseconds(150)));
+    ASSERT_TRUE(animator.GetLayerProperties(scene.box.get(), &properties));
+    EXPECT_FLOAT_EQ(properties.translateX, 100.0f);
+    EXPECT_FALSE(animator.IsActive(slide));
+    const auto finished = animator.TakeFinished();
+    EXPECT_NE(std::find(finished.begin(), finished.end(), slide), finished.end());
+
+    EXPECT_FLOAT_EQ(scene.box->GetTranslateX(), 0.0f);
+    EXPECT_EQ(scene.root->GetSubtreeVersion(), version);
+
+    animator.RemoveLayer(scene.box.get());
+    EXPECT_FALSE(animator.GetLayerProperties(scene.box.get(), &properties));
+}
+
+// 动画期间合成层只录制、光栅化一次，每帧只重新合成
+TEST(CompositorAnimationTest, LayerIsReusedWhileAnimating) {
+    auto scene = test::CreateAnimationScene();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    CompositorAnimator& animator = renderer.GetCompositorAnimator();
+    animator.Animate(scene.box, AnimatedProperty::TranslateX, 0.0f, 100.0f, Linear(100.0f));
+    const auto start = std::chrono::steady_clock::now();
+
+    animator.Sample(start);
+    auto surface = test::MakeRasterSurface(kSceneSize, kSceneSize);
+    renderer.Render(surface->getCanvas());
+    EXPECT_EQ(renderer.GetCompositorLayerRecords(), 1u);
+    EXPECT_EQ(renderer.GetCompositorLayerRasterizations(), 1u);
+    EXPECT_EQ(PixelAt(surface, 25, 25), SK_ColorRED);
+    const uint64_t version = scene.root->GetSubtreeVersion();
+
+    animator.Sample(start + std::chrono::milliseconds(50));
+    surface = test::MakeRasterSurface(kSceneSize, kSceneSize);
+    renderer.Render(surface->getCanvas());
+    EXPECT_EQ(renderer.GetCompositorLayerRecords(), 0u);
+    EXPECT_EQ(renderer.GetCompositorLayerRasterizations(), 1u);
+    EXPECT_EQ(renderer.GetCompositorLayerComposites(), 2u);
+    EXPECT_EQ(PixelAt(surface, 25, 25), SK_ColorWHITE);
+    EXPECT_EQ(PixelAt(surface, 75, 25), SK_ColorRED);
+    EXPECT_EQ(scene.root->GetSubtreeVersion(), version);
+
+    // 内容变化时重新录制
+    scene.box->SetBackgroundColor(SK_ColorBLUE);
+    surface = test::MakeRasterSurface(kSceneSize, kSceneSize);
+    renderer.Render(surface->getCanvas());
+    EXPECT_EQ(renderer.GetCompositorLayerRecords(), 1u);
+    EXPECT_EQ(renderer.GetCompositorLayerRasterizations(), 2u);
+    EXPECT_EQ(PixelAt(surface, 75, 25), SK_ColorBLUE);
+}
+
+// 透明度动画作用于整个图层
+TEST(CompositorAnimationTest, OpacityFadesLayer) {
+    auto scene = test::CreateAnimationScene();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    CompositorAnimator& animator = renderer.GetCompositorAnimator();
+    animator.Animate(scene.box, AnimatedProperty::Opacity, 0.0f, Linear(100.0f));
+    const auto start = std::chrono::steady_clock::now();
+
+    animator.Sample(start);
+    animator.Sample(start + std::chrono::milliseconds(100));
+    auto surface = test::MakeRasterSurface(kSceneSize, kSceneSize);
+    renderer.Render(surface->getCanvas());
+    EXPECT_EQ(PixelAt(surface, 25, 25), SK_ColorWHITE);
+    EXPECT_FLOAT_EQ(scene.box->GetOpacity(), 1.0f);
+}
+
+// UI 线程录制一帧后不再参与：另一个线程随时间推进反复合成同一帧
+TEST(CompositorAnimationTest, RecordedFrameAnimatesOnAnotherThread) {
+    auto scene = test::CreateAnimationScene();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    CompositorAnimator& animator = renderer.GetCompositorAnimator();
+    AnimationOptions spin = Linear(100.0f);
+    spin.repeatCount = 0;
+    const AnimationId slide = animator.Animate(scene.box, AnimatedProperty::TranslateX, 0.0f, 100.0f, spin);
+
+    sk_sp<SkDrawable> frame = renderer.RecordFrame(kSceneSize, kSceneSize);
+    ASSERT_TRUE(frame);
+    const uint64_t version = scene.root->GetSubtreeVersion();
+
+    sk_sp<SkSurface> first;
+    sk_sp<SkSurface> second;
+    std::thread compositor([&]() {
+        const auto start = std::chrono::steady_clock::now();
+        animator.Sample(start);
+        first = test::MakeRasterSurface(kSceneSize, kSceneSize);
+        frame->draw(first->getCanvas());
+        animator.Sample(start + std::chrono::milliseconds(75));
+        second = test::MakeRasterSurface(kSceneSize, kSceneSize);
+        frame->draw(second->getCanvas());
+        frame.reset();
+    });
+    compositor.join();
+
+    EXPECT_EQ(PixelAt(first, 25, 25), SK_ColorRED);
+    EXPECT_EQ(PixelAt(second, 25, 25), SK_ColorWHITE);
+    EXPECT_EQ(PixelAt(second, 100, 25), SK_ColorRED);
+    EXPECT_EQ(renderer.GetCompositorLayerRasterizations(), 1u);
+    EXPECT_EQ(renderer.GetCompositorLayerComposites(), 2u);
+    EXPECT_TRUE(animator.IsActive(slide));
+    EXPECT_EQ(scene.root->GetSubtreeVersion(), version);
+    EXPECT_FLOAT_EQ(scene.box->GetTranslateX(), 0.0f);
+}
+
+} // namespace widget
+} // namespace KiUI
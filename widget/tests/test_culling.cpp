@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Box.hpp"
+#include "SceneRenderer.hpp"
+#include <include/core/SkSurface.h>
+#include <boost/make_shared.hpp>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+// 200x200 的视口中放一列 100 行、每行 20 像素高的长表单
+boost::shared_ptr<Box> CreateLongForm() {
+    auto root = test::MakePlacedBox(0.0f, 0.0f, 200.0f, 2000.0f);
+    for (int i = 0; i < 100; ++i) {
+        root->AddChild(test::MakePlacedBox(0.0f, 20.0f * i, 200.0f, 20.0f));
+    }
+    return root;
+}
+
+} // namespace
+
+// 子树包围盒包含超出父元素的子元素，并在子孙几何变化后重新计算
+TEST(CullingTest, SubtreeBoundsFollowDescendants) {
+    auto root = test::MakePlacedBox(0.0f, 0.0f, 100.0f, 100.0f);
+    auto child = test::MakePlacedBox(10.0f, 10.0f, 50.0f, 50.0f);
+    auto grandChild = test::MakePlacedBox(20.0f, 20.0f, 10.0f, 10.0f);
+    root->AddChild(child);
+    child->AddChild(grandChild);
+    
+    EXPECT_EQ(root->GetSubtreeBounds(), SkRect::MakeWH(100.0f, 100.0f));
+    EXPECT_FALSE(root->HasOverflowingChildren());
+    
+    grandChild->SetLeft(150.0f);
+    EXPECT_EQ(root->GetSubtreeBounds(), SkRect::MakeLTRB(0.0f, 0.0f, 180.0f, 100.0f));
+    EXPECT_TRUE(root->HasOverflowingChildren());
+    
+    // 隐藏的子孙不参与包围盒计算，重新显示后恢复
+    grandChild->SetVisibility(false);
+    EXPECT_EQ(root->GetSubtreeBounds(), SkRect::MakeWH(100.0f, 100.0f));
+    grandChild->SetVisibility(true);
+    EXPECT_EQ(root->GetSubtreeBounds(), SkRect::MakeLTRB(0.0f, 0.0f, 180.0f, 100.0f));
+    
+    // 裁剪到自身范围后，超出部分不再计入包围盒
+    child->SetClipToBounds(true);
+    EXPECT_EQ(root->GetSubtreeBounds(), SkRect::MakeWH(100.0f, 100.0f));
+    EXPECT_TRUE(child->HasOverflowingChildren());
+}
+
+// 视口之外的行不被遍历和绘制（批处理与立即绘制两条路径）
+TEST(CullingTest, SkipsRowsOutsideViewport) {
+    SceneRenderer renderer;
+    renderer.SetRoot(CreateLongForm());
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(200, 200));
+    
+    renderer.Render(surface->getCanvas());
+    EXPECT_GE(renderer.GetCulledCount(), 89u);
+    EXPECT_LE(renderer.GetBatchStats().commands, 12u);
+    
+    renderer.SetBatchingEnabled(false);
+    renderer.Render(surface->getCanvas());
+    EXPECT_GE(renderer.GetCulledCount(), 89u);
+}
+
+// 父元素裁剪区域之外的子元素同样被剔除
+TEST(CullingTest, SkipsChildrenOutsideClippedParent) {
+    auto root = test::MakePlacedBox(0.0f, 0.0f, 200.0f, 200.0f);
+    auto scrollArea = test::MakePlacedBox(0.0f, 0.0f, 200.0f, 50.0f);
+    scrollArea->SetClipToBounds(true);
+    root->AddChild(scrollArea);
+    for (int i = 0; i < 10; ++i) {
+        scrollArea->AddChild(test::MakePlacedBox(0.0f, 25.0f * i, 200.0f, 25.0f));
+    }
+    
+    SceneRenderer renderer;
+    renderer.SetRoot(root);
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(200, 200));
+    renderer.Render(surface->getCanvas());
+    
+    // 只有前两行（以及与裁剪边缘相接的第三行）在滚动区域内可见
+    EXPECT_GE(renderer.GetCulledCount(), 7u);
+}
+
+} // namespace widget
+} // namespace KiUI
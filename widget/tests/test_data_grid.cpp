@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Box.hpp"
+#include "DataGrid.hpp"
+#include "SceneRenderer.hpp"
+#include <include/core/SkSurface.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <boost/make_shared.hpp>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+constexpr size_t kRows = 100000;
+constexpr size_t kColumns = 200;
+constexpr float kGridWidth = 800.0f;
+constexpr float kGridHeight = 600.0f;
+constexpr int kGridPixelWidth = static_cast<int>(kGridWidth);
+constexpr int kGridPixelHeight = static_cast<int>(kGridHeight);
+
+// 记录模板和绑定的单元格，检查回收后的单元格是否按模板复用
+class TestCell : public Box {
+public:
+    explicit TestCell(int templateId) : templateId(templateId) {}
+
+    int templateId;
+    size_t row = 0;
+    size_t column = 0;
+};
+
+SkColor CellColor(size_t row, size_t column) {
+    return SkColorSetRGB(static_cast<U8CPU>(row * 7), static_cast<U8CPU>(column * 13), 200);
+}
+
+// 200 列 x 10 万行，冻结一行表头和一列行标题
+boost::shared_ptr<DataGrid> CreateGrid() {
+    auto grid = boost::make_shared<DataGrid>();
+    grid->SetWidth(kGridWidth);
+    grid->SetHeight(kGridHeight);
+    grid->SetBackgroundColor(SK_ColorWHITE);
+    grid->SetFrozenRowCount(1);
+    grid->SetFrozenColumnCount(1);
+    grid->SetCellFactory([](int templateId) { return boost::make_shared<TestCell>(templateId); });
+    grid->SetCellBinder([](size_t row, size_t column, VisualElement& cell) {
+        auto& testCell = static_cast<TestCell&>(cell);
+        testCell.row = row;
+        testCell.column = column;
+        testCell.SetBackgroundColor(CellColor(row, column));
+    });
+    grid->SetRowCount(kRows);
+    grid->SetColumnCount(kColumns);
+    grid->CalculateLayout(kGridWidth, kGridHeight);
+    return grid;
+}
+
+size_t MaxRealizedCells() {
+    const size_t rows = static_cast<size_t>(kGridHeight / DataGrid::kDefaultRowHeight) + 2 + 2 * DataGrid::kDefaultRowOverscan;
+    const size_t columns = static_cast<size_t>(kGridWidth / DataGrid::kDefaultColumnWidth) + 2 + 2 * DataGrid::kDefaultColumnOverscan;
+    return rows * columns;
+}
+
+} // namespace
+
+// 两千万个单元格时只创建与视口相交的单元格，冻结的行列不随滚动移动
+TEST(DataGridTest, RealizesOnlyVisibleCells) {
+    auto grid = CreateGrid();
+    EXPECT_LE(grid->GetStats().realizedCells, MaxRealizedCells());
+
+    grid->SetScrollOffset(100 * DataGrid::kDefaultColumnWidth + 30.0, 50000 * DataGrid::kDefaultRowHeight + 5.0);
+    EXPECT_LE(grid->GetStats().realizedCells, MaxRealizedCells());
+    auto cell = grid->GetRealizedCell(50001, 101);
+    ASSERT_NE(cell, nullptr);
+    EXPECT_EQ(static_cast<TestCell&>(*cell).row, 50001u);
+    EXPECT_EQ(static_cast<TestCell&>(*cell).column, 101u);
+    EXPECT_FLOAT_EQ(cell->GetWidth(), DataGrid::kDefaultColumnWidth);
+    EXPECT_FLOAT_EQ(cell->GetHeight(), DataGrid::kDefaultRowHeight);
+    // 表头和行标题仍然显示
+    EXPECT_NE(grid->GetRealizedCell(0, 101), nullptr);
+    EXPECT_NE(grid->GetRealizedCell(50001, 0), nullptr);
+    EXPECT_NE(grid->GetRealizedCell(0, 0), nullptr);
+    EXPECT_EQ(grid->GetRealizedCell(1, 1), nullptr);
+
+    // 命中测试经过分区的滚动偏移找到单元格
+    size_t row = 0;
+    size_t column = 0;
+    ASSERT_TRUE(grid->GetCellIndex(grid->HitTest(150.0f, 30.0f), &row, &column));
+    EXPECT_EQ(row, 50001u);
+    EXPECT_EQ(column, 101u);
+    ASSERT_TRUE(grid->GetCellIndex(grid->HitTest(150.0f, 10.0f), &row, &column));
+    EXPECT_EQ(row, 0u);
+    EXPECT_EQ(column, 101u);
+    ASSERT_TRUE(grid->GetCellIndex(grid->HitTest(50.0f, 30.0f), &row, &column));
+    EXPECT_EQ(row, 50001u);
+    EXPECT_EQ(column, 0u);
+
+    // 滚动位置限制在内容范围内
+    grid->SetScrollOffset(1e12, 1e12);
+    EXPECT_DOUBLE_EQ(grid->GetScrollY(), grid->GetMaxScrollY());
+    EXPECT_NE(grid->GetRealizedCell(kRows - 1, kColumns - 1), nullptr);
+}
+
+// 滚动没有改变显示范围时不修改任何单元格；滚出视口的单元格按模板回收复用
+TEST(DataGridTest, ScrollingRecyclesCellsPerTemplate) {
+    auto grid = CreateGrid();
+    grid->SetScrollOffset(0.0, 1000.0);
+    const auto before = grid->GetStats();
+    grid->SetScrollOffset(3.0, 1003.0);
+    EXPECT_EQ(grid->GetStats().cellsBound, before.cellsBound);
+    EXPECT_EQ(grid->GetStats().cellsArranged, before.cellsArranged);
+
+    grid->SetTemplateSelector([](size_t row, size_t) { return static_cast<int>(row % 2); });
+    const uint64_t created = grid->GetStats().cellsCreated;
+    for (int page = 1; page <= 50; ++page) {
+        grid->SetScrollOffset(page * 37.0, page * kGridHeight);
+        const size_t row = static_cast<size_t>(page * kGridHeight / DataGrid::kDefaultRowHeight) + 2;
+        const size_t column = static_cast<size_t>(page * 37.0 / DataGrid::kDefaultColumnWidth) + 2;
+        auto cell = grid->GetRealizedCell(row, column);
+        ASSERT_NE(cell, nullptr);
+        EXPECT_EQ(static_cast<TestCell&>(*cell).templateId, static_cast<int>(row % 2));
+        EXPECT_EQ(static_cast<TestCell&>(*cell).row, row);
+        EXPECT_EQ(static_cast<TestCell&>(*cell).column, column);
+    }
+    // 每个模板最多比首屏多出一屏的单元格
+    EXPECT_LE(grid->GetStats().cellsCreated, created + 2 * MaxRealizedCells());
+}
+
+// 修改单个单元格时滚动图层只重新绘制该单元格
+TEST(DataGridTest, CellUpdateRepaintsOnlyThatCell) {
+    auto grid = CreateGrid();
+    const size_t row = 110;
+    const size_t column = 5;
+    SkColor highlight = CellColor(row, column);
+    grid->SetCellBinder([&highlight, row, column](size_t r, size_t c, VisualElement& cell) {
+        cell.SetBackgroundColor(r == row && c == column ? highlight : CellColor(r, c));
+    });
+    grid->SetScrollOffset(250.0, 2400.0);
+    SceneRenderer renderer;
+    renderer.SetRoot(grid);
+    test::RenderScene(renderer, kGridPixelWidth, kGridPixelHeight);
+    test::RenderScene(renderer, kGridPixelWidth, kGridPixelHeight);
+    EXPECT_EQ(renderer.GetScrollLayerRasterizedPixels(), 0u);
+
+    highlight = SK_ColorBLACK;
+    grid->InvalidateCell(row, column);
+    auto image = test::RenderScene(renderer, kGridPixelWidth, kGridPixelHeight);
+    EXPECT_EQ(renderer.GetScrollLayerDamageUpdates(), 1u);
+    EXPECT_EQ(renderer.GetScrollLayerRenders(), 0u);
+    EXPECT_EQ(renderer.GetScrollLayerRasterizedPixels(),
+              static_cast<uint64_t>(DataGrid::kDefaultColumnWidth * DataGrid::kDefaultRowHeight));
+
+    // 与不使用缓存的渲染器逐像素比较
+    SceneRenderer fresh;
+    fresh.SetRoot(grid);
+    fresh.SetBatchingEnabled(false);
+    auto expected = test::RenderScene(fresh, kGridPixelWidth, kGridPixelHeight);
+    SkPixmap actualPixels;
+    SkPixmap expectedPixels;
+    ASSERT_TRUE(image->peekPixels(&actualPixels));
+    ASSERT_TRUE(expected->peekPixels(&expectedPixels));
+    for (int y = 0; y < actualPixels.height(); ++y) {
+        for (int x = 0; x < actualPixels.width(); ++x) {
+            ASSERT_EQ(actualPixels.getColor(x, y), expectedPixels.getColor(x, y)) << "at " << x << "," << y;
+        }
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
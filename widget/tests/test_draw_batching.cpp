@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Box.hpp"
+#include "SceneRenderer.hpp"
+#include <include/core/SkSurface.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <boost/make_shared.hpp>
+#include <cstring>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+constexpr int kViewportWidth = 200;
+constexpr int kViewportHeight = 240;
+
+// 一个典型的列表：交替颜色的行，其中一部分带边框和圆角
+boost::shared_ptr<Box> CreateListScene() {
+    auto root = boost::make_shared<Box>();
+    root->SetWidth(static_cast<float>(kViewportWidth));
+    root->SetHeight(static_cast<float>(kViewportHeight));
+    root->SetBackgroundColor(SK_ColorWHITE);
+    
+    for (int i = 0; i < 20; ++i) {
+        auto row = boost::make_shared<Box>();
+        row->SetWidth(180.0f);
+        row->SetHeight(12.0f);
+        row->SetBackgroundColor(i % 2 == 0 ? SK_ColorLTGRAY : SK_ColorCYAN);
+        if (i % 5 == 0) {
+            row->SetBorderColor(SK_ColorBLACK);
+            row->SetBorderWidth(BorderWidth::All, 1.0f);
+        }
+        if (i % 7 == 0) {
+            row->SetBorderRadius(BorderRadius::All, 3.0f);
+        }
+        root->AddChild(row);
+    }
+    return root;
+}
+
+} // namespace
+
+// 批处理绘制与逐个立即绘制的像素结果一致
+TEST(DrawBatchingTest, MatchesImmediateRendering) {
+    SceneRenderer renderer;
+    renderer.SetRoot(CreateListScene());
+    renderer.CalculateLayout(static_cast<float>(kViewportWidth), static_cast<float>(kViewportHeight));
+    
+    renderer.SetBatchingEnabled(false);
+    auto immediate = test::RenderScene(renderer, kViewportWidth, kViewportHeight);
+    renderer.SetBatchingEnabled(true);
+    auto batched = test::RenderScene(renderer, kViewportWidth, kViewportHeight);
+    
+    SkPixmap expected;
+    SkPixmap actual;
+    ASSERT_TRUE(immediate->peekPixels(&expected));
+    ASSERT_TRUE(batched->peekPixels(&actual));
+    for (int y = 0; y < kViewportHeight; ++y) {
+        const auto* expectedRow = static_cast<const uint8_t*>(expected.addr()) + y * expected.rowBytes();
+        const auto* actualRow = static_cast<const uint8_t*>(actual.addr()) + y * actual.rowBytes();
+        ASSERT_EQ(std::memcmp(expectedRow, actualRow, kViewportWidth * 4), 0) << "row " << y;
+    }
+}
+
+// 同色且对齐像素的行被合并，绘制调用数明显少于命令数
+TEST(DrawBatchingTest, MergesAlignedSolidRects) {
+    SceneRenderer renderer;
+    renderer.SetRoot(CreateListScene());
+    renderer.CalculateLayout(static_cast<float>(kViewportWidth), static_cast<float>(kViewportHeight));
+    test::RenderScene(renderer, kViewportWidth, kViewportHeight);
+    
+    const auto& stats = renderer.GetBatchStats();
+    // 根节点 + 20 行填充 + 4 条边框
+    EXPECT_EQ(stats.commands, 25u);
+    EXPECT_GT(stats.mergedRects, 0u);
+    EXPECT_LT(stats.drawCalls, stats.commands);
+}
+
+// 独立使用命令缓冲区：重叠的不同颜色命令保持原有顺序，不参与重排
+TEST(DrawBatchingTest, KeepsPainterOrderForOverlaps) {
+    graphics::DrawCommandBuffer buffer;
+    buffer.AddRectangle(0.0f, 0.0f, 10.0f, 10.0f, SK_ColorRED);
+    buffer.AddRectangle(5.0f, 5.0f, 10.0f, 10.0f, SK_ColorBLUE);
+    buffer.AddRectangle(8.0f, 8.0f, 10.0f, 10.0f, SK_ColorRED);
+    buffer.AddRectangle(40.0f, 40.0f, 10.0f, 10.0f, SK_ColorBLUE);
+    
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(64, 64));
+    buffer.Flush(surface->getCanvas());
+    
+    // 第三个红色矩形与蓝色重叠，不能并入第一个批次；第四个蓝色矩形可以并入第二个批次
+    const auto& stats = buffer.GetLastFlushStats();
+    EXPECT_EQ(stats.commands, 4u);
+    EXPECT_EQ(stats.batches, 3u);
+    EXPECT_TRUE(buffer.IsEmpty());
+    
+    SkPixmap pixels;
+    auto image = surface->makeImageSnapshot();
+    ASSERT_TRUE(image->peekPixels(&pixels));
+    EXPECT_EQ(pixels.getColor(9, 9), SK_ColorRED);
+    EXPECT_EQ(pixels.getColor(6, 6), SK_ColorBLUE);
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include "AnimationEngine.hpp"
+#include "Box.hpp"
+#include "SceneRenderer.hpp"
+#include <include/core/SkSurface.h>
+#include <boost/make_shared.hpp>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+constexpr float kSceneSize = 200.0f;
+
+bool HasFlags(DirtyFlags flags, DirtyFlags mask) {
+    return (flags & mask) != DirtyFlags::None;
+}
+
+// 200x200 的根容器中放两个 Box，完成一次布局和绘制后组件树是干净的
+struct PipelineScene {
+    boost::shared_ptr<Box> root;
+    boost::shared_ptr<Box> box;
+    boost::shared_ptr<Box> sibling;
+    SceneRenderer renderer;
+    sk_sp<SkSurface> surface;
+};
+
+void CreateScene(PipelineScene& scene) {
+    scene.root = boost::make_shared<Box>();
+    scene.root->SetWidth(kSceneSize);
+    scene.root->SetHeight(kSceneSize);
+    scene.box = boost::make_shared<Box>();
+    scene.box->SetWidth(50.0f);
+    scene.box->SetHeight(50.0f);
+    scene.box->SetBackgroundColor(SK_ColorRED);
+    scene.root->AddChild(scene.box);
+    scene.sibling = boost::make_shared<Box>();
+    scene.sibling->SetHeight(20.0f);
+    scene.root->AddChild(scene.sibling);
+
+    scene.renderer.SetRoot(scene.root);
+    scene.surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(200, 200));
+    scene.renderer.UpdateStyles();
+    scene.renderer.CalculateLayout(kSceneSize, kSceneSize);
+    scene.renderer.Render(scene.surface->getCanvas());
+    scene.renderer.GetHitTestVersion();
+}
+
+} // namespace
+
+// 新组件从所有阶段都脏开始；跑完样式、布局、绘制后不再需要新的一帧
+TEST(FramePipelineTest, CleanTreeNeedsNoFrame) {
+    auto box = boost::make_shared<Box>();
+    EXPECT_TRUE(HasFlags(box->GetDirtyFlags(), DirtyFlags::Style | DirtyFlags::Layout | DirtyFlags::Paint));
+
+    PipelineScene scene;
+    CreateScene(scene);
+    EXPECT_EQ(scene.root->GetSubtreeDirtyFlags() & ~DirtyFlags::HitTest, DirtyFlags::None);
+    EXPECT_FALSE(scene.root->IsLayoutDirty());
+    EXPECT_FALSE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+    // 视口变化需要重新布局
+    EXPECT_TRUE(scene.renderer.NeedsFrame(kSceneSize * 2.0f, kSceneSize));
+
+    scene.renderer.RequestFrame();
+    EXPECT_TRUE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+    scene.renderer.Render(scene.surface->getCanvas());
+    EXPECT_FALSE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+}
+
+// 颜色只标记绘制：不经过样式和布局，命中测试版本不变
+TEST(FramePipelineTest, ColorMarksPaintOnly) {
+    PipelineScene scene;
+    CreateScene(scene);
+    const uint64_t hitTestVersion = scene.renderer.GetHitTestVersion();
+
+    scene.box->SetBackgroundColor(SK_ColorBLUE);
+    EXPECT_EQ(scene.box->GetDirtyFlags(), DirtyFlags::Paint);
+    EXPECT_EQ(scene.root->GetSubtreeDirtyFlags(), DirtyFlags::Paint);
+    EXPECT_EQ(scene.sibling->GetSubtreeDirtyFlags(), DirtyFlags::None);
+    EXPECT_FALSE(scene.root->IsLayoutDirty());
+    EXPECT_TRUE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+    EXPECT_EQ(scene.renderer.GetHitTestVersion(), hitTestVersion);
+
+    scene.renderer.Render(scene.surface->getCanvas());
+    EXPECT_EQ(scene.root->GetSubtreeDirtyFlags(), DirtyFlags::None);
+    EXPECT_FALSE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+}
+
+// 根元素没有父元素承接合成属性的变化，改动后仍然需要新的一帧
+TEST(FramePipelineTest, RootCompositingChangeNeedsFrame) {
+    PipelineScene scene;
+    CreateScene(scene);
+    ASSERT_FALSE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+
+    scene.root->SetOpacity(0.5f);
+    EXPECT_TRUE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+    scene.renderer.Render(scene.surface->getCanvas());
+    EXPECT_FALSE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+
+    scene.root->SetVisibility(false);
+    EXPECT_TRUE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+}
+
+// 颜色和透明度动画每一帧都只经过绘制阶段
+TEST(FramePipelineTest, ColorAnimationNeverReachesLayout) {
+    PipelineScene scene;
+    CreateScene(scene);
+    const uint64_t hitTestVersion = scene.renderer.GetHitTestVersion();
+    AnimationEngine& engine = scene.renderer.GetAnimationEngine();
+    AnimationOptions options;
+    options.duration = 100.0f;
+    options.easing = Easing::Linear();
+    engine.AnimateColor(scene.box, AnimatedProperty::BackgroundColor, SK_ColorBLACK, SK_ColorWHITE, options);
+    engine.Animate(scene.box, AnimatedProperty::Opacity, 0.5f, options);
+    EXPECT_TRUE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+
+    for (int frame = 0; frame < 4; ++frame) {
+        engine.Tick(30.0f);
+        EXPECT_EQ(scene.root->GetSubtreeDirtyFlags(), DirtyFlags::Paint);
+        EXPECT_FALSE(scene.root->IsLayoutDirty());
+        EXPECT_EQ(scene.renderer.GetHitTestVersion(), hitTestVersion);
+        scene.renderer.Render(scene.surface->getCanvas());
+    }
+    EXPECT_EQ(engine.GetActiveCount(), 0u);
+    EXPECT_FALSE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+
+    // 降到 0 的透明度让组件不再参与命中测试
+    scene.box->SetOpacity(0.0f);
+    EXPECT_NE(scene.renderer.GetHitTestVersion(), hitTestVersion);
+}
+
+// 尺寸标记样式和布局；样式阶段同步 Yoga 节点，布局阶段清除布局标记
+TEST(FramePipelineTest, SizeMarksStyleAndLayout) {
+    PipelineScene scene;
+    CreateScene(scene);
+    const uint64_t hitTestVersion = scene.renderer.GetHitTestVersion();
+
+    scene.box->SetWidth(80.0f);
+    EXPECT_TRUE(HasFlags(scene.box->GetDirtyFlags(), DirtyFlags::Style));
+    EXPECT_TRUE(HasFlags(scene.box->GetDirtyFlags(), DirtyFlags::Layout));
+    EXPECT_TRUE(scene.root->IsLayoutDirty());
+    EXPECT_FALSE(HasFlags(scene.sibling->GetSubtreeDirtyFlags(), DirtyFlags::Style | DirtyFlags::Layout));
+
+    scene.renderer.UpdateStyles();
+    EXPECT_FALSE(HasFlags(scene.root->GetSubtreeDirtyFlags(), DirtyFlags::Style));
+    EXPECT_TRUE(HasFlags(scene.box->GetDirtyFlags(), DirtyFlags::Layout));
+
+    scene.renderer.CalculateLayout(kSceneSize, kSceneSize);
+    EXPECT_FALSE(scene.root->IsLayoutDirty());
+    EXPECT_FLOAT_EQ(scene.box->GetWidth(), 80.0f);
+    EXPECT_NE(scene.renderer.GetHitTestVersion(), hitTestVersion);
+}
+
+// 批量更新期间样式阶段跳过该组件，EndUpdate 后重新标记
+TEST(FramePipelineTest, BatchDefersStyleSync) {
+    PipelineScene scene;
+    CreateScene(scene);
+
+    scene.box->BeginUpdate();
+    scene.box->SetWidth(60.0f);
+    scene.box->SetMargin(Margin::Top, 4.0f);
+    scene.renderer.UpdateStyles();
+    EXPECT_TRUE(HasFlags(scene.box->GetDirtyFlags(), DirtyFlags::Style));
+    scene.box->EndUpdate();
+    EXPECT_TRUE(HasFlags(scene.root->GetSubtreeDirtyFlags(), DirtyFlags::Style));
+
+    scene.renderer.CalculateLayout(kSceneSize, kSceneSize);
+    EXPECT_FALSE(HasFlags(scene.root->GetSubtreeDirtyFlags(), DirtyFlags::Style | DirtyFlags::Layout));
+    EXPECT_FLOAT_EQ(scene.box->GetWidth(), 60.0f);
+}
+
+// 布局结果不会被写回样式：自动尺寸的组件随视口变化
+TEST(FramePipelineTest, LayoutResultIsNotPinned) {
+    auto root = boost::make_shared<Box>();
+    auto child = boost::make_shared<Box>();
+    child->SetHeight(20.0f);
+    root->AddChild(child);
+
+    root->CalculateLayout(200.0f, 100.0f);
+    EXPECT_FLOAT_EQ(root->GetWidth(), 200.0f);
+    EXPECT_FLOAT_EQ(child->GetWidth(), 200.0f);
+
+    child->SetBackgroundColor(SK_ColorRED);
+    root->SetMargin(Margin::All, 0.0f);
+    root->CalculateLayout(300.0f, 100.0f);
+    EXPECT_FLOAT_EQ(root->GetWidth(), 300.0f);
+    EXPECT_FLOAT_EQ(child->GetWidth(), 300.0f);
+}
+
+// 插入带有脏标记的子树时，新的祖先也知道需要执行哪些阶段
+TEST(FramePipelineTest, InsertedSubtreePropagatesFlags) {
+    PipelineScene scene;
+    CreateScene(scene);
+
+    auto group = boost::make_shared<Box>();
+    auto leaf = boost::make_shared<Box>();
+    group->AddChild(leaf);
+    group->ClearDirtyFlags(DirtyFlags::Style | DirtyFlags::Layout | DirtyFlags::Paint | DirtyFlags::HitTest);
+    leaf->SetBackgroundColor(SK_ColorGREEN);
+    EXPECT_EQ(group->GetSubtreeDirtyFlags(), DirtyFlags::Paint);
+
+    scene.sibling->AddChild(group);
+    EXPECT_TRUE(HasFlags(scene.root->GetSubtreeDirtyFlags(), DirtyFlags::Paint));
+    EXPECT_TRUE(scene.root->IsLayoutDirty());
+
+    scene.renderer.UpdateStyles();
+    scene.renderer.CalculateLayout(kSceneSize, kSceneSize);
+    scene.renderer.Render(scene.surface->getCanvas());
+    EXPECT_FALSE(scene.renderer.NeedsFrame(kSceneSize, kSceneSize));
+    EXPECT_EQ(leaf->GetSubtreeDirtyFlags() & ~DirtyFlags::HitTest, DirtyFlags::None);
+}
+
+} // namespace widget
+} // namespace KiUI
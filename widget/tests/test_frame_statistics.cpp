@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "FrameStatistics.hpp"
+#include "clock.hpp"
+#include <chrono>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::chrono::microseconds Ms(float milliseconds) {
+    return std::chrono::microseconds(static_cast<int64_t>(milliseconds * 1000.0f));
+}
+
+// 在 start 开始记录一帧，帧内各阶段依次占用 phases 中的时长，返回帧结束的时间
+Clock::time_point RecordFrame(FrameStatistics& statistics, Clock::time_point start,
+                              const std::vector<std::pair<FramePhase, float>>& phases) {
+    statistics.BeginFrame(start);
+    float total = 0.0f;
+    for (const auto& phase : phases) {
+        statistics.RecordPhase(phase.first, phase.second);
+        total += phase.second;
+    }
+    statistics.EndFrame(start + Ms(total));
+    return start + Ms(total);
+}
+
+} // namespace
+
+// 卡顿造成的长帧间隔如实报告
+TEST(FrameStatisticsTest, ClockReportsStalls) {
+    CompositionClock clock;
+    const auto start = Clock::now();
+    clock.Tick(start);
+    clock.Tick(start + std::chrono::milliseconds(250));
+    EXPECT_FLOAT_EQ(clock.GetDeltaTime(), 250.0f);
+}
+
+// 百分位数按最近秩计算，精度为 0.1 毫秒；超出直方图范围的慢帧精确报告
+TEST(FrameStatisticsTest, PercentilesAndPhases) {
+    FrameStatistics statistics;
+    auto now = Clock::now();
+    // 98 帧 5 毫秒（布局 1 + 绘制 4），1 帧 12 毫秒，1 帧 150 毫秒
+    for (int i = 0; i < 98; ++i) {
+        RecordFrame(statistics, now, {{FramePhase::Layout, 1.0f}, {FramePhase::Paint, 4.0f}});
+        now += Ms(16.0f);
+    }
+    RecordFrame(statistics, now, {{FramePhase::Paint, 12.0f}});
+    now += Ms(16.0f);
+    RecordFrame(statistics, now, {{FramePhase::Tasks, 150.0f}});
+
+    const auto summary = statistics.GetSummary();
+    EXPECT_EQ(summary.frames, 100u);
+    EXPECT_NEAR(summary.p50, 5.0f, 0.11f);
+    EXPECT_NEAR(summary.p95, 5.0f, 0.11f);
+    EXPECT_NEAR(summary.p99, 12.0f, 0.11f);
+    EXPECT_NEAR(statistics.GetPercentile(100.0f), 150.0f, 1e-3f);
+    EXPECT_NEAR(summary.max, 150.0f, 1e-3f);
+    EXPECT_NEAR(summary.phaseP95[static_cast<size_t>(FramePhase::Paint)], 4.0f, 0.11f);
+    EXPECT_NEAR(statistics.GetPhasePercentile(FramePhase::Layout, 50.0f), 1.0f, 0.11f);
+    EXPECT_EQ(statistics.GetPhasePercentile(FramePhase::Swap, 99.0f), 0.0f);
+    EXPECT_NEAR(statistics.GetLastFrame().GetPhase(FramePhase::Tasks), 150.0f, 1e-3f);
+}
+
+// 超过预算的帧触发回调；帧间隔超过刷新间隔的整数倍时计入错过的帧
+TEST(FrameStatisticsTest, OverBudgetAndDroppedFrames) {
+    FrameStatistics statistics;
+    statistics.SetFrameBudget(16.0f);
+    std::vector<FrameTiming> slowFrames;
+    statistics.OnFrameOverBudget.connect([&slowFrames](const FrameTiming& frame) { slowFrames.push_back(frame); });
+
+    auto now = Clock::now();
+    RecordFrame(statistics, now, {{FramePhase::Paint, 8.0f}});
+    now += Ms(16.0f);
+    RecordFrame(statistics, now, {{FramePhase::Layout, 40.0f}});
+    now += Ms(48.0f);   // 上一帧占用了三个刷新间隔
+    RecordFrame(statistics, now, {{FramePhase::Paint, 8.0f}});
+
+    ASSERT_EQ(slowFrames.size(), 1u);
+    EXPECT_EQ(slowFrames[0].frameIndex, 1u);
+    EXPECT_NEAR(slowFrames[0].GetPhase(FramePhase::Layout), 40.0f, 1e-3f);
+    EXPECT_EQ(statistics.GetLastFrame().droppedFrames, 2u);
+    EXPECT_NEAR(statistics.GetLastFrame().interval, 48.0f, 1e-2f);
+    const auto summary = statistics.GetSummary();
+    EXPECT_EQ(summary.overBudgetFrames, 1u);
+    EXPECT_EQ(summary.droppedFrames, 2u);
+}
+
+// 在交换缓冲区中等待垂直同步的帧总时长接近预算，但不算超过预算
+TEST(FrameStatisticsTest, VsyncBoundFrameIsNotOverBudget) {
+    FrameStatistics statistics;
+    statistics.SetFrameBudget(16.0f);
+    size_t overBudget = 0;
+    statistics.OnFrameOverBudget.connect([&overBudget](const FrameTiming&) { ++overBudget; });
+
+    auto now = Clock::now();
+    for (int i = 0; i < 3; ++i) {
+        RecordFrame(statistics, now, {{FramePhase::Events, 0.5f}, {FramePhase::Paint, 3.0f},
+                                      {FramePhase::Flush, 1.0f}, {FramePhase::Swap, 12.5f}});
+        now += Ms(17.0f);
+    }
+    EXPECT_EQ(overBudget, 0u);
+    EXPECT_NEAR(statistics.GetLastFrame().total, 17.0f, 1e-2f);
+    EXPECT_NEAR(statistics.GetLastFrame().work, 4.5f, 1e-2f);
+    EXPECT_EQ(statistics.GetLastFrame().droppedFrames, 0u);
+
+    // 工作量本身超过预算时仍然触发，即使交换缓冲区没有等待
+    RecordFrame(statistics, now, {{FramePhase::Paint, 18.0f}, {FramePhase::Swap, 0.5f}});
+    EXPECT_EQ(overBudget, 1u);
+    EXPECT_EQ(statistics.GetSummary().overBudgetFrames, 1u);
+}
+
+// 空闲期（没有内容需要绘制）之后的第一帧不计入错过的帧
+TEST(FrameStatisticsTest, IdleGapIsNotDropped) {
+    FrameStatistics statistics;
+    statistics.SetFrameBudget(16.0f);
+    auto now = Clock::now();
+    RecordFrame(statistics, now, {{FramePhase::Paint, 4.0f}});
+    statistics.MarkIdle();
+    now += Ms(2000.0f);
+    RecordFrame(statistics, now, {{FramePhase::Style, 1.0f}, {FramePhase::Paint, 4.0f}});
+    EXPECT_EQ(statistics.GetLastFrame().droppedFrames, 0u);
+    EXPECT_EQ(statistics.GetLastFrame().interval, 0.0f);
+    EXPECT_NEAR(statistics.GetLastFrame().GetPhase(FramePhase::Style), 1.0f, 1e-3f);
+    EXPECT_EQ(statistics.GetSummary().droppedFrames, 0u);
+}
+
+// 环形缓冲区只保留最近的帧，被覆盖的帧不再参与统计
+TEST(FrameStatisticsTest, RingKeepsRecentFrames) {
+    FrameStatistics statistics(10);
+    auto now = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        RecordFrame(statistics, now, {{FramePhase::Paint, 30.0f}});
+        now += Ms(33.0f);
+    }
+    EXPECT_NEAR(statistics.GetPercentile(50.0f), 30.0f, 0.11f);
+    for (int i = 0; i < 10; ++i) {
+        RecordFrame(statistics, now, {{FramePhase::Paint, 2.0f}});
+        now += Ms(16.0f);
+    }
+    EXPECT_EQ(statistics.GetFrameCount(), 10u);
+    EXPECT_NEAR(statistics.GetPercentile(99.0f), 2.0f, 0.11f);
+    const auto frames = statistics.GetFrames();
+    ASSERT_EQ(frames.size(), 10u);
+    EXPECT_EQ(frames.front().frameIndex, 10u);
+    EXPECT_EQ(frames.back().frameIndex, 19u);
+
+    statistics.Reset();
+    EXPECT_EQ(statistics.GetFrameCount(), 0u);
+    EXPECT_EQ(statistics.GetPercentile(50.0f), 0.0f);
+}
+
+} // namespace widget
+} // namespace KiUI
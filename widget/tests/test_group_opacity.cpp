@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Box.hpp"
+#include "SceneRenderer.hpp"
+#include <include/core/SkSurface.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <boost/make_shared.hpp>
+#include <cstdlib>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+// 半透明面板中放两个互相重叠的不透明子元素
+struct FadingPanel {
+    boost::shared_ptr<Box> root;
+    boost::shared_ptr<Box> panel;
+    boost::shared_ptr<Box> first;
+    boost::shared_ptr<Box> second;
+};
+
+FadingPanel CreateFadingPanel() {
+    FadingPanel scene;
+    scene.root = test::MakePlacedBox(0.0f, 0.0f, 100.0f, 100.0f, SK_ColorWHITE);
+    scene.panel = test::MakePlacedBox(10.0f, 10.0f, 80.0f, 80.0f, SK_ColorTRANSPARENT);
+    scene.panel->SetOpacity(0.5f);
+    scene.first = test::MakePlacedBox(0.0f, 0.0f, 40.0f, 40.0f, SK_ColorRED);
+    scene.second = test::MakePlacedBox(20.0f, 20.0f, 40.0f, 40.0f, SK_ColorRED);
+    scene.panel->AddChild(scene.first);
+    scene.panel->AddChild(scene.second);
+    scene.root->AddChild(scene.panel);
+    return scene;
+}
+
+bool ColorsNear(SkColor a, SkColor b) {
+    return std::abs(int(SkColorGetA(a)) - int(SkColorGetA(b))) <= 1 &&
+           std::abs(int(SkColorGetR(a)) - int(SkColorGetR(b))) <= 1 &&
+           std::abs(int(SkColorGetG(a)) - int(SkColorGetG(b))) <= 1 &&
+           std::abs(int(SkColorGetB(a)) - int(SkColorGetB(b))) <= 1;
+}
+
+} // namespace
+
+// 重叠部分与非重叠部分颜色一致：透明度作用于整个分组而不是每个子元素
+TEST(GroupOpacityTest, OverlapBlendsAsOneGroup) {
+    auto scene = CreateFadingPanel();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    
+    for (bool batching : {false, true}) {
+        renderer.SetBatchingEnabled(batching);
+        auto image = test::RenderScene(renderer, 100, 100);
+        SkPixmap pixels;
+        ASSERT_TRUE(image->peekPixels(&pixels));
+        
+        const SkColor single = pixels.getColor(15, 15);   // 只有第一个子元素
+        const SkColor overlap = pixels.getColor(40, 40);  // 两个子元素重叠
+        EXPECT_TRUE(ColorsNear(single, overlap)) << std::hex << single << " vs " << overlap;
+        EXPECT_NE(single, SK_ColorRED);
+    }
+}
+
+// 内容不变时复用图层；只改变分组透明度或整数平移也不重新渲染
+TEST(GroupOpacityTest, ReusesLayerWhileContentUnchanged) {
+    auto scene = CreateFadingPanel();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    
+    test::RenderScene(renderer, 100, 100);
+    EXPECT_EQ(renderer.GetGroupLayerRenders(), 1u);
+    
+    test::RenderScene(renderer, 100, 100);
+    EXPECT_EQ(renderer.GetGroupLayerRenders(), 0u);
+    EXPECT_EQ(renderer.GetGroupLayerHits(), 1u);
+    
+    scene.panel->SetOpacity(0.25f);
+    scene.panel->SetLeft(5.0f);
+    test::RenderScene(renderer, 100, 100);
+    EXPECT_EQ(renderer.GetGroupLayerRenders(), 0u);
+    EXPECT_EQ(renderer.GetGroupLayerHits(), 1u);
+    
+    // 子元素内容变化后需要重新渲染
+    scene.second->SetBackgroundColor(SK_ColorBLUE);
+    test::RenderScene(renderer, 100, 100);
+    EXPECT_EQ(renderer.GetGroupLayerRenders(), 1u);
+}
+
+// 只有一次绘制的半透明组件直接把透明度折算进画笔，不使用图层
+TEST(GroupOpacityTest, SingleDrawSkipsLayer) {
+    auto root = test::MakePlacedBox(0.0f, 0.0f, 100.0f, 100.0f, SK_ColorWHITE);
+    auto leaf = test::MakePlacedBox(10.0f, 10.0f, 20.0f, 20.0f, SK_ColorRED);
+    leaf->SetOpacity(0.5f);
+    root->AddChild(leaf);
+    EXPECT_FALSE(leaf->UsesGroupOpacity());
+    
+    SceneRenderer renderer;
+    renderer.SetRoot(root);
+    test::RenderScene(renderer, 100, 100);
+    EXPECT_EQ(renderer.GetGroupLayerRenders(), 0u);
+    EXPECT_EQ(renderer.GetGroupLayerHits(), 0u);
+}
+
+} // namespace widget
+} // namespace KiUI
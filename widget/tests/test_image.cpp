@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Image.hpp"
+#include <window.hpp>
+#include <include/core/SkSurface.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+using test::PixelAt;
+
+sk_sp<SkImage> RenderElement(Image& image, int width, int height) {
+    Image::BeginFrame();
+    return test::RenderElement(image, width, height);
+}
+
+boost::shared_ptr<Image> MakeImage(float width, float height) {
+    auto image = boost::make_shared<Image>();
+    image->SetWidth(width);
+    image->SetHeight(height);
+    return image;
+}
+
+// 在 UI 线程轮询后台任务的回调，直到图片不再处于加载中
+void WaitForLoad(const boost::shared_ptr<Image>& image) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (image->GetState() == ImageState::Loading && std::chrono::steady_clock::now() < deadline) {
+        foundation::WindowManager::GetSharedInstance().PollMainThreadTasks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+// 没有图片时绘制占位色，设置图片后绘制图片
+TEST(ImageTest, PlaceholderUntilImageIsSet) {
+    auto image = MakeImage(20.0f, 20.0f);
+    image->SetPlaceholderColor(SK_ColorGRAY);
+    EXPECT_EQ(image->GetState(), ImageState::Empty);
+    EXPECT_EQ(PixelAt(RenderElement(*image, 20, 20), 10, 10), SK_ColorGRAY);
+
+    image->SetImage(test::MakeSolidImage(4, 4, SK_ColorRED));
+    EXPECT_EQ(image->GetState(), ImageState::Decoded);
+    EXPECT_EQ(PixelAt(RenderElement(*image, 20, 20), 10, 10), SK_ColorRED);
+    EXPECT_EQ(image->GetState(), ImageState::Ready);
+}
+
+// Uniform 保持宽高比并居中，UniformToFill 填满元素
+TEST(ImageTest, StretchModes) {
+    auto image = MakeImage(100.0f, 100.0f);
+    image->SetPlaceholderColor(SK_ColorTRANSPARENT);
+    image->SetImage(test::MakeSolidImage(200, 100, SK_ColorBLUE));
+
+    image->SetStretch(ImageStretch::Uniform);
+    auto uniform = RenderElement(*image, 100, 100);
+    EXPECT_EQ(PixelAt(uniform, 50, 10), SK_ColorTRANSPARENT);
+    EXPECT_EQ(PixelAt(uniform, 50, 50), SK_ColorBLUE);
+
+    image->SetStretch(ImageStretch::UniformToFill);
+    auto fill = RenderElement(*image, 100, 100);
+    EXPECT_EQ(PixelAt(fill, 50, 10), SK_ColorBLUE);
+    EXPECT_EQ(PixelAt(fill, 50, 90), SK_ColorBLUE);
+}
+
+// 加载失败时进入 Failed 状态并继续绘制占位
+TEST(ImageTest, MissingFileFails) {
+    auto image = MakeImage(10.0f, 10.0f);
+    bool loaded = true;
+    image->OnLoaded.connect([&loaded](bool success) { loaded = success; });
+    image->SetPlaceholderColor(SK_ColorGRAY);
+    image->SetSource("this/file/does/not/exist.png");
+    WaitForLoad(image);
+    EXPECT_EQ(image->GetState(), ImageState::Failed);
+    EXPECT_FALSE(loaded);
+    EXPECT_EQ(PixelAt(RenderElement(*image, 10, 10), 5, 5), SK_ColorGRAY);
+}
+
+#ifdef WIDGET_USE_STB
+// 文件在后台线程解码，回到 UI 线程后可以绘制；换图后旧的解码结果被丢弃
+TEST(ImageTest, DecodesInBackground) {
+    auto path = std::filesystem::temp_directory_path() / "kiui_image_test.ppm";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "P6\n2 2\n255\n";
+        for (int i = 0; i < 4; ++i) {
+            file.put(static_cast<char>(0)).put(static_cast<char>(255)).put(static_cast<char>(0));
+        }
+    }
+
+    auto image = MakeImage(10.0f, 10.0f);
+    image->SetSource(path.string());
+    EXPECT_EQ(image->GetState(), ImageState::Loading);
+    WaitForLoad(image);
+    ASSERT_EQ(image->GetState(), ImageState::Decoded);
+    EXPECT_EQ(PixelAt(RenderElement(*image, 10, 10), 5, 5), SK_ColorGREEN);
+
+    image->SetSource(path.string() + ".missing");
+    image->SetSource("");
+    WaitForLoad(image);
+    EXPECT_EQ(image->GetState(), ImageState::Empty);
+    EXPECT_EQ(image->GetImage(), nullptr);
+
+    std::filesystem::remove(path);
+}
+#endif
+
+} // namespace widget
+} // namespace KiUI
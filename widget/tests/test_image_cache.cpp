@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "ImageCache.hpp"
+#include "Image.hpp"
+#include <window.hpp>
+#include <RenderContext.hpp>
+#include <include/core/SkSurface.h>
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+ImageCache::Key MakeKey(const std::string& source, int width, int height) {
+    ImageCache::Key key;
+    key.source = source;
+    key.target.width = width;
+    key.target.height = height;
+    return key;
+}
+
+ImageCache::Entry MakeEntry(int width, int height) {
+    ImageCache::Entry entry;
+    entry.image = test::MakeSolidImage(width, height, SK_ColorRED);
+    entry.sourceWidth = width;
+    entry.sourceHeight = height;
+    return entry;
+}
+
+// 缓存只把上下文指针当作键，测试用一个不会被解引用的地址代替真实上下文
+GrDirectContext* FakeContext() {
+    static char tag;
+    return reinterpret_cast<GrDirectContext*>(&tag);
+}
+
+// 每个测试使用干净的共享缓存，结束时恢复默认预算
+class ImageCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ImageCache::GetSharedInstance().Clear();
+        ImageCache::GetSharedInstance().ReleaseTextures(FakeContext());
+        ImageCache::GetSharedInstance().SetBudget(ImageCache::kDefaultBudget);
+    }
+
+    void TearDown() override {
+        ImageCache::GetSharedInstance().Clear();
+        ImageCache::GetSharedInstance().ReleaseTextures(FakeContext());
+        ImageCache::GetSharedInstance().SetBudget(ImageCache::kDefaultBudget);
+    }
+};
+
+} // namespace
+
+// 同一来源不同目标尺寸是不同的条目
+TEST_F(ImageCacheTest, KeyIncludesTargetSize) {
+    ImageCache& cache = ImageCache::GetSharedInstance();
+    cache.Insert(MakeKey("a.png", 10, 10), MakeEntry(10, 10));
+
+    ImageCache::Entry entry;
+    EXPECT_TRUE(cache.Find(MakeKey("a.png", 10, 10), &entry));
+    EXPECT_EQ(entry.image->width(), 10);
+    EXPECT_FALSE(cache.Find(MakeKey("a.png", 20, 20), &entry));
+    EXPECT_FALSE(cache.Find(MakeKey("b.png", 10, 10), &entry));
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.usedBytes, 10u * 10u * 4u);
+}
+
+// 超出预算时淘汰最久未使用的条目，Find 会刷新使用顺序
+TEST_F(ImageCacheTest, EvictsLeastRecentlyUsed) {
+    ImageCache& cache = ImageCache::GetSharedInstance();
+    const size_t entryBytes = 10 * 10 * 4;
+    cache.SetBudget(entryBytes * 2);
+
+    cache.Insert(MakeKey("a.png", 10, 10), MakeEntry(10, 10));
+    cache.Insert(MakeKey("b.png", 10, 10), MakeEntry(10, 10));
+    EXPECT_TRUE(cache.Find(MakeKey("a.png", 10, 10), nullptr));
+    cache.Insert(MakeKey("c.png", 10, 10), MakeEntry(10, 10));
+
+    EXPECT_TRUE(cache.Find(MakeKey("a.png", 10, 10), nullptr));
+    EXPECT_FALSE(cache.Find(MakeKey("b.png", 10, 10), nullptr));
+    EXPECT_TRUE(cache.Find(MakeKey("c.png", 10, 10), nullptr));
+    EXPECT_EQ(cache.GetStats().evictions, 1u);
+    EXPECT_LE(cache.GetStats().usedBytes, entryBytes * 2);
+
+    // 缩小预算立即生效，但总保留最近使用的一项
+    cache.SetBudget(1);
+    EXPECT_EQ(cache.GetStats().entryCount, 1u);
+    EXPECT_TRUE(cache.Find(MakeKey("c.png", 10, 10), nullptr));
+}
+
+// 纹理按上下文保存；解码线程上的淘汰不释放纹理，而是留给所属上下文的线程释放
+TEST_F(ImageCacheTest, EvictionRetiresTexturesToOwningContext) {
+    ImageCache& cache = ImageCache::GetSharedInstance();
+    const size_t entryBytes = 10 * 10 * 4;
+    cache.SetBudget(entryBytes * 5 / 2);
+
+    const ImageCache::Key key = MakeKey("a.png", 10, 10);
+    cache.Insert(key, MakeEntry(10, 10));
+    sk_sp<SkImage> texture = test::MakeSolidImage(10, 10, SK_ColorBLUE);
+    cache.SetTexture(key, FakeContext(), texture);
+    EXPECT_EQ(cache.FindTexture(key, FakeContext()).get(), texture.get());
+    EXPECT_EQ(cache.FindTexture(key, nullptr).get(), nullptr);
+    EXPECT_EQ(cache.GetStats().usedBytes, entryBytes * 2);
+
+    std::thread decoder([&]() { cache.Insert(MakeKey("b.png", 10, 10), MakeEntry(10, 10)); });
+    decoder.join();
+
+    EXPECT_FALSE(cache.Find(key, nullptr));
+    EXPECT_EQ(cache.GetStats().evictions, 1u);
+    EXPECT_EQ(cache.GetStats().retiredTextures, 1u);
+    EXPECT_EQ(cache.GetStats().usedBytes, entryBytes);
+    EXPECT_FALSE(texture->unique());
+
+    cache.ReleaseRetiredTextures(FakeContext());
+    EXPECT_EQ(cache.GetStats().retiredTextures, 0u);
+    EXPECT_TRUE(texture->unique());
+}
+
+// 上下文关闭时释放它在缓存中的全部纹理，CPU 图片保留
+TEST_F(ImageCacheTest, ContextShutdownReleasesTextures) {
+    ImageCache& cache = ImageCache::GetSharedInstance();
+    const ImageCache::Key key = MakeKey("a.png", 10, 10);
+    cache.Insert(key, MakeEntry(10, 10));
+    sk_sp<SkImage> texture = test::MakeSolidImage(10, 10, SK_ColorBLUE);
+    cache.SetTexture(key, FakeContext(), texture);
+    cache.Insert(MakeKey("b.png", 10, 10), MakeEntry(10, 10));
+    cache.SetTexture(MakeKey("b.png", 10, 10), FakeContext(), test::MakeSolidImage(10, 10, SK_ColorBLUE));
+    cache.Clear();
+    cache.Insert(key, MakeEntry(10, 10));
+    cache.SetTexture(key, FakeContext(), texture);
+    EXPECT_EQ(cache.GetStats().retiredTextures, 2u);
+
+    graphics::RenderContext::OnContextShutdown()(FakeContext());
+
+    EXPECT_TRUE(cache.Find(key, nullptr));
+    EXPECT_EQ(cache.FindTexture(key, FakeContext()).get(), nullptr);
+    EXPECT_EQ(cache.GetStats().retiredTextures, 0u);
+    EXPECT_EQ(cache.GetStats().usedBytes, 10u * 10u * 4u);
+    EXPECT_TRUE(texture->unique());
+}
+
+// 缩小后的尺寸保持宽高比：cover 覆盖目标，contain 放入目标，从不放大
+TEST_F(ImageCacheTest, ComputesScaledSize) {
+    ImageDecoder::TargetSize target;
+    target.width = 120;
+    target.height = 90;
+
+    EXPECT_EQ(ImageDecoder::ComputeScaledSize(4000, 3000, target), SkISize::Make(120, 90));
+    EXPECT_EQ(ImageDecoder::ComputeScaledSize(4000, 2000, target), SkISize::Make(180, 90));
+    target.cover = false;
+    EXPECT_EQ(ImageDecoder::ComputeScaledSize(4000, 2000, target), SkISize::Make(120, 60));
+    EXPECT_EQ(ImageDecoder::ComputeScaledSize(60, 40, target), SkISize::Make(60, 40));
+    EXPECT_EQ(ImageDecoder::ComputeScaledSize(4000, 3000, ImageDecoder::TargetSize()), SkISize::Make(4000, 3000));
+}
+
+#ifdef WIDGET_USE_STB
+// 大图按元素尺寸解码，结果进入缓存，第二个元素直接命中
+TEST_F(ImageCacheTest, ImageDecodesAtDisplaySize) {
+    auto path = std::filesystem::temp_directory_path() / "kiui_image_cache_test.ppm";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "P6\n400 300\n255\n";
+        for (int i = 0; i < 400 * 300; ++i) {
+            file.put(static_cast<char>(0)).put(static_cast<char>(0)).put(static_cast<char>(255));
+        }
+    }
+
+    auto first = boost::make_shared<Image>();
+    first->SetWidth(40.0f);
+    first->SetHeight(30.0f);
+    first->SetSource(path.string());
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (first->GetState() == ImageState::Loading && std::chrono::steady_clock::now() < deadline) {
+        foundation::WindowManager::GetSharedInstance().PollMainThreadTasks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(first->GetState(), ImageState::Decoded);
+    EXPECT_EQ(first->GetImage()->width(), 40);
+    EXPECT_EQ(first->GetImage()->height(), 30);
+
+    auto second = boost::make_shared<Image>();
+    second->SetWidth(40.0f);
+    second->SetHeight(30.0f);
+    second->SetSource(path.string());
+    EXPECT_EQ(second->GetState(), ImageState::Decoded);
+    EXPECT_EQ(second->GetImage().get(), first->GetImage().get());
+    EXPECT_EQ(ImageCache::GetSharedInstance().GetStats().entryCount, 1u);
+
+    std::filesystem::remove(path);
+}
+#endif
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "Box.hpp"
+#include "ItemExtentIndex.hpp"
+#include "ListView.hpp"
+#include <boost/make_shared.hpp>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+// 记录模板和绑定的条目，检查回收后的行是否按模板复用
+class TestRow : public Box {
+public:
+    explicit TestRow(int templateId) : templateId(templateId) {}
+
+    int templateId;
+    size_t boundIndex = 0;
+};
+
+boost::shared_ptr<ListView> CreateList(size_t count, float width, float height) {
+    auto list = boost::make_shared<ListView>();
+    list->SetWidth(width);
+    list->SetHeight(height);
+    list->SetRowHeight(20.0f);
+    list->SetRowFactory([](int templateId) { return boost::make_shared<TestRow>(templateId); });
+    list->SetRowBinder([](size_t index, VisualElement& row) { static_cast<TestRow&>(row).boundIndex = index; });
+    list->SetItemCount(count);
+    list->CalculateLayout(width, height);
+    return list;
+}
+
+} // namespace
+
+// 统一尺寸和设置过单个尺寸后，位置和按位置查找都一致
+TEST(ItemExtentIndexTest, FindsItemsByOffset) {
+    ItemExtentIndex index;
+    index.Reset(1000000, 20.0f);
+    EXPECT_TRUE(index.IsUniform());
+    EXPECT_DOUBLE_EQ(index.GetTotal(), 20000000.0);
+    EXPECT_EQ(index.FindIndex(19999999.0), 999999u);
+
+    index.SetExtent(10, 50.0f);
+    EXPECT_FALSE(index.IsUniform());
+    EXPECT_DOUBLE_EQ(index.GetOffset(11), 250.0);
+    EXPECT_EQ(index.FindIndex(249.0), 10u);
+    EXPECT_EQ(index.FindIndex(250.0), 11u);
+
+    // 追加的条目使用默认尺寸
+    index.Resize(1000002);
+    EXPECT_DOUBLE_EQ(index.GetTotal(), 20000030.0 + 40.0);
+    EXPECT_EQ(index.FindIndex(index.GetTotal() - 1.0), 1000001u);
+}
+
+// 百万条目时只创建与视口相交的行
+TEST(ListViewTest, RealizesOnlyVisibleRows) {
+    auto list = CreateList(1000000, 300.0f, 200.0f);
+    const size_t visible = 200 / 20 + 1 + 2 * ListView::kDefaultOverscan;
+    EXPECT_LE(list->GetStats().realizedRows, visible);
+    EXPECT_LE(list->GetChildrenCount(), visible);
+
+    list->SetScrollOffset(500000 * 20.0 + 5.0);
+    EXPECT_LE(list->GetStats().realizedRows, visible);
+    auto row = list->GetRealizedRow(500000);
+    ASSERT_NE(row, nullptr);
+    EXPECT_EQ(static_cast<TestRow&>(*row).boundIndex, 500000u);
+    EXPECT_FLOAT_EQ(row->GetTop(), -5.0f);
+    EXPECT_FLOAT_EQ(row->GetWidth(), 300.0f);
+
+    // 命中测试只遍历显示的行
+    auto hit = list->HitTest(10.0f, 30.0f);
+    ASSERT_NE(hit, nullptr);
+    size_t index = 0;
+    ASSERT_TRUE(list->GetItemIndex(hit, &index));
+    EXPECT_EQ(index, 500001u);
+
+    // 滚动位置限制在内容范围内
+    list->SetScrollOffset(1e12);
+    EXPECT_DOUBLE_EQ(list->GetScrollOffset(), list->GetContentHeight() - 200.0);
+    EXPECT_NE(list->GetRealizedRow(999999), nullptr);
+}
+
+// 滚出视口的行按模板回收复用，滚动不再创建行元素
+TEST(ListViewTest, RecyclesRowsPerTemplate) {
+    auto list = CreateList(100000, 300.0f, 200.0f);
+    list->SetTemplateSelector([](size_t index) { return static_cast<int>(index % 2); });
+    const uint64_t created = list->GetStats().rowsCreated;
+
+    for (int page = 1; page <= 50; ++page) {
+        list->SetScrollOffset(page * 200.0);
+        for (size_t i = 0; i < 10; ++i) {
+            const size_t item = static_cast<size_t>(page) * 10 + i;
+            auto row = list->GetRealizedRow(item);
+            ASSERT_NE(row, nullptr);
+            EXPECT_EQ(static_cast<TestRow&>(*row).templateId, static_cast<int>(item % 2));
+            EXPECT_EQ(static_cast<TestRow&>(*row).boundIndex, item);
+        }
+    }
+    // 每个模板最多比首屏多出一屏的行
+    EXPECT_LE(list->GetStats().rowsCreated, created + 2 * (200 / 20 + 1 + 2 * ListView::kDefaultOverscan));
+    EXPECT_EQ(list->GetChildrenCount(), list->GetStats().realizedRows + list->GetStats().pooledRows);
+}
+
+// 估算行高：行显示时按内容测量，视口上方的行变高时可见内容保持不动
+TEST(ListViewTest, MeasuredRowsKeepAnchorStable) {
+    auto list = boost::make_shared<ListView>();
+    list->SetWidth(300.0f);
+    list->SetHeight(200.0f);
+    list->SetRowHeightMode(ListView::RowHeightMode::Measured);
+    list->SetRowHeight(20.0f);
+    list->SetRowFactory([](int) {
+        auto row = boost::make_shared<Box>();
+        row->AddChild(boost::make_shared<Box>());
+        return row;
+    });
+    list->SetRowBinder([](size_t, VisualElement& row) {
+        // 实际行高 40，是估算值的两倍
+        row.GetChildren().front()->AsVisualElement()->SetHeight(40.0f);
+    });
+    list->SetItemCount(10000);
+    list->CalculateLayout(300.0f, 200.0f);
+
+    auto firstRow = list->GetRealizedRow(0);
+    ASSERT_NE(firstRow, nullptr);
+    EXPECT_FLOAT_EQ(firstRow->GetHeight(), 40.0f);
+    EXPECT_DOUBLE_EQ(list->GetItemOffset(1), 40.0);
+    // 测量后的行仍然填满视口
+    EXPECT_NE(list->GetRealizedRow(4), nullptr);
+
+    // 滚动到还没测量的区域：上方 overscan 行测量后变高，滚动位置随之调整
+    const double offset = list->GetItemOffset(5000) + 5.0;
+    list->SetScrollOffset(offset);
+    auto anchor = list->GetRealizedRow(5000);
+    ASSERT_NE(anchor, nullptr);
+    EXPECT_FLOAT_EQ(anchor->GetTop(), -5.0f);
+    EXPECT_GT(list->GetScrollOffset(), offset);
+    EXPECT_DOUBLE_EQ(list->GetScrollOffset(), list->GetItemOffset(5000) + 5.0);
+}
+
+} // namespace widget
+} // namespace KiUI
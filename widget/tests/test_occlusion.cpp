@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Box.hpp"
+#include "SceneRenderer.hpp"
+#include <include/core/SkSurface.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <boost/make_shared.hpp>
+#include <cstring>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+// 两个叠放的标签页：下面的页面有 40 行内容，上面的页面完全不透明并覆盖整个视口
+struct TabScene {
+    boost::shared_ptr<Box> root;
+    boost::shared_ptr<Box> hiddenPage;
+    boost::shared_ptr<Box> activePage;
+};
+
+TabScene CreateTabScene() {
+    TabScene scene;
+    scene.root = test::MakePlacedBox(0.0f, 0.0f, 200.0f, 200.0f, SK_ColorWHITE);
+    scene.hiddenPage = test::MakePlacedBox(0.0f, 0.0f, 200.0f, 200.0f, SK_ColorLTGRAY);
+    for (int i = 0; i < 40; ++i) {
+        scene.hiddenPage->AddChild(test::MakePlacedBox(0.0f, 5.0f * i, 200.0f, 5.0f, i % 2 ? SK_ColorRED : SK_ColorGREEN));
+    }
+    scene.activePage = test::MakePlacedBox(0.0f, 0.0f, 200.0f, 200.0f, SK_ColorDKGRAY);
+    scene.activePage->AddChild(test::MakePlacedBox(20.0f, 20.0f, 50.0f, 50.0f, SK_ColorBLUE));
+    scene.root->AddChild(scene.hiddenPage);
+    scene.root->AddChild(scene.activePage);
+    return scene;
+}
+
+} // namespace
+
+// 被不透明页面完全覆盖的页面整棵子树都不绘制
+TEST(OcclusionTest, SkipsCoveredPage) {
+    auto scene = CreateTabScene();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    test::RenderScene(renderer, 200, 200);
+    
+    // 下面的页面作为整棵子树跳过，根节点自身的背景也被覆盖
+    EXPECT_EQ(renderer.GetOccludedCount(), 2u);
+    // 只剩上层页面和它的一个子元素
+    EXPECT_EQ(renderer.GetBatchStats().commands, 2u);
+}
+
+// 半透明或带圆角的页面不能完全遮挡下面的内容
+TEST(OcclusionTest, KeepsContentBelowTranslucentPage) {
+    auto scene = CreateTabScene();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    
+    scene.activePage->SetOpacity(0.5f);
+    test::RenderScene(renderer, 200, 200);
+    EXPECT_EQ(renderer.GetOccludedCount(), 0u);
+    
+    scene.activePage->SetOpacity(1.0f);
+    scene.activePage->SetBorderRadius(BorderRadius::All, 8.0f);
+    test::RenderScene(renderer, 200, 200);
+    // 圆角处露出下面的页面：根节点、下层页面背景以及靠近上下边缘的 4 行仍需绘制
+    EXPECT_EQ(renderer.GetOccludedCount(), 36u);
+    EXPECT_EQ(renderer.GetBatchStats().commands, 2u + 2u + 4u);
+}
+
+// 遮挡剔除不改变绘制结果
+TEST(OcclusionTest, MatchesUnculledRendering) {
+    auto scene = CreateTabScene();
+    scene.activePage->SetTop(100.0f);
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    
+    renderer.SetOcclusionCullingEnabled(false);
+    auto expectedImage = test::RenderScene(renderer, 200, 200);
+    renderer.SetOcclusionCullingEnabled(true);
+    auto actualImage = test::RenderScene(renderer, 200, 200);
+    EXPECT_GT(renderer.GetOccludedCount(), 0u);
+    
+    SkPixmap expected;
+    SkPixmap actual;
+    ASSERT_TRUE(expectedImage->peekPixels(&expected));
+    ASSERT_TRUE(actualImage->peekPixels(&actual));
+    for (int y = 0; y < 200; ++y) {
+        const auto* expectedRow = static_cast<const uint8_t*>(expected.addr()) + y * expected.rowBytes();
+        const auto* actualRow = static_cast<const uint8_t*>(actual.addr()) + y * actual.rowBytes();
+        ASSERT_EQ(std::memcmp(expectedRow, actualRow, 200 * 4), 0) << "row " << y;
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "Box.hpp"
+#include "SceneSerializer.hpp"
+#include <boost/make_shared.hpp>
+#include <boost/filesystem.hpp>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+boost::shared_ptr<Box> CreateSampleTree() {
+    auto root = boost::make_shared<Box>();
+    root->SetWidth(800.0f);
+    root->SetHeight(600.0f);
+    root->SetPadding(Padding::All, 20.0f);
+    root->SetBackgroundColor(SK_ColorGRAY);
+    
+    auto panel = boost::make_shared<Box>();
+    panel->SetWidth(300.0f);
+    panel->SetHeight(200.0f);
+    panel->SetBackgroundColor(SK_ColorBLUE);
+    panel->SetBorderColor(SK_ColorWHITE);
+    panel->SetBorderWidth(BorderWidth::All, 2.0f);
+    panel->SetBorderRadius(BorderRadius::TopLeft, 6.0f);
+    panel->SetAlignment(Alignment::Center);
+    panel->SetJustification(Justification::Center);
+    panel->SetOpacity(0.5f);
+    root->AddChild(panel);
+    
+    auto child = boost::make_shared<Box>();
+    child->SetWidth(100.0f);
+    child->SetHeight(50.0f);
+    child->SetMargin(Margin::Left, 5.0f);
+    child->SetVisibility(false);
+    panel->AddChild(child);
+    
+    auto sibling = boost::make_shared<Box>();
+    sibling->SetWidth(150.0f);
+    sibling->SetHeight(100.0f);
+    sibling->SetAlignment(Alignment::End);
+    root->AddChild(sibling);
+    return root;
+}
+
+} // namespace
+
+// 内存缓冲区往返：结构与样式保持不变
+TEST(SceneSerializerTest, RoundTripBuffer) {
+    auto original = CreateSampleTree();
+    std::vector<uint8_t> buffer;
+    ASSERT_TRUE(SceneSerializer::SaveToBuffer(original, buffer));
+    EXPECT_EQ(buffer.size(), sizeof(SceneFileHeader) + 4 * sizeof(SceneNodeRecord));
+    
+    auto loaded = SceneSerializer::LoadFromMemory(buffer.data(), buffer.size());
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_FLOAT_EQ(loaded->GetWidth(), 800.0f);
+    EXPECT_FLOAT_EQ(loaded->GetPadding(Padding::Left), 20.0f);
+    EXPECT_EQ(loaded->GetBackgroundColor(), SK_ColorGRAY);
+    ASSERT_EQ(loaded->GetChildrenCount(), 2u);
+    
+    auto panel = loaded->GetChildren()[0]->AsVisualElement();
+    ASSERT_NE(panel, nullptr);
+    EXPECT_EQ(panel->GetParent(), loaded);
+    EXPECT_EQ(panel->GetBorderColor(), SK_ColorWHITE);
+    EXPECT_FLOAT_EQ(panel->GetBorderWidth(BorderWidth::Right), 2.0f);
+    EXPECT_FLOAT_EQ(panel->GetBorderRadius(BorderRadius::TopLeft), 6.0f);
+    EXPECT_EQ(panel->GetAlignment(), Alignment::Center);
+    EXPECT_EQ(panel->GetJustification(), Justification::Center);
+    EXPECT_FLOAT_EQ(panel->GetOpacity(), 0.5f);
+    ASSERT_EQ(panel->GetChildrenCount(), 1u);
+    
+    auto child = panel->GetChildren()[0]->AsVisualElement();
+    EXPECT_FLOAT_EQ(child->GetMargin(Margin::Left), 5.0f);
+    EXPECT_FALSE(child->GetVisibility());
+    
+    auto sibling = loaded->GetChildren()[1]->AsVisualElement();
+    EXPECT_EQ(sibling->GetIndexInParent(), 1u);
+    EXPECT_EQ(sibling->GetAlignment(), Alignment::End);
+}
+
+// 加载结果与原始树的布局一致
+TEST(SceneSerializerTest, LoadedTreeLaysOutLikeOriginal) {
+    auto original = CreateSampleTree();
+    std::vector<uint8_t> buffer;
+    ASSERT_TRUE(SceneSerializer::SaveToBuffer(original, buffer));
+    auto loaded = SceneSerializer::LoadFromMemory(buffer.data(), buffer.size());
+    ASSERT_NE(loaded, nullptr);
+    
+    original->CalculateLayout(800.0f, 600.0f);
+    loaded->CalculateLayout(800.0f, 600.0f);
+    
+    auto originalSibling = original->GetChildren()[1]->AsVisualElement();
+    auto loadedSibling = loaded->GetChildren()[1]->AsVisualElement();
+    EXPECT_FLOAT_EQ(loadedSibling->GetLeft(), originalSibling->GetLeft());
+    EXPECT_FLOAT_EQ(loadedSibling->GetTop(), originalSibling->GetTop());
+}
+
+// 自动尺寸的元素往返后仍然随父元素重新布局，不会被固定为保存时的布局结果
+TEST(SceneSerializerTest, AutoSizeSurvivesRoundTrip) {
+    auto root = boost::make_shared<Box>();
+    root->SetWidth(400.0f);
+    root->SetHeight(300.0f);
+    auto child = boost::make_shared<Box>();
+    child->SetHeight(50.0f);
+    child->SetAlignment(Alignment::Stretch);
+    root->AddChild(child);
+    root->CalculateLayout(400.0f, 300.0f);
+    ASSERT_FLOAT_EQ(child->GetWidth(), 400.0f);
+    
+    std::vector<uint8_t> buffer;
+    ASSERT_TRUE(SceneSerializer::SaveToBuffer(root, buffer));
+    auto loaded = SceneSerializer::LoadFromMemory(buffer.data(), buffer.size());
+    ASSERT_NE(loaded, nullptr);
+    auto loadedChild = loaded->GetChildren()[0]->AsVisualElement();
+    EXPECT_FALSE(loadedChild->HasExplicitWidth());
+    EXPECT_TRUE(loadedChild->HasExplicitHeight());
+    
+    loaded->SetWidth(600.0f);
+    loaded->CalculateLayout(600.0f, 300.0f);
+    EXPECT_FLOAT_EQ(loadedChild->GetWidth(), 600.0f);
+    EXPECT_FLOAT_EQ(loadedChild->GetHeight(), 50.0f);
+}
+
+// 通过内存映射从文件加载
+TEST(SceneSerializerTest, RoundTripFile) {
+    auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("kiui-%%%%-%%%%.kiscene");
+    ASSERT_TRUE(SceneSerializer::Save(CreateSampleTree(), path.string()));
+    
+    auto loaded = SceneSerializer::Load(path.string());
+    boost::filesystem::remove(path);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->GetChildrenCount(), 2u);
+}
+
+// 损坏或截断的数据返回 nullptr
+TEST(SceneSerializerTest, RejectsInvalidData) {
+    std::vector<uint8_t> buffer;
+    ASSERT_TRUE(SceneSerializer::SaveToBuffer(CreateSampleTree(), buffer));
+    
+    EXPECT_EQ(SceneSerializer::LoadFromMemory(buffer.data(), buffer.size() - sizeof(SceneNodeRecord)), nullptr);
+    
+    auto corrupted = buffer;
+    corrupted[0] = 'X';
+    EXPECT_EQ(SceneSerializer::LoadFromMemory(corrupted.data(), corrupted.size()), nullptr);
+    
+    EXPECT_EQ(SceneSerializer::Load("does-not-exist.kiscene"), nullptr);
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "SceneTemplate.hpp"
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+constexpr scene::Style ButtonStyle = scene::Style{}.Size(24.0f, 24.0f).Radius(4.0f).Background(SK_ColorBLUE);
+
+using TitleBar = scene::Node<scene::Style{}.Size(0.0f, 32.0f).Padding(4.0f).Background(SK_ColorDKGRAY),
+    scene::Node<ButtonStyle>,
+    scene::Node<ButtonStyle.Margin(0.0f, 0.0f, 8.0f, 0.0f),
+        scene::Node<scene::Style{}.Size(12.0f, 12.0f).Opacity(0.5f)>>,
+    scene::Node<ButtonStyle.Align(Alignment::End)>>;
+
+// 结构信息在编译期可知
+static_assert(TitleBar::NodeCount == 5, "unexpected node count");
+static_assert(TitleBar::ChildCount == 3, "unexpected child count");
+static_assert(TitleBar::Depth == 3, "unexpected depth");
+static_assert(TitleBar::MakeFlat().childCounts[2] == 1, "unexpected flattened child count");
+static_assert(TitleBar::MakeFlat().subtreeSizes[0] == 5, "unexpected subtree size");
+
+} // namespace
+
+// 实例化后的元素树与模板描述一致
+TEST(SceneTemplateTest, InstantiateBuildsTree) {
+    auto root = scene::Instantiate<TitleBar>();
+    ASSERT_NE(root, nullptr);
+    EXPECT_FLOAT_EQ(root->GetHeight(), 32.0f);
+    EXPECT_FLOAT_EQ(root->GetPadding(Padding::Left), 4.0f);
+    EXPECT_EQ(root->GetBackgroundColor(), SK_ColorDKGRAY);
+    ASSERT_EQ(root->GetChildrenCount(), 3u);
+    
+    auto second = root->GetChildren()[1]->AsVisualElement();
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(second->GetParent(), root);
+    EXPECT_EQ(second->GetIndexInParent(), 1u);
+    EXPECT_FLOAT_EQ(second->GetMargin(Margin::Left), 8.0f);
+    EXPECT_FLOAT_EQ(second->GetBorderRadius(BorderRadius::TopRight), 4.0f);
+    ASSERT_EQ(second->GetChildrenCount(), 1u);
+    
+    auto icon = second->GetChildren()[0]->AsVisualElement();
+    EXPECT_FLOAT_EQ(icon->GetOpacity(), 0.5f);
+    EXPECT_FLOAT_EQ(icon->GetWidth(), 12.0f);
+    
+    auto last = root->GetChildren()[2]->AsVisualElement();
+    EXPECT_EQ(last->GetAlignment(), Alignment::End);
+    EXPECT_FALSE(last->IsUpdating());
+}
+
+// 每次实例化得到独立的元素树
+TEST(SceneTemplateTest, InstancesAreIndependent) {
+    auto first = scene::Instantiate<TitleBar>();
+    auto second = scene::Instantiate<TitleBar>();
+    ASSERT_NE(first, second);
+    
+    first->RemoveChildAt(0);
+    EXPECT_EQ(first->GetChildrenCount(), 2u);
+    EXPECT_EQ(second->GetChildrenCount(), 3u);
+    
+    // 子元素在根节点释放后仍然有效（内存池由所有元素共同持有）
+    auto detached = second->GetChildren()[0];
+    second->RemoveChild(detached);
+    second.reset();
+    EXPECT_EQ(detached->GetParent(), nullptr);
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Box.hpp"
+#include "SceneRenderer.hpp"
+#include "ScrollViewer.hpp"
+#include <include/core/SkSurface.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <boost/make_shared.hpp>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+constexpr int kViewportSize = 100;
+constexpr int kStripeCount = 50;
+constexpr float kStripeHeight = 20.0f;
+
+boost::shared_ptr<Box> MakeStripe(float top, SkColor color) {
+    auto box = boost::make_shared<Box>();
+    box->SetTop(top);
+    box->SetWidth(100.0f);
+    box->SetHeight(kStripeHeight);
+    box->SetBackgroundColor(color);
+    return box;
+}
+
+// 100x100 的视口中纵向排列 50 条不同颜色的横条
+struct ScrollScene {
+    boost::shared_ptr<Box> root;
+    boost::shared_ptr<ScrollViewer> viewer;
+    std::vector<boost::shared_ptr<Box>> stripes;
+};
+
+ScrollScene CreateScrollScene() {
+    ScrollScene scene;
+    scene.root = boost::make_shared<Box>();
+    scene.root->SetWidth(kViewportSize);
+    scene.root->SetHeight(kViewportSize);
+    scene.root->SetBackgroundColor(SK_ColorWHITE);
+
+    scene.viewer = boost::make_shared<ScrollViewer>();
+    scene.viewer->SetWidth(kViewportSize);
+    scene.viewer->SetHeight(kViewportSize);
+    auto content = boost::make_shared<Box>();
+    content->SetWidth(100.0f);
+    content->SetHeight(kStripeCount * kStripeHeight);
+    for (int i = 0; i < kStripeCount; ++i) {
+        const SkColor color = SkColorSetRGB(static_cast<U8CPU>(i * 5), static_cast<U8CPU>(255 - i * 5), 128);
+        scene.stripes.push_back(MakeStripe(i * kStripeHeight, color));
+        content->AddChild(scene.stripes.back());
+    }
+    scene.viewer->SetContent(content);
+    scene.root->AddChild(scene.viewer);
+    return scene;
+}
+
+// 与不使用缓存的渲染器逐像素比较
+void ExpectMatchesFreshRender(const ScrollScene& scene, const sk_sp<SkImage>& image) {
+    SceneRenderer fresh;
+    fresh.SetRoot(scene.root);
+    fresh.SetBatchingEnabled(false);
+    auto expected = test::RenderScene(fresh, kViewportSize, kViewportSize);
+    SkPixmap actualPixels;
+    SkPixmap expectedPixels;
+    ASSERT_TRUE(image->peekPixels(&actualPixels));
+    ASSERT_TRUE(expected->peekPixels(&expectedPixels));
+    for (int y = 0; y < kViewportSize; ++y) {
+        for (int x = 0; x < kViewportSize; ++x) {
+            ASSERT_EQ(actualPixels.getColor(x, y), expectedPixels.getColor(x, y)) << "at " << x << "," << y;
+        }
+    }
+}
+
+} // namespace
+
+// 滚动只平移图层并光栅化新露出的横条，不改变视口自身的版本
+TEST(ScrollViewerTest, ScrollRasterizesOnlyExposedStrip) {
+    auto scene = CreateScrollScene();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+
+    test::RenderScene(renderer, kViewportSize, kViewportSize);
+    EXPECT_EQ(renderer.GetScrollLayerRenders(), 1u);
+    test::RenderScene(renderer, kViewportSize, kViewportSize);
+    EXPECT_EQ(renderer.GetScrollLayerHits(), 1u);
+    EXPECT_EQ(renderer.GetScrollLayerRasterizedPixels(), 0u);
+
+    const uint64_t version = scene.viewer->GetSubtreeVersion();
+    scene.viewer->ScrollBy(0.0f, 7.0f);
+    EXPECT_EQ(scene.viewer->GetSubtreeVersion(), version);
+    auto image = test::RenderScene(renderer, kViewportSize, kViewportSize);
+    EXPECT_EQ(renderer.GetScrollLayerScrolls(), 1u);
+    EXPECT_EQ(renderer.GetScrollLayerRenders(), 0u);
+    EXPECT_EQ(renderer.GetScrollLayerRasterizedPixels(), static_cast<uint64_t>(kViewportSize * 7));
+    ExpectMatchesFreshRender(scene, image);
+
+    // 向回滚动露出顶部
+    scene.viewer->ScrollBy(0.0f, -3.0f);
+    image = test::RenderScene(renderer, kViewportSize, kViewportSize);
+    EXPECT_EQ(renderer.GetScrollLayerScrolls(), 1u);
+    ExpectMatchesFreshRender(scene, image);
+}
+
+// 内容变化后整个图层重新绘制
+TEST(ScrollViewerTest, ContentChangeRepaintsLayer) {
+    auto scene = CreateScrollScene();
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.root);
+    scene.viewer->SetScrollOffset(0.0f, 30.0f);
+    test::RenderScene(renderer, kViewportSize, kViewportSize);
+
+    scene.stripes[2]->SetBackgroundColor(SK_ColorBLACK);
+    auto image = test::RenderScene(renderer, kViewportSize, kViewportSize);
+    EXPECT_EQ(renderer.GetScrollLayerRenders(), 1u);
+    SkPixmap pixels;
+    ASSERT_TRUE(image->peekPixels(&pixels));
+    EXPECT_EQ(pixels.getColor(50, 15), SK_ColorBLACK);
+    ExpectMatchesFreshRender(scene, image);
+}
+
+// 滚动偏移限制在内容范围内并取整，命中测试跟随滚动
+TEST(ScrollViewerTest, OffsetIsClampedAndHitTested) {
+    auto scene = CreateScrollScene();
+    scene.viewer->SetScrollOffset(0.0f, 1e6f);
+    EXPECT_FLOAT_EQ(scene.viewer->GetScrollY(), kStripeCount * kStripeHeight - kViewportSize);
+    scene.viewer->SetScrollOffset(5.0f, 3.6f);
+    EXPECT_FLOAT_EQ(scene.viewer->GetScrollX(), 0.0f);
+    EXPECT_FLOAT_EQ(scene.viewer->GetScrollY(), 4.0f);
+
+    scene.viewer->SetScrollOffset(0.0f, 30.0f);
+    EXPECT_EQ(scene.root->HitTest(50.0f, 5.0f), scene.stripes[1]);
+    EXPECT_EQ(scene.root->HitTest(50.0f, 95.0f), scene.stripes[6]);
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "TestFonts.hpp"
+#include "TestRendering.hpp"
+#include "Text.hpp"
+#include <GlyphAtlas.hpp>
+#include <TextEngine.hpp>
+#include <include/core/SkImage.h>
+#include <include/core/SkPicture.h>
+#include <include/core/SkPictureRecorder.h>
+#include <include/core/SkPixmap.h>
+#include <include/core/SkSurface.h>
+#include <boost/make_shared.hpp>
+#include <cstring>
+#include <string>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+using test::LoadTestFont;
+using test::RenderElement;
+
+int CountInkedPixels(const sk_sp<SkImage>& image) {
+    SkPixmap pixmap;
+    EXPECT_TRUE(image->peekPixels(&pixmap));
+    int count = 0;
+    for (int y = 0; y < pixmap.height(); ++y) {
+        for (int x = 0; x < pixmap.width(); ++x) {
+            if (SkColorGetA(pixmap.getColor(x, y)) != 0) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+// 没有可用字体时不排版、不绘制
+TEST(TextTest, InvalidFontDrawsNothing) {
+    auto text = boost::make_shared<Text>();
+    text->SetText("hello");
+    text->SetFont(1000);
+    EXPECT_EQ(text->GetShapedRun(), nullptr);
+    EXPECT_EQ(CountInkedPixels(RenderElement(*text, 40, 20)), 0);
+}
+
+// 相同的（文字、字体、字号、特性）只排版一次，元素之间共享结果
+TEST(TextTest, ShapedRunsAreCached) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    graphics::TextEngine& engine = graphics::TextEngine::GetSharedInstance();
+    engine.ClearShapeCache();
+    const auto before = engine.GetShapeCacheStats();
+
+    auto first = boost::make_shared<Text>();
+    first->SetFont(font);
+    first->SetText("Quantity");
+    auto second = boost::make_shared<Text>();
+    second->SetFont(font);
+    second->SetText("Quantity");
+
+    auto run = first->GetShapedRun();
+    ASSERT_NE(run, nullptr);
+    EXPECT_EQ(run->glyphs.size(), 8u);
+    EXPECT_GT(run->advance, 0.0f);
+    EXPECT_EQ(second->GetShapedRun().get(), run.get());
+    // 元素自己持有结果，重复获取不再查询缓存
+    first->GetShapedRun();
+
+    auto stats = engine.GetShapeCacheStats();
+    EXPECT_EQ(stats.misses - before.misses, 1u);
+    EXPECT_EQ(stats.hits - before.hits, 1u);
+
+    // 特性和字号是缓存键的一部分
+    second->SetFontFeatures({"kern=0"});
+    EXPECT_NE(second->GetShapedRun().get(), run.get());
+    second->SetFontFeatures({});
+    second->SetFontSize(20.0f);
+    EXPECT_NE(second->GetShapedRun().get(), run.get());
+    EXPECT_EQ(engine.GetShapeCacheStats().misses - before.misses, 3u);
+}
+
+// 字形光栅化进图集后重复绘制不再光栅化
+TEST(TextTest, GlyphsAreRasterizedOnce) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    auto text = boost::make_shared<Text>();
+    text->SetFont(font);
+    text->SetText("atlas");
+    text->SetForegroundColor(SK_ColorBLACK);
+
+    EXPECT_GT(CountInkedPixels(RenderElement(*text, 80, 30)), 0);
+    const auto afterFirst = graphics::GlyphAtlas::GetSharedInstance().GetStats();
+    EXPECT_GT(CountInkedPixels(RenderElement(*text, 80, 30)), 0);
+    EXPECT_EQ(graphics::GlyphAtlas::GetSharedInstance().GetStats().rasterized, afterFirst.rasterized);
+}
+
+// 独立的图集放满后清空重建，绘制不受影响
+TEST(TextTest, SmallAtlasResetsWhenFull) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    auto run = graphics::TextEngine::GetSharedInstance().Shape("ABCDEFGHIJ", font, 16.0f);
+    ASSERT_NE(run, nullptr);
+
+    graphics::GlyphAtlas atlas(40, 24);
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(200, 30));
+    surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+    atlas.DrawRun(surface->getCanvas(), *run, 0.0f, run->metrics.ascent, SK_ColorBLACK);
+    auto otherRun = graphics::TextEngine::GetSharedInstance().Shape("KLMNOPQRST", font, 16.0f);
+    atlas.DrawRun(surface->getCanvas(), *otherRun, 0.0f, run->metrics.ascent, SK_ColorBLACK);
+    EXPECT_GT(atlas.GetStats().resets, 0u);
+    EXPECT_GT(CountInkedPixels(surface->makeImageSnapshot()), 0);
+}
+
+// 录制的画布持有图集快照：之后图集新增字形或清空重建，回放的结果不变
+TEST(TextTest, RecordedRunKeepsAtlasSnapshot) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    auto run = graphics::TextEngine::GetSharedInstance().Shape("ABCDE", font, 16.0f);
+    auto otherRun = graphics::TextEngine::GetSharedInstance().Shape("KLMNOPQRST", font, 16.0f);
+    ASSERT_NE(run, nullptr);
+    ASSERT_NE(otherRun, nullptr);
+
+    graphics::GlyphAtlas atlas(40, 24);
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(120, 30);
+    auto expected = SkSurfaces::Raster(info);
+    expected->getCanvas()->clear(SK_ColorTRANSPARENT);
+    atlas.DrawRun(expected->getCanvas(), *run, 0.0f, run->metrics.ascent, SK_ColorBLACK);
+
+    SkPictureRecorder recorder;
+    atlas.DrawRun(recorder.beginRecording(SkRect::MakeWH(120, 30)), *run, 0.0f, run->metrics.ascent, SK_ColorBLACK);
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    auto scratch = SkSurfaces::Raster(info);
+    atlas.DrawRun(scratch->getCanvas(), *otherRun, 0.0f, run->metrics.ascent, SK_ColorBLACK);
+    EXPECT_GT(atlas.GetStats().resets, 0u);
+
+    auto replayed = SkSurfaces::Raster(info);
+    replayed->getCanvas()->clear(SK_ColorTRANSPARENT);
+    picture->playback(replayed->getCanvas());
+
+    SkPixmap expectedPixels;
+    SkPixmap replayedPixels;
+    sk_sp<SkImage> expectedImage = expected->makeImageSnapshot();
+    sk_sp<SkImage> replayedImage = replayed->makeImageSnapshot();
+    ASSERT_TRUE(expectedImage->peekPixels(&expectedPixels));
+    ASSERT_TRUE(replayedImage->peekPixels(&replayedPixels));
+    EXPECT_GT(CountInkedPixels(replayedImage), 0);
+    for (int y = 0; y < info.height(); ++y) {
+        ASSERT_EQ(std::memcmp(expectedPixels.addr32(0, y), replayedPixels.addr32(0, y), info.minRowBytes()), 0)
+            << "row " << y;
+    }
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "TestFonts.hpp"
+#include "TextArea.hpp"
+#include "TextBuffer.hpp"
+#include <TextEngine.hpp>
+#include <include/core/SkSurface.h>
+#include <boost/make_shared.hpp>
+#include <string>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+using test::LoadTestFont;
+
+std::string MakeLog(size_t lines) {
+    std::string text;
+    for (size_t i = 0; i < lines; ++i) {
+        text += "[info] request " + std::to_string(i) + " completed in 12 ms\n";
+    }
+    return text;
+}
+
+void RenderArea(TextArea& area) {
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(static_cast<int>(area.GetWidth()),
+                                                                 static_cast<int>(area.GetHeight())));
+    area.Render(surface->getCanvas());
+}
+
+} // namespace
+
+// 插入、删除后内容和行号换算保持一致
+TEST(TextBufferTest, EditsKeepLineIndex) {
+    TextBuffer buffer("first\nsecond\nthird");
+    EXPECT_EQ(buffer.GetLineCount(), 3u);
+    EXPECT_EQ(buffer.GetLineText(1), "second");
+
+    buffer.Insert(6, "new\n");
+    EXPECT_EQ(buffer.GetText(), "first\nnew\nsecond\nthird");
+    EXPECT_EQ(buffer.GetLineCount(), 4u);
+    EXPECT_EQ(buffer.GetLineStart(2), 10u);
+    EXPECT_EQ(buffer.GetLineFromOffset(11), 2u);
+
+    // 跨越多个片段删除，合并两行
+    buffer.Erase(3, 9);
+    EXPECT_EQ(buffer.GetText(), "fircond\nthird");
+    EXPECT_EQ(buffer.GetLineCount(), 2u);
+    EXPECT_EQ(buffer.GetLineText(1), "third");
+    EXPECT_EQ(buffer.GetLineLength(0), 7u);
+}
+
+// 连续输入并入同一个片段，片段数不随按键增长
+TEST(TextBufferTest, TypingCoalescesPieces) {
+    TextBuffer buffer(MakeLog(1000));
+    const size_t offset = buffer.GetLineStart(500);
+    for (int i = 0; i < 100; ++i) {
+        buffer.Insert(offset + i, "x");
+    }
+    EXPECT_EQ(buffer.GetPieceCount(), 3u);
+    EXPECT_EQ(buffer.GetLineText(500).substr(0, 100), std::string(100, 'x'));
+}
+
+// 编辑只让涉及的段落失效
+TEST(TextAreaTest, EditsInvalidateTouchedParagraphs) {
+    auto area = boost::make_shared<TextArea>();
+    area->SetText(MakeLog(100));
+    EXPECT_EQ(area->GetParagraphCount(), 101u);
+    const float lineHeight = area->GetLineHeight();
+    EXPECT_FLOAT_EQ(area->GetContentHeight(), 101 * lineHeight);
+
+    area->Insert(area->GetBuffer().GetLineStart(10), "a\nb\n");
+    EXPECT_EQ(area->GetParagraphCount(), 103u);
+    EXPECT_FLOAT_EQ(area->GetContentHeight(), 103 * lineHeight);
+
+    area->Erase(area->GetBuffer().GetLineStart(10), 4);
+    EXPECT_EQ(area->GetParagraphCount(), 101u);
+    EXPECT_EQ(area->GetText(), MakeLog(100));
+}
+
+// 只排版可见的段落，按键只重新断行一个段落
+TEST(TextAreaTest, ShapesOnlyVisibleParagraphs) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    auto area = boost::make_shared<TextArea>();
+    area->SetFont(font);
+    area->SetWidth(300.0f);
+    area->SetHeight(100.0f);
+    area->SetText(MakeLog(20000));
+
+    RenderArea(*area);
+    const auto first = area->GetStats();
+    const size_t visible = static_cast<size_t>(100.0f / area->GetLineHeight()) + 2;
+    EXPECT_GT(first.shapedParagraphs, 0u);
+    EXPECT_LE(first.shapedParagraphs, visible);
+    EXPECT_EQ(first.paragraphsBroken, first.shapedParagraphs);
+
+    area->Insert(area->GetBuffer().GetLineStart(1) + 3, "x");
+    RenderArea(*area);
+    EXPECT_EQ(area->GetStats().paragraphsBroken, first.paragraphsBroken + 1);
+
+    // 滚动到文档末尾，离开视口的段落释放排版结果
+    area->SetScrollOffset(area->GetContentHeight() - 100.0f);
+    RenderArea(*area);
+    EXPECT_LE(area->GetStats().shapedParagraphs, visible);
+}
+
+// 长段落按视口宽度在空格处换行
+TEST(TextAreaTest, WrapsLongParagraphs) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    auto area = boost::make_shared<TextArea>();
+    area->SetFont(font);
+    area->SetWidth(120.0f);
+    area->SetHeight(200.0f);
+    area->SetText("the quick brown fox jumps over the lazy dog\nend");
+    RenderArea(*area);
+    EXPECT_GT(area->GetContentHeight(), 2 * area->GetLineHeight());
+
+    area->SetWrap(false);
+    RenderArea(*area);
+    EXPECT_FLOAT_EQ(area->GetContentHeight(), 2 * area->GetLineHeight());
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "TestFonts.hpp"
+#include <GlyphAtlas.hpp>
+#include <TextDiskCache.hpp>
+#include <TextEngine.hpp>
+#include <include/core/SkSurface.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace KiUI {
+namespace graphics {
+
+namespace {
+
+using test::LoadTestFont;
+
+std::filesystem::path MakeTempCacheFile(const std::string& name) {
+    auto path = std::filesystem::temp_directory_path() / ("kiui_text_cache_" + name + ".bin");
+    std::filesystem::remove(path);
+    return path;
+}
+
+} // namespace
+
+// 不存在或格式不对的文件不会被加载
+TEST(TextDiskCacheTest, RejectsMissingAndInvalidFiles) {
+    auto path = MakeTempCacheFile("invalid");
+    EXPECT_FALSE(TextDiskCache::Load(path.string()));
+
+    std::ofstream(path, std::ios::binary) << "not a text cache";
+    TextDiskCache::Stats stats;
+    EXPECT_FALSE(TextDiskCache::Load(path.string(), &stats));
+    EXPECT_EQ(stats.glyphsLoaded, 0u);
+    std::filesystem::remove(path);
+}
+
+// 保存后清空内存中的缓存（模拟重新启动），加载后不需要重新排版和光栅化
+TEST(TextDiskCacheTest, RestoresGlyphsAndRuns) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    TextEngine& engine = TextEngine::GetSharedInstance();
+    GlyphAtlas& atlas = GlyphAtlas::GetSharedInstance();
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(200, 40));
+
+    auto run = engine.Shape("Cold start", font, 16.0f, {"kern"});
+    ASSERT_NE(run, nullptr);
+    atlas.DrawRun(surface->getCanvas(), *run, 0.0f, 20.0f, SK_ColorBLACK);
+
+    auto path = MakeTempCacheFile("roundtrip");
+    ASSERT_TRUE(TextDiskCache::Save(path.string()));
+    engine.ClearShapeCache();
+    atlas.Clear();
+
+    TextDiskCache::Stats stats;
+    ASSERT_TRUE(TextDiskCache::Load(path.string(), &stats));
+    EXPECT_EQ(stats.fontsMatched, 1u);
+    EXPECT_GT(stats.glyphsLoaded, 0u);
+    EXPECT_GE(stats.runsLoaded, 1u);
+
+    const auto shapeBefore = engine.GetShapeCacheStats();
+    auto restored = engine.Shape("Cold start", font, 16.0f, {"kern"});
+    ASSERT_NE(restored, nullptr);
+    EXPECT_EQ(engine.GetShapeCacheStats().hits - shapeBefore.hits, 1u);
+    ASSERT_EQ(restored->glyphs.size(), run->glyphs.size());
+    EXPECT_FLOAT_EQ(restored->advance, run->advance);
+
+    const auto atlasBefore = atlas.GetStats();
+    atlas.DrawRun(surface->getCanvas(), *restored, 0.0f, 20.0f, SK_ColorBLACK);
+    EXPECT_EQ(atlas.GetStats().rasterized, atlasBefore.rasterized);
+    std::filesystem::remove(path);
+}
+
+// 损坏的特性数量不会导致超大分配，对应的字体段按跳过处理
+TEST(TextDiskCacheTest, SkipsSectionWithCorruptedFeatureCount) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    TextEngine& engine = TextEngine::GetSharedInstance();
+    engine.ClearShapeCache();
+    GlyphAtlas::GetSharedInstance().Clear();
+    const std::string text = "Corrupted features";
+    ASSERT_NE(engine.Shape(text, font, 16.0f, {"kern"}), nullptr);
+
+    auto path = MakeTempCacheFile("corrupted");
+    ASSERT_TRUE(TextDiskCache::Save(path.string()));
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // 排版记录中文字之后紧跟特性数量
+    auto it = std::search(bytes.begin(), bytes.end(), text.begin(), text.end());
+    ASSERT_NE(it, bytes.end());
+    const uint32_t hugeCount = 0xFFFFFFFFu;
+    std::memcpy(&*(it + text.size()), &hugeCount, sizeof(hugeCount));
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+
+    engine.ClearShapeCache();
+    TextDiskCache::Stats stats;
+    ASSERT_TRUE(TextDiskCache::Load(path.string(), &stats));
+    EXPECT_EQ(stats.fontsMatched, 0u);
+    EXPECT_EQ(stats.fontsSkipped, 1u);
+    EXPECT_EQ(stats.runsLoaded, 0u);
+    std::filesystem::remove(path);
+}
+
+} // namespace graphics
+} // namespace KiUI
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "TestFonts.hpp"
+#include "Box.hpp"
+#include "Text.hpp"
+#include "TextMeasureCache.hpp"
+#include <TextEngine.hpp>
+#include <boost/make_shared.hpp>
+#include <cmath>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+using test::LoadTestFont;
+
+// 按内容测量的固定尺寸元素，记录测量次数
+class CountingElement : public VisualElement {
+public:
+    CountingElement() { SetMeasured(true); }
+
+    void SetContentSize(float width, float height) {
+        contentWidth_ = width;
+        contentHeight_ = height;
+        InvalidateMeasure();
+    }
+
+    void Render(SkCanvas*) override {}
+
+    int measureCount = 0;
+
+protected:
+    SkSize MeasureContent(float, YGMeasureMode, float, YGMeasureMode) override {
+        ++measureCount;
+        return SkSize::Make(contentWidth_, contentHeight_);
+    }
+
+private:
+    float contentWidth_ = 0.0f;
+    float contentHeight_ = 0.0f;
+};
+
+} // namespace
+
+// Undefined 模式下的 NaN 宽度归一化后可以命中
+TEST(TextMeasureTest, UndefinedWidthKeysMatch) {
+    auto a = TextMeasureCache::MakeKey(1, 2, 0, 14.0f, NAN, YGMeasureModeUndefined);
+    auto b = TextMeasureCache::MakeKey(1, 2, 0, 14.0f, NAN, YGMeasureModeUndefined);
+    EXPECT_TRUE(a == b);
+    auto atMost = TextMeasureCache::MakeKey(1, 2, 0, 14.0f, 100.0f, YGMeasureModeAtMost);
+    EXPECT_FALSE(a == atMost);
+    EXPECT_NE(TextMeasureCache::HashContent("Total"), TextMeasureCache::HashContent("Totals"));
+}
+
+// 超出容量时淘汰最久未使用的条目
+TEST(TextMeasureTest, EvictsLeastRecentlyUsed) {
+    TextMeasureCache& cache = TextMeasureCache::GetSharedInstance();
+    cache.Clear();
+    cache.SetCapacity(2);
+    auto first = TextMeasureCache::MakeKey(1, 0, 0, 14.0f, 0.0f, YGMeasureModeUndefined);
+    auto second = TextMeasureCache::MakeKey(2, 0, 0, 14.0f, 0.0f, YGMeasureModeUndefined);
+    auto third = TextMeasureCache::MakeKey(3, 0, 0, 14.0f, 0.0f, YGMeasureModeUndefined);
+    cache.Insert(first, SkSize::Make(10.0f, 5.0f));
+    cache.Insert(second, SkSize::Make(20.0f, 5.0f));
+    SkSize size;
+    EXPECT_TRUE(cache.Find(first, &size));
+    cache.Insert(third, SkSize::Make(30.0f, 5.0f));
+
+    EXPECT_TRUE(cache.Find(first, &size));
+    EXPECT_EQ(size.width(), 10.0f);
+    EXPECT_FALSE(cache.Find(second, &size));
+    EXPECT_EQ(cache.GetStats().entryCount, 2u);
+    cache.SetCapacity(TextMeasureCache::kDefaultCapacity);
+    cache.Clear();
+}
+
+// 没有设置宽高的元素由测量函数决定尺寸，布局没有变化时不再测量
+TEST(TextMeasureTest, MeasureFunctionSizesElement) {
+    auto root = boost::make_shared<Box>();
+    root->SetWidth(200.0f);
+    root->SetHeight(100.0f);
+    root->SetAlignment(Alignment::Start);
+    auto child = boost::make_shared<CountingElement>();
+    child->SetContentSize(42.0f, 12.0f);
+    root->AddChild(child);
+
+    root->CalculateLayout(200.0f, 100.0f);
+    EXPECT_EQ(child->GetWidth(), 42.0f);
+    EXPECT_EQ(child->GetHeight(), 12.0f);
+    EXPECT_GT(child->measureCount, 0);
+
+    // 布局后宽高不会被写回样式，内容变化时元素可以缩小
+    const int count = child->measureCount;
+    root->CalculateLayout(200.0f, 100.0f);
+    EXPECT_EQ(child->measureCount, count);
+    child->SetContentSize(30.0f, 12.0f);
+    EXPECT_TRUE(root->IsLayoutDirty());
+    root->CalculateLayout(200.0f, 100.0f);
+    EXPECT_EQ(child->GetWidth(), 30.0f);
+}
+
+// 相同内容的标签共享测量结果，只有第一个需要排版
+TEST(TextMeasureTest, IdenticalLabelsHitCache) {
+    const int font = LoadTestFont();
+    if (font < 0) {
+        GTEST_SKIP() << "no test font available";
+    }
+    TextMeasureCache& cache = TextMeasureCache::GetSharedInstance();
+    cache.Clear();
+    const auto before = cache.GetStats();
+
+    auto root = boost::make_shared<Box>();
+    root->SetWidth(400.0f);
+    root->SetHeight(400.0f);
+    root->SetAlignment(Alignment::Start);
+    std::vector<boost::shared_ptr<Text>> labels;
+    for (int i = 0; i < 10; ++i) {
+        auto label = boost::make_shared<Text>();
+        label->SetFont(font);
+        label->SetText("Quantity");
+        root->AddChild(label);
+        labels.push_back(label);
+    }
+    root->CalculateLayout(400.0f, 400.0f);
+
+    auto run = labels.front()->GetShapedRun();
+    ASSERT_NE(run, nullptr);
+    for (const auto& label : labels) {
+        EXPECT_EQ(label->GetWidth(), std::ceil(run->advance));
+        EXPECT_EQ(label->GetHeight(), std::ceil(run->metrics.GetLineHeight()));
+    }
+    const auto stats = cache.GetStats();
+    EXPECT_LT(stats.entryCount, labels.size());
+    EXPECT_GE(stats.hits - before.hits, 9u);
+
+    // 内容变化后重新测量
+    labels.back()->SetText("Quantity (total)");
+    root->CalculateLayout(400.0f, 400.0f);
+    EXPECT_GT(labels.back()->GetWidth(), labels.front()->GetWidth());
+}
+
+} // namespace widget
+} // namespace KiUI
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "TestRendering.hpp"
+#include "Box.hpp"
+#include "SceneRenderer.hpp"
+#include "TiledView.hpp"
+#include <window.hpp>
+#include <include/core/SkSurface.h>
+#include <include/core/SkImage.h>
+#include <include/core/SkPixmap.h>
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace KiUI {
+namespace widget {
+
+namespace {
+
+constexpr int kViewSize = 512;
+constexpr int kCellCount = 20;
+constexpr float kCellSize = 200.0f;
+constexpr size_t kTileBytes = TiledView::kDefaultTileSize * TiledView::kDefaultTileSize * 4;
+
+SkColor CellColor(int row, int column) {
+    return SkColorSetRGB(static_cast<U8CPU>(row * 12), static_cast<U8CPU>(column * 12), 100);
+}
+
+// 512x512 的视图显示 4000x4000 的内容：20x20 个不同颜色的方格
+struct TiledScene {
+    boost::shared_ptr<TiledView> view;
+    boost::shared_ptr<Box> content;
+    std::vector<boost::shared_ptr<Box>> cells;
+};
+
+TiledScene CreateTiledScene(bool background) {
+    TiledScene scene;
+    scene.view = boost::make_shared<TiledView>();
+    scene.view->SetWidth(kViewSize);
+    scene.view->SetHeight(kViewSize);
+    scene.view->SetBackgroundColor(SK_ColorWHITE);
+    scene.view->SetBackgroundRasterization(background);
+
+    scene.content = boost::make_shared<Box>();
+    scene.content->SetWidth(kCellCount * kCellSize);
+    scene.content->SetHeight(kCellCount * kCellSize);
+    for (int row = 0; row < kCellCount; ++row) {
+        for (int column = 0; column < kCellCount; ++column) {
+            auto cell = boost::make_shared<Box>();
+            cell->SetLeft(column * kCellSize);
+            cell->SetTop(row * kCellSize);
+            cell->SetWidth(kCellSize);
+            cell->SetHeight(kCellSize);
+            cell->SetBackgroundColor(CellColor(row, column));
+            scene.content->AddChild(cell);
+            scene.cells.push_back(cell);
+        }
+    }
+    scene.view->SetContent(scene.content);
+    return scene;
+}
+
+// 不经过瓦片直接绘制平移后的内容，与瓦片合成的结果逐像素比较
+void ExpectMatchesContent(const TiledScene& scene, const sk_sp<SkImage>& image) {
+    auto surface = test::MakeRasterSurface(kViewSize, kViewSize, SK_ColorWHITE);
+    surface->getCanvas()->translate(-scene.view->GetViewX(), -scene.view->GetViewY());
+    SceneRenderer renderer;
+    renderer.SetRoot(scene.content);
+    renderer.Render(surface->getCanvas());
+    auto expected = surface->makeImageSnapshot();
+
+    SkPixmap actualPixels;
+    SkPixmap expectedPixels;
+    ASSERT_TRUE(image->peekPixels(&actualPixels));
+    ASSERT_TRUE(expected->peekPixels(&expectedPixels));
+    for (int y = 0; y < kViewSize; ++y) {
+        for (int x = 0; x < kViewSize; ++x) {
+            ASSERT_EQ(actualPixels.getColor(x, y), expectedPixels.getColor(x, y)) << "at " << x << "," << y;
+        }
+    }
+}
+
+// 在 UI 线程轮询后台光栅化的回调，直到没有排队的瓦片
+void WaitForTiles(const boost::shared_ptr<TiledView>& view) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (view->GetStats().pendingTiles > 0 && std::chrono::steady_clock::now() < deadline) {
+        foundation::WindowManager::GetSharedInstance().PollMainThreadTasks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+// 内容只录制一次；平移只光栅化新露出的瓦片，回到原处时复用缓存
+TEST(TiledViewTest, PanReusesCachedTiles) {
+    auto scene = CreateTiledScene(false);
+    auto image = test::RenderElement(*scene.view, kViewSize, kViewSize);
+    EXPECT_EQ(scene.view->GetStats().pictureRecords, 1u);
+    EXPECT_EQ(scene.view->GetStats().tilesRasterized, 4u);
+    ExpectMatchesContent(scene, image);
+
+    scene.view->PanBy(100.0f, 0.0f);
+    image = test::RenderElement(*scene.view, kViewSize, kViewSize);
+    EXPECT_EQ(scene.view->GetStats().tilesRasterized, 6u);
+    ExpectMatchesContent(scene, image);
+
+    scene.view->SetViewOffset(0.0f, 0.0f);
+    test::RenderElement(*scene.view, kViewSize, kViewSize);
+    EXPECT_EQ(scene.view->GetStats().pictureRecords, 1u);
+    EXPECT_EQ(scene.view->GetStats().tilesRasterized, 6u);
+    EXPECT_EQ(scene.view->GetStats().tilesMissing, 0u);
+}
+
+// 内容变化后重新录制图片并重新光栅化可见瓦片
+TEST(TiledViewTest, ContentChangeRecordsNewPicture) {
+    auto scene = CreateTiledScene(false);
+    test::RenderElement(*scene.view, kViewSize, kViewSize);
+
+    scene.cells[1]->SetBackgroundColor(SK_ColorBLACK);
+    auto image = test::RenderElement(*scene.view, kViewSize, kViewSize);
+    EXPECT_EQ(scene.view->GetStats().pictureRecords, 2u);
+    EXPECT_EQ(scene.view->GetStats().tilesRasterized, 8u);
+    SkPixmap pixels;
+    ASSERT_TRUE(image->peekPixels(&pixels));
+    EXPECT_EQ(pixels.getColor(300, 100), SK_ColorBLACK);
+    ExpectMatchesContent(scene, image);
+}
+
+// 录制内容不开始新的一帧：内容的 Paint 标记留给外层渲染器在它的帧开始时清除
+TEST(TiledViewTest, RecordingKeepsOuterFrameState) {
+    auto scene = CreateTiledScene(false);
+    test::RenderElement(*scene.view, kViewSize, kViewSize);
+
+    scene.cells[1]->SetBackgroundColor(SK_ColorBLACK);
+    test::RenderElement(*scene.view, kViewSize, kViewSize);
+    EXPECT_EQ(scene.view->GetStats().pictureRecords, 2u);
+    EXPECT_NE(scene.cells[1]->GetDirtyFlags() & DirtyFlags::Paint, DirtyFlags::None);
+}
+
+// 瓦片缓存不超过预算，最久未使用的瓦片被淘汰
+TEST(TiledViewTest, CacheStaysWithinBudget) {
+    auto scene = CreateTiledScene(false);
+    scene.view->SetTileBudget(12 * kTileBytes);
+    for (int step = 0; step < 12; ++step) {
+        scene.view->SetViewOffset(step * 300.0f, step * 250.0f);
+        auto image = test::RenderElement(*scene.view, kViewSize, kViewSize);
+        EXPECT_LE(scene.view->GetStats().cachedBytes, 12 * kTileBytes);
+        if (step == 11) {
+            ExpectMatchesContent(scene, image);
+        }
+    }
+    EXPECT_GT(scene.view->GetStats().tilesEvicted, 0u);
+    EXPECT_LE(scene.view->GetStats().cachedTiles, 12u);
+}
+
+// 后台光栅化期间先绘制已有瓦片：缩放后缺少的瓦片由旧比例的瓦片缩放填充
+TEST(TiledViewTest, BackgroundTilesFillProgressively) {
+    auto scene = CreateTiledScene(true);
+    auto image = test::RenderElement(*scene.view, kViewSize, kViewSize);
+    EXPECT_EQ(scene.view->GetStats().tilesDrawn, 0u);
+    EXPECT_GT(scene.view->GetStats().pendingTiles, 0u);
+    WaitForTiles(scene.view);
+    image = test::RenderElement(*scene.view, kViewSize, kViewSize);
+    EXPECT_EQ(scene.view->GetStats().tilesDrawn, 4u);
+    ExpectMatchesContent(scene, image);
+
+    // 缩小一半：新比例的瓦片还没有光栅化，视图左上角仍然显示内容而不是背景
+    scene.view->SetZoom(0.5f);
+    const uint64_t missing = scene.view->GetStats().tilesMissing;
+    image = test::RenderElement(*scene.view, kViewSize, kViewSize);
+    EXPECT_GT(scene.view->GetStats().tilesMissing, missing);
+    SkPixmap pixels;
+    ASSERT_TRUE(image->peekPixels(&pixels));
+    EXPECT_EQ(pixels.getColor(50, 50), CellColor(0, 0));
+
+    WaitForTiles(scene.view);
+    image = test::RenderElement(*scene.view, kViewSize, kViewSize);
+    ASSERT_TRUE(image->peekPixels(&pixels));
+    EXPECT_EQ(pixels.getColor(150, 50), CellColor(0, 1));
+    EXPECT_EQ(pixels.getColor(350, 450), CellColor(4, 3));
+}
+
+// 命中测试按视图偏移和缩放找到内容中的元素，锚点缩放保持锚点下的内容不动
+TEST(TiledViewTest, HitTestFollowsPanAndZoom) {
+    auto scene = CreateTiledScene(false);
+    EXPECT_EQ(scene.view->HitTest(250.0f, 50.0f), scene.cells[1]);
+
+    scene.view->SetViewOffset(400.0f, 200.0f);
+    EXPECT_EQ(scene.view->HitTest(50.0f, 50.0f), scene.cells[kCellCount + 2]);
+
+    // 锚点 (100, 100) 下是内容坐标 (500, 300)
+    scene.view->ZoomAt(2.0f, 100.0f, 100.0f);
+    EXPECT_FLOAT_EQ(scene.view->GetViewX(), 900.0f);
+    EXPECT_FLOAT_EQ(scene.view->GetViewY(), 500.0f);
+    EXPECT_EQ(scene.view->HitTest(100.0f, 100.0f), scene.cells[kCellCount + 2]);
+    EXPECT_EQ(scene.view->HitTest(301.0f, 100.0f), scene.cells[kCellCount + 3]);
+
+    // 视图偏移限制在缩放后的内容范围内
+    scene.view->SetViewOffset(1e6f, 1e6f);
+    EXPECT_FLOAT_EQ(scene.view->GetViewX(), kCellCount * kCellSize * 2.0f - kViewSize);
+}
+
+} // namespace widget
+} // namespace KiUI